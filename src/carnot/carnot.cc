@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "src/carnot/carnot.h"
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
@@ -58,7 +59,11 @@ class CarnotImpl final : public Carnot {
   Status ExecuteQuery(const std::string& query, const sole::uuid& query_id,
                       types::Time64NSValue time_now, bool analyze) override;
 
-  Status ExecutePlan(const planpb::Plan& plan, const sole::uuid& query_id, bool analyze) override;
+  StatusOr<planpb::Plan> CompileQuery(const std::string& query,
+                                      types::Time64NSValue time_now) override;
+
+  Status ExecutePlan(const planpb::Plan& plan, const sole::uuid& query_id, bool analyze,
+                     exec::YieldFunc yield_func) override;
 
   void RegisterAgentMetadataCallback(AgentMetadataCallbackFunc func) override {
     agent_md_callback_ = func;
@@ -67,6 +72,8 @@ class CarnotImpl final : public Carnot {
   const udf::Registry* FuncRegistry() const override { return engine_state_->func_registry(); }
 
  private:
+  StatusOr<planpb::Plan> CompilePlan(const std::string& query,
+                                     planner::CompilerState* compiler_state);
   Status RegisterUDFs(exec::ExecState* exec_state, plan::Plan* plan);
 
   Status RegisterUDFsInPlanFragment(exec::ExecState* exec_state, plan::PlanFragment* pf);
@@ -121,19 +128,29 @@ Status CarnotImpl::Init(const sole::uuid& agent_id, std::unique_ptr<udf::Registr
 
 Status CarnotImpl::ExecuteQuery(const std::string& query, const sole::uuid& query_id,
                                 types::Time64NSValue time_now, bool analyze) {
-  // Compile the query.
   auto compiler_state = engine_state_->CreateLocalExecutionCompilerState(time_now);
-  PL_ASSIGN_OR_RETURN(auto logical_plan, compiler_.CompileToIR(query, compiler_state.get()));
+  PL_ASSIGN_OR_RETURN(auto plan_proto, CompilePlan(query, compiler_state.get()));
+  auto dest = plan_proto.add_execution_status_destinations();
+  dest->set_grpc_address(compiler_state->result_address());
+  dest->set_ssl_targetname(compiler_state->result_ssl_targetname());
+  return ExecutePlan(plan_proto, query_id, analyze);
+}
+
+StatusOr<planpb::Plan> CarnotImpl::CompileQuery(const std::string& query,
+                                                types::Time64NSValue time_now) {
+  auto compiler_state = engine_state_->CreateLocalExecutionCompilerState(time_now);
+  return CompilePlan(query, compiler_state.get());
+}
+
+StatusOr<planpb::Plan> CarnotImpl::CompilePlan(const std::string& query,
+                                               planner::CompilerState* compiler_state) {
+  PL_ASSIGN_OR_RETURN(auto logical_plan, compiler_.CompileToIR(query, compiler_state));
   // TOOD(james/nserrino/philkuz): This is a hack to make sure that the distributed rule for limits
   // gets run even in carnot_test. We should think about how we want to run distributed analyzer
   // rules in these test envs.
   planner::distributed::AnnotateAbortableSourcesForLimitsRule rule;
   PL_RETURN_IF_ERROR(rule.Execute(logical_plan.get()));
-  PL_ASSIGN_OR_RETURN(auto plan_proto, logical_plan->ToProto());
-  auto dest = plan_proto.add_execution_status_destinations();
-  dest->set_grpc_address(compiler_state->result_address());
-  dest->set_ssl_targetname(compiler_state->result_ssl_targetname());
-  return ExecutePlan(plan_proto, query_id, analyze);
+  return logical_plan->ToProto();
 }
 
 /**
@@ -170,6 +187,7 @@ Status CarnotImpl::RegisterUDFsInPlanFragment(exec::ExecState* exec_state, plan:
         return WalkExpression(exec_state, *filter.expression());
       })
       .OnLimit(no_op)
+      .OnTopK(no_op)
       .OnMemorySink(no_op)
       .OnMemorySource(no_op)
       .OnUnion(no_op)
@@ -317,7 +335,7 @@ Status InitiateOutgoingConns(
 }
 
 Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uuid& query_id,
-                               bool analyze) {
+                               bool analyze, exec::YieldFunc yield_func) {
   auto timer = ElapsedTimer();
   plan::Plan plan;
 
@@ -326,6 +344,7 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
   // For each of the plan fragments in the plan, execute the query.
   std::vector<std::string> output_table_strs;
   auto exec_state = engine_state_->CreateExecState(query_id);
+  exec_state->set_yield_func(std::move(yield_func));
   auto outgoing_conns = GetOutgoingConns(exec_state.get(), logical_plan);
   PL_RETURN_IF_ERROR(InitiateOutgoingConns(query_id, outgoing_conns,
                                            engine_state_->add_auth_to_grpc_context_func()));
@@ -71,14 +71,26 @@ class Carnot : public NotCopyable {
    */
   virtual Status ExecuteQuery(const std::string& query, const sole::uuid& query_id,
                               types::Time64NSValue time_now, bool analyze = false) = 0;
+  /**
+   * Compiles the given query for local execution, without executing it. The returned plan can
+   * be executed with ExecutePlan(), possibly many times.
+   *
+   * @param query the query in the form of a string.
+   * @param time_now the current time.
+   * @return the compiled plan if successful. Error status otherwise.
+   */
+  virtual StatusOr<planpb::Plan> CompileQuery(const std::string& query,
+                                              types::Time64NSValue time_now) = 0;
+
   /**
    * Executes the given logical plan.
    *
    * @param plan the plan protobuf describing what should be compiled.
+   * @param yield_func if set, called between the batches of the query, see exec::YieldFunc.
    * @return a Carnot Return with output_tables if successful. Error status otherwise.
    */
   virtual Status ExecutePlan(const planpb::Plan& plan, const sole::uuid& query_id,
-                             bool analyze = false) = 0;
+                             bool analyze = false, exec::YieldFunc yield_func = nullptr) = 0;
 
   /**
    * Registers the callback for updating the agents metadata state.
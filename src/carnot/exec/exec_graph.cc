@@ -36,6 +36,7 @@
 #include "src/carnot/exec/memory_sink_node.h"
 #include "src/carnot/exec/memory_source_node.h"
 #include "src/carnot/exec/otel_export_sink_node.h"
+#include "src/carnot/exec/topk_node.h"
 #include "src/carnot/exec/udtf_source_node.h"
 #include "src/carnot/exec/union_node.h"
 #include "src/carnot/plan/operators.h"
@@ -81,6 +82,9 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
       .OnLimit([&](auto& node) {
         return OnOperatorImpl<plan::LimitOperator, LimitNode>(node, &descriptors);
       })
+      .OnTopK([&](auto& node) {
+        return OnOperatorImpl<plan::TopKOperator, TopKNode>(node, &descriptors);
+      })
       .OnUnion([&](auto& node) {
         return OnOperatorImpl<plan::UnionOperator, UnionNode>(node, &descriptors);
       })
@@ -214,6 +218,7 @@ Status ExecutionGraph::ExecuteSources() {
         }
         PL_RETURN_IF_ERROR(source->GenerateNext(exec_state_));
       }
+      exec_state_->MaybeYield();
 
       // keep_running will be set to false when a downstream limit for this particular
       // source (set in exec_state) has been reached.
@@ -279,6 +279,55 @@ TEST_F(ExecGraphTest, execute_time) {
       types::ToArrow(out_in2, arrow::default_memory_pool())));
 }
 
+TEST_F(ExecGraphTest, execute_calls_yield_func_between_batches) {
+  planpb::PlanFragment pf_pb;
+  ASSERT_TRUE(TextFormat::MergeFromString(planpb::testutils::kLinearPlanFragment, &pf_pb));
+  std::shared_ptr<plan::PlanFragment> plan_fragment_ = std::make_shared<plan::PlanFragment>(1);
+  ASSERT_OK(plan_fragment_->Init(pf_pb));
+
+  auto plan_state = std::make_unique<plan::PlanState>(func_registry_.get());
+  auto schema = std::make_shared<table_store::schema::Schema>();
+  schema->AddRelation(
+      1, table_store::schema::Relation(
+             std::vector<types::DataType>(
+                 {types::DataType::INT64, types::DataType::BOOLEAN, types::DataType::FLOAT64}),
+             std::vector<std::string>({"a", "b", "c"})));
+
+  table_store::schema::Relation rel(
+      {types::DataType::INT64, types::DataType::BOOLEAN, types::DataType::FLOAT64},
+      {"col1", "col2", "col3"});
+  auto table = Table::Create("test", rel);
+  for (int64_t i = 0; i < 3; ++i) {
+    auto rb = RowBatch(RowDescriptor(rel.col_types()), 1);
+    std::vector<types::Int64Value> col1 = {i};
+    std::vector<types::BoolValue> col2 = {true};
+    std::vector<types::Float64Value> col3 = {1.5};
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col2, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col3, arrow::default_memory_pool())));
+    EXPECT_OK(table->WriteRowBatch(rb));
+  }
+  exec_state_->table_store()->AddTable("numbers", table);
+
+  EXPECT_OK(exec_state_->AddScalarUDF(
+      0, "add", std::vector<types::DataType>({types::DataType::INT64, types::DataType::FLOAT64})));
+  EXPECT_OK(exec_state_->AddScalarUDF(
+      1, "multiply",
+      std::vector<types::DataType>({types::DataType::FLOAT64, types::DataType::INT64})));
+
+  int yield_calls = 0;
+  exec_state_->set_yield_func([&yield_calls]() { ++yield_calls; });
+
+  ExecutionGraph e;
+  ASSERT_OK(e.Init(schema.get(), plan_state.get(), exec_state_.get(), plan_fragment_.get(),
+                   /* collect_exec_node_stats */ false,
+                   /* consecutive_generate_calls_per_source */ 1));
+  ASSERT_OK(e.Execute());
+
+  // Once after each of the batches of the source.
+  EXPECT_GE(yield_calls, 3);
+}
+
 TEST_F(ExecGraphTest, two_limits_dont_interfere) {
   planpb::PlanFragment pf_pb;
   ASSERT_TRUE(
@@ -20,6 +20,7 @@
 
 #include <arrow/memory_pool.h>
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -53,6 +54,9 @@ using MetricsStubGenerator = std::function<
 using TraceStubGenerator = std::function<
     std::unique_ptr<opentelemetry::proto::collector::trace::v1::TraceService::StubInterface>(
         const std::string& address, bool insecure)>;
+// Called by the execution graph between the batches of a query. It may block, to pause the query
+// in favor of more urgent ones.
+using YieldFunc = std::function<void()>;
 
 /**
  * ExecState manages the execution state for a single query. A new one will
@@ -192,6 +196,15 @@ class ExecState {
 
   GRPCRouter* grpc_router() { return grpc_router_; }
 
+  void set_yield_func(YieldFunc yield_func) { yield_func_ = std::move(yield_func); }
+
+  // Gives the caller of the query a chance to pause it. Called between the batches of the sources.
+  void MaybeYield() {
+    if (yield_func_) {
+      yield_func_();
+    }
+  }
+
   void AddAuthToGRPCClientContext(grpc::ClientContext* ctx) {
     CHECK(add_auth_to_grpc_client_context_func_);
     add_auth_to_grpc_client_context_func_(ctx);
@@ -209,6 +222,7 @@ class ExecState {
   const sole::uuid query_id_;
   ml::ModelPool* model_pool_;
   GRPCRouter* grpc_router_ = nullptr;
+  YieldFunc yield_func_;
   std::function<void(grpc::ClientContext*)> add_auth_to_grpc_client_context_func_;
 
   int64_t current_source_ = 0;
@@ -26,6 +26,7 @@
 #include <iterator>
 #include <memory>
 #include <ostream>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/str_join.h>
@@ -139,6 +140,9 @@ Status ScalarExpressionEvaluator::Evaluate(ExecState* exec_state, const RowBatch
   CHECK(output != nullptr);
   CHECK_EQ(static_cast<size_t>(output->num_columns()), expressions_.size());
 
+  if (function_ctx_ != nullptr) {
+    function_ctx_->StartBatch();
+  }
   for (const auto& expression : expressions_) {
     PL_RETURN_IF_ERROR(EvaluateSingleExpression(exec_state, input, *expression, output));
   }
@@ -151,6 +155,20 @@ std::string ScalarExpressionEvaluator::DebugString() {
   return absl::Substitute("ExpressionEvaluator<$0>", absl::StrJoin(debug_strs, ","));
 }
 
+void ScalarExpressionEvaluator::SetExecArgColumns(const plan::ScalarFunc& fn) {
+  if (function_ctx_ == nullptr) {
+    return;
+  }
+  std::vector<int64_t> columns;
+  columns.reserve(fn.arg_deps().size());
+  for (const auto& arg : fn.arg_deps()) {
+    columns.push_back(arg->ExpressionType() == plan::Expression::kColumn
+                          ? static_cast<const plan::Column&>(*arg).Index()
+                          : -1);
+  }
+  function_ctx_->set_exec_arg_columns(std::move(columns));
+}
+
 Status ScalarExpressionEvaluator::InitFuncsInExpression(
     ExecState* exec_state, std::shared_ptr<const plan::ScalarExpression> expr) {
   plan::ExpressionWalker<bool> walker;
@@ -232,6 +250,7 @@ VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
           raw_children.emplace_back(child.get());
         }
         auto output = types::ColumnWrapper::Make(def->exec_return_type(), num_rows);
+        SetExecArgColumns(fn);
         // TODO(zasgar): need a better way to handle errors.
         PL_CHECK_OK(def->ExecBatch(udf, function_ctx_, raw_children, output.get(), num_rows));
         return output;
@@ -328,6 +347,7 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
           raw_children.push_back(child.get());
         }
 
+        SetExecArgColumns(fn);
         PL_CHECK_OK(def->ExecBatchArrow(udf, function_ctx_, raw_children, output.get(), num_rows));
 
         std::shared_ptr<arrow::Array> output_array;
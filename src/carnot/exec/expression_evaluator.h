@@ -123,6 +123,8 @@ class ScalarExpressionEvaluator : public ExpressionEvaluator {
                                           table_store::schema::RowBatch* output) = 0;
   Status InitFuncsInExpression(ExecState* exec_state,
                                std::shared_ptr<const plan::ScalarExpression> expr);
+  // Tells the UDFs which input columns are passed to fn, see udf::FunctionContext.
+  void SetExecArgColumns(const plan::ScalarFunc& fn);
   plan::ConstScalarExpressionVector expressions_;
   udf::FunctionContext* function_ctx_ = nullptr;
   std::map<int64_t, std::unique_ptr<udf::ScalarUDF>> id_to_udf_map_;
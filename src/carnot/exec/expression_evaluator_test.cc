@@ -76,6 +76,20 @@ class InitArgUDF : public udf::ScalarUDF {
   int64_t i_;
 };
 
+// Outputs which input columns it was given, as 100 * the column of the first argument + the column
+// of the second.
+class ArgColumnsUDF : public udf::ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::Int64Value, types::Int64Value) { return 0; }
+  Status ExecBatch(FunctionContext* ctx, size_t count, types::Int64Value* out,
+                   const types::Int64Value*, const types::Int64Value*) {
+    for (size_t idx = 0; idx < count; ++idx) {
+      out[idx] = 100 * ctx->exec_arg_column(0) + ctx->exec_arg_column(1);
+    }
+    return Status::OK();
+  }
+};
+
 std::shared_ptr<plan::ScalarExpression> AddScalarExpr() {
   planpb::ScalarExpression se_pb;
   google::protobuf::TextFormat::MergeFromString(kAddScalarFuncPbtxt, &se_pb);
@@ -116,6 +130,7 @@ class ScalarExpressionTest : public ::testing::TestWithParam<ScalarExpressionEva
 
     EXPECT_TRUE(func_registry_->Register<AddUDF>("add").ok());
     EXPECT_TRUE(func_registry_->Register<InitArgUDF>("init_arg").ok());
+    EXPECT_TRUE(func_registry_->Register<ArgColumnsUDF>("arg_columns").ok());
     exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
                                               MockResultSinkStubGenerator, MockMetricsStubGenerator,
                                               MockTraceStubGenerator, sole::uuid4(), nullptr);
@@ -123,6 +138,7 @@ class ScalarExpressionTest : public ::testing::TestWithParam<ScalarExpressionEva
         0, "add", std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
     EXPECT_OK(
         exec_state_->AddScalarUDF(1, "init_arg", {types::STRING, types::INT64, types::STRING}));
+    EXPECT_OK(exec_state_->AddScalarUDF(2, "arg_columns", {types::INT64, types::INT64}));
 
     std::vector<types::Int64Value> in1 = {1, 2, 3};
     std::vector<types::Int64Value> in2 = {3, 4, 5};
@@ -270,6 +286,42 @@ TEST_P(ScalarExpressionTest, eval_init_arg_udf) {
   EXPECT_EQ("init_arg, 1234, c", casted->GetString(2));
 }
 
+constexpr char kArgColumnsScalarFunc[] = R"pb(
+func {
+  name: "arg_columns"
+  id: 2
+  args {
+    column {
+      node: 0
+      index: 1
+    }
+  }
+  args {
+    constant {
+      data_type: INT64
+      int64_value: 1337
+    }
+  }
+  args_data_types: INT64
+  args_data_types: INT64
+}
+)pb";
+
+// The UDFs are told which input column each argument comes from, so that they can share work
+// between calls on the same column.
+TEST_P(ScalarExpressionTest, exec_arg_columns) {
+  RowDescriptor rd_output({types::DataType::INT64});
+  RowBatch output_rb(rd_output, input_rb_->num_rows());
+
+  auto se = ScalarExpressionOf(kArgColumnsScalarFunc);
+  RunEvaluator({se}, &output_rb);
+
+  auto casted = static_cast<arrow::Int64Array*>(output_rb.ColumnAt(0).get());
+  // Column 1, and a constant.
+  EXPECT_EQ(99, casted->Value(0));
+  EXPECT_EQ(1, function_ctx_->batch_idx());
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
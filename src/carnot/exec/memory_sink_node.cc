@@ -62,7 +62,21 @@ Status MemorySinkNode::PrepareImpl(ExecState* exec_state_) {
     col_names.push_back(plan_node_->ColumnName(i));
   }
 
-  table_ = Table::Create(TableName(), Relation(input_descriptor_->types(), col_names));
+  Relation relation(input_descriptor_->types(), col_names);
+
+  if (plan_node_->append()) {
+    table_ = exec_state_->table_store()->GetSharedTable(plan_node_->TableName());
+    if (table_ != nullptr) {
+      if (table_->GetRelation() != relation) {
+        return error::InvalidArgument(
+            "Cannot append to table '$0', its relation $1 does not match the sink's relation $2",
+            plan_node_->TableName(), table_->GetRelation().DebugString(), relation.DebugString());
+      }
+      return Status::OK();
+    }
+  }
+
+  table_ = Table::Create(TableName(), relation);
   exec_state_->table_store()->AddTable(plan_node_->TableName(), table_);
 
   return Status::OK();
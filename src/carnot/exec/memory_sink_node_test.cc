@@ -182,6 +182,54 @@ TEST_F(MemorySinkNodeTest, zero_row_row_batch_eos) {
   EXPECT_EQ(0, exec_state_->table_store()->GetTable("cpu_15s")->GetTableStats().batches_added);
 }
 
+TEST_F(MemorySinkNodeTest, append_to_existing_table) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::BOOLEAN});
+  RowDescriptor output_rd({});
+
+  table_store::schema::Relation rel({types::DataType::INT64, types::DataType::BOOLEAN},
+                                    {"test_col1", "test_col2"});
+  auto existing_table = table_store::Table::Create("cpu_15s", rel);
+  exec_state_->table_store()->AddTable("cpu_15s", existing_table);
+  ASSERT_OK(existing_table->WriteRowBatch(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                                               .AddColumn<types::Int64Value>({1, 2})
+                                               .AddColumn<types::BoolValue>({true, false})
+                                               .get()));
+
+  auto op_proto = planpb::testutils::CreateTestSink2PB();
+  op_proto.mutable_mem_sink_op()->set_append(true);
+  auto plan_node = plan::MemorySinkOperator::FromProto(op_proto, 1);
+
+  auto tester = exec::ExecNodeTester<MemorySinkNode, plan::MemorySinkOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({3, 4})
+                       .AddColumn<types::BoolValue>({false, true})
+                       .get(),
+                   false, 0)
+      .Close();
+
+  auto table = exec_state_->table_store()->GetTable("cpu_15s");
+  EXPECT_EQ(existing_table.get(), table);
+  EXPECT_EQ(2, table->GetTableStats().batches_added);
+}
+
+TEST_F(MemorySinkNodeTest, append_to_incompatible_table) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::BOOLEAN});
+  RowDescriptor output_rd({});
+
+  table_store::schema::Relation rel({types::DataType::INT64}, {"test_col1"});
+  exec_state_->table_store()->AddTable("cpu_15s", table_store::Table::Create("cpu_15s", rel));
+
+  auto op_proto = planpb::testutils::CreateTestSink2PB();
+  op_proto.mutable_mem_sink_op()->set_append(true);
+  auto plan_node = plan::MemorySinkOperator::FromProto(op_proto, 1);
+
+  auto node = std::make_unique<MemorySinkNode>();
+  ASSERT_OK(node->Init(*plan_node, output_rd, {input_rd}));
+  EXPECT_NOT_OK(node->Prepare(exec_state_.get()));
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -22,8 +22,10 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include <cstring>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -37,6 +39,27 @@ namespace carnot {
 namespace exec {
 namespace ml {
 
+namespace internal {
+
+// Helpers for the binary serialization of coresets, which copies the float buffers as is. It is
+// meant for partial aggregates exchanged between agents of the same build.
+template <typename T>
+void AppendRaw(const T* data, size_t count, std::string* buf) {
+  buf->append(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+template <typename T>
+Status ExtractRaw(std::string_view* buf, size_t count, T* data) {
+  if (buf->size() < count * sizeof(T)) {
+    return error::InvalidArgument("Truncated serialized coreset.");
+  }
+  std::memcpy(data, buf->data(), count * sizeof(T));
+  buf->remove_prefix(count * sizeof(T));
+  return Status::OK();
+}
+
+}  // namespace internal
+
 class WeightedPointSet {
  public:
   WeightedPointSet() : size_(0) {}
@@ -118,6 +141,33 @@ class WeightedPointSet {
     size_ = points.Size();
   }
 
+  void Serialize(std::string* buf) const {
+    const int32_t dims[] = {size_, static_cast<int32_t>(points_.cols())};
+    internal::AppendRaw(dims, 2, buf);
+    internal::AppendRaw(points_.data(), points_.size(), buf);
+    internal::AppendRaw(weights_.data(), weights_.size(), buf);
+  }
+
+  Status Deserialize(std::string_view* buf) {
+    int32_t dims[2];
+    PL_RETURN_IF_ERROR(internal::ExtractRaw(buf, 2, dims));
+    if (dims[0] < 0 || dims[1] < 0) {
+      return error::InvalidArgument("Invalid dimensions of serialized point set.");
+    }
+    // Check the size before allocating, since the buffer comes from another agent.
+    const uint64_t num_floats =
+        static_cast<uint64_t>(dims[0]) * (static_cast<uint64_t>(dims[1]) + 1);
+    if (buf->size() / sizeof(float) < num_floats) {
+      return error::InvalidArgument("Truncated serialized coreset.");
+    }
+    size_ = dims[0];
+    point_size_ = dims[1];
+    points_.resize(size_, point_size_);
+    weights_.resize(size_);
+    PL_RETURN_IF_ERROR(internal::ExtractRaw(buf, points_.size(), points_.data()));
+    return internal::ExtractRaw(buf, weights_.size(), weights_.data());
+  }
+
   static std::shared_ptr<WeightedPointSet> CreateFromJSON(
       const rapidjson::Document::ValueType& doc) {
     auto set = std::make_shared<WeightedPointSet>();
@@ -221,6 +271,27 @@ class CoresetTree {
     }
   }
 
+  bool empty() const {
+    for (const auto& level : levels_) {
+      if (!level.empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Whether all the non-empty sets of the tree have points of the given size.
+  bool HasPointSize(int point_size) const {
+    for (const auto& level : levels_) {
+      for (const auto& set : level) {
+        if (set->size() > 0 && set->point_size() != point_size) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
   void ToJSON(rapidjson::Writer<rapidjson::StringBuffer>* writer) const {
     writer->StartObject();
     writer->Key("coreset_size");
@@ -243,6 +314,42 @@ class CoresetTree {
     writer->EndObject();
   }
 
+  void Serialize(std::string* buf) const {
+    const uint64_t header[] = {coreset_size_, r_, levels_.size()};
+    internal::AppendRaw(header, 3, buf);
+    for (const auto& level : levels_) {
+      const uint64_t level_size = level.size();
+      internal::AppendRaw(&level_size, 1, buf);
+      for (const auto& set : level) {
+        set->Serialize(buf);
+      }
+    }
+  }
+
+  Status Deserialize(std::string_view* buf) {
+    uint64_t header[3];
+    PL_RETURN_IF_ERROR(internal::ExtractRaw(buf, 3, header));
+    coreset_size_ = header[0];
+    r_ = header[1];
+    levels_.clear();
+    for (uint64_t i = 0; i < header[2]; ++i) {
+      uint64_t level_size;
+      PL_RETURN_IF_ERROR(internal::ExtractRaw(buf, 1, &level_size));
+      // Levels are coresetted once they reach r sets.
+      if (level_size >= r_) {
+        return error::InvalidArgument("Level $0 of serialized coreset tree has $1 sets.", i,
+                                      level_size);
+      }
+      Level& level = levels_.emplace_back();
+      for (uint64_t j = 0; j < level_size; ++j) {
+        auto set = std::make_shared<WeightedPointSet>();
+        PL_RETURN_IF_ERROR(set->Deserialize(buf));
+        level.push_back(std::move(set));
+      }
+    }
+    return Status::OK();
+  }
+
   void FromJSON(const rapidjson::Document::ValueType& doc) {
     DCHECK(doc.IsObject());
     DCHECK(doc.HasMember("coreset_size"));
@@ -308,7 +415,22 @@ class CoresetDriver {
     return WeightedPointSet::Union({coreset, CurrentSet()});
   }
 
+  int d() const { return d_; }
+
+  bool empty() const { return size_ == 0 && coreset_data_.empty(); }
+
+  /**
+   * Merges the state of another driver. An empty driver takes the dimension of the other one, so
+   * that the agent merging partial aggregates does not need to know it in advance.
+   */
   void Merge(const CoresetDriver<TCoresetStructure>& other) {
+    if (other.empty()) {
+      return;
+    }
+    if (other.d_ != d_ && empty()) {
+      SetDimension(other.d_);
+    }
+    DCHECK_EQ(other.d_, d_);
     coreset_data_.Merge(other.coreset_data_);
     auto new_set = WeightedPointSet::Union({CurrentSet(), other.CurrentSet()});
     if (new_set->size() >= m_) {
@@ -331,6 +453,42 @@ class CoresetDriver {
     return sb.GetString();
   }
 
+  /**
+   * Serializes the state in a compact binary form, to be shipped as a partial aggregate. Its size
+   * is bounded by the base bucket plus fewer than r coresets per level of the tree, so it grows
+   * only logarithmically with the number of points.
+   */
+  std::string Serialize() const {
+    std::string buf;
+    CurrentSet()->Serialize(&buf);
+    coreset_data_.Serialize(&buf);
+    return buf;
+  }
+
+  /**
+   * Replaces the state with a serialized one. The dimension of the points is taken from the
+   * serialized state.
+   */
+  Status Deserialize(std::string_view buf) {
+    auto set = std::make_shared<WeightedPointSet>();
+    PL_RETURN_IF_ERROR(set->Deserialize(&buf));
+    if (set->size() >= m_ || set->point_size() <= 0) {
+      return error::InvalidArgument(
+          "Serialized coreset has invalid dimensions [size=$0, d=$1] for m=$2", set->size(),
+          set->point_size(), m_);
+    }
+    PL_RETURN_IF_ERROR(coreset_data_.Deserialize(&buf));
+    if (!buf.empty()) {
+      return error::InvalidArgument("Unexpected trailing bytes in serialized coreset.");
+    }
+    if (!coreset_data_.HasPointSize(set->point_size())) {
+      return error::InvalidArgument("Serialized coreset has points of different dimensions.");
+    }
+    SetDimension(set->point_size());
+    GatherPointsFromSet(set);
+    return Status::OK();
+  }
+
   void FromJSON(std::string data) {
     rapidjson::Document doc;
     doc.Parse(data.data());
@@ -351,6 +509,10 @@ class CoresetDriver {
         points_(Eigen::seq(0, size_ - 1), Eigen::indexing::all),
         weights_(Eigen::seq(0, size_ - 1)));
   }
+  void SetDimension(int d) {
+    d_ = d;
+    points_.resize(m_, d_);
+  }
   void GatherPointsFromSet(std::shared_ptr<WeightedPointSet> set) {
     size_ = set->size();
     if (set->size() == 1) {
@@ -39,6 +39,23 @@ static void BM_CoresetTreeUpdate(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_CoresetTreeBuild(benchmark::State& state) {
+  int d = 64;
+  Eigen::MatrixXf points = Eigen::MatrixXf::Random(state.range(0), d);
+  Eigen::VectorXf point(d);
+
+  for (auto _ : state) {
+    CoresetDriver<CoresetTree<KMeansCoreset>> driver(64, d, 4, 64);
+    for (int i = 0; i < points.rows(); i++) {
+      point = points.row(i).transpose();
+      driver.Update(point);
+    }
+    benchmark::DoNotOptimize(driver.Query());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_CoresetTreeQuery(benchmark::State& state) {
   int d = 64;
@@ -90,12 +107,45 @@ static void BM_CoresetSerialize(benchmark::State& state) {
   }
 
   for (auto _ : state) {
-    benchmark::DoNotOptimize(driver.ToJSON());
+    benchmark::DoNotOptimize(driver.Serialize());
   }
+  state.counters["bytes"] = driver.Serialize().size();
 }
 
 // NOLINTNEXTLINE : runtime/references.
 static void BM_CoresetDeserialize(benchmark::State& state) {
+  int d = 64;
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver(64, d, 4, 64);
+  Eigen::VectorXf point = Eigen::VectorXf::Random(d);
+  for (int i = 0; i < 10000; i++) {
+    driver.Update(point);
+  }
+  auto serialized = driver.Serialize();
+
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver2(64, d, 4, 64);
+
+  for (auto _ : state) {
+    PL_CHECK_OK(driver2.Deserialize(serialized));
+  }
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_CoresetSerializeJSON(benchmark::State& state) {
+  int d = 64;
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver(64, d, 4, 64);
+  Eigen::VectorXf point = Eigen::VectorXf::Random(d);
+  for (int i = 0; i < 10000; i++) {
+    driver.Update(point);
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(driver.ToJSON());
+  }
+  state.counters["bytes"] = driver.ToJSON().size();
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_CoresetDeserializeJSON(benchmark::State& state) {
   int d = 64;
   CoresetDriver<CoresetTree<KMeansCoreset>> driver(64, d, 4, 64);
   Eigen::VectorXf point = Eigen::VectorXf::Random(d);
@@ -113,7 +163,10 @@ static void BM_CoresetDeserialize(benchmark::State& state) {
 
 BENCHMARK(BM_CoresetTreeUpdate);
 BENCHMARK(BM_CoresetFromWeightedPointSet);
+BENCHMARK(BM_CoresetTreeBuild)->Arg(1000000)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_CoresetTreeQuery);
 BENCHMARK(BM_CoresetTreeMerge);
 BENCHMARK(BM_CoresetSerialize);
 BENCHMARK(BM_CoresetDeserialize);
+BENCHMARK(BM_CoresetSerializeJSON);
+BENCHMARK(BM_CoresetDeserializeJSON);
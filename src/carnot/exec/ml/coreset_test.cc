@@ -18,8 +18,10 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <string>
 
 #include "src/carnot/exec/ml/coreset.h"
+#include "src/common/testing/testing.h"
 
 namespace px {
 namespace carnot {
@@ -105,6 +107,47 @@ TEST(CoresetDriver, serialization) {
   EXPECT_EQ(256, point_set->size());
 }
 
+TEST(CoresetDriver, binary_serialization) {
+  int d = 64;
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver(64, d, 4, 64);
+  // Insert 10 buckets worth of points, and a partial bucket.
+  for (int i = 0; i < 64 * 10 + 5; i++) {
+    driver.Update(Eigen::VectorXf::Random(d));
+  }
+  auto serialized = driver.Serialize();
+  // The points are stored as raw floats.
+  EXPECT_LT(serialized.size(), (4 * 64 + 5) * (d + 1) * sizeof(float) + 1024);
+
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver2(64, d, 4, 64);
+  ASSERT_OK(driver2.Deserialize(serialized));
+  auto expected = driver.Query();
+  auto actual = driver2.Query();
+  ASSERT_EQ(expected->size(), 4 * 64 + 5);
+  EXPECT_EQ(actual->points(), expected->points());
+  EXPECT_EQ(actual->weights(), expected->weights());
+
+  EXPECT_NOT_OK(driver2.Deserialize(serialized.substr(0, serialized.size() - 1)));
+  EXPECT_NOT_OK(driver2.Deserialize(serialized + "x"));
+  // The dimension is taken from the serialized state.
+  CoresetDriver<CoresetTree<KMeansCoreset>> other_dims(64, d / 2, 4, 64);
+  ASSERT_OK(other_dims.Deserialize(serialized));
+  EXPECT_EQ(other_dims.d(), d);
+  EXPECT_EQ(other_dims.Query()->points(), expected->points());
+}
+
+TEST(CoresetDriver, binary_serialization_rejects_oversized_dimensions) {
+  // A header that claims far more points than the buffer holds must not be allocated.
+  const int32_t dims[] = {1 << 30, 1 << 30};
+  std::string serialized(reinterpret_cast<const char*>(dims), sizeof(dims));
+  serialized.append(64, '\0');
+  CoresetDriver<CoresetTree<KMeansCoreset>> driver(64, 2, 4, 64);
+  EXPECT_NOT_OK(driver.Deserialize(serialized));
+
+  WeightedPointSet set;
+  std::string_view buf = serialized;
+  EXPECT_NOT_OK(set.Deserialize(&buf));
+}
+
 }  // namespace ml
 }  // namespace exec
 }  // namespace carnot
@@ -17,6 +17,7 @@
  */
 
 #include "src/carnot/exec/ml/kmeans.h"
+#include <algorithm>
 #include <random>
 
 #include "src/carnot/exec/ml/sampling.h"
@@ -48,19 +49,40 @@ void KMeans::Fit(std::shared_ptr<WeightedPointSet> set) {
   }
 }
 
+namespace {
+
+// Number of points whose distances to the centroids are computed at once. Bounds the size of the
+// distance matrix, so that it stays in cache.
+constexpr int kBlockSize = 1024;
+
+}  // namespace
+
 bool KMeans::LloydsIteration(const Eigen::MatrixXf& points, const Eigen::VectorXf& weights) {
   Eigen::MatrixXf new_centroids = Eigen::MatrixXf::Zero(centroids_.rows(), centroids_.cols());
   Eigen::ArrayXf centroid_weights = Eigen::ArrayXf::Zero(centroids_.rows());
 
-  for (int i = 0; i < points.rows(); i++) {
-    Eigen::VectorXf::Index closest_centroid;
-    (centroids_.rowwise() - points(i, Eigen::indexing::all))
-        .rowwise()
-        .squaredNorm()
-        .minCoeff(&closest_centroid);
-    new_centroids(closest_centroid, Eigen::indexing::all) +=
-        weights(i) * points(i, Eigen::indexing::all);
-    centroid_weights(closest_centroid) += weights(i);
+  // The closest centroid minimizes |c|^2 - 2 p.c, since |p - c|^2 = |p|^2 - 2 p.c + |c|^2.
+  // Computing that for a block of points is a matrix product, which Eigen runs with SIMD kernels
+  // over contiguous buffers, instead of one small reduction per point and centroid.
+  const Eigen::RowVectorXf centroid_norms = centroids_.rowwise().squaredNorm().transpose();
+  Eigen::MatrixXf dists;
+  Eigen::MatrixXf assignments;
+  for (int start = 0; start < points.rows(); start += kBlockSize) {
+    const int n = std::min<int>(kBlockSize, points.rows() - start);
+    const auto block = points.middleRows(start, n);
+    dists.noalias() = -2 * block * centroids_.transpose();
+    dists.rowwise() += centroid_norms;
+
+    // The weighted one-hot assignment of each point, so that the sums of the points assigned to
+    // each centroid are also a matrix product.
+    assignments.setZero(n, centroids_.rows());
+    for (int i = 0; i < n; i++) {
+      Eigen::Index closest_centroid;
+      dists.row(i).minCoeff(&closest_centroid);
+      assignments(i, closest_centroid) = weights(start + i);
+    }
+    new_centroids.noalias() += assignments.transpose() * block;
+    centroid_weights += assignments.colwise().sum().transpose().array();
   }
 
   for (int i = 0; i < k_; i++) {
@@ -83,20 +105,18 @@ void KMeans::KMeansPlusPlusInit(const Eigen::MatrixXf& points, const Eigen::Vect
   auto firstCentroid = dist(random_gen_);
   centroids_(0, Eigen::indexing::all) = points(firstCentroid, Eigen::indexing::all);
 
+  // The squared distance of each point to its closest centroid so far. Only the distances to the
+  // newest centroid have to be computed in each round.
+  Eigen::VectorXf min_dists =
+      (points.rowwise() - centroids_.row(0)).rowwise().squaredNorm();
   Eigen::VectorXf probDist(points.rows());
   for (auto i = 1; i < k_; i++) {
-    for (auto j = 0; j < probDist.rows(); j++) {
-      auto point = points(j, Eigen::indexing::all);
-      Eigen::VectorXf::Index closestCentroid;
-      auto dist = (centroids_(Eigen::seq(0, i - 1), Eigen::indexing::all).rowwise() - point)
-                      .rowwise()
-                      .squaredNorm()
-                      .minCoeff(&closestCentroid);
-      probDist(j) = weights(j) * dist;
-    }
+    probDist = weights.cwiseProduct(min_dists);
     std::discrete_distribution<> pointDist(probDist.begin(), probDist.end());
     auto ind = pointDist(random_gen_);
     centroids_(i, Eigen::indexing::all) = points(ind, Eigen::indexing::all);
+    min_dists =
+        min_dists.cwiseMin((points.rowwise() - centroids_.row(i)).rowwise().squaredNorm());
   }
 }
 
@@ -31,13 +31,14 @@ static void BM_KMeansFit(benchmark::State& state) {
   int d = 64;
   KMeans kmeans(k);
 
-  Eigen::MatrixXf points = Eigen::MatrixXf::Random(500, d);
-  Eigen::VectorXf weights = Eigen::VectorXf::Random(500);
+  Eigen::MatrixXf points = Eigen::MatrixXf::Random(state.range(0), d);
+  Eigen::VectorXf weights = Eigen::VectorXf::Ones(state.range(0));
   auto set = std::make_shared<WeightedPointSet>(points, weights);
 
   for (auto _ : state) {
     kmeans.Fit(set);
   }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
 }
 
 // NOLINTNEXTLINE : runtime/references.
@@ -58,5 +59,5 @@ static void BM_KMeansTransform(benchmark::State& state) {
   }
 }
 
-BENCHMARK(BM_KMeansFit);
+BENCHMARK(BM_KMeansFit)->Arg(500)->Arg(1000000)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_KMeansTransform);
@@ -23,9 +23,9 @@ namespace carnot {
 namespace exec {
 namespace ml {
 
-static int load_ints_from_json(std::string in, int32_t* arr, int max_num) {
+static int load_ints_from_json(std::string_view in, int32_t* arr, int max_num) {
   rapidjson::Document d;
-  rapidjson::ParseResult ok = d.Parse(in.data());
+  rapidjson::ParseResult ok = d.Parse(in.data(), in.size());
   // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
   if (ok == nullptr) {
     return 0;
@@ -49,57 +49,74 @@ static int load_ints_from_json(std::string in, int32_t* arr, int max_num) {
   return count;
 }
 
-void TransformerExecutor::Execute(std::string doc, std::string* out) {
-  // LOG(INFO) << "inputs: " << tf_interpreter_->inputs().size() << "\n";
-  // LOG(INFO) << "input(0) name: " << tf_interpreter_->GetInputName(0) << "\n";
-
-  // int t_size = tf_interpreter_->tensors_size();
-  // for (int i = 0; i < t_size; i++) {
-  //   if (tf_interpreter_->tensor(i)->name) {
-  //     LOG(INFO) << i << ": " << tf_interpreter_->tensor(i)->name << ", "
-  //               << tf_interpreter_->tensor(i)->bytes << ", "
-  //               << tf_interpreter_->tensor(i)->type;
-  //   }
-  // }
-  auto input = tf_interpreter_->typed_input_tensor<int32_t>(0);
-  if (input == nullptr) {
-    LOG(INFO) << "Error getting typed input tensor, most likely using wrong type for this model";
-    *out = "";
-    return;
+bool TransformerExecutor::ResizeBatch(int batch_size) {
+  if (batch_size == batch_size_) {
+    return true;
   }
-
-  auto count = load_ints_from_json(doc, input, max_length_);
-  if (count == 0) {
-    // Either input array was empty or there was an error parsing the json, either way don't
-    // continue.
-    *out = "";
-    return;
+  tf_interpreter_->ResizeInputTensor(tf_interpreter_->inputs()[0], {batch_size, max_length_});
+  if (tf_interpreter_->AllocateTensors() != kTfLiteOk) {
+    batch_size_ = 0;
+    return false;
   }
+  batch_size_ = batch_size;
+  return true;
+}
 
-  // Add 1 to each token to account for pad token.
-  for (int i = 0; i < count; i++) {
-    input[i] = input[i] + 1;
-  }
+void TransformerExecutor::Execute(std::string doc, std::string* out) {
+  std::vector<std::string> outs;
+  ExecuteBatch({doc}, &outs);
+  *out = std::move(outs[0]);
+}
 
-  for (int i = count; i < max_length_; i++) {
-    input[i] = 0;
-  }
+void TransformerExecutor::ExecuteBatch(const std::vector<std::string_view>& docs,
+                                       std::vector<std::string>* out) {
+  out->assign(docs.size(), "");
 
-  const int embedding_size = 256;
+  for (size_t start = 0; start < docs.size(); start += kMaxBatchSize) {
+    const int batch_size = std::min<size_t>(kMaxBatchSize, docs.size() - start);
+    // Only the last mini-batch of a record batch is smaller, so the tensors are rarely
+    // reallocated.
+    if (!ResizeBatch(batch_size)) {
+      LOG(INFO) << "Failed to allocate tensors";
+      return;
+    }
 
-  tf_interpreter_->Invoke();
+    auto input = tf_interpreter_->typed_input_tensor<int32_t>(0);
+    if (input == nullptr) {
+      LOG(INFO) << "Error getting typed input tensor, most likely using wrong type for this model";
+      return;
+    }
 
-  auto output = tf_interpreter_->typed_output_tensor<float>(0);
+    std::vector<bool> valid(batch_size);
+    bool any_valid = false;
+    for (int b = 0; b < batch_size; ++b) {
+      int32_t* row = input + b * max_length_;
+      auto count = load_ints_from_json(docs[start + b], row, max_length_);
+      // Either input array was empty or there was an error parsing the json, either way the
+      // document gets no embedding. Its row is still fed to the model, as padding.
+      valid[b] = count != 0;
+      any_valid |= valid[b];
 
-  // Copy output to json array.
-  rapidjson::StringBuffer sb;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-  writer.StartArray();
-  for (int i = 0; i < embedding_size; i++) {
-    writer.Double(output[i]);
+      // Add 1 to each token to account for pad token.
+      for (int i = 0; i < count; i++) {
+        row[i] = row[i] + 1;
+      }
+      std::fill(row + count, row + max_length_, 0);
+    }
+    if (!any_valid) {
+      continue;
+    }
+
+    tf_interpreter_->Invoke();
+
+    auto output = tf_interpreter_->typed_output_tensor<float>(0);
+    for (int b = 0; b < batch_size; ++b) {
+      if (valid[b]) {
+        (*out)[start + b].assign(reinterpret_cast<const char*>(output + b * kEmbeddingSize),
+                                 kEmbeddingSize * sizeof(float));
+      }
+    }
   }
-  writer.EndArray();
-  *out = sb.GetString();
 }
 
 }  // namespace ml
@@ -24,8 +24,12 @@
 #include <tensorflow/lite/interpreter.h>
 #include <tensorflow/lite/kernels/register.h>
 #include <tensorflow/lite/model.h>
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include "src/carnot/exec/ml/model_executor.h"
 #include "src/common/base/utils.h"
 
@@ -41,24 +45,47 @@ class TransformerExecutor : public ModelExecutor {
 
   static constexpr ModelType Type() { return kTransformer; }
 
+  // Number of floats in the embedding of a document.
+  static constexpr int kEmbeddingSize = 256;
+
   void Init(std::string model_proto_path) {
     model_ = tflite::FlatBufferModel::BuildFromFile(model_proto_path.c_str());
     tflite::ops::builtin::BuiltinOpResolver resolver;
     tflite::InterpreterBuilder(*model_, resolver)(&tf_interpreter_);
-    tf_interpreter_->ResizeInputTensor(tf_interpreter_->inputs()[0], {1, max_length_});
-    if (tf_interpreter_->AllocateTensors() != kTfLiteOk) {
+    // Let the interpreter split the work of each invocation across cores, but leave room for the
+    // rest of the query.
+    const int num_threads = std::clamp<int>(std::thread::hardware_concurrency() / 2, 1, 4);
+    tf_interpreter_->SetNumThreads(num_threads);
+    if (!ResizeBatch(1)) {
       LOG(INFO) << "Failed to allocate tensors";
     } else {
       LOG(INFO) << "Init Transformer model";
     }
   }
 
+  /**
+   * Computes the embedding of a document, which is a JSON array of token ids.
+   * The embedding is written to out as kEmbeddingSize packed floats, or an empty string if the
+   * document could not be parsed.
+   */
   void Execute(std::string doc, std::string* out);
 
+  /**
+   * Same as Execute() for each of the docs, but feeds them to the model in padded mini-batches of
+   * up to kMaxBatchSize documents, which amortizes the cost of invoking the model.
+   */
+  void ExecuteBatch(const std::vector<std::string_view>& docs, std::vector<std::string>* out);
+
  private:
+  static constexpr int kMaxBatchSize = 32;
+
+  // Resizes the input tensor to hold batch_size documents. Returns false on failure.
+  bool ResizeBatch(int batch_size);
+
   std::unique_ptr<tflite::Interpreter> tf_interpreter_;
   std::unique_ptr<tflite::FlatBufferModel> model_;
   int max_length_ = 64;
+  int batch_size_ = 0;
 };
 
 }  // namespace ml
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/topk_node.h"
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+namespace {
+
+// The buffered rows are compacted once there are this many times more of them than the rows that
+// are kept, so that the cost of the compaction is amortized over the rows that were dropped.
+constexpr size_t kCompactionFactor = 4;
+// Small values of k are not worth compacting for until this many rows are buffered.
+constexpr size_t kMinRowsToCompact = 4096;
+
+// Returns <0, 0 or >0 depending on whether the value at lhs comes before, ties with, or comes after
+// the value at rhs in the output. NaNs are unordered, so they are put last in both directions,
+// as they would otherwise break the strict weak ordering of the heap and the sort.
+template <types::DataType DT>
+int CompareValues(const arrow::Array* lhs, int64_t lhs_idx, const arrow::Array* rhs,
+                  int64_t rhs_idx, bool ascending) {
+  int cmp;
+  if constexpr (DT == types::DataType::STRING) {
+    cmp = types::GetStringViewFromArrowArray(lhs, lhs_idx)
+              .compare(types::GetStringViewFromArrowArray(rhs, rhs_idx));
+  } else {
+    auto lhs_val = types::GetValueFromArrowArray<DT>(lhs, lhs_idx);
+    auto rhs_val = types::GetValueFromArrowArray<DT>(rhs, rhs_idx);
+    if constexpr (DT == types::DataType::FLOAT64) {
+      bool lhs_nan = std::isnan(lhs_val);
+      bool rhs_nan = std::isnan(rhs_val);
+      if (lhs_nan || rhs_nan) {
+        return static_cast<int>(lhs_nan) - static_cast<int>(rhs_nan);
+      }
+    }
+    cmp = lhs_val < rhs_val ? -1 : (rhs_val < lhs_val ? 1 : 0);
+  }
+  return ascending ? cmp : -cmp;
+}
+
+template <types::DataType DT, typename TRowIter>
+Status AppendRows(arrow::ArrayBuilder* builder, const std::vector<const arrow::Array*>& arrays,
+                  TRowIter begin, TRowIter end) {
+  for (auto it = begin; it != end; ++it) {
+    PL_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(
+        builder, types::GetValueFromArrowArray<DT>(arrays[it->batch_idx], it->row_idx)));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+std::string TopKNode::DebugStringImpl() {
+  return absl::Substitute("Exec::TopKNode<$0>", plan_node_->DebugString());
+}
+
+Status TopKNode::InitImpl(const plan::Operator& plan_node) {
+  CHECK(plan_node.op_type() == planpb::OperatorType::TOPK_OPERATOR);
+  const auto* topk_plan_node = static_cast<const plan::TopKOperator*>(&plan_node);
+  // copy the plan node to local object;
+  plan_node_ = std::make_unique<plan::TopKOperator>(*topk_plan_node);
+
+  if (input_descriptors_.size() != 1) {
+    return error::InvalidArgument("TopK operator expects a single input relation, got $0",
+                                  input_descriptors_.size());
+  }
+  if (plan_node_->k() < 0) {
+    return error::InvalidArgument("TopK operator expects a non-negative k, got $0",
+                                  plan_node_->k());
+  }
+  const RowDescriptor& input_desc = input_descriptors_[0];
+  for (int64_t sort_col : plan_node_->sort_cols()) {
+    if (sort_col < 0 || static_cast<size_t>(sort_col) >= input_desc.size()) {
+      return error::InvalidArgument("Sort column index $0 is out of bounds", sort_col);
+    }
+#define TYPE_CASE(_dt_) compare_fns_.push_back(&CompareValues<_dt_>)
+    PL_SWITCH_FOREACH_DATATYPE(input_desc.type(sort_col), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return Status::OK();
+}
+
+Status TopKNode::PrepareImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status TopKNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
+
+Status TopKNode::CloseImpl(ExecState* /*exec_state*/) {
+  batches_.clear();
+  rows_.clear();
+  num_buffered_rows_ = 0;
+  return Status::OK();
+}
+
+bool TopKNode::RowBefore(const RowRef& lhs, const RowRef& rhs) const {
+  const auto& lhs_arrays = batches_[lhs.batch_idx].sort_arrays;
+  const auto& rhs_arrays = batches_[rhs.batch_idx].sort_arrays;
+  for (size_t i = 0; i < compare_fns_.size(); ++i) {
+    int cmp = compare_fns_[i](lhs_arrays[i], lhs.row_idx, rhs_arrays[i], rhs.row_idx,
+                              plan_node_->ascending()[i]);
+    if (cmp != 0) {
+      return cmp < 0;
+    }
+  }
+  // Break ties by the input order, which makes the output deterministic.
+  if (lhs.batch_idx != rhs.batch_idx) {
+    return lhs.batch_idx < rhs.batch_idx;
+  }
+  return lhs.row_idx < rhs.row_idx;
+}
+
+void TopKNode::AddBatch(std::shared_ptr<RowBatch> rb) {
+  BufferedBatch batch;
+  for (int64_t sort_col : plan_node_->sort_cols()) {
+    batch.sort_arrays.push_back(rb->ColumnAt(sort_col).get());
+  }
+  num_buffered_rows_ += rb->num_rows();
+  batch.rb = std::move(rb);
+  batches_.push_back(std::move(batch));
+}
+
+void TopKNode::AddRow(const RowRef& row) {
+  auto before = [this](const RowRef& lhs, const RowRef& rhs) { return RowBefore(lhs, rhs); };
+  size_t k = static_cast<size_t>(plan_node_->k());
+  if (k == 0) {
+    rows_.push_back(row);
+    return;
+  }
+  if (rows_.size() < k) {
+    rows_.push_back(row);
+    std::push_heap(rows_.begin(), rows_.end(), before);
+    return;
+  }
+  // The row replaces the last of the kept rows if it comes before it.
+  if (RowBefore(row, rows_.front())) {
+    std::pop_heap(rows_.begin(), rows_.end(), before);
+    rows_.back() = row;
+    std::push_heap(rows_.begin(), rows_.end(), before);
+  }
+}
+
+StatusOr<std::vector<std::unique_ptr<RowBatch>>> TopKNode::MaterializeRows(
+    const std::vector<RowRef>& rows, const std::vector<int64_t>& cols, const RowDescriptor& desc,
+    size_t max_rows_per_batch) const {
+  DCHECK_EQ(cols.size(), desc.size());
+  std::vector<std::unique_ptr<RowBatch>> output;
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> builders(cols.size());
+  std::vector<const arrow::Array*> arrays(batches_.size());
+
+  size_t start = 0;
+  do {
+    size_t end = std::min(rows.size(), start + max_rows_per_batch);
+    for (size_t i = 0; i < cols.size(); ++i) {
+      for (size_t b = 0; b < batches_.size(); ++b) {
+        arrays[b] = batches_[b].rb->ColumnAt(cols[i]).get();
+      }
+      builders[i] = types::MakeArrowBuilder(desc.type(i), arrow::default_memory_pool());
+      PL_RETURN_IF_ERROR(builders[i]->Reserve(end - start));
+#define TYPE_CASE(_dt_)                                                                    \
+  PL_RETURN_IF_ERROR(AppendRows<_dt_>(builders[i].get(), arrays, rows.begin() + start, \
+                                      rows.begin() + end))
+      PL_SWITCH_FOREACH_DATATYPE(desc.type(i), TYPE_CASE);
+#undef TYPE_CASE
+    }
+    PL_ASSIGN_OR_RETURN(auto rb, RowBatch::FromColumnBuilders(desc, /*eow*/ false,
+                                                              /*eos*/ false, &builders));
+    output.push_back(std::move(rb));
+    start = end;
+  } while (start < rows.size());
+  return output;
+}
+
+Status TopKNode::Compact() {
+  const RowDescriptor& input_desc = input_descriptors_[0];
+  std::vector<int64_t> all_cols(input_desc.size());
+  for (size_t i = 0; i < all_cols.size(); ++i) {
+    all_cols[i] = i;
+  }
+
+  // Materialize the kept rows in their output order, so that the ties between them are still
+  // broken by their input order once they all live in the same batch.
+  std::vector<RowRef> sorted_rows = rows_;
+  std::sort(sorted_rows.begin(), sorted_rows.end(),
+            [this](const RowRef& lhs, const RowRef& rhs) { return RowBefore(lhs, rhs); });
+  PL_ASSIGN_OR_RETURN(auto compacted, MaterializeRows(sorted_rows, all_cols, input_desc,
+                                                      std::max<size_t>(sorted_rows.size(), 1)));
+  DCHECK_EQ(compacted.size(), 1U);
+
+  batches_.clear();
+  num_buffered_rows_ = 0;
+  AddBatch(std::move(compacted[0]));
+  // A vector sorted in the reverse order is a valid heap, with the last row at its front.
+  rows_.clear();
+  for (int64_t i = static_cast<int64_t>(sorted_rows.size()) - 1; i >= 0; --i) {
+    rows_.push_back({0, i});
+  }
+  return Status::OK();
+}
+
+Status TopKNode::Flush(ExecState* exec_state, bool eos) {
+  auto before = [this](const RowRef& lhs, const RowRef& rhs) { return RowBefore(lhs, rhs); };
+  if (plan_node_->k() == 0) {
+    std::sort(rows_.begin(), rows_.end(), before);
+  } else {
+    std::sort_heap(rows_.begin(), rows_.end(), before);
+  }
+
+  PL_ASSIGN_OR_RETURN(auto output, MaterializeRows(rows_, plan_node_->selected_cols(),
+                                                   *output_descriptor_, kTopKOutputRowsPerBatch));
+  output.back()->set_eow(true);
+  output.back()->set_eos(eos);
+  batches_.clear();
+  rows_.clear();
+  num_buffered_rows_ = 0;
+
+  for (const auto& rb : output) {
+    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *rb));
+  }
+  return Status::OK();
+}
+
+Status TopKNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (rb.num_rows() > 0) {
+    AddBatch(std::make_shared<RowBatch>(rb));
+    size_t batch_idx = batches_.size() - 1;
+    for (int64_t i = 0; i < rb.num_rows(); ++i) {
+      AddRow({batch_idx, i});
+    }
+
+    size_t k = static_cast<size_t>(plan_node_->k());
+    if (k > 0 && num_buffered_rows_ > std::max(kCompactionFactor * k, kMinRowsToCompact)) {
+      PL_RETURN_IF_ERROR(Compact());
+    }
+  }
+
+  if (rb.eow() || rb.eos()) {
+    return Flush(exec_state, rb.eos());
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/common/base/status.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+constexpr size_t kTopKOutputRowsPerBatch = 1024;
+
+/**
+ * TopKNode sorts its input by the sort columns of the plan node, and outputs the first k rows
+ * (or all of them when k is 0) once the input window or stream ends.
+ *
+ * With a non-zero k, only the best k rows seen so far are kept, in a heap whose top is the worst
+ * of them. Rows are referenced in place in the input row batches, which are compacted into a
+ * single batch of the kept rows once too many of them are buffered. The memory used is therefore
+ * bounded by k rather than by the size of the input, which lets each PEM send only its own top k
+ * rows to the Kelvin.
+ */
+class TopKNode : public ProcessingNode {
+ public:
+  TopKNode() = default;
+  virtual ~TopKNode() = default;
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  // A reference to a row of one of the buffered row batches.
+  struct RowRef {
+    size_t batch_idx;
+    int64_t row_idx;
+  };
+
+  // Returns <0, 0 or >0 depending on whether the value at the lhs row comes before, ties with, or
+  // comes after the value at the rhs row in the output, when sorting in the given direction.
+  using CompareFn = int (*)(const arrow::Array* lhs, int64_t lhs_idx, const arrow::Array* rhs,
+                            int64_t rhs_idx, bool ascending);
+
+  // Whether the row lhs comes before the row rhs in the output.
+  bool RowBefore(const RowRef& lhs, const RowRef& rhs) const;
+  void AddBatch(std::shared_ptr<table_store::schema::RowBatch> rb);
+  void AddRow(const RowRef& row);
+
+  // Copies the given columns of the rows into new row batches of up to max_rows_per_batch rows.
+  StatusOr<std::vector<std::unique_ptr<table_store::schema::RowBatch>>> MaterializeRows(
+      const std::vector<RowRef>& rows, const std::vector<int64_t>& cols,
+      const table_store::schema::RowDescriptor& desc, size_t max_rows_per_batch) const;
+  // Replaces the buffered row batches by a single one that holds only the kept rows.
+  Status Compact();
+  Status Flush(ExecState* exec_state, bool eos);
+
+  std::unique_ptr<plan::TopKOperator> plan_node_;
+  std::vector<CompareFn> compare_fns_;
+
+  struct BufferedBatch {
+    std::shared_ptr<table_store::schema::RowBatch> rb;
+    // The sort columns of rb, cached to avoid copying the shared pointers in comparisons.
+    std::vector<const arrow::Array*> sort_arrays;
+  };
+  std::vector<BufferedBatch> batches_;
+  size_t num_buffered_rows_ = 0;
+  // The kept rows. When k is not 0, this is a heap ordered by RowBefore(), with the row that
+  // comes last in the output at its front.
+  std::vector<RowRef> rows_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/topk_node.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/base.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+// The test plan node sorts by column 1 descending, then by column 0 ascending, keeps 5 rows, and
+// outputs columns 0 and 2.
+class TopKNodeTest : public ::testing::Test {
+ public:
+  TopKNodeTest() {
+    auto op_proto = planpb::testutils::CreateTestTopK1PB();
+    plan_node_ = plan::TopKOperator::FromProto(op_proto, 1);
+
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+
+    auto table_store = std::make_shared<table_store::TableStore>();
+
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, MockMetricsStubGenerator,
+                                              MockTraceStubGenerator, sole::uuid4(), nullptr);
+  }
+
+ protected:
+  void SetK(int64_t k) {
+    auto op_proto = planpb::testutils::CreateTestTopK1PB();
+    op_proto.mutable_topk_op()->set_k(k);
+    plan_node_ = plan::TopKOperator::FromProto(op_proto, 1);
+  }
+
+  RowDescriptor input_rd_ = RowDescriptor(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd_ = RowDescriptor({types::DataType::INT64, types::DataType::STRING});
+
+  std::unique_ptr<plan::Operator> plan_node_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<udf::Registry> func_registry_;
+};
+
+TEST_F(TopKNodeTest, single_batch) {
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(
+      *plan_node_, output_rd_, {input_rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_, 7, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6, 7})
+                       .AddColumn<types::Int64Value>({10, 30, 20, 30, 5, 20, 40})
+                       .AddColumn<types::StringValue>({"a", "b", "c", "d", "e", "f", "g"})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 5, true, true)
+                          .AddColumn<types::Int64Value>({7, 2, 4, 3, 6})
+                          .AddColumn<types::StringValue>({"g", "b", "d", "c", "f"})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, multiple_batches) {
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(
+      *plan_node_, output_rd_, {input_rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                       .AddColumn<types::Int64Value>({10, 30, 20, 30})
+                       .AddColumn<types::StringValue>({"a", "b", "c", "d"})
+                       .get(),
+                   0, /*child_called_times*/ 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_, 0, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({})
+                       .AddColumn<types::Int64Value>({})
+                       .AddColumn<types::StringValue>({})
+                       .get(),
+                   0, /*child_called_times*/ 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({5, 6, 7})
+                       .AddColumn<types::Int64Value>({5, 20, 40})
+                       .AddColumn<types::StringValue>({"e", "f", "g"})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 5, true, true)
+                          .AddColumn<types::Int64Value>({7, 2, 4, 3, 6})
+                          .AddColumn<types::StringValue>({"g", "b", "d", "c", "f"})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, sort_all) {
+  SetK(0);
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(
+      *plan_node_, output_rd_, {input_rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_, 7, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6, 7})
+                       .AddColumn<types::Int64Value>({10, 30, 20, 30, 5, 20, 40})
+                       .AddColumn<types::StringValue>({"a", "b", "c", "d", "e", "f", "g"})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 7, true, true)
+                          .AddColumn<types::Int64Value>({7, 2, 4, 3, 6, 1, 5})
+                          .AddColumn<types::StringValue>({"g", "b", "d", "c", "f", "a", "e"})
+                          .get())
+      .Close();
+}
+
+// Tests that NaNs are output after all the other values, and are the first rows to be dropped.
+TEST_F(TopKNodeTest, nan_sorted_last) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::FLOAT64,
+                          types::DataType::STRING});
+  RowBatchBuilder input(input_rd, 6, /*eow*/ true, /*eos*/ true);
+  input.AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6})
+      .AddColumn<types::Float64Value>({1.0, NAN, 3.0, NAN, 2.0, 4.0})
+      .AddColumn<types::StringValue>({"a", "b", "c", "d", "e", "f"});
+
+  SetK(0);
+  auto sort_all = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(*plan_node_, output_rd_,
+                                                                     {input_rd}, exec_state_.get());
+  sort_all.ConsumeNext(input.get(), 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 6, true, true)
+                          .AddColumn<types::Int64Value>({6, 3, 5, 1, 2, 4})
+                          .AddColumn<types::StringValue>({"f", "c", "e", "a", "b", "d"})
+                          .get())
+      .Close();
+
+  SetK(4);
+  auto top_k = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(*plan_node_, output_rd_,
+                                                                  {input_rd}, exec_state_.get());
+  top_k.ConsumeNext(input.get(), 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 4, true, true)
+                          .AddColumn<types::Int64Value>({6, 3, 5, 1})
+                          .AddColumn<types::StringValue>({"f", "c", "e", "a"})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, empty_input) {
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(
+      *plan_node_, output_rd_, {input_rd_}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_, 0, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({})
+                       .AddColumn<types::Int64Value>({})
+                       .AddColumn<types::StringValue>({})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 0, true, true)
+                          .AddColumn<types::Int64Value>({})
+                          .AddColumn<types::StringValue>({})
+                          .get())
+      .Close();
+}
+
+// Tests that the rows kept across the compaction of the buffered batches are output in order.
+TEST_F(TopKNodeTest, compaction) {
+  SetK(3);
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(
+      *plan_node_, output_rd_, {input_rd_}, exec_state_.get());
+
+  constexpr int kNumBatches = 4;
+  constexpr int kRowsPerBatch = 3000;
+  for (int batch = 0; batch < kNumBatches; ++batch) {
+    std::vector<types::Int64Value> col0;
+    std::vector<types::Int64Value> col1;
+    std::vector<types::StringValue> col2;
+    for (int i = 0; i < kRowsPerBatch; ++i) {
+      int64_t val = batch * kRowsPerBatch + i;
+      col0.push_back(val);
+      // Every value of the sort column appears twice, the ties are broken by column 0.
+      col1.push_back(val / 2);
+      col2.push_back(std::to_string(val));
+    }
+    bool last = batch == kNumBatches - 1;
+    tester.ConsumeNext(RowBatchBuilder(input_rd_, kRowsPerBatch, last, last)
+                           .AddColumn<types::Int64Value>(col0)
+                           .AddColumn<types::Int64Value>(col1)
+                           .AddColumn<types::StringValue>(col2)
+                           .get(),
+                       0, /*child_called_times*/ last ? 1 : 0);
+  }
+  tester
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 3, true, true)
+                          .AddColumn<types::Int64Value>({11998, 11999, 11996})
+                          .AddColumn<types::StringValue>({"11998", "11999", "11996"})
+                          .get())
+      .Close();
+}
+
+TEST_F(TopKNodeTest, multiple_output_batches) {
+  SetK(0);
+  auto tester = exec::ExecNodeTester<TopKNode, plan::TopKOperator>(
+      *plan_node_, output_rd_, {input_rd_}, exec_state_.get());
+
+  int64_t num_rows = kTopKOutputRowsPerBatch + 1;
+  std::vector<types::Int64Value> col0;
+  std::vector<types::Int64Value> col1;
+  std::vector<types::StringValue> col2;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    col0.push_back(i);
+    col1.push_back(i);
+    col2.push_back("");
+  }
+  tester.ConsumeNext(RowBatchBuilder(input_rd_, num_rows, /*eow*/ true, /*eos*/ true)
+                         .AddColumn<types::Int64Value>(col0)
+                         .AddColumn<types::Int64Value>(col1)
+                         .AddColumn<types::StringValue>(col2)
+                         .get(),
+                     0, /*child_called_times*/ 2);
+
+  std::vector<types::Int64Value> expected_col0;
+  std::vector<types::StringValue> expected_col2;
+  for (int64_t i = 0; i < static_cast<int64_t>(kTopKOutputRowsPerBatch); ++i) {
+    expected_col0.push_back(num_rows - 1 - i);
+    expected_col2.push_back("");
+  }
+  tester
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, kTopKOutputRowsPerBatch, false, false)
+                          .AddColumn<types::Int64Value>(expected_col0)
+                          .AddColumn<types::StringValue>(expected_col2)
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd_, 1, true, true)
+                          .AddColumn<types::Int64Value>({0})
+                          .AddColumn<types::StringValue>({""})
+                          .get())
+      .Close();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -111,19 +111,67 @@ types::Time64NSValue UnionNode::GetTimeAtParentCursor(size_t parent_index) const
                                                         row_cursors_[parent_index]);
 }
 
-Status UnionNode::AppendRow(size_t parent) {
-  auto row = row_cursors_[parent];
+namespace {
+
+template <types::DataType DT>
+Status AppendSlice(arrow::ArrayBuilder* builder, const arrow::Array* input, int64_t start,
+                   int64_t num_rows) {
+  using BuilderType = typename types::DataTypeTraits<DT>::arrow_builder_type;
+  using ArrayType = typename types::DataTypeTraits<DT>::arrow_array_type;
+  auto* typed_builder = static_cast<BuilderType*>(builder);
+  const auto* typed_input = static_cast<const ArrayType*>(input);
+
+  if constexpr (DT == types::DataType::INT64 || DT == types::DataType::FLOAT64 ||
+                DT == types::DataType::TIME64NS) {
+    PL_RETURN_IF_ERROR(typed_builder->AppendValues(typed_input->raw_values() + start, num_rows));
+  } else if constexpr (DT == types::DataType::STRING) {
+    int64_t num_bytes =
+        typed_input->value_offset(start + num_rows) - typed_input->value_offset(start);
+    PL_RETURN_IF_ERROR(typed_builder->ReserveData(num_bytes));
+    for (int64_t i = start; i < start + num_rows; ++i) {
+      auto value = typed_input->GetView(i);
+      typed_builder->UnsafeAppend(value.data(), static_cast<int32_t>(value.size()));
+    }
+  } else {
+    for (int64_t i = start; i < start + num_rows; ++i) {
+      PL_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(
+          builder, types::GetValueFromArrowArray<DT>(input, i)));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status UnionNode::AppendRows(size_t parent, size_t num_rows) {
+  auto start = row_cursors_[parent];
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
     auto input_col = data_columns_[parent][i];
-#define TYPE_CASE(_dt_)                                    \
-  PL_RETURN_IF_ERROR(table_store::schema::CopyValue<_dt_>( \
-      column_builders_[i].get(), types::GetValueFromArrowArray<_dt_>(input_col, row)));
+#define TYPE_CASE(_dt_) \
+  PL_RETURN_IF_ERROR(AppendSlice<_dt_>(column_builders_[i].get(), input_col, start, num_rows));
     PL_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(i), TYPE_CASE);
 #undef TYPE_CASE
   }
   return Status::OK();
 }
 
+void UnionNode::AdvanceCursor(size_t parent, size_t num_rows) {
+  const auto& rb = parent_row_batches_[parent][0];
+  row_cursors_[parent] += num_rows;
+  DCHECK_LE(row_cursors_[parent], static_cast<size_t>(rb.num_rows()));
+  if (row_cursors_[parent] < static_cast<size_t>(rb.num_rows())) {
+    return;
+  }
+  // Mark whether or not we hit the eos for this stream, delete the top row batch from our buffer
+  // and update the cursor.
+  if (rb.eos()) {
+    flushed_parent_eoses_[parent] = true;
+  }
+  parent_row_batches_[parent].erase(parent_row_batches_[parent].begin());
+  row_cursors_[parent] = 0;
+  CacheNextRowBatch(parent);
+}
+
 // Flush the row batch if we have waited too long between row batches.
 Status UnionNode::OptionallyFlushRowBatchIfTimeout(ExecState* exec_state) {
   if (!enable_data_flush_timeout_) {
@@ -169,71 +217,151 @@ Status UnionNode::FlushBatch(ExecState* exec_state) {
   return SendRowBatchToChildren(exec_state, *rb);
 }
 
-Status UnionNode::MergeData(ExecState* exec_state) {
-  while (!sent_eos_) {
-    // Get the smallest time out of all of the current streams.
-    std::vector<size_t> parent_streams;
-    parent_streams.reserve(row_cursors_.size());
+bool UnionNode::ParentBefore(size_t parent_a, size_t parent_b) const {
+  bool eos_a = flushed_parent_eoses_[parent_a];
+  bool eos_b = flushed_parent_eoses_[parent_b];
+  if (eos_a || eos_b) {
+    return eos_a == eos_b ? parent_a < parent_b : eos_b;
+  }
+  // Rows with the same time are output in the order of their parent index, so that rows are
+  // always stable with respect to the input parent index.
+  auto time_a = GetTimeAtParentCursor(parent_a);
+  auto time_b = GetTimeAtParentCursor(parent_b);
+  return time_a < time_b || (time_a == time_b && parent_a < parent_b);
+}
 
-    for (size_t parent = 0; parent < row_cursors_.size(); ++parent) {
-      if (flushed_parent_eoses_[parent]) {
-        continue;
-      }
-      // If we lack necessary data, we can't merge anymore.
-      if (!parent_row_batches_[parent].size()) {
-        return Status::OK();
-      }
-      parent_streams.push_back(parent);
+void UnionNode::BuildMergeTree() {
+  // winners[i] is the winner of the match at node i.
+  std::vector<size_t> winners(2 * num_parents_);
+  for (size_t parent = 0; parent < num_parents_; ++parent) {
+    winners[num_parents_ + parent] = parent;
+  }
+  merge_tree_.resize(num_parents_);
+  for (size_t node = num_parents_ - 1; node > 0; --node) {
+    size_t left = winners[2 * node];
+    size_t right = winners[2 * node + 1];
+    bool left_wins = ParentBefore(left, right);
+    winners[node] = left_wins ? left : right;
+    merge_tree_[node] = left_wins ? right : left;
+  }
+  merge_tree_[0] = winners[1];
+  merge_tree_built_ = true;
+}
+
+void UnionNode::ReplayMergeTree(size_t parent) {
+  DCHECK_EQ(parent, merge_tree_[0]);
+  size_t winner = parent;
+  for (size_t node = (num_parents_ + parent) / 2; node > 0; node /= 2) {
+    if (ParentBefore(merge_tree_[node], winner)) {
+      std::swap(merge_tree_[node], winner);
     }
+  }
+  merge_tree_[0] = winner;
+}
 
-    // If we have reached end of stream for all of our inputs, flush the queue.
-    if (!parent_streams.size()) {
-      return OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state);
+std::optional<size_t> UnionNode::MergeTreeRunnerUp() const {
+  // The runner-up only lost to the winner, so it is one of the losers on the path of the winner.
+  std::optional<size_t> runner_up;
+  for (size_t node = (num_parents_ + merge_tree_[0]) / 2; node > 0; node /= 2) {
+    if (!runner_up.has_value() || ParentBefore(merge_tree_[node], *runner_up)) {
+      runner_up = merge_tree_[node];
     }
+  }
+  return runner_up;
+}
 
-    std::sort(parent_streams.begin(), parent_streams.end(),
-              [this](size_t parent_a, size_t parent_b) {
-                auto time_a = GetTimeAtParentCursor(parent_a);
-                auto time_b = GetTimeAtParentCursor(parent_b);
-                return time_a < time_b || (time_a == time_b && parent_a < parent_b);
-              });
-
-    bool has_limit = parent_streams.size() > 1;
-    size_t parent = parent_streams[0];
-
-    while (parent_row_batches_[parent].size()) {
-      if (has_limit) {
-        size_t next_parent = parent_streams[1];
-        // If this time is greater than another parent stream's earliest time,
-        // or if they are the same but the first parent is at a smaller index, stop merging.
-        // This way rows are always stable with respect to input parent index.
-        if (GetTimeAtParentCursor(parent) > GetTimeAtParentCursor(next_parent) ||
-            (GetTimeAtParentCursor(parent) == GetTimeAtParentCursor(next_parent) &&
-             parent > next_parent)) {
-          break;
-        }
-      }
+size_t UnionNode::RunEnd(size_t parent) const {
+  auto num_rows = static_cast<size_t>(parent_row_batches_[parent][0].num_rows());
+  std::optional<size_t> runner_up = MergeTreeRunnerUp();
+  if (!runner_up.has_value() || flushed_parent_eoses_[*runner_up]) {
+    return num_rows;
+  }
 
-      PL_RETURN_IF_ERROR(AppendRow(parent));
+  // The time column of each row batch is sorted, so the run ends at the first row that is after
+  // the row at the cursor of the runner-up.
+  int64_t bound = GetTimeAtParentCursor(*runner_up).val;
+  const int64_t* times =
+      static_cast<const arrow::Time64Array*>(time_columns_[parent])->raw_values();
+  const int64_t* begin = times + row_cursors_[parent];
+  const int64_t* end = times + num_rows;
+  const int64_t* run_end = parent < *runner_up ? std::upper_bound(begin, end, bound)
+                                               : std::lower_bound(begin, end, bound);
+  return run_end - times;
+}
 
-      // Mark whether or not we hit the eos for this stream, and whether the row batch needs to be
-      // popped.
-      const auto& rb = parent_row_batches_[parent][0];
-      bool pop_row_batch = ++row_cursors_[parent] == static_cast<size_t>(rb.num_rows());
-      if (pop_row_batch && rb.eos()) {
-        flushed_parent_eoses_[parent] = true;
+Status UnionNode::EmitRun(ExecState* exec_state, size_t parent, size_t run_end) {
+  DCHECK_GT(run_end, row_cursors_[parent]);
+  size_t remaining = run_end - row_cursors_[parent];
+  while (remaining > 0) {
+    size_t buffered_rows = column_builders_[0]->length();
+
+    // Whole output row batches are sliced out of the input row batch, without copying the data.
+    if (buffered_rows == 0 && remaining >= output_rows_per_batch_) {
+      RowBatch output_rb(*output_descriptor_, output_rows_per_batch_);
+      const auto& input_rb = parent_row_batches_[parent][0];
+      for (size_t i = 0; i < output_descriptor_->size(); ++i) {
+        PL_RETURN_IF_ERROR(output_rb.AddColumn(GetInputColumn(input_rb, parent, i)
+                                                   ->Slice(row_cursors_[parent],
+                                                           output_rows_per_batch_)));
       }
+      AdvanceCursor(parent, output_rows_per_batch_);
+      remaining -= output_rows_per_batch_;
+
+      output_rb.set_eow(InputsComplete());
+      output_rb.set_eos(InputsComplete());
+      last_data_flush_time_ = std::chrono::system_clock::now();
+      PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+      continue;
+    }
+
+    size_t num_rows = std::min(remaining, output_rows_per_batch_ - buffered_rows);
+    PL_RETURN_IF_ERROR(AppendRows(parent, num_rows));
+    AdvanceCursor(parent, num_rows);
+    remaining -= num_rows;
 
-      if (pop_row_batch) {
-        // Delete the top row batch from our buffer and update the cursor.
-        parent_row_batches_[parent].erase(parent_row_batches_[parent].begin());
-        row_cursors_[parent] = 0;
-        CacheNextRowBatch(parent);
+    // Flush the current RowBatch if necessary.
+    PL_RETURN_IF_ERROR(OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state));
+  }
+  return Status::OK();
+}
+
+Status UnionNode::MergeData(ExecState* exec_state) {
+  // A parent that lacks data and has not reached its end of stream might have the earliest row,
+  // so we can't merge until it gets data.
+  auto starved = [this](size_t parent) {
+    return !flushed_parent_eoses_[parent] && parent_row_batches_[parent].empty();
+  };
+
+  if (!merge_tree_built_) {
+    for (size_t parent = 0; parent < num_parents_; ++parent) {
+      if (starved(parent)) {
+        return Status::OK();
       }
+    }
+    BuildMergeTree();
+  }
+
+  while (!sent_eos_) {
+    // Once the tree is built, only the winning parent can run out of data, because the other
+    // parents still hold their earliest row.
+    size_t parent = merge_tree_[0];
+    if (starved(parent)) {
+      return Status::OK();
+    }
+    if (replay_winner_) {
+      ReplayMergeTree(parent);
+      replay_winner_ = false;
+      parent = merge_tree_[0];
+    }
 
-      // Flush the current RowBatch if necessary.
-      PL_RETURN_IF_ERROR(OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state));
+    // If we have reached end of stream for all of our inputs, flush the queue.
+    if (flushed_parent_eoses_[parent]) {
+      return OptionallyFlushRowBatchIfMaxRowsOrEOS(exec_state);
     }
+
+    // Output the rows of the winning parent up to the earliest row of any other parent.
+    PL_RETURN_IF_ERROR(EmitRun(exec_state, parent, RunEnd(parent)));
+    replay_winner_ = true;
   }
   return Status::OK();
 }
@@ -22,6 +22,7 @@
 #include <arrow/array/builder_base.h>
 #include <stddef.h>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -91,12 +92,27 @@ class UnionNode : public ProcessingNode {
   void CacheNextRowBatch(size_t parent);
   Status InitializeColumnBuilders();
   types::Time64NSValue GetTimeAtParentCursor(size_t parent_index) const;
-  Status AppendRow(size_t parent);
+  // Copies num_rows rows from the cursor of the parent into the column builders.
+  Status AppendRows(size_t parent, size_t num_rows);
+  void AdvanceCursor(size_t parent, size_t num_rows);
+  // Returns the row of the top row batch of the parent that ends its run, which is the first row
+  // that must be output after the cursor of the runner-up parent.
+  size_t RunEnd(size_t parent) const;
+  Status EmitRun(ExecState* exec_state, size_t parent, size_t run_end);
   Status OptionallyFlushRowBatchIfMaxRowsOrEOS(ExecState* exec_state);
   Status OptionallyFlushRowBatchIfTimeout(ExecState* exec_state);
   Status FlushBatch(ExecState* exec_state);
   Status MergeData(ExecState* exec_state);
 
+  // Whether the row at the cursor of parent_a is output before the one at the cursor of parent_b.
+  // Parents that reached their end of stream come last.
+  bool ParentBefore(size_t parent_a, size_t parent_b) const;
+  void BuildMergeTree();
+  // Updates the merge tree after the key of the winning parent changed.
+  void ReplayMergeTree(size_t parent);
+  // Returns the parent that would win if the current winner was removed, if any.
+  std::optional<size_t> MergeTreeRunnerUp() const;
+
   // output_rows_per_batch is only used in the ordered case, because in the unordered case,
   // we just maintain the original row count to avoid copying the data.
   size_t output_rows_per_batch_;
@@ -113,6 +129,16 @@ class UnionNode : public ProcessingNode {
   std::vector<arrow::Array*> time_columns_;
   std::vector<std::vector<arrow::Array*>> data_columns_;
 
+  // Loser tree over the parents, which finds the parent with the earliest row in O(log(parents))
+  // per run of rows, instead of sorting all the parents for every row. merge_tree_[0] holds the
+  // winning parent, and merge_tree_[i] the parent that lost the match at internal node i, whose
+  // children are the nodes 2i and 2i+1. The leaf of parent p is node num_parents_ + p.
+  std::vector<size_t> merge_tree_;
+  // The tree is built once every parent has data or reached its end of stream.
+  bool merge_tree_built_ = false;
+  // Whether the key of the winning parent changed since the tree was last updated.
+  bool replay_winner_ = false;
+
   bool enable_data_flush_timeout_ = true;
   // When enable_data_flush_timeout_ is set to true, use this time to decide if we should
   // flush data to consumers before the output row batch reaches a certain size.
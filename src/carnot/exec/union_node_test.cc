@@ -276,6 +276,104 @@ TEST_F(UnionNodeTest, ordered_full_overlap) {
       .Close();
 }
 
+TEST_F(UnionNodeTest, ordered_interleaved_many_parents) {
+  auto op_proto = planpb::testutils::CreateTestUnionOrderedPB();
+  auto mapping = op_proto.mutable_union_op()->add_column_mappings();
+  mapping->add_column_indexes(0);
+  mapping->add_column_indexes(1);
+  plan_node_ = plan::UnionOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd_0({types::DataType::STRING, types::DataType::TIME64NS});
+  RowDescriptor input_rd_1({types::DataType::TIME64NS, types::DataType::STRING});
+
+  RowDescriptor output_rd({types::DataType::STRING, types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<UnionNode, plan::UnionOperator>(
+      *plan_node_, output_rd, {input_rd_0, input_rd_1, input_rd_0}, exec_state_.get());
+  tester.node()->disable_data_flush_timeout();
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 5, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::StringValue>({"a", "d", "g", "j", "m"})
+                       .AddColumn<types::Time64NSValue>({0, 3, 6, 9, 12})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 5, true, true)
+                       .AddColumn<types::Time64NSValue>({1, 4, 7, 10, 13})
+                       .AddColumn<types::StringValue>({"b", "e", "h", "k", "n"})
+                       .get(),
+                   1, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 5, true, true)
+                       .AddColumn<types::StringValue>({"c", "f", "i", "l", "o"})
+                       .AddColumn<types::Time64NSValue>({2, 5, 8, 11, 14})
+                       .get(),
+                   2, 3)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, false, false)
+                          .AddColumn<types::StringValue>({"a", "b", "c", "d", "e"})
+                          .AddColumn<types::Time64NSValue>({0, 1, 2, 3, 4})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, false, false)
+                          .AddColumn<types::StringValue>({"f", "g", "h", "i", "j"})
+                          .AddColumn<types::Time64NSValue>({5, 6, 7, 8, 9})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, true, true)
+                          .AddColumn<types::StringValue>({"k", "l", "m", "n", "o"})
+                          .AddColumn<types::Time64NSValue>({10, 11, 12, 13, 14})
+                          .get())
+      .Close();
+}
+
+// Runs that span whole output row batches are sliced out of the input without copying, and the
+// output row batches are the same as when every row is copied.
+TEST_F(UnionNodeTest, ordered_long_runs) {
+  auto op_proto = planpb::testutils::CreateTestUnionOrderedPB();
+  plan_node_ = plan::UnionOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd_0({types::DataType::STRING, types::DataType::TIME64NS});
+  RowDescriptor input_rd_1({types::DataType::TIME64NS, types::DataType::STRING});
+
+  RowDescriptor output_rd({types::DataType::STRING, types::DataType::TIME64NS});
+
+  auto tester = exec::ExecNodeTester<UnionNode, plan::UnionOperator>(
+      *plan_node_, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+  tester.node()->disable_data_flush_timeout();
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 10, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::StringValue>(
+                           {"A", "B", "C", "D", "E", "F", "G", "H", "I", "J"})
+                       .AddColumn<types::Time64NSValue>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 5, true, true)
+                       .AddColumn<types::Time64NSValue>({20, 21, 22, 23, 24})
+                       .AddColumn<types::StringValue>({"Z", "Y", "X", "W", "V"})
+                       .get(),
+                   1, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, false, false)
+                          .AddColumn<types::StringValue>({"A", "B", "C", "D", "E"})
+                          .AddColumn<types::Time64NSValue>({0, 1, 2, 3, 4})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, false, false)
+                          .AddColumn<types::StringValue>({"F", "G", "H", "I", "J"})
+                          .AddColumn<types::Time64NSValue>({5, 6, 7, 8, 9})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 2, true, true)
+                       .AddColumn<types::StringValue>({"K", "L"})
+                       .AddColumn<types::Time64NSValue>({10, 11})
+                       .get(),
+                   0, 2)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 5, false, false)
+                          .AddColumn<types::StringValue>({"K", "L", "Z", "Y", "X"})
+                          .AddColumn<types::Time64NSValue>({10, 11, 20, 21, 22})
+                          .get())
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::StringValue>({"W", "V"})
+                          .AddColumn<types::Time64NSValue>({23, 24})
+                          .get())
+      .Close();
+}
+
 TEST_F(UnionNodeTest, no_rows_parent) {
   auto op_proto = planpb::testutils::CreateTestUnionOrderedPB();
   plan_node_ = plan::UnionOperator::FromProto(op_proto, /*id*/ 1);
@@ -18,6 +18,9 @@
 
 #include "src/carnot/funcs/builtins/json_ops.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "src/carnot/udf/registry.h"
 
 namespace px {
@@ -26,11 +29,57 @@ namespace builtins {
 
 using types::StringValue;
 
+namespace internal {
+
+const std::vector<TopLevelMemberFinder::Value>& ColumnMemberCache::Get(
+    int64_t batch_idx, int64_t column_idx, bool case_insensitive, bool strict, size_t count,
+    const StringValue* json, std::string_view key) {
+  Column& column = columns_[{column_idx, case_insensitive, strict}];
+  auto it = std::find(column.keys.begin(), column.keys.end(), key);
+  if (column.batch_idx != batch_idx || column.count != count) {
+    // The first call on this column of the batch. The keys of the previous batch are about to be
+    // looked up again, so they are all extracted at once.
+    column.batch_idx = batch_idx;
+    column.count = count;
+    if (it == column.keys.end()) {
+      column.keys.emplace_back(key);
+    }
+    column.values.assign(column.keys.size(), {});
+    Extract(&column, 0, case_insensitive, strict, json);
+    it = std::find(column.keys.begin(), column.keys.end(), key);
+  } else if (it == column.keys.end()) {
+    column.keys.emplace_back(key);
+    column.values.emplace_back();
+    Extract(&column, column.keys.size() - 1, case_insensitive, strict, json);
+    it = column.keys.end() - 1;
+  }
+  return column.values[it - column.keys.begin()];
+}
+
+void ColumnMemberCache::Extract(Column* column, size_t first_key, bool case_insensitive,
+                                bool strict, const StringValue* json) {
+  std::vector<std::string_view> keys(column->keys.begin() + first_key, column->keys.end());
+  TopLevelMemberFinder finder(std::move(keys), case_insensitive, strict);
+  for (size_t k = first_key; k < column->keys.size(); ++k) {
+    column->values[k].resize(column->count);
+  }
+  for (size_t idx = 0; idx < column->count; ++idx) {
+    finder.Find(json[idx].data());
+    for (size_t k = first_key; k < column->keys.size(); ++k) {
+      column->values[k][idx] = finder.value(k - first_key);
+    }
+  }
+  num_parsed_ += column->count;
+}
+
+}  // namespace internal
+
 void RegisterJSONOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<PluckUDF>("pluck");
   registry->RegisterOrDie<PluckAsInt64UDF>("pluck_int64");
   registry->RegisterOrDie<PluckAsFloat64UDF>("pluck_float64");
   registry->RegisterOrDie<PluckArrayUDF>("pluck_array");
+  registry->RegisterOrDie<HTTPHeaderUDF>("http_header");
 
   // Up to 8 script args are supported for the _script_reference UDF, due to the lack of support for
   // variadic UDF arguments in the UDF registry today. We should clean this up if/when variadic UDF
@@ -18,14 +18,22 @@
 
 #pragma once
 
+#include <algorithm>
+#include <limits>
+#include <map>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include <absl/strings/match.h>
+
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/udf.h"
 
@@ -33,36 +41,356 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
-// TODO(zasgar): PL-419 To have proper support for JSON we need structs and nullable types.
-// Revisit when we have them.
-class PluckUDF : public udf::ScalarUDF {
+namespace internal {
+
+/**
+ * SAX handler that locates members of a top-level JSON object, or an element of a top-level JSON
+ * array, without building a DOM.
+ *
+ * Nested values are re-serialized into a compact JSON string, matching what a DOM + Writer would
+ * produce.
+ *
+ * In strict mode, the whole string is parsed, and nothing is found in a string that is not valid
+ * JSON, as with a DOM parse. Otherwise, parsing is terminated as soon as all the target values have
+ * been consumed, so lookups only pay for the bytes up to and including the last match, and a string
+ * that is malformed after them (e.g. truncated) still yields the values.
+ */
+class TopLevelMemberFinder
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, TopLevelMemberFinder> {
  public:
-  StringValue Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
-    // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return "";
+  enum class ValueType { kNotFound, kNull, kString, kInt64, kDouble, kOther };
+
+  struct Value {
+    ValueType type = ValueType::kNotFound;
+    // The string value if type is kString, or the JSON serialization of the value otherwise.
+    std::string str;
+    int64_t int64_val = 0;
+    double double_val = 0.0;
+  };
+
+  // Finds the first member named key in a top-level object.
+  TopLevelMemberFinder(std::string_view key, bool case_insensitive, bool strict)
+      : TopLevelMemberFinder(std::vector<std::string_view>{key}, case_insensitive, strict) {}
+
+  // Finds the first member named by each of keys in a top-level object, in a single pass.
+  TopLevelMemberFinder(std::vector<std::string_view> keys, bool case_insensitive, bool strict)
+      : keys_(std::move(keys)),
+        case_insensitive_(case_insensitive),
+        strict_(strict),
+        values_(keys_.size()),
+        writer_(sb_) {}
+
+  // Finds the element at index in a top-level array.
+  TopLevelMemberFinder(int64_t index, bool strict)
+      : strict_(strict), index_(index), values_(1), writer_(sb_) {}
+
+  /**
+   * Runs the finder over a null-terminated JSON string. It can be run again on another string,
+   * which replaces the values found.
+   * @return the type of the first value looked for, or kNotFound.
+   */
+  ValueType Find(const char* json) {
+    depth_ = 0;
+    element_idx_ = 0;
+    match_ = -1;
+    capturing_ = false;
+    num_remaining_ = values_.size();
+    for (auto& value : values_) {
+      value.type = ValueType::kNotFound;
+      value.str.clear();
+      value.int64_val = 0;
+      value.double_val = 0.0;
     }
-    if (!d.IsObject()) {
-      return "";
+    rapidjson::StringStream ss(json);
+    reader_.Parse(ss, *this);
+    if (strict_ && reader_.HasParseError()) {
+      for (auto& value : values_) {
+        value.type = ValueType::kNotFound;
+      }
     }
-    if (!d.HasMember(key.data())) {
-      return "";
+    return values_[0].type;
+  }
+
+  // The value found for the i-th key, or for the array element.
+  const Value& value(size_t i = 0) const { return values_[i]; }
+
+  std::string_view str() const { return values_[0].str; }
+  int64_t int64_val() const { return values_[0].int64_val; }
+  double double_val() const { return values_[0].double_val; }
+
+  // SAX callbacks. Returning false terminates the parse.
+  bool Null() {
+    if (capturing_) {
+      return writer_.Null();
     }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
-      return "";
+    return !BeginValue() ? depth_ > 0 : Found(ValueType::kNull);
+  }
+  bool Bool(bool b) {
+    if (capturing_) {
+      return writer_.Bool(b);
+    }
+    return !BeginValue() ? depth_ > 0 : writer_.Bool(b) && Found(ValueType::kOther);
+  }
+  bool Int(int i) { return Int64(i); }
+  bool Uint(unsigned u) { return Int64(u); }
+  bool Int64(int64_t i) {
+    if (capturing_) {
+      return writer_.Int64(i);
     }
-    if (plucked_value.IsString()) {
-      return plucked_value.GetString();
+    if (!BeginValue()) {
+      return depth_ > 0;
+    }
+    values_[match_].int64_val = i;
+    return writer_.Int64(i) && Found(ValueType::kInt64);
+  }
+  bool Uint64(uint64_t u) {
+    if (capturing_) {
+      return writer_.Uint64(u);
     }
+    if (!BeginValue()) {
+      return depth_ > 0;
+    }
+    if (u > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+      return writer_.Uint64(u) && Found(ValueType::kOther);
+    }
+    values_[match_].int64_val = static_cast<int64_t>(u);
+    return writer_.Uint64(u) && Found(ValueType::kInt64);
+  }
+  bool Double(double d) {
+    if (capturing_) {
+      return writer_.Double(d);
+    }
+    if (!BeginValue()) {
+      return depth_ > 0;
+    }
+    values_[match_].double_val = d;
+    return writer_.Double(d) && Found(ValueType::kDouble);
+  }
+  bool String(const char* str, rapidjson::SizeType len, bool) {
+    if (capturing_) {
+      return writer_.String(str, len);
+    }
+    if (!BeginValue()) {
+      return depth_ > 0;
+    }
+    // The reader owns str, and reuses it for the next string.
+    values_[match_].str.assign(str, len);
+    return Found(ValueType::kString);
+  }
+  bool Key(const char* str, rapidjson::SizeType len, bool) {
+    if (capturing_) {
+      return writer_.Key(str, len);
+    }
+    if (depth_ == 1 && num_remaining_ > 0) {
+      match_ = MatchKey(std::string_view(str, len));
+    }
+    return true;
+  }
+  bool StartObject() {
+    // Only an object root can contain the members we are looking for.
+    if (depth_ == 0 && is_array_lookup()) {
+      return false;
+    }
+    return StartNested() && (!capturing_ || writer_.StartObject());
+  }
+  bool EndObject(rapidjson::SizeType) { return EndNested(!capturing_ || writer_.EndObject()); }
+  bool StartArray() {
+    // Only an array root can contain the element we are looking for.
+    if (depth_ == 0 && !is_array_lookup()) {
+      return false;
+    }
+    return StartNested() && (!capturing_ || writer_.StartArray());
+  }
+  bool EndArray(rapidjson::SizeType) { return EndNested(!capturing_ || writer_.EndArray()); }
 
-    // This is robust to nested JSON.
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    plucked_value.Accept(writer);
-    return sb.GetString();
+ private:
+  bool is_array_lookup() const { return index_ >= 0; }
+
+  // Returns the index of the first key that matches and has not been found yet, or -1.
+  int MatchKey(std::string_view key) const {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      if (values_[i].type == ValueType::kNotFound &&
+          (case_insensitive_ ? absl::EqualsIgnoreCase(key, keys_[i]) : key == keys_[i])) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  // Called at the start of every value that is not inside a captured value. Returns whether it is
+  // one of the values being looked for.
+  bool BeginValue() {
+    if (is_array_lookup() && depth_ == 1) {
+      match_ = element_idx_++ == index_ ? 0 : -1;
+    }
+    if (match_ < 0) {
+      return false;
+    }
+    sb_.Clear();
+    writer_.Reset(sb_);
+    return true;
+  }
+
+  bool StartNested() {
+    if (!capturing_ && depth_ > 0 && BeginValue()) {
+      capturing_ = true;
+      capture_depth_ = depth_;
+    }
+    ++depth_;
+    return true;
+  }
+
+  bool EndNested(bool ok) {
+    --depth_;
+    if (capturing_ && depth_ == capture_depth_) {
+      capturing_ = false;
+      return Found(ValueType::kOther);
+    }
+    return ok;
+  }
+
+  bool Found(ValueType type) {
+    Value& value = values_[match_];
+    value.type = type;
+    if (type != ValueType::kString && type != ValueType::kNull) {
+      value.str.assign(sb_.GetString(), sb_.GetSize());
+    }
+    match_ = -1;
+    --num_remaining_;
+    // Unless the rest of the document is to be validated, terminate the parse once everything is
+    // found.
+    return strict_ || num_remaining_ > 0;
+  }
+
+  std::vector<std::string_view> keys_;
+  bool case_insensitive_ = false;
+  bool strict_ = false;
+  int64_t index_ = -1;
+  int64_t element_idx_ = 0;
+
+  int depth_ = 0;
+  int match_ = -1;
+  bool capturing_ = false;
+  int capture_depth_ = 0;
+
+  std::vector<Value> values_;
+  size_t num_remaining_ = 0;
+  rapidjson::StringBuffer sb_;
+  rapidjson::Writer<rapidjson::StringBuffer> writer_;
+  rapidjson::Reader reader_;
+};
+
+/**
+ * Values of members looked up in the input columns of a batch. It is shared by all the JSON member
+ * UDFs of an exec node through their FunctionContext, so that the calls on the same column, e.g.
+ * `px.pluck(df.resp, 'a')` and `px.pluck_int64(df.resp, 'b')`, parse each row once.
+ *
+ * Columns are identified by the batch and column indices that the expression evaluator sets on the
+ * FunctionContext, the strings are not compared or copied. The first call on a column of a batch
+ * extracts, in one pass over each row, the keys that were looked up on that column in the previous
+ * batch. The calls that follow are answered from the cache.
+ */
+class ColumnMemberCache {
+ public:
+  /**
+   * Looks up a member in each of the count JSON strings of a column.
+   * @return the value for each string, valid until the next call.
+   */
+  const std::vector<TopLevelMemberFinder::Value>& Get(int64_t batch_idx, int64_t column_idx,
+                                                      bool case_insensitive, bool strict,
+                                                      size_t count, const types::StringValue* json,
+                                                      std::string_view key);
+
+  // The number of JSON strings parsed so far.
+  int64_t num_parsed() const { return num_parsed_; }
+
+ private:
+  struct Column {
+    int64_t batch_idx = -1;
+    size_t count = 0;
+    // The keys looked up on the column, and their values for each string.
+    std::vector<std::string> keys;
+    std::vector<std::vector<TopLevelMemberFinder::Value>> values;
+  };
+
+  // Extracts the keys of column from first_key onwards.
+  void Extract(Column* column, size_t first_key, bool case_insensitive, bool strict,
+               const types::StringValue* json);
+
+  // Keyed by the column index, and how the keys are matched.
+  std::map<std::tuple<int64_t, bool, bool>, Column> columns_;
+  int64_t num_parsed_ = 0;
+};
+
+/**
+ * Base class for the UDFs that look up a member of a JSON object by key. When the JSON is an input
+ * column, ExecBatch goes through the ColumnMemberCache of the FunctionContext, so that the calls
+ * on the same column share the parse of each row.
+ *
+ * TUDF must define: static TOutput FromValue(const TopLevelMemberFinder::Value& value).
+ */
+template <typename TUDF, typename TOutput>
+class JSONMemberUDF : public udf::ScalarUDF {
+ public:
+  JSONMemberUDF(bool case_insensitive, bool strict)
+      : case_insensitive_(case_insensitive), strict_(strict) {}
+
+  TOutput Exec(FunctionContext*, types::StringValue in, types::StringValue key) {
+    TopLevelMemberFinder finder(key, case_insensitive_, strict_);
+    finder.Find(in.data());
+    return TUDF::FromValue(finder.value());
+  }
+
+  Status ExecBatch(FunctionContext* ctx, size_t count, TOutput* out, const types::StringValue* in,
+                   const types::StringValue* keys) {
+    if (count == 0) {
+      return Status::OK();
+    }
+    const int64_t column_idx = ctx != nullptr ? ctx->exec_arg_column(0) : -1;
+    const bool same_key = std::all_of(
+        keys, keys + count, [&](const types::StringValue& key) { return key == keys[0]; });
+    // The key is nearly always a literal. When it is not, or the JSON is not an input column,
+    // there is nothing to share.
+    if (column_idx < 0 || !same_key) {
+      for (size_t idx = 0; idx < count; ++idx) {
+        out[idx] = Exec(ctx, in[idx], keys[idx]);
+      }
+      return Status::OK();
+    }
+    auto* cache = ctx->GetOrCreateSharedState<ColumnMemberCache>();
+    const auto& values = cache->Get(ctx->batch_idx(), column_idx, case_insensitive_, strict_,
+                                    count, in, keys[0]);
+    for (size_t idx = 0; idx < count; ++idx) {
+      out[idx] = TUDF::FromValue(values[idx]);
+    }
+    return Status::OK();
+  }
+
+ private:
+  bool case_insensitive_;
+  bool strict_;
+};
+
+// Missing and null values are returned as an empty string, nested values as their serialization.
+inline types::StringValue StringFromValue(const TopLevelMemberFinder::Value& value) {
+  // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
+  if (value.type == TopLevelMemberFinder::ValueType::kNotFound ||
+      value.type == TopLevelMemberFinder::ValueType::kNull) {
+    return "";
+  }
+  return value.str;
+}
+
+}  // namespace internal
+
+// TODO(zasgar): PL-419 To have proper support for JSON we need structs and nullable types.
+// Revisit when we have them.
+class PluckUDF : public internal::JSONMemberUDF<PluckUDF, StringValue> {
+ public:
+  PluckUDF() : JSONMemberUDF(/* case_insensitive */ false, /* strict */ true) {}
+
+  static StringValue FromValue(const internal::TopLevelMemberFinder::Value& value) {
+    return internal::StringFromValue(value);
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -84,29 +412,16 @@ class PluckUDF : public udf::ScalarUDF {
   }
 };
 
-class PluckAsInt64UDF : public udf::ScalarUDF {
+class PluckAsInt64UDF : public internal::JSONMemberUDF<PluckAsInt64UDF, Int64Value> {
  public:
-  Int64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+  PluckAsInt64UDF() : JSONMemberUDF(/* case_insensitive */ false, /* strict */ true) {}
+
+  static Int64Value FromValue(const internal::TopLevelMemberFinder::Value& value) {
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return 0;
-    }
-    if (!d.IsObject()) {
-      return 0;
-    }
-    if (!d.HasMember(key.data())) {
-      return 0;
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
+    if (value.type != internal::TopLevelMemberFinder::ValueType::kInt64) {
       return 0;
     }
-    if (plucked_value.IsInt64()) {
-      return plucked_value.GetInt64();
-    }
-    return 0;
+    return value.int64_val;
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -128,29 +443,16 @@ class PluckAsInt64UDF : public udf::ScalarUDF {
   }
 };
 
-class PluckAsFloat64UDF : public udf::ScalarUDF {
+class PluckAsFloat64UDF : public internal::JSONMemberUDF<PluckAsFloat64UDF, Float64Value> {
  public:
-  Float64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
+  PluckAsFloat64UDF() : JSONMemberUDF(/* case_insensitive */ false, /* strict */ true) {}
+
+  static Float64Value FromValue(const internal::TopLevelMemberFinder::Value& value) {
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return 0.0;
-    }
-    if (!d.IsObject()) {
-      return 0.0;
-    }
-    if (!d.HasMember(key.data())) {
-      return 0.0;
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
+    if (value.type != internal::TopLevelMemberFinder::ValueType::kDouble) {
       return 0.0;
     }
-    if (plucked_value.IsDouble()) {
-      return plucked_value.GetDouble();
-    }
-    return 0.0;
+    return value.double_val;
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -178,33 +480,13 @@ class PluckAsFloat64UDF : public udf::ScalarUDF {
 class PluckArrayUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue in, Int64Value index) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
     // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return "";
-    }
-    if (!d.IsArray()) {
-      return "";
-    }
-    const auto& plucked_array = d.GetArray();
-    if (index < 0 || index >= plucked_array.Size()) {
-      return "";
-    }
-
-    const auto& plucked_value = plucked_array[index.val];
-    if (plucked_value.IsNull()) {
+    if (index < 0) {
       return "";
     }
-    if (plucked_value.IsString()) {
-      return plucked_value.GetString();
-    }
-
-    // This is robust to nested JSON.
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    plucked_value.Accept(writer);
-    return sb.GetString();
+    internal::TopLevelMemberFinder finder(index.val, /* strict */ true);
+    finder.Find(in.data());
+    return internal::StringFromValue(finder.value());
   }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -228,6 +510,37 @@ class PluckArrayUDF : public udf::ScalarUDF {
   }
 };
 
+/**
+ * HTTPHeaderUDF looks up a header in the JSON-serialized headers column. Headers are stored as a
+ * string column, not a native map, so each lookup scans the row's JSON up to the header.
+ */
+class HTTPHeaderUDF : public internal::JSONMemberUDF<HTTPHeaderUDF, StringValue> {
+ public:
+  HTTPHeaderUDF() : JSONMemberUDF(/* case_insensitive */ true, /* strict */ false) {}
+
+  static StringValue FromValue(const internal::TopLevelMemberFinder::Value& value) {
+    return internal::StringFromValue(value);
+  }
+  static udf::ScalarUDFDocBuilder Doc() {
+    return udf::ScalarUDFDocBuilder("Returns the value of an HTTP header.")
+        .Details(
+            "Looks up a header in the serialized headers map of an HTTP request or response (e.g. "
+            "the `req_headers` and `resp_headers` columns of `http_events`). Header names are "
+            "matched case-insensitively, as specified by RFC 7230. If the header appears more "
+            "than once, the first value is returned. If the header is not present, an empty "
+            "string is returned.\n"
+            "This function stops parsing as soon as the header is found, so a map that is "
+            "malformed after the header (e.g. truncated) still returns its value.")
+        .Example(R"doc(
+        | df = px.DataFrame('http_events')
+        | df.content_type = px.http_header(df.resp_headers, 'Content-Type')
+        )doc")
+        .Arg("headers", "The HTTP headers map, serialized as a JSON string.")
+        .Arg("name", "The name of the header to look up.")
+        .Returns("The value of the header, or an empty string if it is not present.");
+  }
+};
+
 /**
   DocString intentionally omitted, this is a non-public function.
   This function creates a custom deep link by creating a "script reference" from a label,
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/funcs/builtins/json_ops.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+// Builds a flat JSON object with the given number of members, similar to a response body.
+static std::string MakeJSONObject(int num_members) {
+  std::string json = "{";
+  for (int i = 0; i < num_members; ++i) {
+    absl::StrAppend(&json, absl::Substitute(R"("key_$0":{"latency":$0.5,"name":"value_$0"},)", i));
+  }
+  absl::StrAppend(&json, R"("last":"found"})");
+  return json;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckFirstKey(benchmark::State& state) {
+  PluckUDF udf;
+  StringValue json = MakeJSONObject(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(udf.Exec(nullptr, json, "key_0"));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(json.length()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckLastKey(benchmark::State& state) {
+  PluckUDF udf;
+  StringValue json = MakeJSONObject(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(udf.Exec(nullptr, json, "last"));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(json.length()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckDOM(benchmark::State& state) {
+  StringValue json = MakeJSONObject(state.range(0));
+  for (auto _ : state) {
+    rapidjson::Document d;
+    d.Parse(json.data());
+    benchmark::DoNotOptimize(d["last"].GetString());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(json.length()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+constexpr size_t kBatchSize = 1024;
+constexpr const char* kSiblingKeys[] = {"key_0", "key_3", "key_7", "last"};
+
+// Sibling plucks of a column, e.g. df.a = px.pluck(df.body, 'a'), df.b = px.pluck(df.body, 'b').
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckSiblingsExec(benchmark::State& state) {
+  PluckUDF udf;
+  std::vector<StringValue> rows(kBatchSize, MakeJSONObject(state.range(0)));
+  for (auto _ : state) {
+    for (const char* key : kSiblingKeys) {
+      for (const auto& row : rows) {
+        benchmark::DoNotOptimize(udf.Exec(nullptr, row, key));
+      }
+    }
+  }
+  state.SetItemsProcessed(kBatchSize * state.iterations());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckSiblingsExecBatch(benchmark::State& state) {
+  PluckUDF udf;
+  std::vector<StringValue> rows(kBatchSize, MakeJSONObject(state.range(0)));
+  std::vector<std::vector<StringValue>> keys;
+  for (const char* key : kSiblingKeys) {
+    keys.emplace_back(kBatchSize, key);
+  }
+  std::vector<StringValue> out(kBatchSize);
+  // The rows are the first input column, and the keys are literals.
+  udf::FunctionContext ctx(nullptr, nullptr);
+  ctx.set_exec_arg_columns({0, -1});
+  for (auto _ : state) {
+    ctx.StartBatch();
+    for (const auto& batch_keys : keys) {
+      benchmark::DoNotOptimize(
+          udf.ExecBatch(&ctx, kBatchSize, out.data(), rows.data(), batch_keys.data()));
+    }
+  }
+  state.SetItemsProcessed(kBatchSize * state.iterations());
+}
+
+BENCHMARK(BM_PluckFirstKey)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(BM_PluckLastKey)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(BM_PluckDOM)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(BM_PluckSiblingsExec)->RangeMultiplier(4)->Range(16, 256);
+BENCHMARK(BM_PluckSiblingsExecBatch)->RangeMultiplier(4)->Range(16, 256);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -16,8 +16,14 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+
 #include "src/carnot/funcs/builtins/json_ops.h"
 #include "src/carnot/udf/test_utils.h"
 
@@ -25,6 +31,9 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+using ::testing::ElementsAre;
+using types::Float64Value;
+using types::Int64Value;
 using types::StringValue;
 
 constexpr char kTestJSONStr[] = R"(
@@ -55,6 +64,13 @@ TEST(JSONOps, PluckUDF_bad_input_return_empty) {
   udf_tester.ForInput("asdad", "str_key").Expect("");
 }
 
+// Unlike px.http_header, the whole string is validated.
+TEST(JSONOps, PluckUDF_malformed_after_value_return_empty) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  udf_tester.ForInput(R"({"a":"b","c":)", "a").Expect("");
+  udf_tester.ForInput(R"({"a":"b"} trailing)", "a").Expect("");
+}
+
 TEST(JSONOps, PluckUDF_non_object_input_return_empty) {
   auto udf_tester = udf::UDFTester<PluckUDF>();
   udf_tester.ForInput("[\"asdad\"]", "str_key").Expect("");
@@ -111,6 +127,182 @@ TEST(JSONOps, PluckArrayUDF_index_out_of_bound) {
   udf_tester.ForInput(kTestJSONArray, 3).Expect("");
 }
 
+TEST(JSONOps, PluckArrayUDF_elements) {
+  auto udf_tester = udf::UDFTester<PluckArrayUDF>();
+  udf_tester.ForInput(kTestJSONArray, 0).Expect("foo");
+  udf_tester.ForInput(kTestJSONArray, 1).Expect("bar");
+  udf_tester.ForInput(R"([[1, [2]], null, 3.5])", 0).Expect("[1,[2]]");
+  udf_tester.ForInput(R"([[1, [2]], null, 3.5])", 1).Expect("");
+  udf_tester.ForInput(R"([[1, [2]], null, 3.5])", 2).Expect("3.5");
+  udf_tester.ForInput(kTestJSONArray, -1).Expect("");
+}
+
+TEST(JSONOps, PluckUDF_ignores_nested_keys) {
+  auto udf_tester = udf::UDFTester<PluckUDF>();
+  udf_tester.ForInput(R"({"a": {"abc": 1}, "b": [{"abc": 2}]})", "abc").Expect("");
+  udf_tester.ForInput(R"({"a": {"abc": 1}, "abc": [true, null]})", "abc").Expect("[true,null]");
+  udf_tester.ForInput(R"({"a": null})", "a").Expect("");
+  udf_tester.ForInput(R"({"a": false})", "a").Expect("false");
+}
+
+constexpr char kTestHeadersStr[] =
+    R"({"Accept":"*/*","Content-Type":"application/json","X-Forwarded-For":"10.0.0.1",)"
+    R"("x-forwarded-for":"10.0.0.2"})";
+
+TEST(JSONOps, HTTPHeaderUDF) {
+  auto udf_tester = udf::UDFTester<HTTPHeaderUDF>();
+  udf_tester.ForInput(kTestHeadersStr, "Content-Type").Expect("application/json");
+  udf_tester.ForInput(kTestHeadersStr, "content-type").Expect("application/json");
+  udf_tester.ForInput(kTestHeadersStr, "ACCEPT").Expect("*/*");
+}
+
+TEST(JSONOps, HTTPHeaderUDF_repeated_header_returns_first) {
+  auto udf_tester = udf::UDFTester<HTTPHeaderUDF>();
+  udf_tester.ForInput(kTestHeadersStr, "X-Forwarded-For").Expect("10.0.0.1");
+}
+
+TEST(JSONOps, HTTPHeaderUDF_missing_header_return_empty) {
+  auto udf_tester = udf::UDFTester<HTTPHeaderUDF>();
+  udf_tester.ForInput(kTestHeadersStr, "Host").Expect("");
+  udf_tester.ForInput("{}", "Host").Expect("");
+}
+
+TEST(JSONOps, HTTPHeaderUDF_bad_input_return_empty) {
+  auto udf_tester = udf::UDFTester<HTTPHeaderUDF>();
+  udf_tester.ForInput("", "Host").Expect("");
+  udf_tester.ForInput("asdad", "Host").Expect("");
+  udf_tester.ForInput(R"(["Host"])", "Host").Expect("");
+}
+
+// Parsing stops at the header, so whatever follows it is not validated.
+TEST(JSONOps, HTTPHeaderUDF_malformed_after_header) {
+  auto udf_tester = udf::UDFTester<HTTPHeaderUDF>();
+  udf_tester.ForInput(R"({"Host":"example.com","Accept":)", "host").Expect("example.com");
+  udf_tester.ForInput(R"({"Accept":)", "host").Expect("");
+}
+
+TEST(JSONOps, HTTPHeaderUDF_skips_nested_values) {
+  auto udf_tester = udf::UDFTester<HTTPHeaderUDF>();
+  udf_tester.ForInput(R"({"a":{"Host":"nested"},"b":[1,{"Host":"x"}],"Host":"top"})", "host")
+      .Expect("top");
+  udf_tester.ForInput(R"({"Host":{"a":[1,2.5,"b"]}})", "host").Expect(R"({"a":[1,2.5,"b"]})");
+}
+
+TEST(JSONOps, TopLevelMemberFinder_multiple_keys) {
+  internal::TopLevelMemberFinder finder({"str_plain", "str_key", "blah", "int64_key"},
+                                        /* case_insensitive */ false, /* strict */ false);
+  using ValueType = internal::TopLevelMemberFinder::ValueType;
+  EXPECT_EQ(finder.Find(kTestJSONStr), ValueType::kString);
+  EXPECT_EQ(finder.value(0).str, "abc");
+  EXPECT_EQ(finder.value(1).type, ValueType::kOther);
+  EXPECT_EQ(finder.value(1).str, R"({"abc":"def"})");
+  EXPECT_EQ(finder.value(2).type, ValueType::kNotFound);
+  EXPECT_EQ(finder.value(3).type, ValueType::kInt64);
+  EXPECT_EQ(finder.value(3).int64_val, 34243242341);
+
+  // Running it again replaces the values.
+  EXPECT_EQ(finder.Find(R"({"int64_key": 1, "str_plain": "x")"), ValueType::kString);
+  EXPECT_EQ(finder.value(0).str, "x");
+  EXPECT_EQ(finder.value(1).type, ValueType::kNotFound);
+  EXPECT_EQ(finder.value(3).int64_val, 1);
+}
+
+TEST(JSONOps, TopLevelMemberFinder_strict) {
+  using ValueType = internal::TopLevelMemberFinder::ValueType;
+  constexpr char kTruncated[] = R"({"a": 1, "b": "x", "c": )";
+  internal::TopLevelMemberFinder lenient({"a", "b"}, /* case_insensitive */ false,
+                                         /* strict */ false);
+  EXPECT_EQ(lenient.Find(kTruncated), ValueType::kInt64);
+  EXPECT_EQ(lenient.value(1).str, "x");
+
+  internal::TopLevelMemberFinder strict({"a", "b"}, /* case_insensitive */ false,
+                                        /* strict */ true);
+  EXPECT_EQ(strict.Find(kTruncated), ValueType::kNotFound);
+  EXPECT_EQ(strict.value(1).type, ValueType::kNotFound);
+  EXPECT_EQ(strict.Find(R"({"a": 1, "b": "x", "c": [2]})"), ValueType::kInt64);
+  EXPECT_EQ(strict.value(1).str, "x");
+}
+
+// The plucks of an exec node share the parse of each input column through their FunctionContext,
+// whether or not they share a UDF instance.
+TEST(JSONOps, PluckUDF_batch_matches_exec) {
+  std::vector<std::vector<StringValue>> batches;
+  for (int batch = 0; batch < 3; ++batch) {
+    std::vector<StringValue> rows;
+    for (int i = 0; i < 10; ++i) {
+      rows.push_back(i % 4 == 3 ? "not json"
+                                : absl::Substitute(R"({"a":$0,"b":{"c":"$1"},"d":"$0$1"})",
+                                                   batch * 10 + i, i % 2 == 0 ? "x" : "y"));
+    }
+    batches.push_back(std::move(rows));
+  }
+  std::vector<StringValue> headers(10, kTestHeadersStr);
+  const std::vector<std::string> kKeys = {"d", "a", "b", "a", "missing"};
+
+  udf::FunctionContext ctx(nullptr, nullptr);
+  auto* cache = ctx.GetOrCreateSharedState<internal::ColumnMemberCache>();
+  for (const auto& rows : batches) {
+    ctx.StartBatch();
+    for (const std::string& key : kKeys) {
+      std::vector<StringValue> keys(rows.size(), key);
+      std::vector<StringValue> out(rows.size());
+      PluckUDF udf;
+      ctx.set_exec_arg_columns({0, -1});
+      ASSERT_OK(udf.ExecBatch(&ctx, rows.size(), out.data(), rows.data(), keys.data()));
+      for (size_t i = 0; i < rows.size(); ++i) {
+        EXPECT_EQ(out[i], udf.Exec(nullptr, rows[i], key)) << key << " " << i;
+      }
+
+      // Another input column.
+      std::vector<StringValue> header_out(headers.size());
+      ctx.set_exec_arg_columns({1, -1});
+      ASSERT_OK(
+          udf.ExecBatch(&ctx, headers.size(), header_out.data(), headers.data(), keys.data()));
+      for (size_t i = 0; i < headers.size(); ++i) {
+        EXPECT_EQ(header_out[i], udf.Exec(nullptr, headers[i], key)) << key << " " << i;
+      }
+    }
+  }
+  // Each key added to a column costs a pass over it in the first batch. After that, each column is
+  // parsed once per batch.
+  EXPECT_EQ(cache->num_parsed(), 4 * (10 + 10) + 2 * (10 + 10));
+
+  // Without a FunctionContext, or for a column computed by another function, every call parses.
+  PluckAsInt64UDF int_udf;
+  std::vector<StringValue> a_keys(10, "a");
+  std::vector<Int64Value> ints(10);
+  ctx.set_exec_arg_columns({-1, -1});
+  ASSERT_OK(int_udf.ExecBatch(&ctx, 10, ints.data(), batches[0].data(), a_keys.data()));
+  EXPECT_EQ(ints[1], 1);
+  EXPECT_EQ(cache->num_parsed(), 4 * (10 + 10) + 2 * (10 + 10));
+
+  // The keys do not all have to be the same.
+  HTTPHeaderUDF header_udf;
+  std::vector<StringValue> keys = {"Accept", "content-type", "Host"};
+  std::vector<StringValue> out(keys.size());
+  ASSERT_OK(header_udf.ExecBatch(nullptr, keys.size(), out.data(), headers.data(), keys.data()));
+  EXPECT_THAT(out, ElementsAre("*/*", "application/json", ""));
+}
+
+TEST(JSONOps, PluckAsInt64UDF_batch) {
+  std::vector<StringValue> rows = {R"({"a":1,"b":2.5})", R"({"b":3.5,"a":4})", "[1]"};
+  std::vector<StringValue> a_keys(rows.size(), "a");
+  std::vector<StringValue> b_keys(rows.size(), "b");
+
+  PluckAsInt64UDF int_udf;
+  std::vector<Int64Value> ints(rows.size());
+  ASSERT_OK(int_udf.ExecBatch(nullptr, rows.size(), ints.data(), rows.data(), a_keys.data()));
+  EXPECT_THAT(ints, ElementsAre(1, 4, 0));
+  ASSERT_OK(int_udf.ExecBatch(nullptr, rows.size(), ints.data(), rows.data(), b_keys.data()));
+  EXPECT_THAT(ints, ElementsAre(0, 0, 0));
+
+  PluckAsFloat64UDF float_udf;
+  std::vector<Float64Value> floats(rows.size());
+  ASSERT_OK(
+      float_udf.ExecBatch(nullptr, rows.size(), floats.data(), rows.data(), b_keys.data()));
+  EXPECT_THAT(floats, ElementsAre(2.5, 3.5, 0.0));
+}
+
 TEST(JSONOps, ScriptReferenceUDF_no_args) {
   auto udf_tester = udf::UDFTester<ScriptReferenceUDF<>>();
   auto res = udf_tester.ForInput("text", "px/script").Result();
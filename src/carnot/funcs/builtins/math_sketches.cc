@@ -18,13 +18,222 @@
 
 #include "src/carnot/funcs/builtins/math_sketches.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
 namespace px {
 namespace carnot {
 namespace builtins {
 
+namespace internal {
+
+// Counts are stored as LEB128 varints. Most of them are small, so this takes one or two bytes
+// instead of eight.
+void AppendVarint(uint64_t val, std::string* buf) {
+  while (val >= 0x80) {
+    buf->push_back(static_cast<char>(val | 0x80));
+    val >>= 7;
+  }
+  buf->push_back(static_cast<char>(val));
+}
+
+StatusOr<uint64_t> ExtractVarint(std::string_view* data) {
+  uint64_t val = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (data->empty()) {
+      return error::InvalidArgument("Truncated varint in serialized sketch.");
+    }
+    const uint8_t byte = data->front();
+    data->remove_prefix(1);
+    val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return val;
+    }
+  }
+  return error::InvalidArgument("Malformed varint in serialized sketch.");
+}
+
+void AppendSketchKey(int64_t key, std::string* buf) {
+  buf->append(reinterpret_cast<const char*>(&key), sizeof(key));
+}
+
+void AppendSketchKey(const std::string& key, std::string* buf) {
+  AppendVarint(key.size(), buf);
+  buf->append(key);
+}
+
+Status ExtractSketchKey(std::string_view* data, int64_t* key) {
+  if (data->size() < sizeof(*key)) {
+    return error::InvalidArgument("Truncated key in serialized sketch.");
+  }
+  std::memcpy(key, data->data(), sizeof(*key));
+  data->remove_prefix(sizeof(*key));
+  return Status::OK();
+}
+
+Status ExtractSketchKey(std::string_view* data, std::string* key) {
+  PL_ASSIGN_OR_RETURN(uint64_t len, ExtractVarint(data));
+  if (data->size() < len) {
+    return error::InvalidArgument("Truncated key in serialized sketch.");
+  }
+  key->assign(data->substr(0, len));
+  data->remove_prefix(len);
+  return Status::OK();
+}
+
+}  // namespace internal
+
+namespace {
+
+// The first byte of serialized HyperLogLog registers.
+enum class HLLEncoding : uint8_t {
+  // All registers, one byte each.
+  kDense = 0,
+  // A varint count of the non-zero registers, followed by the varint delta of the index and the
+  // byte value of each of them.
+  kSparse = 1,
+};
+
+// The largest value of a register: the run of zeros is bounded by the sentinel bit.
+constexpr uint8_t kMaxHLLRank = 64 - kHLLPrecision + 1;
+
+}  // namespace
+
+std::string SerializeTDigest(tdigest::TDigest* digest) {
+  // Merge any buffered values into centroids, so that only centroids need to be written.
+  digest->compress();
+  const std::vector<tdigest::Centroid>& centroids = digest->processed();
+
+  std::string buf;
+  buf.reserve(10 + centroids.size() * (sizeof(double) + 2));
+  internal::AppendVarint(centroids.size(), &buf);
+  for (const auto& centroid : centroids) {
+    const double mean = centroid.mean();
+    buf.append(reinterpret_cast<const char*>(&mean), sizeof(mean));
+    internal::AppendVarint(static_cast<uint64_t>(std::llround(centroid.weight())), &buf);
+  }
+  return buf;
+}
+
+Status DeserializeTDigest(std::string_view data, tdigest::TDigest* digest) {
+  PL_ASSIGN_OR_RETURN(uint64_t num_centroids, internal::ExtractVarint(&data));
+  for (uint64_t i = 0; i < num_centroids; ++i) {
+    if (data.size() < sizeof(double)) {
+      return error::InvalidArgument("Truncated centroid in serialized t-digest.");
+    }
+    double mean;
+    std::memcpy(&mean, data.data(), sizeof(mean));
+    data.remove_prefix(sizeof(mean));
+    PL_ASSIGN_OR_RETURN(uint64_t weight, internal::ExtractVarint(&data));
+    digest->add(mean, static_cast<double>(weight));
+  }
+  if (!data.empty()) {
+    return error::InvalidArgument("Unexpected trailing bytes in serialized t-digest.");
+  }
+  return Status::OK();
+}
+
+std::string SerializeHLLRegisters(const HLLRegisters& registers) {
+  size_t num_nonzero = 0;
+  for (uint8_t r : registers) {
+    num_nonzero += r != 0;
+  }
+
+  std::string buf;
+  // Sparse entries take at most 3 bytes for this precision: a 2-byte delta and the value.
+  if (num_nonzero * 3 < registers.size()) {
+    buf.reserve(4 + num_nonzero * 3);
+    buf.push_back(static_cast<char>(HLLEncoding::kSparse));
+    internal::AppendVarint(num_nonzero, &buf);
+    size_t prev_idx = 0;
+    for (size_t i = 0; i < registers.size(); ++i) {
+      if (registers[i] != 0) {
+        internal::AppendVarint(i - prev_idx, &buf);
+        buf.push_back(static_cast<char>(registers[i]));
+        prev_idx = i;
+      }
+    }
+    return buf;
+  }
+
+  buf.reserve(1 + registers.size());
+  buf.push_back(static_cast<char>(HLLEncoding::kDense));
+  buf.append(reinterpret_cast<const char*>(registers.data()), registers.size());
+  return buf;
+}
+
+Status DeserializeHLLRegisters(std::string_view data, HLLRegisters* registers) {
+  if (data.empty()) {
+    return error::InvalidArgument("Empty serialized HyperLogLog.");
+  }
+  const auto encoding = static_cast<HLLEncoding>(data.front());
+  data.remove_prefix(1);
+
+  switch (encoding) {
+    case HLLEncoding::kDense:
+      if (data.size() != registers->size()) {
+        return error::InvalidArgument("Expected $0 registers in serialized HyperLogLog, got $1.",
+                                      registers->size(), data.size());
+      }
+      std::memcpy(registers->data(), data.data(), data.size());
+      if (*std::max_element(registers->begin(), registers->end()) > kMaxHLLRank) {
+        return error::InvalidArgument("Malformed register in serialized HyperLogLog.");
+      }
+      return Status::OK();
+    case HLLEncoding::kSparse: {
+      registers->fill(0);
+      PL_ASSIGN_OR_RETURN(uint64_t num_nonzero, internal::ExtractVarint(&data));
+      uint64_t idx = 0;
+      for (uint64_t i = 0; i < num_nonzero; ++i) {
+        PL_ASSIGN_OR_RETURN(uint64_t delta, internal::ExtractVarint(&data));
+        idx += delta;
+        if (idx >= registers->size() || data.empty() ||
+            static_cast<uint8_t>(data.front()) > kMaxHLLRank) {
+          return error::InvalidArgument("Malformed register in serialized HyperLogLog.");
+        }
+        (*registers)[idx] = data.front();
+        data.remove_prefix(1);
+      }
+      if (!data.empty()) {
+        return error::InvalidArgument("Unexpected trailing bytes in serialized HyperLogLog.");
+      }
+      return Status::OK();
+    }
+  }
+  return error::InvalidArgument("Unknown HyperLogLog encoding $0.", static_cast<int>(encoding));
+}
+
+int64_t EstimateHLLCardinality(const HLLRegisters& registers) {
+  constexpr double m = std::tuple_size_v<HLLRegisters>;
+  double inverse_sum = 0;
+  int num_zeros = 0;
+  for (uint8_t r : registers) {
+    inverse_sum += 1.0 / static_cast<double>(uint64_t{1} << r);
+    num_zeros += r == 0;
+  }
+
+  // With 64-bit hashes there are no collisions to correct for at large cardinalities, but the raw
+  // estimate is biased at small ones, where linear counting over the empty registers is used.
+  const double alpha = 0.7213 / (1 + 1.079 / m);
+  const double estimate = alpha * m * m / inverse_sum;
+  if (estimate <= 2.5 * m && num_zeros != 0) {
+    return std::llround(m * std::log(m / num_zeros));
+  }
+  return std::llround(estimate);
+}
+
 void RegisterMathSketchesOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<QuantilesUDA<types::Int64Value>>("quantiles");
   registry->RegisterOrDie<QuantilesUDA<types::Float64Value>>("quantiles");
+
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::Int64Value>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::Float64Value>>("approx_count_distinct");
+  registry->RegisterOrDie<ApproxCountDistinctUDA<types::StringValue>>("approx_count_distinct");
+
+  registry->RegisterOrDie<ApproxTopKUDA<types::Int64Value>>("approx_topk");
+  registry->RegisterOrDie<ApproxTopKUDA<types::StringValue>>("approx_topk");
 }
 
 }  // namespace builtins
@@ -17,11 +17,22 @@
  */
 
 #pragma once
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
 #include "src/carnot/udf/registry.h"
+#include "src/shared/types/hash_utils.h"
 #include "src/shared/types/types.h"
 #include "tdigest/tdigest.h"
 
@@ -29,14 +40,45 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+/**
+ * Serializes the centroids of a t-digest in a compact binary form, so that partial aggregates can
+ * be shipped between agents. The digest is compressed first.
+ */
+std::string SerializeTDigest(tdigest::TDigest* digest);
+
+/**
+ * Adds the centroids serialized by SerializeTDigest() to the digest.
+ */
+Status DeserializeTDigest(std::string_view data, tdigest::TDigest* digest);
+
+namespace internal {
+
+// Helpers to write the state of sketches into the buffers that are shipped as partial aggregates.
+void AppendVarint(uint64_t val, std::string* buf);
+StatusOr<uint64_t> ExtractVarint(std::string_view* data);
+
+void AppendSketchKey(int64_t key, std::string* buf);
+void AppendSketchKey(const std::string& key, std::string* buf);
+Status ExtractSketchKey(std::string_view* data, int64_t* key);
+Status ExtractSketchKey(std::string_view* data, std::string* key);
+
+}  // namespace internal
+
 // TODO(zasgar): PL-419 Replace this when we add support for structs.
 template <typename TArg>
 class QuantilesUDA : public udf::UDA {
  public:
-  QuantilesUDA() : digest_(1000) {}
+  QuantilesUDA() : digest_(kCompression) {}
   void Update(FunctionContext*, TArg val) { digest_.add(val.val); }
   void Merge(FunctionContext*, const QuantilesUDA& other) { digest_.merge(&other.digest_); }
 
+  StringValue Serialize(FunctionContext*) { return SerializeTDigest(&digest_); }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    digest_ = tdigest::TDigest(kCompression);
+    return DeserializeTDigest(data, &digest_);
+  }
+
   StringValue Finalize(FunctionContext*) {
     rapidjson::Document d;
     d.SetObject();
@@ -78,9 +120,251 @@ class QuantilesUDA : public udf::UDA {
   }
 
  protected:
+  static constexpr double kCompression = 1000;
   tdigest::TDigest digest_;
 };
 
+// The number of registers of ApproxCountDistinctUDA is 2^kHLLPrecision. The standard error of the
+// estimate is 1.04 / sqrt(2^kHLLPrecision), i.e. 1.6%.
+constexpr int kHLLPrecision = 12;
+using HLLRegisters = std::array<uint8_t, 1 << kHLLPrecision>;
+
+/**
+ * Serializes the registers of a HyperLogLog sketch. Registers that are mostly zero (i.e. low
+ * cardinalities) are written in a sparse form, as in HyperLogLog++.
+ */
+std::string SerializeHLLRegisters(const HLLRegisters& registers);
+
+/**
+ * Overwrites the registers with the ones serialized by SerializeHLLRegisters().
+ */
+Status DeserializeHLLRegisters(std::string_view data, HLLRegisters* registers);
+
+/**
+ * Returns the number of distinct values that were added to the registers.
+ */
+int64_t EstimateHLLCardinality(const HLLRegisters& registers);
+
+template <typename TArg>
+class ApproxCountDistinctUDA : public udf::UDA {
+ public:
+  ApproxCountDistinctUDA() { registers_.fill(0); }
+
+  void Update(FunctionContext*, TArg val) {
+    const uint64_t hash = types::utils::hash<TArg>()(val);
+    // The first bits of the hash select the register, which records the longest run of leading
+    // zeros seen in the remaining bits. The low sentinel bit bounds the run if all bits are zero.
+    const size_t idx = hash >> (64 - kHLLPrecision);
+    const uint64_t rest = (hash << kHLLPrecision) | (uint64_t{1} << (kHLLPrecision - 1));
+    const uint8_t rank = __builtin_clzll(rest) + 1;
+    registers_[idx] = std::max(registers_[idx], rank);
+  }
+
+  void Merge(FunctionContext*, const ApproxCountDistinctUDA& other) {
+    // A branch-free loop over contiguous bytes, which the compiler turns into vector max ops.
+    for (size_t i = 0; i < registers_.size(); ++i) {
+      registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+  }
+
+  StringValue Serialize(FunctionContext*) { return SerializeHLLRegisters(registers_); }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    return DeserializeHLLRegisters(data, &registers_);
+  }
+
+  Int64Value Finalize(FunctionContext*) { return EstimateHLLCardinality(registers_); }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Approximates the number of distinct values.")
+        .Details(
+            "Estimates the number of distinct values of the aggregated data using "
+            "[HyperLogLog](https://en.wikipedia.org/wiki/HyperLogLog), with a standard error of "
+            "1.6%. Unlike a group by on the values followed by a count, the memory used is fixed "
+            "(4KB per group), regardless of the number of distinct values.")
+        .Example(R"doc(
+        | # Count the unique remote addresses that talk to each service.
+        | df = df.groupby('service').agg(num_clients=('remote_addr', px.approx_count_distinct))
+        )doc")
+        .Arg("val", "The data to count the distinct values of.")
+        .Returns("The estimated number of distinct values.");
+  }
+
+ protected:
+  HLLRegisters registers_;
+};
+
+/**
+ * Finds the most frequent values with the Space-Saving algorithm
+ * (https://www.cs.ucsb.edu/research/tech-reports/2005-23).
+ *
+ * A fixed number of counters is kept. A value that has no counter takes over the one with the
+ * lowest count, and inherits that count. Every value whose frequency exceeds
+ * total_count / kNumCounters is guaranteed to hold a counter, and counts overestimate the true
+ * frequency by at most the count that was inherited.
+ */
+template <typename TArg>
+class ApproxTopKUDA : public udf::UDA {
+ public:
+  using TKey = typename types::ValueTypeTraits<TArg>::native_type;
+
+  void Update(FunctionContext*, TArg val) {
+    const TKey& key = KeyOf(val);
+    auto iter = index_.find(key);
+    if (iter != index_.end()) {
+      ++counts_[iter->second];
+      return;
+    }
+    if (keys_.size() < kNumCounters) {
+      index_[key] = keys_.size();
+      keys_.push_back(key);
+      counts_.push_back(1);
+      return;
+    }
+    const size_t min_idx = std::min_element(counts_.begin(), counts_.end()) - counts_.begin();
+    index_.erase(keys_[min_idx]);
+    index_[key] = min_idx;
+    keys_[min_idx] = key;
+    ++counts_[min_idx];
+  }
+
+  void Merge(FunctionContext*, const ApproxTopKUDA& other) {
+    // The merge of Agarwal et al., "Mergeable Summaries": a value missing from a full summary may
+    // have been seen there as often as that summary's smallest count.
+    const int64_t min_count = MinCount();
+    const int64_t other_min_count = other.MinCount();
+
+    std::vector<std::pair<TKey, int64_t>> merged;
+    merged.reserve(keys_.size() + other.keys_.size());
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      auto iter = other.index_.find(keys_[i]);
+      const int64_t other_count =
+          iter != other.index_.end() ? other.counts_[iter->second] : other_min_count;
+      merged.emplace_back(std::move(keys_[i]), counts_[i] + other_count);
+    }
+    for (size_t i = 0; i < other.keys_.size(); ++i) {
+      if (!index_.contains(other.keys_[i])) {
+        merged.emplace_back(other.keys_[i], other.counts_[i] + min_count);
+      }
+    }
+    Reset(std::move(merged));
+  }
+
+  StringValue Serialize(FunctionContext*) {
+    std::string buf;
+    internal::AppendVarint(keys_.size(), &buf);
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      internal::AppendSketchKey(keys_[i], &buf);
+      internal::AppendVarint(counts_[i], &buf);
+    }
+    return buf;
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    std::string_view buf = data;
+    PL_ASSIGN_OR_RETURN(uint64_t num_counters, internal::ExtractVarint(&buf));
+    if (num_counters > kNumCounters) {
+      return error::InvalidArgument("Too many counters in serialized top-k: $0", num_counters);
+    }
+    std::vector<std::pair<TKey, int64_t>> counters(num_counters);
+    for (auto& [key, count] : counters) {
+      PL_RETURN_IF_ERROR(internal::ExtractSketchKey(&buf, &key));
+      PL_ASSIGN_OR_RETURN(count, internal::ExtractVarint(&buf));
+    }
+    if (!buf.empty()) {
+      return error::InvalidArgument("Unexpected trailing bytes in serialized top-k.");
+    }
+    Reset(std::move(counters));
+    return Status::OK();
+  }
+
+  StringValue Finalize(FunctionContext*) {
+    std::vector<size_t> order(keys_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    const size_t k = std::min(kTopK, order.size());
+    std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                      [this](size_t a, size_t b) { return counts_[a] > counts_[b]; });
+
+    rapidjson::Document d;
+    d.SetObject();
+    for (size_t i = 0; i < k; ++i) {
+      rapidjson::Value name;
+      if constexpr (std::is_same_v<TKey, std::string>) {
+        name.SetString(keys_[order[i]].data(), keys_[order[i]].size(), d.GetAllocator());
+      } else {
+        const std::string key_str = absl::StrCat(keys_[order[i]]);
+        name.SetString(key_str.data(), key_str.size(), d.GetAllocator());
+      }
+      d.AddMember(name, counts_[order[i]], d.GetAllocator());
+    }
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    d.Accept(writer);
+    return sb.GetString();
+  }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Approximates the most frequent values.")
+        .Details(
+            "Finds the 10 most frequent values of the aggregated data, and estimates their counts "
+            "using the [Space-Saving](https://www.cs.ucsb.edu/research/tech-reports/2005-23) "
+            "algorithm. Counts may be overestimated by up to 1% of the number of aggregated "
+            "records. Returns a serialized JSON object that maps each value to its count, from the "
+            "most to the least frequent. You can use `px.pluck_int64` to grab the count of a "
+            "specific value.")
+        .Example(R"doc(
+        | # Find the endpoints that receive the most requests.
+        | df = df.groupby('service').agg(top_endpoints=('req_path', px.approx_topk))
+        )doc")
+        .Arg("val", "The data to find the most frequent values of.")
+        .Returns("The most frequent values and their counts, serialized as a JSON dictionary.");
+  }
+
+ protected:
+  static constexpr size_t kNumCounters = 100;
+  static constexpr size_t kTopK = 10;
+
+  static const TKey& KeyOf(const TArg& val) {
+    if constexpr (std::is_same_v<TArg, types::StringValue>) {
+      return val;
+    } else {
+      return val.val;
+    }
+  }
+
+  int64_t MinCount() const {
+    if (keys_.size() < kNumCounters) {
+      return 0;
+    }
+    return *std::min_element(counts_.begin(), counts_.end());
+  }
+
+  // Replaces the counters with the kNumCounters largest of the given ones.
+  void Reset(std::vector<std::pair<TKey, int64_t>> counters) {
+    if (counters.size() > kNumCounters) {
+      std::nth_element(counters.begin(), counters.begin() + kNumCounters, counters.end(),
+                       [](const auto& a, const auto& b) { return a.second > b.second; });
+      counters.resize(kNumCounters);
+    }
+    keys_.clear();
+    counts_.clear();
+    index_.clear();
+    for (auto& [key, count] : counters) {
+      index_[key] = keys_.size();
+      keys_.push_back(std::move(key));
+      counts_.push_back(count);
+    }
+  }
+
+  // Keys and counts are kept in separate arrays, so that finding the smallest count is a scan of
+  // contiguous integers.
+  std::vector<TKey> keys_;
+  std::vector<int64_t> counts_;
+  absl::flat_hash_map<TKey, size_t> index_;
+};
+
 void RegisterMathSketchesOrDie(udf::Registry* registry);
 
 }  // namespace builtins
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "src/carnot/funcs/builtins/math_sketches.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+// Builds a partial aggregate over the given number of latency-like values.
+static QuantilesUDA<types::Float64Value> MakePartial(int num_values) {
+  std::default_random_engine rng(42);
+  std::lognormal_distribution<double> latency_ms(3.0, 1.0);
+  QuantilesUDA<types::Float64Value> uda;
+  for (int i = 0; i < num_values; ++i) {
+    uda.Update(nullptr, latency_ms(rng));
+  }
+  return uda;
+}
+
+// Reports the bytes that a PEM ships per group: the raw values without partial aggregation
+// (bytes_raw), against the serialized t-digest with it (bytes_partial).
+// NOLINTNEXTLINE : runtime/references.
+static void BM_QuantilesSerialize(benchmark::State& state) {
+  auto uda = MakePartial(state.range(0));
+  size_t serialized_size = 0;
+  for (auto _ : state) {
+    types::StringValue serialized = uda.Serialize(nullptr);
+    serialized_size = serialized.size();
+    benchmark::DoNotOptimize(serialized);
+  }
+  state.counters["bytes_raw"] = static_cast<double>(state.range(0) * sizeof(double));
+  state.counters["bytes_partial"] = static_cast<double>(serialized_size);
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_QuantilesDeserializeMerge(benchmark::State& state) {
+  auto partial = MakePartial(state.range(0));
+  const types::StringValue serialized = partial.Serialize(nullptr);
+  for (auto _ : state) {
+    QuantilesUDA<types::Float64Value> other;
+    benchmark::DoNotOptimize(other.Deserialize(nullptr, serialized));
+    QuantilesUDA<types::Float64Value> merged;
+    merged.Merge(nullptr, other);
+    benchmark::DoNotOptimize(merged);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(serialized.size()) *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_QuantilesSerialize)->RangeMultiplier(10)->Range(10, 1000000);
+BENCHMARK(BM_QuantilesDeserializeMerge)->RangeMultiplier(10)->Range(10, 1000000);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
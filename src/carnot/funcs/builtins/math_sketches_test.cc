@@ -22,6 +22,7 @@
 #include "src/carnot/funcs/builtins/math_sketches.h"
 #include "src/carnot/udf/test_utils.h"
 #include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
 
 namespace px {
 namespace carnot {
@@ -69,6 +70,141 @@ TEST(MathSketches, quantiles_int64) {
   EXPECT_DOUBLE_EQ(d["p99"].GetDouble(), 6);
 }
 
+TEST(MathSketches, quantiles_partial_aggregates) {
+  // Emulate several agents computing partial aggregates, which are merged by another agent.
+  constexpr int kNumPartials = 4;
+  constexpr int kValuesPerPartial = 10000;
+
+  auto expected_tester = udf::UDATester<QuantilesUDA<types::Float64Value>>();
+  auto merged_tester = udf::UDATester<QuantilesUDA<types::Float64Value>>();
+  for (int p = 0; p < kNumPartials; ++p) {
+    QuantilesUDA<types::Float64Value> partial;
+    for (int i = 0; i < kValuesPerPartial; ++i) {
+      const double val = (i * kNumPartials + p) % 1000;
+      partial.Update(nullptr, val);
+      expected_tester.ForInput(val);
+    }
+    types::StringValue serialized = partial.Serialize(nullptr);
+    // Much smaller than the raw values that would otherwise be shipped.
+    EXPECT_LT(serialized.size(), kValuesPerPartial * sizeof(double) / 4);
+    ASSERT_OK(merged_tester.Deserialize(serialized));
+  }
+
+  rapidjson::Document expected;
+  expected.Parse(expected_tester.Result().data());
+  rapidjson::Document merged;
+  merged.Parse(merged_tester.Result().data());
+  for (const char* key : {"p01", "p10", "p25", "p50", "p75", "p90", "p99"}) {
+    EXPECT_NEAR(merged[key].GetDouble(), expected[key].GetDouble(), 2.0) << key;
+  }
+}
+
+TEST(MathSketches, quantiles_deserialize_errors) {
+  QuantilesUDA<types::Int64Value> uda;
+  uda.Update(nullptr, 1);
+  uda.Update(nullptr, 2);
+  types::StringValue serialized = uda.Serialize(nullptr);
+
+  QuantilesUDA<types::Int64Value> other;
+  EXPECT_OK(other.Deserialize(nullptr, serialized));
+  EXPECT_NOT_OK(other.Deserialize(nullptr, serialized.substr(0, serialized.size() - 2)));
+  EXPECT_NOT_OK(other.Deserialize(nullptr, serialized + "x"));
+}
+
+TEST(MathSketches, approx_count_distinct) {
+  auto uda_tester = udf::UDATester<ApproxCountDistinctUDA<types::StringValue>>();
+  uda_tester.ForInput("a").ForInput("b").ForInput("a").ForInput("c").ForInput("b").Expect(3);
+}
+
+TEST(MathSketches, approx_count_distinct_partial_aggregates) {
+  constexpr int kNumPartials = 4;
+  constexpr int kValuesPerPartial = 100000;
+
+  auto merged_tester = udf::UDATester<ApproxCountDistinctUDA<types::Int64Value>>();
+  for (int p = 0; p < kNumPartials; ++p) {
+    ApproxCountDistinctUDA<types::Int64Value> partial;
+    // Each partial shares half of its values with the next one.
+    for (int i = 0; i < kValuesPerPartial; ++i) {
+      partial.Update(nullptr, p * kValuesPerPartial / 2 + i);
+    }
+    types::StringValue serialized = partial.Serialize(nullptr);
+    EXPECT_LE(serialized.size(), 1 + HLLRegisters().size());
+    ASSERT_OK(merged_tester.Deserialize(serialized));
+  }
+
+  const double expected = (kNumPartials + 1) * kValuesPerPartial / 2;
+  EXPECT_NEAR(merged_tester.Result().val, expected, expected * 0.05);
+}
+
+TEST(MathSketches, approx_count_distinct_sparse_serialization) {
+  ApproxCountDistinctUDA<types::Int64Value> uda;
+  for (int i = 0; i < 100; ++i) {
+    uda.Update(nullptr, i);
+  }
+  types::StringValue serialized = uda.Serialize(nullptr);
+  EXPECT_LT(serialized.size(), 400);
+
+  ApproxCountDistinctUDA<types::Int64Value> other;
+  ASSERT_OK(other.Deserialize(nullptr, serialized));
+  EXPECT_EQ(other.Finalize(nullptr).val, uda.Finalize(nullptr).val);
+  EXPECT_NOT_OK(other.Deserialize(nullptr, serialized.substr(0, serialized.size() - 1)));
+  EXPECT_NOT_OK(other.Deserialize(nullptr, ""));
+}
+
+TEST(MathSketches, approx_topk) {
+  auto uda_tester = udf::UDATester<ApproxTopKUDA<types::StringValue>>();
+  uda_tester.ForInput("/a").ForInput("/b").ForInput("/a").ForInput("/c").ForInput("/a").ForInput(
+      "/b");
+  rapidjson::Document d;
+  d.Parse(uda_tester.Result().data());
+  ASSERT_EQ(d.MemberCount(), 3);
+  EXPECT_EQ(d["/a"].GetInt64(), 3);
+  EXPECT_EQ(d["/b"].GetInt64(), 2);
+  EXPECT_EQ(d["/c"].GetInt64(), 1);
+  // Ordered from the most to the least frequent.
+  EXPECT_STREQ(d.MemberBegin()->name.GetString(), "/a");
+}
+
+TEST(MathSketches, approx_topk_partial_aggregates) {
+  // Heavy hitters 0..9, with value v seen 1000 * (10 - v) times, hidden among many values that
+  // are seen once.
+  constexpr int kNumPartials = 4;
+  constexpr int kRecordsPerPartial = 2 * 250 * 55;
+  auto merged_tester = udf::UDATester<ApproxTopKUDA<types::Int64Value>>();
+  for (int p = 0; p < kNumPartials; ++p) {
+    ApproxTopKUDA<types::Int64Value> partial;
+    for (int v = 0; v < 10; ++v) {
+      for (int i = 0; i < 250 * (10 - v); ++i) {
+        partial.Update(nullptr, v);
+        partial.Update(nullptr, 1000 + p * 1000000 + v * 10000 + i);
+      }
+    }
+    ASSERT_OK(merged_tester.Deserialize(partial.Serialize(nullptr)));
+  }
+
+  rapidjson::Document d;
+  d.Parse(merged_tester.Result().data());
+  ASSERT_EQ(d.MemberCount(), 10);
+  int v = 0;
+  for (auto iter = d.MemberBegin(); iter != d.MemberEnd(); ++iter, ++v) {
+    EXPECT_STREQ(iter->name.GetString(), std::to_string(v).c_str());
+    // Counts are overestimated by at most 1% of the number of aggregated records.
+    EXPECT_GE(iter->value.GetInt64(), 1000 * (10 - v));
+    EXPECT_LE(iter->value.GetInt64(), 1000 * (10 - v) + kNumPartials * kRecordsPerPartial / 100);
+  }
+}
+
+TEST(MathSketches, approx_topk_deserialize_errors) {
+  ApproxTopKUDA<types::StringValue> uda;
+  uda.Update(nullptr, "a");
+  types::StringValue serialized = uda.Serialize(nullptr);
+
+  ApproxTopKUDA<types::StringValue> other;
+  EXPECT_OK(other.Deserialize(nullptr, serialized));
+  EXPECT_NOT_OK(other.Deserialize(nullptr, serialized.substr(0, serialized.size() - 2)));
+  EXPECT_NOT_OK(other.Deserialize(nullptr, serialized + "x"));
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -17,6 +17,10 @@
  */
 
 #include "src/carnot/funcs/builtins/ml_ops.h"
+
+#include <algorithm>
+#include <cstring>
+
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
 
@@ -30,12 +34,15 @@ void RegisterMLOpsOrDie(udf::Registry* registry) {
    * Scalar UDFs.
    *****************************************/
   registry->RegisterOrDie<TransformerUDF>("_text_embedding");
+  registry->RegisterOrDie<PackedTransformerUDF>("_text_embedding_packed");
   registry->RegisterOrDie<SentencePieceUDF>("_encode_sentence_piece");
   registry->RegisterOrDie<KMeansUDF>("_kmeans_inference");
+  registry->RegisterOrDie<PackedKMeansUDF>("_kmeans_inference_packed");
   /*****************************************
    * Aggregate UDFs.
    *****************************************/
   registry->RegisterOrDie<KMeansUDA>("_kmeans_fit");
+  registry->RegisterOrDie<PackedKMeansUDA>("_kmeans_fit_packed");
   registry->RegisterOrDie<ReservoirSampleUDA<types::StringValue>>("sample");
 }
 
@@ -65,6 +72,39 @@ int load_floats_from_json(std::string in, Eigen::VectorXf* out, int max_num) {
   return count;
 }
 
+int load_packed_floats(std::string_view in, Eigen::VectorXf* out, int max_num) {
+  if (in.size() % sizeof(float) != 0) {
+    return 0;
+  }
+  const int count = std::min<int>(max_num, in.size() / sizeof(float));
+  std::memcpy(out->data(), in.data(), count * sizeof(float));
+  return count;
+}
+
+int load_embedding(EmbeddingFormat format, std::string_view in, Eigen::VectorXf* out,
+                   int max_num) {
+  switch (format) {
+    case EmbeddingFormat::kJSON:
+      return load_floats_from_json(std::string(in), out, max_num);
+    case EmbeddingFormat::kPacked:
+      return load_packed_floats(in, out, max_num);
+  }
+  return 0;
+}
+
+std::string write_packed_floats_to_json(std::string_view in) {
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartArray();
+  for (size_t i = 0; i + sizeof(float) <= in.size(); i += sizeof(float)) {
+    float val;
+    std::memcpy(&val, in.data() + i, sizeof(float));
+    writer.Double(val);
+  }
+  writer.EndArray();
+  return sb.GetString();
+}
+
 std::string write_ints_to_json(int* arr, int num) {
   // Copy output to json array.
   rapidjson::StringBuffer sb;
@@ -24,8 +24,11 @@
 #include <rapidjson/writer.h>
 #include <sentencepiece/sentencepiece_processor.h>
 
+#include <cstring>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/exec/ml/coreset.h"
@@ -46,25 +49,73 @@ using exec::ml::CoresetTree;
 using exec::ml::KMeans;
 using exec::ml::KMeansCoreset;
 
+/**
+ * The encoding of a text embedding in a string column.
+ */
+enum class EmbeddingFormat {
+  // A JSON array of floats.
+  kJSON,
+  // The floats packed in native byte order, which avoids formatting and parsing them.
+  kPacked,
+};
+
 int load_floats_from_json(std::string in, Eigen::VectorXf* out, int max_num);
+// Reads up to max_num packed floats. Returns the number of floats read, or 0 if the size of in is
+// not a multiple of the size of a float.
+int load_packed_floats(std::string_view in, Eigen::VectorXf* out, int max_num);
+// Reads up to max_num floats of an embedding in the given format. Returns the number of floats
+// read.
+int load_embedding(EmbeddingFormat format, std::string_view in, Eigen::VectorXf* out,
+                   int max_num);
+// Converts packed floats to a JSON array.
+std::string write_packed_floats_to_json(std::string_view in);
 std::string write_ints_to_json(int* arr, int num);
 
-class TransformerUDF : public udf::ScalarUDF {
+template <EmbeddingFormat TFormat>
+class BaseTransformerUDF : public udf::ScalarUDF {
  public:
-  TransformerUDF() : TransformerUDF("/embedding.proto") {}
-  explicit TransformerUDF(std::string model_proto_path) : model_proto_path_(model_proto_path) {}
+  BaseTransformerUDF() : BaseTransformerUDF("/embedding.proto") {}
+  explicit BaseTransformerUDF(std::string model_proto_path)
+      : model_proto_path_(model_proto_path) {}
   StringValue Exec(FunctionContext* ctx, StringValue doc) {
     auto executor =
         ctx->model_pool()->GetModelExecutor<exec::ml::TransformerExecutor>(model_proto_path_);
     std::string output;
     executor->Execute(doc, &output);
-    return output;
+    return Format(std::move(output));
+  }
+
+  Status ExecBatch(FunctionContext* ctx, size_t count, StringValue* out, const StringValue* docs) {
+    auto executor =
+        ctx->model_pool()->GetModelExecutor<exec::ml::TransformerExecutor>(model_proto_path_);
+    std::vector<std::string_view> doc_views(docs, docs + count);
+    std::vector<std::string> outputs;
+    executor->ExecuteBatch(doc_views, &outputs);
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = Format(std::move(outputs[i]));
+    }
+    return Status::OK();
   }
 
  private:
+  // The executor outputs packed floats.
+  static std::string Format(std::string packed) {
+    if constexpr (TFormat == EmbeddingFormat::kJSON) {
+      // A document without embedding stays empty.
+      return packed.empty() ? packed : write_packed_floats_to_json(packed);
+    } else {
+      return packed;
+    }
+  }
+
   std::string model_proto_path_;
 };
 
+// Outputs the embedding as a JSON array.
+using TransformerUDF = BaseTransformerUDF<EmbeddingFormat::kJSON>;
+// Outputs the embedding as packed floats, for PackedKMeansUDA and PackedKMeansUDF.
+using PackedTransformerUDF = BaseTransformerUDF<EmbeddingFormat::kPacked>;
+
 class SentencePieceUDF : public udf::ScalarUDF {
  public:
   SentencePieceUDF() : SentencePieceUDF("/sentencepiece.proto") {}
@@ -85,21 +136,27 @@ class SentencePieceUDF : public udf::ScalarUDF {
   sentencepiece::SentencePieceProcessor processor_;
 };
 
-class KMeansUDA : public udf::UDA {
+template <EmbeddingFormat TFormat>
+class BaseKMeansUDA : public udf::UDA {
  public:
-  KMeansUDA() : KMeansUDA(64) {}
-  explicit KMeansUDA(int d)
-      : d_(d), coreset_(/*base_bucket_size*/ 64, d, /*r*/ 4, /*coreset_size*/ 64) {}
+  BaseKMeansUDA() : BaseKMeansUDA(64) {}
+  explicit BaseKMeansUDA(int d)
+      : d_(d), coreset_(/*base_bucket_size*/ 64, d, /*r*/ 4, /*coreset_size*/ 64), point_(d) {}
   void Update(FunctionContext*, StringValue in, Int64Value k) {
     if (k_ == -1) {
       k_ = k.val;
     }
-    Eigen::VectorXf point(d_);
-    int d = load_floats_from_json(in, &point, d_);
+    int d = load_embedding(TFormat, in, &point_, d_);
     DCHECK_EQ(d_, d);
-    coreset_.Update(point);
+    coreset_.Update(point_);
+  }
+  void Merge(FunctionContext*, const BaseKMeansUDA& other) {
+    if (k_ == -1) {
+      k_ = other.k_;
+    }
+    coreset_.Merge(other.coreset_);
+    SetDimension(coreset_.d());
   }
-  void Merge(FunctionContext*, const KMeansUDA& other) { coreset_.Merge(other.coreset_); }
   StringValue Finalize(FunctionContext*) {
     auto point_set = coreset_.Query();
     KMeans kmeans(k_);
@@ -107,23 +164,48 @@ class KMeansUDA : public udf::UDA {
     return kmeans.ToJSON();
   }
 
-  StringValue Serialize(FunctionContext*) { return coreset_.ToJSON(); }
+  // The partial aggregate carries k, since the agent that finalizes the fit may not see any
+  // input rows itself.
+  StringValue Serialize(FunctionContext*) {
+    std::string buf(reinterpret_cast<const char*>(&k_), sizeof(k_));
+    buf.append(coreset_.Serialize());
+    return buf;
+  }
 
   Status Deserialize(FunctionContext*, const StringValue& data) {
-    coreset_.FromJSON(data);
+    if (data.size() < sizeof(k_)) {
+      return error::InvalidArgument("Truncated serialized kmeans state.");
+    }
+    std::memcpy(&k_, data.data(), sizeof(k_));
+    PL_RETURN_IF_ERROR(coreset_.Deserialize(std::string_view(data).substr(sizeof(k_))));
+    SetDimension(coreset_.d());
     return Status::OK();
   }
 
  protected:
+  // The dimension is taken from the merged or deserialized state, which may differ from the
+  // default one of the UDA that the agent creates to merge partial aggregates.
+  void SetDimension(int d) {
+    d_ = d;
+    point_.resize(d_);
+  }
+
   int d_;
   int k_ = -1;
   CoresetDriver<CoresetTree<KMeansCoreset>> coreset_;
+  // Reused across calls to Update, to avoid an allocation per row.
+  Eigen::VectorXf point_;
 };
 
-class KMeansUDF : public udf::ScalarUDF {
+using KMeansUDA = BaseKMeansUDA<EmbeddingFormat::kJSON>;
+// Fits embeddings of PackedTransformerUDF.
+using PackedKMeansUDA = BaseKMeansUDA<EmbeddingFormat::kPacked>;
+
+template <EmbeddingFormat TFormat>
+class BaseKMeansUDF : public udf::ScalarUDF {
  public:
-  KMeansUDF() : KMeansUDF(64) {}
-  explicit KMeansUDF(int d) : d_(d) {}
+  BaseKMeansUDF() : BaseKMeansUDF(64) {}
+  explicit BaseKMeansUDF(int d) : d_(d) {}
 
   Int64Value Exec(FunctionContext*, StringValue embedding, StringValue kmeans_json) {
     if (kmeans_ == nullptr) {
@@ -131,7 +213,7 @@ class KMeansUDF : public udf::ScalarUDF {
       kmeans_->FromJSON(kmeans_json);
     }
     Eigen::VectorXf point(d_);
-    int d = load_floats_from_json(embedding, &point, d_);
+    int d = load_embedding(TFormat, embedding, &point, d_);
     DCHECK_EQ(d_, d);
     return kmeans_->Transform(point);
   }
@@ -141,6 +223,10 @@ class KMeansUDF : public udf::ScalarUDF {
   std::unique_ptr<KMeans> kmeans_;
 };
 
+using KMeansUDF = BaseKMeansUDF<EmbeddingFormat::kJSON>;
+// Classifies embeddings of PackedTransformerUDF.
+using PackedKMeansUDF = BaseKMeansUDF<EmbeddingFormat::kPacked>;
+
 template <typename TArg>
 class ReservoirSampleUDA : public udf::UDA {
  public:
@@ -18,6 +18,7 @@
 
 #include <gflags/gflags.h>
 #include <gmock/gmock.h>
+#include <cstring>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -28,6 +29,7 @@
 #include "src/carnot/funcs/builtins/ml_ops.h"
 #include "src/carnot/udf/test_utils.h"
 #include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
 
 #include "src/carnot/exec/ml/eigen_test_utils.h"
 
@@ -71,6 +73,31 @@ TEST(KMeans, basic) {
   EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(expected_centroids, 0.1));
 }
 
+TEST(KMeans, partial_aggregates) {
+  int k = 3;
+  int d = 2;
+
+  Eigen::MatrixXf expected_centroids = kmeans_expected_centroids();
+  Eigen::MatrixXf points = kmeans_test_data();
+
+  // Split the points across several agents, whose partial states are merged by an agent that did
+  // not see any rows, and so does not know k or d until it merges.
+  constexpr int kNumPartials = 3;
+  auto merged_tester = udf::UDATester<KMeansUDA>();
+  for (int p = 0; p < kNumPartials; p++) {
+    KMeansUDA partial(d);
+    for (int i = p; i < points.rows(); i += kNumPartials) {
+      auto inp = write_vector_to_json(points(i, Eigen::indexing::all).transpose());
+      partial.Update(nullptr, inp, k);
+    }
+    ASSERT_OK(merged_tester.Deserialize(partial.Serialize(nullptr)));
+  }
+
+  px::carnot::exec::ml::KMeans kmeans(k);
+  kmeans.FromJSON(merged_tester.Result());
+  EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(expected_centroids, 0.1));
+}
+
 TEST(SentencePiece, basic) {
   auto udf_tester = udf::UDFTester<SentencePieceUDF>(FLAGS_sentencepiece_dir);
   udf_tester.ForInput("Test 123!");
@@ -86,22 +113,94 @@ TEST(Transformer, basic) {
   udf_tester.ForInput("[4,197,803,195,16,5001]");
   // This test is just a sanity check to see that the transformer UDF runs.
   // If the model changes this test will fail.
-  auto vector_str = udf_tester.Result();
-  rapidjson::Document d;
-  rapidjson::ParseResult ok = d.Parse(vector_str.data());
-  ASSERT_NE(ok, nullptr);
-  std::vector<double> vals;
-  for (rapidjson::Value::ConstValueIterator itr = d.Begin(); itr != d.End(); ++itr) {
-    vals.push_back(itr->GetFloat());
-  }
+  auto embedding = udf_tester.Result();
+  Eigen::VectorXf vals(exec::ml::TransformerExecutor::kEmbeddingSize);
+  ASSERT_EQ(load_floats_from_json(embedding, &vals, vals.rows()), vals.rows());
   std::vector<double> expected_vals = {8.423064231872559, 1.762765645980835, 17.635025024414064,
                                        15.878694534301758};
   // Sanity check the model by checking the first few values of the model output.
   for (const auto& [i, val] : Enumerate(expected_vals)) {
-    EXPECT_NEAR(val, vals[i], 0.0001);
+    EXPECT_NEAR(val, vals(i), 0.0001);
   }
 }
 
+TEST(Transformer, packed_matches_json) {
+  auto pool = exec::ml::ModelPool::Create();
+  FunctionContext ctx(nullptr, pool.get());
+  TransformerUDF json_udf(FLAGS_embedding_dir);
+  PackedTransformerUDF packed_udf(FLAGS_embedding_dir);
+
+  const types::StringValue doc = "[4,197,803,195,16,5001]";
+  types::StringValue packed = packed_udf.Exec(&ctx, doc);
+  ASSERT_EQ(packed.size(), exec::ml::TransformerExecutor::kEmbeddingSize * sizeof(float));
+  EXPECT_EQ(json_udf.Exec(&ctx, doc), write_packed_floats_to_json(packed));
+}
+
+TEST(Transformer, batch_matches_single) {
+  auto pool = exec::ml::ModelPool::Create();
+  FunctionContext ctx(nullptr, pool.get());
+  PackedTransformerUDF udf(FLAGS_embedding_dir);
+
+  // More documents than fit in one mini-batch, including ones that cannot be parsed.
+  std::vector<types::StringValue> docs;
+  for (int i = 0; i < 40; ++i) {
+    docs.push_back(i % 10 == 3 ? "not json" : absl::Substitute("[4,$0,803,195,16]", i + 1));
+  }
+  std::vector<types::StringValue> batch_out(docs.size());
+  ASSERT_OK(udf.ExecBatch(&ctx, docs.size(), batch_out.data(), docs.data()));
+
+  for (const auto& [i, doc] : Enumerate(docs)) {
+    types::StringValue single_out = udf.Exec(&ctx, doc);
+    ASSERT_EQ(batch_out[i].size(), single_out.size()) << i;
+    std::vector<float> batch_vals(single_out.size() / sizeof(float));
+    std::vector<float> single_vals(single_out.size() / sizeof(float));
+    std::memcpy(batch_vals.data(), batch_out[i].data(), batch_out[i].size());
+    std::memcpy(single_vals.data(), single_out.data(), single_out.size());
+    EXPECT_THAT(batch_vals, ::testing::Pointwise(::testing::FloatNear(0.001), single_vals)) << i;
+  }
+  EXPECT_TRUE(batch_out[3].empty());
+}
+
+TEST(KMeans, packed_embeddings) {
+  int k = 3;
+  int d = 2;
+
+  auto kmeans_uda_tester = udf::UDATester<PackedKMeansUDA>(d);
+
+  Eigen::MatrixXf expected_centroids = kmeans_expected_centroids();
+  Eigen::MatrixXf points = kmeans_test_data();
+
+  for (int i = 0; i < points.rows(); i++) {
+    Eigen::VectorXf point = points(i, Eigen::indexing::all).transpose();
+    std::string inp(reinterpret_cast<const char*>(point.data()), d * sizeof(float));
+    kmeans_uda_tester.ForInput(inp, k);
+  }
+
+  auto res = kmeans_uda_tester.Result();
+  px::carnot::exec::ml::KMeans kmeans(k);
+  kmeans.FromJSON(res);
+  EXPECT_THAT(kmeans.centroids(), UnorderedRowsAre(expected_centroids, 0.1));
+}
+
+TEST(KMeans, load_embedding) {
+  Eigen::VectorXf expected(3);
+  expected << 1.5, -2, 3.25;
+  std::string packed(reinterpret_cast<const char*>(expected.data()), 3 * sizeof(float));
+  std::string json = write_packed_floats_to_json(packed);
+  EXPECT_EQ(json, write_vector_to_json(expected));
+
+  Eigen::VectorXf point(3);
+  EXPECT_EQ(load_embedding(EmbeddingFormat::kPacked, packed, &point, 3), 3);
+  EXPECT_EQ(point, expected);
+  point.setZero();
+  EXPECT_EQ(load_embedding(EmbeddingFormat::kJSON, json, &point, 3), 3);
+  EXPECT_EQ(point, expected);
+
+  // The format is not guessed from the contents.
+  EXPECT_EQ(load_embedding(EmbeddingFormat::kJSON, packed, &point, 3), 0);
+  EXPECT_EQ(load_embedding(EmbeddingFormat::kPacked, "abc", &point, 3), 0);
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
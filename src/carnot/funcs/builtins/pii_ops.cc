@@ -17,6 +17,7 @@
  */
 #include <algorithm>
 #include <map>
+#include <numeric>
 #include <vector>
 
 #include <absl/strings/numbers.h>
@@ -334,6 +335,24 @@ Status RedactPIIUDF::Init(FunctionContext*) {
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IMEISV>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::CC_NUMBER>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::SSN>>());
+
+  re2::RE2::Options opts;
+  opts.set_log_errors(false);
+  // The automaton of all the patterns together is larger than that of any single one.
+  opts.set_max_mem(32 << 20);
+  prefilter_ = std::make_unique<re2::RE2::Set>(opts, RE2::UNANCHORED);
+  for (size_t i = 0; i < taggers_.size(); ++i) {
+    std::string_view pattern = taggers_[i]->Prefilter();
+    if (!pattern.empty() &&
+        prefilter_->Add(re2::StringPiece(pattern.data(), pattern.size()), /*error*/ nullptr) >= 0) {
+      prefilter_tagger_idx_.push_back(i);
+    } else {
+      unfiltered_tagger_idx_.push_back(i);
+    }
+  }
+  if (!prefilter_->Compile()) {
+    prefilter_.reset();
+  }
   return Status::OK();
 }
 
@@ -393,13 +412,33 @@ static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag
 }
 
 StringValue RedactPIIUDF::Exec(FunctionContext*, StringValue input) {
+  // The taggers to run, in their original order.
+  std::vector<size_t> tagger_idxs;
+  std::vector<int> matches;
+  re2::RE2::Set::ErrorInfo error_info;
+  if (prefilter_ != nullptr && (prefilter_->Match(input, &matches, &error_info) ||
+                                error_info.kind == re2::RE2::Set::kNoError)) {
+    tagger_idxs = unfiltered_tagger_idx_;
+    for (int match : matches) {
+      tagger_idxs.push_back(prefilter_tagger_idx_[match]);
+    }
+    std::sort(tagger_idxs.begin(), tagger_idxs.end());
+  } else {
+    // The prefilter is unavailable, or ran out of memory on this input.
+    tagger_idxs.resize(taggers_.size());
+    std::iota(tagger_idxs.begin(), tagger_idxs.end(), 0);
+  }
+
   std::vector<Tag> tags;
-  for (const auto& tagger : taggers_) {
-    auto s = tagger->AddTags(&input, &tags);
+  for (size_t idx : tagger_idxs) {
+    auto s = taggers_[idx]->AddTags(&input, &tags);
     if (!s.ok()) {
       return "Invalid regex: " + s.msg();
     }
   }
+  if (tags.empty()) {
+    return input;
+  }
   return ReplaceTagsWithSubs(input, &tags);
 }
 
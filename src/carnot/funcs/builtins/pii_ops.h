@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "re2/re2.h"
+#include "re2/set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -70,6 +71,9 @@ class Tagger {
  public:
   virtual ~Tagger() = default;
   virtual Status AddTags(std::string* input, std::vector<Tag>* tags) = 0;
+  // A regex that matches somewhere in every input that AddTags() adds tags for, which is used to
+  // skip the tagger on other inputs. Empty if the tagger has to run on every input.
+  virtual std::string_view Prefilter() const { return ""; }
 };
 
 class RedactPIIUDF : public udf::ScalarUDF {
@@ -94,6 +98,13 @@ class RedactPIIUDF : public udf::ScalarUDF {
 
  private:
   std::vector<std::unique_ptr<Tagger>> taggers_;
+  // The prefilters of all taggers, compiled into one automaton so that inputs without PII are
+  // scanned once instead of once per tagger. Null if it could not be built.
+  std::unique_ptr<re2::RE2::Set> prefilter_;
+  // The index in taggers_ of each pattern of prefilter_.
+  std::vector<size_t> prefilter_tagger_idx_;
+  // Taggers that run on every input.
+  std::vector<size_t> unfiltered_tagger_idx_;
 };
 
 void RegisterPIIOpsOrDie(udf::Registry* registry);
@@ -106,7 +117,9 @@ class RegexTagger : public Tagger {
     DCHECK_EQ(regex_.error_code(), RE2::NoError) << regex_.error();
   }
 
-  Status AddTags(std::string* input, std::vector<Tag>* tags) {
+  std::string_view Prefilter() const override { return TagTypeTraits<TTag>::BuildRegexPattern(); }
+
+  Status AddTags(std::string* input, std::vector<Tag>* tags) override {
     re2::StringPiece input_piece(input->data(), input->length());
     auto prev_length = input_piece.length();
     int curr_idx = 0;
@@ -17,6 +17,11 @@
  */
 #include <benchmark/benchmark.h>
 
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "src/carnot/funcs/builtins/pii_ops.h"
 
 namespace px {
@@ -51,7 +56,47 @@ static void BM_RedactPII(benchmark::State& state) {
                           static_cast<int64_t>(state.iterations()));
 }
 
+// A typical JSON API response, without PII.
+static constexpr std::string_view http_body = R"body({
+  "id": "f2b7c9e0-3c1d-4a8e-9b61-0c4f5d2e7a11",
+  "status": "active",
+  "created_at": "2021-09-14T18:32:05Z",
+  "items": [
+    {"sku": "SKU-88213", "name": "Wireless Mouse", "qty": 2, "price": 24.99},
+    {"sku": "SKU-10457", "name": "USB-C Cable", "qty": 1, "price": 9.5}
+  ],
+  "shipping": {"method": "ground", "eta_days": 5, "city": "Springfield"},
+  "meta": {"request_id": "9a1c2b3d", "latency_ms": 42, "version": "v2.3.1"}
+})body";
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RedactPIIHTTPBodies(benchmark::State& state) {
+  RedactPIIUDF udf;
+  PL_UNUSED(udf.Init(nullptr));
+
+  // state.range(0) percent of the bodies contain PII.
+  std::vector<std::string> bodies;
+  int64_t total_bytes = 0;
+  for (int i = 0; i < 100; i++) {
+    std::string body(http_body);
+    if (i < state.range(0)) {
+      body.replace(body.find("Springfield"), strlen("Springfield"),
+                   "Springfield\", \"email\": \"jane.doe@example.com\", \"ip\": \"10.1.2.3");
+    }
+    total_bytes += body.size();
+    bodies.push_back(std::move(body));
+  }
+  for (auto _ : state) {
+    for (const auto& body : bodies) {
+      benchmark::DoNotOptimize(udf.Exec(nullptr, body));
+    }
+  }
+  state.SetBytesProcessed(total_bytes * static_cast<int64_t>(state.iterations()));
+  state.SetItemsProcessed(bodies.size() * state.iterations());
+}
+
 BENCHMARK(BM_RedactPII)->RangeMultiplier(2)->Range(1, 12);
+BENCHMARK(BM_RedactPIIHTTPBodies)->Arg(0)->Arg(5)->Arg(100);
 
 }  // namespace builtins
 }  // namespace carnot
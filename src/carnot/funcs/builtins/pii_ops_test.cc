@@ -267,6 +267,17 @@ INSTANTIATE_TEST_SUITE_P(TemplatedRedactionTest, RedactionTest,
                                                           EmailGen(), CCGen(), IMEIGen(), SSNGen(),
                                                           NegativeExampleGen()})));
 
+TEST(RedactPIIUDF, http_bodies) {
+  udf::UDFTester<RedactPIIUDF> udf_tester;
+  udf_tester.Init();
+  // Most bodies contain no PII, and are skipped after a single scan.
+  udf_tester.ForInput(R"({"status": "ok", "items": ["a", "b"]})")
+      .Expect(R"({"status": "ok", "items": ["a", "b"]})");
+  // Only some of the taggers have to run on the others.
+  udf_tester.ForInput(R"({"user": "jane@example.com", "client": "10.0.0.1", "id": 12})")
+      .Expect(R"({"user": "<REDACTED_EMAIL>", "client": "<REDACTED_IPV4>", "id": 12})");
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
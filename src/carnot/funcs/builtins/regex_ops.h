@@ -29,6 +29,7 @@
 #include <utility>
 #include <vector>
 #include "re2/re2.h"
+#include "re2/set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -126,6 +127,15 @@ class MatchRegexRule : public udf::ScalarUDF {
     if (!parse_result) {
       return Status(statuspb::Code::INVALID_ARGUMENT, "unable to parse string as json");
     }
+    // All the rules are compiled into a single automaton, so that a value is scanned once,
+    // regardless of the number of rules.
+    re2::RE2::Options opts;
+    opts.set_dot_nl(true);
+    opts.set_log_errors(false);
+    regex_set_ = std::make_unique<re2::RE2::Set>(opts, RE2::ANCHOR_BOTH);
+    set_rule_idx_.clear();
+    regex_rules.clear();
+    regex_rules_length = 0;
     // Populate the parse regular expressions into self::regex_rules.
     for (rapidjson::Value::ConstMemberIterator itr = regex_rules_json.MemberBegin();
          itr != regex_rules_json.MemberEnd(); ++itr) {
@@ -133,13 +143,33 @@ class MatchRegexRule : public udf::ScalarUDF {
       std::string name = itr->name.GetString();
       std::string regex_pattern = itr->value.GetString();
       PL_RETURN_IF_ERROR(regex_match_udf.Init(ctx, regex_pattern));
+      // Invalid patterns never match, so they are left out of the set.
+      if (regex_set_->Add(regex_pattern, /*error*/ nullptr) >= 0) {
+        set_rule_idx_.push_back(regex_rules_length);
+      }
       regex_rules.emplace_back(make_pair(name, std::move(regex_match_udf)));
       regex_rules_length++;
     }
+    if (!regex_set_->Compile()) {
+      // Out of memory. Fall back to matching the rules one by one.
+      regex_set_.reset();
+    }
     return Status::OK();
   }
 
   types::StringValue Exec(FunctionContext* ctx, StringValue value) {
+    if (regex_set_ != nullptr) {
+      std::vector<int> matches;
+      re2::RE2::Set::ErrorInfo error_info;
+      if (regex_set_->Match(value, &matches, &error_info)) {
+        // Set indices are in the order of the rules, and the first matching rule wins.
+        return regex_rules[set_rule_idx_[*std::min_element(matches.begin(), matches.end())]].first;
+      }
+      if (error_info.kind == re2::RE2::Set::kNoError) {
+        return "";
+      }
+      // The automaton ran out of memory on this value. Fall back to matching rules one by one.
+    }
     for (int i = 0; i < regex_rules_length; i++) {
       if (regex_rules[i].second.Exec(ctx, value).val) {
         return regex_rules[i].first;
@@ -172,6 +202,9 @@ class MatchRegexRule : public udf::ScalarUDF {
  private:
   int regex_rules_length = 0;
   std::vector<std::pair<std::string, RegexMatchUDF> > regex_rules;
+  std::unique_ptr<re2::RE2::Set> regex_set_;
+  // The index in regex_rules of each pattern of regex_set_.
+  std::vector<int> set_rule_idx_;
 };
 
 void RegisterRegexOpsOrDie(udf::Registry* registry);
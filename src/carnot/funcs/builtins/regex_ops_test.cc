@@ -96,6 +96,18 @@ TEST(RegexOps, regex_match_rules) {
   EXPECT_NOT_OK(MatchRegexRule().Init(nullptr, "(?i).*onpointerenter.*"));
 }
 
+TEST(RegexOps, regex_match_multiple_rules) {
+  auto udf_tester = udf::UDFTester<MatchRegexRule>();
+  // The first rule that matches is returned. Rules with invalid patterns never match.
+  constexpr char kRules[] =
+      R"({"invalid": "(.*", "sqli": ".*(?i:union\\s+select).*", "select": "(?i)select.*",)"
+      R"( "any": ".+"})";
+  udf_tester.Init(kRules).ForInput("SELECT a FROM t UNION SELECT b FROM u").Expect("sqli");
+  udf_tester.Init(kRules).ForInput("select a from t").Expect("select");
+  udf_tester.Init(kRules).ForInput("(.*").Expect("any");
+  udf_tester.Init(kRules).ForInput("").Expect("");
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
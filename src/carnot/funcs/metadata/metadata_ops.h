@@ -20,11 +20,13 @@
 
 #include <sys/sysinfo.h>
 
+#include <absl/container/flat_hash_map.h>
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 #include <set>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -63,6 +65,49 @@ inline const px::md::AgentMetadataState* GetMetadataState(px::carnot::udf::Funct
   return md;
 }
 
+namespace internal {
+// The key under which MemoizedScalarUDF remembers the result for an argument value.
+template <typename TArg>
+struct MemoKey {
+  static auto Get(const TArg& arg) { return arg.val; }
+};
+
+template <>
+struct MemoKey<types::StringValue> {
+  static std::string_view Get(const types::StringValue& arg) { return arg; }
+};
+}  // namespace internal
+
+/**
+ * Base class for the metadata UDFs that map a single argument (a UPID or a K8s ID/name) to a
+ * value in the metadata state. A record batch usually holds only a handful of distinct UPIDs, so
+ * ExecBatch calls Exec once per distinct argument value in the batch and copies its result to the
+ * remaining records, instead of repeating the lookups and the formatting of names for each one.
+ *
+ * The memo lives for a single batch only, so that updates of the metadata state are picked up.
+ */
+template <typename TUDF, typename TOutput, typename TArg>
+class MemoizedScalarUDF : public ScalarUDF {
+ public:
+  Status ExecBatch(FunctionContext* ctx, size_t count, TOutput* out, const TArg* args) {
+    auto* udf = static_cast<TUDF*>(this);
+    memo_.clear();
+    for (size_t idx = 0; idx < count; ++idx) {
+      auto [it, inserted] = memo_.try_emplace(internal::MemoKey<TArg>::Get(args[idx]), idx);
+      if (inserted) {
+        out[idx] = udf->Exec(ctx, args[idx]);
+      } else {
+        out[idx] = out[it->second];
+      }
+    }
+    return Status::OK();
+  }
+
+ private:
+  // Maps each argument value to the first record of the batch that holds it.
+  absl::flat_hash_map<decltype(internal::MemoKey<TArg>::Get(std::declval<TArg>())), size_t> memo_;
+};
+
 class ASIDUDF : public ScalarUDF {
  public:
   Int64Value Exec(FunctionContext* ctx) {
@@ -98,7 +143,7 @@ class UPIDToASIDUDF : public ScalarUDF {
   }
 };
 
-class PodIDToPodNameUDF : public ScalarUDF {
+class PodIDToPodNameUDF : public MemoizedScalarUDF<PodIDToPodNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -122,7 +167,8 @@ class PodIDToPodNameUDF : public ScalarUDF {
   }
 };
 
-class PodIDToPodLabelsUDF : public ScalarUDF {
+class PodIDToPodLabelsUDF
+    : public MemoizedScalarUDF<PodIDToPodLabelsUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -143,7 +189,7 @@ class PodIDToPodLabelsUDF : public ScalarUDF {
   }
 };
 
-class PodNameToPodIDUDF : public ScalarUDF {
+class PodNameToPodIDUDF : public MemoizedScalarUDF<PodNameToPodIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -166,7 +212,7 @@ class PodNameToPodIDUDF : public ScalarUDF {
   }
 };
 
-class PodNameToPodIPUDF : public ScalarUDF {
+class PodNameToPodIPUDF : public MemoizedScalarUDF<PodNameToPodIPUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -187,7 +233,8 @@ class PodNameToPodIPUDF : public ScalarUDF {
   }
 };
 
-class PodIDToNamespaceUDF : public ScalarUDF {
+class PodIDToNamespaceUDF
+    : public MemoizedScalarUDF<PodIDToNamespaceUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -233,7 +280,8 @@ class PodNameToNamespaceUDF : public ScalarUDF {
   }
 };
 
-class UPIDToContainerIDUDF : public ScalarUDF {
+class UPIDToContainerIDUDF
+    : public MemoizedScalarUDF<UPIDToContainerIDUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -274,7 +322,8 @@ inline const md::ContainerInfo* UPIDToContainer(const px::md::AgentMetadataState
   return md->k8s_metadata_state().ContainerInfoByID(pid->cid());
 }
 
-class UPIDToContainerNameUDF : public ScalarUDF {
+class UPIDToContainerNameUDF
+    : public MemoizedScalarUDF<UPIDToContainerNameUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -339,7 +388,7 @@ inline types::StringValue StringifyVector(const std::vector<std::string>& vec) {
   return "";
 }
 
-class UPIDToNamespaceUDF : public ScalarUDF {
+class UPIDToNamespaceUDF : public MemoizedScalarUDF<UPIDToNamespaceUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -371,7 +420,7 @@ class UPIDToNamespaceUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 };
 
-class UPIDToPodIDUDF : public ScalarUDF {
+class UPIDToPodIDUDF : public MemoizedScalarUDF<UPIDToPodIDUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -398,7 +447,7 @@ class UPIDToPodIDUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 };
 
-class UPIDToPodNameUDF : public ScalarUDF {
+class UPIDToPodNameUDF : public MemoizedScalarUDF<UPIDToPodNameUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -429,7 +478,8 @@ class UPIDToPodNameUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 };
 
-class ServiceIDToServiceNameUDF : public ScalarUDF {
+class ServiceIDToServiceNameUDF
+    : public MemoizedScalarUDF<ServiceIDToServiceNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue service_id) {
     auto md = GetMetadataState(ctx);
@@ -457,7 +507,8 @@ class ServiceIDToServiceNameUDF : public ScalarUDF {
   }
 };
 
-class ServiceIDToClusterIPUDF : public ScalarUDF {
+class ServiceIDToClusterIPUDF
+    : public MemoizedScalarUDF<ServiceIDToClusterIPUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue service_id) {
     auto md = GetMetadataState(ctx);
@@ -482,7 +533,8 @@ class ServiceIDToClusterIPUDF : public ScalarUDF {
   }
 };
 
-class ServiceIDToExternalIPsUDF : public ScalarUDF {
+class ServiceIDToExternalIPsUDF
+    : public MemoizedScalarUDF<ServiceIDToExternalIPsUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue service_id) {
     auto md = GetMetadataState(ctx);
@@ -505,7 +557,8 @@ class ServiceIDToExternalIPsUDF : public ScalarUDF {
   }
 };
 
-class ServiceNameToServiceIDUDF : public ScalarUDF {
+class ServiceNameToServiceIDUDF
+    : public MemoizedScalarUDF<ServiceNameToServiceIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue service_name) {
     auto md = GetMetadataState(ctx);
@@ -557,7 +610,7 @@ class ServiceNameToNamespaceUDF : public ScalarUDF {
 /**
  * @brief Returns the service ids for services that are currently running.
  */
-class UPIDToServiceIDUDF : public ScalarUDF {
+class UPIDToServiceIDUDF : public MemoizedScalarUDF<UPIDToServiceIDUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -599,7 +652,8 @@ class UPIDToServiceIDUDF : public ScalarUDF {
 /**
  * @brief Returns the service names for services that are currently running.
  */
-class UPIDToServiceNameUDF : public ScalarUDF {
+class UPIDToServiceNameUDF
+    : public MemoizedScalarUDF<UPIDToServiceNameUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -645,7 +699,7 @@ class UPIDToServiceNameUDF : public ScalarUDF {
 /**
  * @brief Returns the node name for the pod associated with the input upid.
  */
-class UPIDToNodeNameUDF : public ScalarUDF {
+class UPIDToNodeNameUDF : public MemoizedScalarUDF<UPIDToNodeNameUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -854,7 +908,8 @@ inline std::vector<const px::md::K8sMetadataObject*> GetOwnerReferenceInfosFromM
 /**
  * @brief Returns the replica set id for the given replica set name.
  */
-class ReplicaSetIDToReplicaSetNameUDF : public ScalarUDF {
+class ReplicaSetIDToReplicaSetNameUDF
+    : public MemoizedScalarUDF<ReplicaSetIDToReplicaSetNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_id) {
     auto md = GetMetadataState(ctx);
@@ -882,7 +937,8 @@ class ReplicaSetIDToReplicaSetNameUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set start time for Replica Set ID.
  */
-class ReplicaSetIDToStartTimeUDF : public ScalarUDF {
+class ReplicaSetIDToStartTimeUDF
+    : public MemoizedScalarUDF<ReplicaSetIDToStartTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue replica_set_id) {
     auto md = GetMetadataState(ctx);
@@ -906,7 +962,8 @@ class ReplicaSetIDToStartTimeUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set stop time for Replica Set ID.
  */
-class ReplicaSetIDToStopTimeUDF : public ScalarUDF {
+class ReplicaSetIDToStopTimeUDF
+    : public MemoizedScalarUDF<ReplicaSetIDToStopTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue replica_set_id) {
     auto md = GetMetadataState(ctx);
@@ -930,7 +987,8 @@ class ReplicaSetIDToStopTimeUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set namespace for Replica Set ID.
  */
-class ReplicaSetIDToNamespaceUDF : public ScalarUDF {
+class ReplicaSetIDToNamespaceUDF
+    : public MemoizedScalarUDF<ReplicaSetIDToNamespaceUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_id) {
     auto md = GetMetadataState(ctx);
@@ -953,7 +1011,8 @@ class ReplicaSetIDToNamespaceUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set owner references for Replica Sets ID.
  */
-class ReplicaSetIDToOwnerReferencesUDF : public ScalarUDF {
+class ReplicaSetIDToOwnerReferencesUDF
+    : public MemoizedScalarUDF<ReplicaSetIDToOwnerReferencesUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_id) {
     auto md = GetMetadataState(ctx);
@@ -983,7 +1042,8 @@ class ReplicaSetIDToOwnerReferencesUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set status for Replica Set ID.
  */
-class ReplicaSetIDToStatusUDF : public ScalarUDF {
+class ReplicaSetIDToStatusUDF
+    : public MemoizedScalarUDF<ReplicaSetIDToStatusUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_id) {
     auto md = GetMetadataState(ctx);
@@ -1007,7 +1067,8 @@ class ReplicaSetIDToStatusUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment name for Replica Set ID.
  */
-class ReplicaSetIDToDeploymentNameUDF : public ScalarUDF {
+class ReplicaSetIDToDeploymentNameUDF
+    : public MemoizedScalarUDF<ReplicaSetIDToDeploymentNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_id) {
     auto md = GetMetadataState(ctx);
@@ -1037,7 +1098,8 @@ class ReplicaSetIDToDeploymentNameUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment ID for Replica Set ID.
  */
-class ReplicaSetIDToDeploymentIDUDF : public ScalarUDF {
+class ReplicaSetIDToDeploymentIDUDF
+    : public MemoizedScalarUDF<ReplicaSetIDToDeploymentIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_id) {
     auto md = GetMetadataState(ctx);
@@ -1067,7 +1129,8 @@ class ReplicaSetIDToDeploymentIDUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set name from Replica Set ID.
  */
-class ReplicaSetNameToReplicaSetIDUDF : public ScalarUDF {
+class ReplicaSetNameToReplicaSetIDUDF
+    : public MemoizedScalarUDF<ReplicaSetNameToReplicaSetIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_name) {
     auto md = GetMetadataState(ctx);
@@ -1097,7 +1160,8 @@ class ReplicaSetNameToReplicaSetIDUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set start time for Replica Set name.
  */
-class ReplicaSetNameToStartTimeUDF : public ScalarUDF {
+class ReplicaSetNameToStartTimeUDF
+    : public MemoizedScalarUDF<ReplicaSetNameToStartTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue replica_set_name) {
     auto md = GetMetadataState(ctx);
@@ -1128,7 +1192,8 @@ class ReplicaSetNameToStartTimeUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set stop time for Replica Set name.
  */
-class ReplicaSetNameToStopTimeUDF : public ScalarUDF {
+class ReplicaSetNameToStopTimeUDF
+    : public MemoizedScalarUDF<ReplicaSetNameToStopTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue replica_set_name) {
     auto md = GetMetadataState(ctx);
@@ -1159,7 +1224,8 @@ class ReplicaSetNameToStopTimeUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set namespace for Replica Set name.
  */
-class ReplicaSetNameToNamespaceUDF : public ScalarUDF {
+class ReplicaSetNameToNamespaceUDF
+    : public MemoizedScalarUDF<ReplicaSetNameToNamespaceUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_name) {
     auto md = GetMetadataState(ctx);
@@ -1189,7 +1255,8 @@ class ReplicaSetNameToNamespaceUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set owner references for Replica Set name.
  */
-class ReplicaSetNameToOwnerReferencesUDF : public ScalarUDF {
+class ReplicaSetNameToOwnerReferencesUDF
+    : public MemoizedScalarUDF<ReplicaSetNameToOwnerReferencesUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_name) {
     auto md = GetMetadataState(ctx);
@@ -1225,7 +1292,8 @@ class ReplicaSetNameToOwnerReferencesUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set status for Replica Set name.
  */
-class ReplicaSetNameToStatusUDF : public ScalarUDF {
+class ReplicaSetNameToStatusUDF
+    : public MemoizedScalarUDF<ReplicaSetNameToStatusUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_name) {
     auto md = GetMetadataState(ctx);
@@ -1256,7 +1324,8 @@ class ReplicaSetNameToStatusUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment name for Replica Set name.
  */
-class ReplicaSetNameToDeploymentNameUDF : public ScalarUDF {
+class ReplicaSetNameToDeploymentNameUDF
+    : public MemoizedScalarUDF<ReplicaSetNameToDeploymentNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_name) {
     auto md = GetMetadataState(ctx);
@@ -1291,7 +1360,8 @@ class ReplicaSetNameToDeploymentNameUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment ID for Replica Set ID.
  */
-class ReplicaSetNameToDeploymentIDUDF : public ScalarUDF {
+class ReplicaSetNameToDeploymentIDUDF
+    : public MemoizedScalarUDF<ReplicaSetNameToDeploymentIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue replica_set_name) {
     auto md = GetMetadataState(ctx);
@@ -1326,7 +1396,8 @@ class ReplicaSetNameToDeploymentIDUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment name for the given Deployment ID.
  */
-class DeploymentIDToDeploymentNameUDF : public ScalarUDF {
+class DeploymentIDToDeploymentNameUDF
+    : public MemoizedScalarUDF<DeploymentIDToDeploymentNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue deployment_id) {
     auto md = GetMetadataState(ctx);
@@ -1354,7 +1425,8 @@ class DeploymentIDToDeploymentNameUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment start time for Deployment ID.
  */
-class DeploymentIDToStartTimeUDF : public ScalarUDF {
+class DeploymentIDToStartTimeUDF
+    : public MemoizedScalarUDF<DeploymentIDToStartTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue deployment_id) {
     auto md = GetMetadataState(ctx);
@@ -1378,7 +1450,8 @@ class DeploymentIDToStartTimeUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment stop time for Deployment ID.
  */
-class DeploymentIDToStopTimeUDF : public ScalarUDF {
+class DeploymentIDToStopTimeUDF
+    : public MemoizedScalarUDF<DeploymentIDToStopTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue deployment_id) {
     auto md = GetMetadataState(ctx);
@@ -1401,7 +1474,8 @@ class DeploymentIDToStopTimeUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment namespace for Deployment ID.
  */
-class DeploymentIDToNamespaceUDF : public ScalarUDF {
+class DeploymentIDToNamespaceUDF
+    : public MemoizedScalarUDF<DeploymentIDToNamespaceUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue deployment_id) {
     auto md = GetMetadataState(ctx);
@@ -1424,7 +1498,8 @@ class DeploymentIDToNamespaceUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment status for Deployment ID.
  */
-class DeploymentIDToStatusUDF : public ScalarUDF {
+class DeploymentIDToStatusUDF
+    : public MemoizedScalarUDF<DeploymentIDToStatusUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue deployment_id) {
     auto md = GetMetadataState(ctx);
@@ -1448,7 +1523,8 @@ class DeploymentIDToStatusUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment ID from Deployment name.
  */
-class DeploymentNameToDeploymentIDUDF : public ScalarUDF {
+class DeploymentNameToDeploymentIDUDF
+    : public MemoizedScalarUDF<DeploymentNameToDeploymentIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue deployment_name) {
     auto md = GetMetadataState(ctx);
@@ -1478,7 +1554,8 @@ class DeploymentNameToDeploymentIDUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment start time for Deployment name.
  */
-class DeploymentNameToStartTimeUDF : public ScalarUDF {
+class DeploymentNameToStartTimeUDF
+    : public MemoizedScalarUDF<DeploymentNameToStartTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue deployment_name) {
     auto md = GetMetadataState(ctx);
@@ -1509,7 +1586,8 @@ class DeploymentNameToStartTimeUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment stop time for Deployment name.
  */
-class DeploymentNameToStopTimeUDF : public ScalarUDF {
+class DeploymentNameToStopTimeUDF
+    : public MemoizedScalarUDF<DeploymentNameToStopTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue deployment_name) {
     auto md = GetMetadataState(ctx);
@@ -1540,7 +1618,8 @@ class DeploymentNameToStopTimeUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment namespace for Deployment name.
  */
-class DeploymentNameToNamespaceUDF : public ScalarUDF {
+class DeploymentNameToNamespaceUDF
+    : public MemoizedScalarUDF<DeploymentNameToNamespaceUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue deployment_name) {
     auto md = GetMetadataState(ctx);
@@ -1570,7 +1649,8 @@ class DeploymentNameToNamespaceUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment status for Deployment name.
  */
-class DeploymentNameToStatusUDF : public ScalarUDF {
+class DeploymentNameToStatusUDF
+    : public MemoizedScalarUDF<DeploymentNameToStatusUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue deployment_name) {
     auto md = GetMetadataState(ctx);
@@ -1601,7 +1681,8 @@ class DeploymentNameToStatusUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set names for Replica Sets that are currently running.
  */
-class UPIDToReplicaSetNameUDF : public ScalarUDF {
+class UPIDToReplicaSetNameUDF
+    : public MemoizedScalarUDF<UPIDToReplicaSetNameUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1646,7 +1727,8 @@ class UPIDToReplicaSetNameUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set IDs for Replica Sets that are currently running.
  */
-class UPIDToReplicaSetIDUDF : public ScalarUDF {
+class UPIDToReplicaSetIDUDF
+    : public MemoizedScalarUDF<UPIDToReplicaSetIDUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1687,7 +1769,8 @@ class UPIDToReplicaSetIDUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set status for Replica Sets that are currently running.
  */
-class UPIDToReplicaSetStatusUDF : public ScalarUDF {
+class UPIDToReplicaSetStatusUDF
+    : public MemoizedScalarUDF<UPIDToReplicaSetStatusUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1727,7 +1810,8 @@ class UPIDToReplicaSetStatusUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment name for processes which are currently running.
  */
-class UPIDToDeploymentNameUDF : public ScalarUDF {
+class UPIDToDeploymentNameUDF
+    : public MemoizedScalarUDF<UPIDToDeploymentNameUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1775,7 +1859,8 @@ class UPIDToDeploymentNameUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment ID for process which is currently running.
  */
-class UPIDToDeploymentIDUDF : public ScalarUDF {
+class UPIDToDeploymentIDUDF
+    : public MemoizedScalarUDF<UPIDToDeploymentIDUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1822,7 +1907,7 @@ class UPIDToDeploymentIDUDF : public ScalarUDF {
 /**
  * @brief Returns the hostname for the pod associated with the input upid.
  */
-class UPIDToHostnameUDF : public ScalarUDF {
+class UPIDToHostnameUDF : public MemoizedScalarUDF<UPIDToHostnameUDF, StringValue, UInt128Value> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1850,7 +1935,8 @@ class UPIDToHostnameUDF : public ScalarUDF {
 /**
  * @brief Returns the service names for the given pod ID.
  */
-class PodIDToServiceNameUDF : public ScalarUDF {
+class PodIDToServiceNameUDF
+    : public MemoizedScalarUDF<PodIDToServiceNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -1892,7 +1978,8 @@ class PodIDToServiceNameUDF : public ScalarUDF {
 /**
  * @brief Returns the service ids for the given pod ID.
  */
-class PodIDToServiceIDUDF : public ScalarUDF {
+class PodIDToServiceIDUDF
+    : public MemoizedScalarUDF<PodIDToServiceIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -1928,7 +2015,8 @@ class PodIDToServiceIDUDF : public ScalarUDF {
 /**
  * @brief Returns the owner references for the given pod ID.
  */
-class PodIDToOwnerReferencesUDF : public ScalarUDF {
+class PodIDToOwnerReferencesUDF
+    : public MemoizedScalarUDF<PodIDToOwnerReferencesUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -1958,7 +2046,8 @@ class PodIDToOwnerReferencesUDF : public ScalarUDF {
 /**
  * @brief Returns the owner references for the given pod name.
  */
-class PodNameToOwnerReferencesUDF : public ScalarUDF {
+class PodNameToOwnerReferencesUDF
+    : public MemoizedScalarUDF<PodNameToOwnerReferencesUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -1989,7 +2078,7 @@ class PodNameToOwnerReferencesUDF : public ScalarUDF {
 /**
  * @brief Returns the Node Name of a pod ID passed in.
  */
-class PodIDToNodeNameUDF : public ScalarUDF {
+class PodIDToNodeNameUDF : public MemoizedScalarUDF<PodIDToNodeNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -2018,7 +2107,8 @@ class PodIDToNodeNameUDF : public ScalarUDF {
 /**
  * @brief Returns the ReplicaSet name of a pod ID passed in.
  */
-class PodIDToReplicaSetNameUDF : public ScalarUDF {
+class PodIDToReplicaSetNameUDF
+    : public MemoizedScalarUDF<PodIDToReplicaSetNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -2053,7 +2143,8 @@ class PodIDToReplicaSetNameUDF : public ScalarUDF {
 /**
  * @brief Returns the ReplicaSet ID of a pod ID passed in.
  */
-class PodIDToReplicaSetIDUDF : public ScalarUDF {
+class PodIDToReplicaSetIDUDF
+    : public MemoizedScalarUDF<PodIDToReplicaSetIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -2088,7 +2179,8 @@ class PodIDToReplicaSetIDUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment name of a pod ID passed in.
  */
-class PodIDToDeploymentNameUDF : public ScalarUDF {
+class PodIDToDeploymentNameUDF
+    : public MemoizedScalarUDF<PodIDToDeploymentNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -2127,7 +2219,8 @@ class PodIDToDeploymentNameUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment ID of a pod ID passed in.
  */
-class PodIDToDeploymentIDUDF : public ScalarUDF {
+class PodIDToDeploymentIDUDF
+    : public MemoizedScalarUDF<PodIDToDeploymentIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -2166,7 +2259,8 @@ class PodIDToDeploymentIDUDF : public ScalarUDF {
 /**
  * @brief Returns the ReplicaSet name of a pod name passed in.
  */
-class PodNameToReplicaSetNameUDF : public ScalarUDF {
+class PodNameToReplicaSetNameUDF
+    : public MemoizedScalarUDF<PodNameToReplicaSetNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -2206,7 +2300,8 @@ class PodNameToReplicaSetNameUDF : public ScalarUDF {
 /**
  * @brief Returns the ReplicaSet ID of a Pod name passed in.
  */
-class PodNameToReplicaSetIDUDF : public ScalarUDF {
+class PodNameToReplicaSetIDUDF
+    : public MemoizedScalarUDF<PodNameToReplicaSetIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -2246,7 +2341,8 @@ class PodNameToReplicaSetIDUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment name of a pod name passed in.
  */
-class PodNameToDeploymentNameUDF : public ScalarUDF {
+class PodNameToDeploymentNameUDF
+    : public MemoizedScalarUDF<PodNameToDeploymentNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -2290,7 +2386,8 @@ class PodNameToDeploymentNameUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment ID of a Pod name passed in.
  */
-class PodNameToDeploymentIDUDF : public ScalarUDF {
+class PodNameToDeploymentIDUDF
+    : public MemoizedScalarUDF<PodNameToDeploymentIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -2334,7 +2431,8 @@ class PodNameToDeploymentIDUDF : public ScalarUDF {
 /**
  * @brief Returns the service names for the given pod name.
  */
-class PodNameToServiceNameUDF : public ScalarUDF {
+class PodNameToServiceNameUDF
+    : public MemoizedScalarUDF<PodNameToServiceNameUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -2380,7 +2478,8 @@ class PodNameToServiceNameUDF : public ScalarUDF {
 /**
  * @brief Returns the service ids for the given pod name.
  */
-class PodNameToServiceIDUDF : public ScalarUDF {
+class PodNameToServiceIDUDF
+    : public MemoizedScalarUDF<PodNameToServiceIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -2477,7 +2576,8 @@ class UPIDToStartTSUDF : public ScalarUDF {
   }
 };
 
-class PodIDToPodStartTimeUDF : public ScalarUDF {
+class PodIDToPodStartTimeUDF
+    : public MemoizedScalarUDF<PodIDToPodStartTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -2496,7 +2596,8 @@ class PodIDToPodStartTimeUDF : public ScalarUDF {
   }
 };
 
-class PodIDToPodStopTimeUDF : public ScalarUDF {
+class PodIDToPodStopTimeUDF
+    : public MemoizedScalarUDF<PodIDToPodStopTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -2515,7 +2616,8 @@ class PodIDToPodStopTimeUDF : public ScalarUDF {
   }
 };
 
-class PodNameToPodStartTimeUDF : public ScalarUDF {
+class PodNameToPodStartTimeUDF
+    : public MemoizedScalarUDF<PodNameToPodStartTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -2535,7 +2637,8 @@ class PodNameToPodStartTimeUDF : public ScalarUDF {
   }
 };
 
-class PodNameToPodStopTimeUDF : public ScalarUDF {
+class PodNameToPodStopTimeUDF
+    : public MemoizedScalarUDF<PodNameToPodStopTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -2555,7 +2658,8 @@ class PodNameToPodStopTimeUDF : public ScalarUDF {
   }
 };
 
-class ContainerNameToContainerIDUDF : public ScalarUDF {
+class ContainerNameToContainerIDUDF
+    : public MemoizedScalarUDF<ContainerNameToContainerIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue container_name) {
     auto md = GetMetadataState(ctx);
@@ -2571,7 +2675,8 @@ class ContainerNameToContainerIDUDF : public ScalarUDF {
   }
 };
 
-class ContainerIDToContainerStartTimeUDF : public ScalarUDF {
+class ContainerIDToContainerStartTimeUDF
+    : public MemoizedScalarUDF<ContainerIDToContainerStartTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue container_id) {
     auto md = GetMetadataState(ctx);
@@ -2593,7 +2698,8 @@ class ContainerIDToContainerStartTimeUDF : public ScalarUDF {
   }
 };
 
-class ContainerIDToContainerStopTimeUDF : public ScalarUDF {
+class ContainerIDToContainerStopTimeUDF
+    : public MemoizedScalarUDF<ContainerIDToContainerStopTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue container_id) {
     auto md = GetMetadataState(ctx);
@@ -2615,7 +2721,8 @@ class ContainerIDToContainerStopTimeUDF : public ScalarUDF {
   }
 };
 
-class ContainerNameToContainerStartTimeUDF : public ScalarUDF {
+class ContainerNameToContainerStartTimeUDF
+    : public MemoizedScalarUDF<ContainerNameToContainerStartTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue container_name) {
     auto md = GetMetadataState(ctx);
@@ -2637,7 +2744,8 @@ class ContainerNameToContainerStartTimeUDF : public ScalarUDF {
   }
 };
 
-class ContainerNameToContainerStopTimeUDF : public ScalarUDF {
+class ContainerNameToContainerStopTimeUDF
+    : public MemoizedScalarUDF<ContainerNameToContainerStopTimeUDF, Time64NSValue, StringValue> {
  public:
   Time64NSValue Exec(FunctionContext* ctx, StringValue container_name) {
     auto md = GetMetadataState(ctx);
@@ -2706,7 +2814,8 @@ inline types::StringValue PodInfoToPodStatus(const px::md::PodInfo* pod_info) {
   return sb.GetString();
 }
 
-class PodNameToPodStatusUDF : public ScalarUDF {
+class PodNameToPodStatusUDF
+    : public MemoizedScalarUDF<PodNameToPodStatusUDF, StringValue, StringValue> {
  public:
   /**
    * @brief Gets the Pod status for a passed in pod.
@@ -2742,7 +2851,8 @@ class PodNameToPodStatusUDF : public ScalarUDF {
   }
 };
 
-class PodNameToPodReadyUDF : public ScalarUDF {
+class PodNameToPodReadyUDF
+    : public MemoizedScalarUDF<PodNameToPodReadyUDF, BoolValue, StringValue> {
  public:
   BoolValue Exec(FunctionContext* ctx, StringValue pod_name) {
     auto md = GetMetadataState(ctx);
@@ -2775,7 +2885,8 @@ class PodNameToPodReadyUDF : public ScalarUDF {
   }
 };
 
-class PodNameToPodStatusMessageUDF : public ScalarUDF {
+class PodNameToPodStatusMessageUDF
+    : public MemoizedScalarUDF<PodNameToPodStatusMessageUDF, StringValue, StringValue> {
  public:
   /**
    * @brief Gets the Pod status message for a passed in pod.
@@ -2795,7 +2906,8 @@ class PodNameToPodStatusMessageUDF : public ScalarUDF {
   }
 };
 
-class PodNameToPodStatusReasonUDF : public ScalarUDF {
+class PodNameToPodStatusReasonUDF
+    : public MemoizedScalarUDF<PodNameToPodStatusReasonUDF, StringValue, StringValue> {
  public:
   /**
    * @brief Gets the Pod status reason for a passed in pod.
@@ -2829,7 +2941,8 @@ inline std::string ContainerStateToString(const px::md::ContainerState& containe
   }
 }
 
-class ContainerIDToContainerStatusUDF : public ScalarUDF {
+class ContainerIDToContainerStatusUDF
+    : public MemoizedScalarUDF<ContainerIDToContainerStatusUDF, StringValue, StringValue> {
  public:
   /**
    * @brief Gets the Container status for a passed in container.
@@ -2879,7 +2992,7 @@ class ContainerIDToContainerStatusUDF : public ScalarUDF {
   }
 };
 
-class UPIDToPodStatusUDF : public ScalarUDF {
+class UPIDToPodStatusUDF : public MemoizedScalarUDF<UPIDToPodStatusUDF, StringValue, UInt128Value> {
  public:
   /**
    * @brief Gets the Pod status for a passed in UPID.
@@ -2918,7 +3031,7 @@ class UPIDToPodStatusUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 };
 
-class UPIDToCmdLineUDF : public ScalarUDF {
+class UPIDToCmdLineUDF : public MemoizedScalarUDF<UPIDToCmdLineUDF, StringValue, UInt128Value> {
  public:
   /**
    * @brief Gets the cmdline for the upid.
@@ -2959,7 +3072,7 @@ inline std::string PodInfoToPodQoS(const px::md::PodInfo* pod_info) {
   return std::string(magic_enum::enum_name(pod_info->qos_class()));
 }
 
-class UPIDToPodQoSUDF : public ScalarUDF {
+class UPIDToPodQoSUDF : public MemoizedScalarUDF<UPIDToPodQoSUDF, StringValue, UInt128Value> {
  public:
   /**
    * @brief Gets the qos for the upid's pod.
@@ -3026,7 +3139,7 @@ class HostNumCPUsUDF : public ScalarUDF {
   }
 };
 
-class IPToPodIDUDF : public ScalarUDF {
+class IPToPodIDUDF : public MemoizedScalarUDF<IPToPodIDUDF, StringValue, StringValue> {
  public:
   /**
    * @brief Gets the pod id of pod with given pod_ip
@@ -3059,7 +3172,7 @@ class IPToPodIDUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_KELVIN; }
 };
 
-class IPToServiceIDUDF : public ScalarUDF {
+class IPToServiceIDUDF : public MemoizedScalarUDF<IPToServiceIDUDF, StringValue, StringValue> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue ip) {
     auto md = GetMetadataState(ctx);
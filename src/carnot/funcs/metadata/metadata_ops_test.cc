@@ -44,6 +44,7 @@ using ::px::carnot::udf::FunctionContext;
 
 using ResourceUpdate = px::shared::k8s::metadatapb::ResourceUpdate;
 using ::testing::AnyOf;
+using ::testing::ElementsAre;
 
 class MetadataOpsTest : public ::testing::Test {
  protected:
@@ -147,6 +148,26 @@ TEST_F(MetadataOpsTest, upid_to_pod_name_test) {
   udf_tester.ForInput(upid3).Expect("");
 }
 
+TEST_F(MetadataOpsTest, upid_to_pod_name_exec_batch_test) {
+  auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
+  UPIDToPodNameUDF udf;
+  auto upid1 = types::UInt128Value(528280977975, 89101);
+  auto upid2 = types::UInt128Value(528280977975, 468);
+  auto upid3 = types::UInt128Value(528280977975, 123);
+
+  std::vector<types::UInt128Value> upids = {upid1, upid1, upid2, upid3, upid1, upid2};
+  std::vector<types::StringValue> out(upids.size());
+  ASSERT_OK(udf.ExecBatch(function_ctx.get(), upids.size(), out.data(), upids.data()));
+  EXPECT_THAT(out, ElementsAre("pl/running_pod", "pl/running_pod", "pl/terminating_pod", "",
+                               "pl/running_pod", "pl/terminating_pod"));
+
+  // Results are not carried over to the next batch.
+  upids = {upid3, upid2};
+  out.assign(upids.size(), "");
+  ASSERT_OK(udf.ExecBatch(function_ctx.get(), upids.size(), out.data(), upids.data()));
+  EXPECT_THAT(out, ElementsAre("", "pl/terminating_pod"));
+}
+
 TEST_F(MetadataOpsTest, upid_to_namespace_test) {
   auto function_ctx = std::make_unique<FunctionContext>(metadata_state_, nullptr);
   auto udf_tester = px::carnot::udf::UDFTester<UPIDToNamespaceUDF>(std::move(function_ctx));
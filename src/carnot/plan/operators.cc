@@ -74,6 +74,8 @@ std::unique_ptr<Operator> Operator::FromProto(const planpb::Operator& pb, int64_
       return CreateOperator<FilterOperator>(id, pb.filter_op());
     case planpb::LIMIT_OPERATOR:
       return CreateOperator<LimitOperator>(id, pb.limit_op());
+    case planpb::TOPK_OPERATOR:
+      return CreateOperator<TopKOperator>(id, pb.topk_op());
     case planpb::UNION_OPERATOR:
       return CreateOperator<UnionOperator>(id, pb.union_op());
     case planpb::JOIN_OPERATOR:
@@ -454,6 +456,73 @@ StatusOr<table_store::schema::Relation> LimitOperator::OutputRelation(
   return output_relation;
 }
 
+/**
+ * TopK Operator Implementation.
+ */
+std::string TopKOperator::DebugString() const {
+  std::vector<std::string> sort_strs;
+  for (size_t i = 0; i < sort_cols_.size(); ++i) {
+    sort_strs.push_back(absl::Substitute("$0 $1", sort_cols_[i], ascending_[i] ? "asc" : "desc"));
+  }
+  return absl::Substitute("Op:TopK($0, sort: [$1], cols: [$2])", k_, absl::StrJoin(sort_strs, ","),
+                          absl::StrJoin(selected_cols_, ","));
+}
+
+Status TopKOperator::Init(const planpb::TopKOperator& pb) {
+  pb_ = pb;
+  k_ = pb_.k();
+
+  sort_cols_.reserve(pb_.sort_columns_size());
+  ascending_.reserve(pb_.sort_columns_size());
+  for (const auto& sort_col : pb_.sort_columns()) {
+    sort_cols_.push_back(sort_col.index());
+    ascending_.push_back(sort_col.ascending());
+  }
+
+  selected_cols_.reserve(pb_.columns_size());
+  for (auto i = 0; i < pb_.columns_size(); ++i) {
+    selected_cols_.push_back(pb_.columns(i).index());
+  }
+
+  is_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<table_store::schema::Relation> TopKOperator::OutputRelation(
+    const table_store::schema::Schema& schema, const PlanState& /*state*/,
+    const std::vector<int64_t>& input_ids) const {
+  DCHECK(is_initialized_) << "Not initialized";
+
+  if (input_ids.size() != 1) {
+    return error::InvalidArgument("TopK operator must have exactly one input");
+  }
+  if (!schema.HasRelation(input_ids[0])) {
+    return error::NotFound("Missing relation ($0) for input of TopKOperator", input_ids[0]);
+  }
+
+  PL_ASSIGN_OR_RETURN(const table_store::schema::Relation& input_relation,
+                      schema.GetRelation(input_ids[0]));
+  for (auto sort_col_idx : sort_cols_) {
+    if (sort_col_idx < 0 || sort_col_idx >= static_cast<int64_t>(input_relation.NumColumns())) {
+      return error::InvalidArgument(
+          "Sort column index $0 is out of bounds, number of columns is $1", sort_col_idx,
+          input_relation.NumColumns());
+    }
+  }
+
+  table_store::schema::Relation output_relation;
+  for (auto selected_col_idx : selected_cols_) {
+    CHECK_LT(selected_col_idx, static_cast<int64_t>(input_relation.NumColumns()))
+        << absl::Substitute("Column index $0 is out of bounds, number of columns is $1",
+                            selected_col_idx, input_relation.NumColumns());
+
+    output_relation.AddColumn(input_relation.GetColumnType(selected_col_idx),
+                              input_relation.GetColumnName(selected_col_idx),
+                              input_relation.GetColumnDesc(selected_col_idx));
+  }
+  return output_relation;
+}
+
 /**
  * Zip Operator Implementation.
  */
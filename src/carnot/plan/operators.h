@@ -162,6 +162,7 @@ class MemorySinkOperator : public Operator {
   Status Init(const planpb::MemorySinkOperator& pb);
   std::string TableName() const { return pb_.name(); }
   std::string ColumnName(int64_t i) const { return pb_.column_names(i); }
+  bool append() const { return pb_.append(); }
   std::string DebugString() const override;
 
  private:
@@ -262,6 +263,33 @@ class LimitOperator : public Operator {
   planpb::LimitOperator pb_;
 };
 
+class TopKOperator : public Operator {
+ public:
+  explicit TopKOperator(int64_t id) : Operator(id, planpb::TOPK_OPERATOR) {}
+  ~TopKOperator() override = default;
+
+  StatusOr<table_store::schema::Relation> OutputRelation(
+      const table_store::schema::Schema& schema, const PlanState& state,
+      const std::vector<int64_t>& input_ids) const override;
+  Status Init(const planpb::TopKOperator& pb);
+  std::string DebugString() const override;
+  const std::vector<int64_t>& selected_cols() const { return selected_cols_; }
+
+  // The indexes of the input columns to sort by, in decreasing order of precedence.
+  const std::vector<int64_t>& sort_cols() const { return sort_cols_; }
+  // Whether each of the sort_cols() is sorted in ascending order.
+  const std::vector<bool>& ascending() const { return ascending_; }
+  // The number of rows to keep. 0 keeps all the rows.
+  int64_t k() const { return k_; }
+
+ private:
+  int64_t k_ = 0;
+  std::vector<int64_t> sort_cols_;
+  std::vector<bool> ascending_;
+  std::vector<int64_t> selected_cols_;
+  planpb::TopKOperator pb_;
+};
+
 class UnionOperator : public Operator {
  public:
   explicit UnionOperator(int64_t id) : Operator(id, planpb::UNION_OPERATOR) {}
@@ -239,6 +239,20 @@ TEST_F(OperatorTest, from_proto_drop_limit) {
   auto limit_typed_op = static_cast<LimitOperator*>(limit_op.get());
   EXPECT_THAT(limit_typed_op->selected_cols(), ElementsAre(0, 2));
 }
+
+TEST_F(OperatorTest, from_proto_topk) {
+  auto topk_pb = planpb::testutils::CreateTestTopK1PB();
+  auto topk_op = Operator::FromProto(topk_pb, 1);
+  EXPECT_EQ(1, topk_op->id());
+  EXPECT_TRUE(topk_op->is_initialized());
+  EXPECT_EQ(planpb::OperatorType::TOPK_OPERATOR, topk_op->op_type());
+  auto topk_typed_op = static_cast<TopKOperator*>(topk_op.get());
+  EXPECT_EQ(5, topk_typed_op->k());
+  EXPECT_THAT(topk_typed_op->sort_cols(), ElementsAre(1, 0));
+  EXPECT_THAT(topk_typed_op->ascending(), ElementsAre(false, true));
+  EXPECT_THAT(topk_typed_op->selected_cols(), ElementsAre(0, 2));
+}
+
 TEST_F(OperatorTest, from_proto_join_with_time) {
   auto join_pb = planpb::testutils::CreateTestJoinWithTimePB();
   auto join_op = std::make_unique<JoinOperator>(1);
@@ -415,6 +429,18 @@ TEST_F(OperatorTest, output_relation_drop_limit) {
   EXPECT_EQ(expected_relation, rel);
 }
 
+TEST_F(OperatorTest, output_relation_topk) {
+  auto topk_pb = planpb::testutils::CreateTestTopK1PB();
+  auto topk_op = Operator::FromProto(topk_pb, 1);
+
+  auto rel =
+      topk_op->OutputRelation(schema_, *state_, std::vector<int64_t>({0})).ConsumeValueOrDie();
+  Relation expected_relation;
+  expected_relation.AddColumn(types::DataType::INT64, "col0");
+  expected_relation.AddColumn(types::DataType::STRING, "col2");
+  EXPECT_EQ(expected_relation, rel);
+}
+
 TEST_F(OperatorTest, output_relation_union) {
   auto union_pb = planpb::testutils::CreateTestUnionOrderedPB();
   auto union_op = Operator::FromProto(union_pb, 4);
@@ -561,6 +561,13 @@ class OperatorTests : public ::testing::Test {
     return limit;
   }
 
+  TopKIR* MakeTopK(OperatorIR* parent, const std::vector<std::string>& sort_cols,
+                   const std::vector<bool>& ascending, int64_t k) {
+    TopKIR* topk =
+        graph->CreateNode<TopKIR>(ast, parent, sort_cols, ascending, k).ConsumeValueOrDie();
+    return topk;
+  }
+
   BlockingAggIR* MakeBlockingAgg(OperatorIR* parent, const std::vector<ColumnIR*>& columns,
                                  const ColExpressionVector& col_agg) {
     BlockingAggIR* agg =
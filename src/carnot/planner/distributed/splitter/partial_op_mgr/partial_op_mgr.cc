@@ -44,6 +44,23 @@ StatusOr<OperatorIR*> LimitOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR
   return new_limit;
 }
 
+StatusOr<OperatorIR*> TopKOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
+  DCHECK(Matches(op));
+  TopKIR* topk = static_cast<TopKIR*>(op);
+  PL_ASSIGN_OR_RETURN(TopKIR * new_topk, plan->CopyNode(topk));
+  PL_RETURN_IF_ERROR(new_topk->CopyParentsFrom(topk));
+  return new_topk;
+}
+
+StatusOr<OperatorIR*> TopKOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                                           OperatorIR* op) const {
+  DCHECK(Matches(op));
+  TopKIR* topk = static_cast<TopKIR*>(op);
+  PL_ASSIGN_OR_RETURN(TopKIR * new_topk, plan->CopyNode(topk));
+  PL_RETURN_IF_ERROR(new_topk->AddParent(new_parent));
+  return new_topk;
+}
+
 StatusOr<OperatorIR*> AggOperatorMgr::CreatePrepareOperator(IR* plan, OperatorIR* op) const {
   DCHECK(Matches(op));
   BlockingAggIR* agg = static_cast<BlockingAggIR*>(op);
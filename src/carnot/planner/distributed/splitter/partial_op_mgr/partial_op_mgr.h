@@ -87,6 +87,25 @@ class LimitOperatorMgr : public PartialOperatorMgr {
                                             OperatorIR* op) const override;
 };
 
+/**
+ * @brief TopKOperatorMgr manages splitting top k operators over the boundary. Each Prepare TopK
+ * keeps the top k rows of its data, which is enough for the Merge TopK to find the top k rows
+ * overall, so at most k rows per agent cross the network. A full sort (k = 0) is not split, as it
+ * would not reduce the data that is sent.
+ */
+class TopKOperatorMgr : public PartialOperatorMgr {
+ public:
+  bool Matches(OperatorIR* op) const override {
+    if (!Match(op, TopK())) {
+      return false;
+    }
+    return static_cast<TopKIR*>(op)->k() > 0;
+  }
+  StatusOr<OperatorIR*> CreatePrepareOperator(IR* plan, OperatorIR* op) const override;
+  StatusOr<OperatorIR*> CreateMergeOperator(IR* plan, OperatorIR* new_parent,
+                                            OperatorIR* op) const override;
+};
+
 /**
  * @brief AggOperatorMgr manages splitting aggregates into partial aggregate and the merging node
  * over a network boundary.
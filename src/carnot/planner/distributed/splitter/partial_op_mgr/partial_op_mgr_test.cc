@@ -68,6 +68,39 @@ TEST_F(PartialOpMgrTest, limit_test) {
   EXPECT_NE(merge_limit, limit);
 }
 
+TEST_F(PartialOpMgrTest, topk_test) {
+  auto mem_src = MakeMemSource(MakeRelation());
+  auto topk = MakeTopK(mem_src, {"count"}, {false}, 10);
+  MakeMemSink(topk, "out");
+
+  TopKOperatorMgr mgr;
+  EXPECT_TRUE(mgr.Matches(topk));
+  auto prepare_topk_or_s = mgr.CreatePrepareOperator(graph.get(), topk);
+  ASSERT_OK(prepare_topk_or_s);
+  OperatorIR* prepare_topk_uncasted = prepare_topk_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(prepare_topk_uncasted, TopK());
+  TopKIR* prepare_topk = static_cast<TopKIR*>(prepare_topk_uncasted);
+  EXPECT_EQ(prepare_topk->k(), topk->k());
+  EXPECT_EQ(prepare_topk->sort_cols(), topk->sort_cols());
+  EXPECT_EQ(prepare_topk->ascending(), topk->ascending());
+  EXPECT_EQ(prepare_topk->parents(), topk->parents());
+  EXPECT_NE(prepare_topk, topk);
+
+  auto mem_src2 = MakeMemSource(MakeRelation());
+  auto merge_topk_or_s = mgr.CreateMergeOperator(graph.get(), mem_src2, topk);
+  ASSERT_OK(merge_topk_or_s);
+  OperatorIR* merge_topk_uncasted = merge_topk_or_s.ConsumeValueOrDie();
+  ASSERT_MATCH(merge_topk_uncasted, TopK());
+  TopKIR* merge_topk = static_cast<TopKIR*>(merge_topk_uncasted);
+  EXPECT_EQ(merge_topk->k(), topk->k());
+  EXPECT_EQ(merge_topk->parents()[0], mem_src2);
+  EXPECT_NE(merge_topk, topk);
+
+  // A full sort is not split.
+  auto sort = MakeTopK(MakeMemSource(MakeRelation()), {"count"}, {true}, 0);
+  EXPECT_FALSE(mgr.Matches(sort));
+}
+
 TEST_F(PartialOpMgrTest, agg_test) {
   auto relation = MakeRelation();
   relation.AddColumn(types::STRING, "service");
@@ -73,6 +73,7 @@
 #include "src/carnot/planner/ir/memory_source_ir.h"
 #include "src/carnot/planner/ir/otel_export_sink_ir.h"
 #include "src/carnot/planner/ir/string_ir.h"
+#include "src/carnot/planner/ir/topk_ir.h"
 
 namespace px {
 namespace carnot {
@@ -164,6 +165,7 @@ inline ClassMatch<IRNodeType::kEmptySource> EmptySource() {
   return ClassMatch<IRNodeType::kEmptySource>();
 }
 inline ClassMatch<IRNodeType::kLimit> Limit() { return ClassMatch<IRNodeType::kLimit>(); }
+inline ClassMatch<IRNodeType::kTopK> TopK() { return ClassMatch<IRNodeType::kTopK>(); }
 
 inline ClassMatch<IRNodeType::kGRPCSource> GRPCSource() {
   return ClassMatch<IRNodeType::kGRPCSource>();
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/ir/topk_ir.h"
+
+#include <absl/strings/str_join.h>
+#include <absl/strings/substitute.h>
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+std::string TopKIR::DebugString() const {
+  std::vector<std::string> sort_strs;
+  for (size_t i = 0; i < sort_cols_.size(); ++i) {
+    sort_strs.push_back(absl::Substitute("$0 $1", sort_cols_[i], ascending_[i] ? "asc" : "desc"));
+  }
+  return absl::Substitute("$0(id=$1, k=$2, sort=[$3])", type_string(), id(), k_,
+                          absl::StrJoin(sort_strs, ", "));
+}
+
+Status TopKIR::Init(OperatorIR* parent, const std::vector<std::string>& sort_cols,
+                    const std::vector<bool>& ascending, int64_t k) {
+  PL_RETURN_IF_ERROR(AddParent(parent));
+  if (sort_cols.empty()) {
+    return CreateIRNodeError("Expected at least one column to sort by.");
+  }
+  if (sort_cols.size() != ascending.size()) {
+    return CreateIRNodeError("Expected $0 sort orders, received $1.", sort_cols.size(),
+                             ascending.size());
+  }
+  if (k < 0) {
+    return CreateIRNodeError("The number of rows to keep must be non-negative, received $0.", k);
+  }
+  sort_cols_ = sort_cols;
+  ascending_ = ascending;
+  k_ = k;
+  return Status::OK();
+}
+
+StatusOr<std::vector<absl::flat_hash_set<std::string>>> TopKIR::RequiredInputColumns() const {
+  DCHECK(is_type_resolved());
+  absl::flat_hash_set<std::string> required_cols(sort_cols_.begin(), sort_cols_.end());
+  required_cols.insert(resolved_table_type()->ColumnNames().begin(),
+                       resolved_table_type()->ColumnNames().end());
+  return std::vector<absl::flat_hash_set<std::string>>{required_cols};
+}
+
+Status TopKIR::ToProto(planpb::Operator* op) const {
+  auto pb = op->mutable_topk_op();
+  op->set_op_type(planpb::TOPK_OPERATOR);
+  DCHECK_EQ(parents().size(), 1UL);
+
+  DCHECK(parents()[0]->is_type_resolved());
+  auto parent_table_type = parents()[0]->resolved_table_type();
+  auto parent_id = parents()[0]->id();
+
+  DCHECK(is_type_resolved());
+  for (const std::string& col_name : resolved_table_type()->ColumnNames()) {
+    planpb::Column* col_pb = pb->add_columns();
+    col_pb->set_node(parent_id);
+    DCHECK(parent_table_type->HasColumn(col_name));
+    col_pb->set_index(parent_table_type->GetColumnIndex(col_name));
+  }
+  for (size_t i = 0; i < sort_cols_.size(); ++i) {
+    if (!parent_table_type->HasColumn(sort_cols_[i])) {
+      return CreateIRNodeError("Column '$0' not found in parent dataframe", sort_cols_[i]);
+    }
+    auto sort_col_pb = pb->add_sort_columns();
+    sort_col_pb->set_index(parent_table_type->GetColumnIndex(sort_cols_[i]));
+    sort_col_pb->set_ascending(ascending_[i]);
+  }
+  pb->set_k(k_);
+  return Status::OK();
+}
+
+Status TopKIR::ResolveType(CompilerState* /* compiler_state */) {
+  DCHECK_EQ(1U, parent_types().size());
+  auto parent_table_type = std::static_pointer_cast<TableType>(parent_types()[0]);
+  for (const auto& col_name : sort_cols_) {
+    if (!parent_table_type->HasColumn(col_name)) {
+      return CreateIRNodeError("Column '$0' not found in parent dataframe", col_name);
+    }
+  }
+  PL_ASSIGN_OR_RETURN(auto type_ptr, OperatorIR::DefaultResolveType(parent_types()));
+  return SetResolvedType(type_ptr);
+}
+
+Status TopKIR::CopyFromNodeImpl(const IRNode* node, absl::flat_hash_map<const IRNode*, IRNode*>*) {
+  const TopKIR* topk = static_cast<const TopKIR*>(node);
+  sort_cols_ = topk->sort_cols_;
+  ascending_ = topk->ascending_;
+  k_ = topk->k_;
+  return Status::OK();
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
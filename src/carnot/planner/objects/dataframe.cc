@@ -270,6 +270,55 @@ StatusOr<QLObjectPtr> LimitHandler(CompilerState* compiler_state, IR* graph, Ope
   return Dataframe::Create(compiler_state, limit_op, visitor);
 }
 
+// Parses the sort order of each of the num_sort_cols columns, which is either a single bool that
+// applies to all the columns, or a list with a bool per column.
+StatusOr<std::vector<bool>> ParseSortOrders(const pypa::AstPtr& ast, QLObjectPtr obj,
+                                            size_t num_sort_cols) {
+  PL_ASSIGN_OR_RETURN(auto bool_irs, ParseAsListOf<BoolIR>(obj, "ascending"));
+  if (!CollectionObject::IsCollection(obj)) {
+    return std::vector<bool>(num_sort_cols, bool_irs[0]->val());
+  }
+  if (bool_irs.size() != num_sort_cols) {
+    return CreateAstError(ast, "Expected $0 values for 'ascending', received $1", num_sort_cols,
+                          bool_irs.size());
+  }
+  std::vector<bool> ascending;
+  for (BoolIR* bool_ir : bool_irs) {
+    ascending.push_back(bool_ir->val());
+  }
+  return ascending;
+}
+
+StatusOr<QLObjectPtr> CreateTopK(CompilerState* compiler_state, IR* graph, OperatorIR* op,
+                                 const pypa::AstPtr& ast, const ParsedArgs& args, int64_t k,
+                                 ASTVisitor* visitor) {
+  PL_ASSIGN_OR_RETURN(std::vector<std::string> sort_cols,
+                      ParseAsListOfStrings(args.GetArg("by"), "by"));
+  PL_ASSIGN_OR_RETURN(std::vector<bool> ascending,
+                      ParseSortOrders(ast, args.GetArg("ascending"), sort_cols.size()));
+  PL_ASSIGN_OR_RETURN(TopKIR * topk_op,
+                      graph->CreateNode<TopKIR>(ast, op, sort_cols, ascending, k));
+  return Dataframe::Create(compiler_state, topk_op, visitor);
+}
+
+// Handles the sort_values() DataFrame logic.
+StatusOr<QLObjectPtr> SortHandler(CompilerState* compiler_state, IR* graph, OperatorIR* op,
+                                  const pypa::AstPtr& ast, const ParsedArgs& args,
+                                  ASTVisitor* visitor) {
+  return CreateTopK(compiler_state, graph, op, ast, args, /* k */ 0, visitor);
+}
+
+// Handles the top_k() DataFrame logic.
+StatusOr<QLObjectPtr> TopKHandler(CompilerState* compiler_state, IR* graph, OperatorIR* op,
+                                  const pypa::AstPtr& ast, const ParsedArgs& args,
+                                  ASTVisitor* visitor) {
+  PL_ASSIGN_OR_RETURN(IntIR * k_node, GetArgAs<IntIR>(ast, args, "k"));
+  if (k_node->val() <= 0) {
+    return k_node->CreateIRNodeError("'k' must be positive, received $0", k_node->val());
+  }
+  return CreateTopK(compiler_state, graph, op, ast, args, k_node->val(), visitor);
+}
+
 class SubscriptHandler {
  public:
   /**
@@ -515,6 +564,40 @@ Status Dataframe::Init() {
   PL_RETURN_IF_ERROR(limitfn->SetDocString(kLimitOpDocstring));
   AddMethod(kLimitOpID, limitfn);
 
+  /**
+   * # Equivalent to the python method method syntax:
+   * def sort_values(self, by, ascending=True):
+   *     ...
+   */
+  PL_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> sortfn,
+      FuncObject::Create(
+          kSortOpID, {"by", "ascending"}, {{"ascending", "True"}},
+          /* has_variable_len_args */ false,
+          /* has_variable_len_kwargs */ false,
+          std::bind(&SortHandler, compiler_state_, graph(), op(), std::placeholders::_1,
+                    std::placeholders::_2, std::placeholders::_3),
+          ast_visitor()));
+  PL_RETURN_IF_ERROR(sortfn->SetDocString(kSortOpDocstring));
+  AddMethod(kSortOpID, sortfn);
+
+  /**
+   * # Equivalent to the python method method syntax:
+   * def top_k(self, by, k=5, ascending=False):
+   *     ...
+   */
+  PL_ASSIGN_OR_RETURN(
+      std::shared_ptr<FuncObject> topkfn,
+      FuncObject::Create(
+          kTopKOpID, {"by", "k", "ascending"}, {{"k", "5"}, {"ascending", "False"}},
+          /* has_variable_len_args */ false,
+          /* has_variable_len_kwargs */ false,
+          std::bind(&TopKHandler, compiler_state_, graph(), op(), std::placeholders::_1,
+                    std::placeholders::_2, std::placeholders::_3),
+          ast_visitor()));
+  PL_RETURN_IF_ERROR(topkfn->SetDocString(kTopKOpDocstring));
+  AddMethod(kTopKOpID, topkfn);
+
   /**
    *
    * # Equivalent to the python method method syntax:
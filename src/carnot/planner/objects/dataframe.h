@@ -281,6 +281,56 @@ class Dataframe : public QLObject {
     px.DataFrame: DataFrame with the first n rows.
   )doc";
 
+  inline static constexpr char kSortOpID[] = "sort_values";
+  inline static constexpr char kSortOpDocstring[] = R"doc(
+  Sort the rows by the values of the given columns.
+
+  Returns a DataFrame with the rows sorted by the first of the columns, with ties broken by the
+  following ones. Rows that are equal in all the columns keep their input order.
+
+  :topic: dataframe_ops
+  :opname: Sort
+
+  Examples:
+    df = px.DataFrame('http_events')
+    # Sort the http requests by latency, slowest first.
+    df = df.sort_values('latency', ascending=False)
+
+  Args:
+    by (Union[str, List[str]]): The column or columns to sort by.
+    ascending (Union[bool, List[bool]]): Whether to sort in ascending order, either for all the
+      columns or for each of them. If not set, default is True.
+
+  Returns:
+    px.DataFrame: DataFrame with the sorted rows.
+  )doc";
+
+  inline static constexpr char kTopKOpID[] = "top_k";
+  inline static constexpr char kTopKOpDocstring[] = R"doc(
+  Return the first k rows in the sort order of the given columns.
+
+  Equivalent to `df.sort_values(by, ascending).head(k)`, but only keeps k rows in memory.
+  When the data comes from several nodes, each of them sends only its own top k rows.
+
+  :topic: dataframe_ops
+  :opname: TopK
+
+  Examples:
+    df = px.DataFrame('http_events')
+    # Keep the 10 slowest http requests.
+    df = df.top_k('latency', k=10)
+
+  Args:
+    by (Union[str, List[str]]): The column or columns to sort by.
+    k (int): The number of rows to return. If not set, default is 5.
+    ascending (Union[bool, List[bool]]): Whether to sort in ascending order, either for all the
+      columns or for each of them. If not set, default is False, which returns the k largest
+      rows.
+
+  Returns:
+    px.DataFrame: DataFrame with the first k sorted rows.
+  )doc";
+
   inline static constexpr char kMergeOpID[] = "merge";
   inline static constexpr char kMergeOpDocstring[] = R"doc(
   Merges the input DataFrame with this one using a database-style join.
@@ -234,6 +234,43 @@ TEST_F(DataframeTest, LimitNonIntArgument) {
               HasCompilerError("Expected arg 'n' as type 'Int', received 'String'"));
 }
 
+TEST_F(DataframeTest, CreateSort) {
+  ASSERT_OK(ParseScript(var_table, "sorted = df.sort_values(['service', 'latency'])"));
+  auto var = var_table->Lookup("sorted");
+  ASSERT_EQ(var->type_descriptor().type(), QLObjectType::kDataframe);
+  auto sort_obj = std::static_pointer_cast<Dataframe>(var);
+
+  ASSERT_MATCH(sort_obj->op(), TopK());
+  TopKIR* topk = static_cast<TopKIR*>(sort_obj->op());
+  EXPECT_THAT(topk->sort_cols(), ElementsAre("service", "latency"));
+  EXPECT_THAT(topk->ascending(), ElementsAre(true, true));
+  EXPECT_EQ(topk->k(), 0);
+}
+
+TEST_F(DataframeTest, CreateTopK) {
+  ASSERT_OK(ParseScript(var_table, "top = df.top_k(['service', 'latency'], k=10, "
+                                   "ascending=[True, False])"));
+  auto var = var_table->Lookup("top");
+  ASSERT_EQ(var->type_descriptor().type(), QLObjectType::kDataframe);
+  auto topk_obj = std::static_pointer_cast<Dataframe>(var);
+
+  ASSERT_MATCH(topk_obj->op(), TopK());
+  TopKIR* topk = static_cast<TopKIR*>(topk_obj->op());
+  EXPECT_THAT(topk->sort_cols(), ElementsAre("service", "latency"));
+  EXPECT_THAT(topk->ascending(), ElementsAre(true, false));
+  EXPECT_EQ(topk->k(), 10);
+}
+
+TEST_F(DataframeTest, TopKMismatchedSortOrders) {
+  EXPECT_THAT(ParseScript(var_table, "df.top_k(['service', 'latency'], ascending=[True])"),
+              HasCompilerError("Expected 2 values for 'ascending', received 1"));
+}
+
+TEST_F(DataframeTest, TopKNonPositiveK) {
+  EXPECT_THAT(ParseScript(var_table, "df.top_k('latency', k=0)"),
+              HasCompilerError("'k' must be positive, received 0"));
+}
+
 TEST_F(DataframeTest, SubscriptFilterRows) {
   ASSERT_OK(ParseScript(var_table, "filter = df[df.service == 'blah']"));
   auto var = var_table->Lookup("filter");
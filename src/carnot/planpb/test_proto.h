@@ -335,6 +335,26 @@ columns {
   index: 2
 }
 )";
+constexpr char kTopKOperator1[] = R"(
+k: 5
+sort_columns {
+  index: 1
+  ascending: false
+}
+sort_columns {
+  index: 0
+  ascending: true
+}
+columns {
+  node: 1
+  index: 0
+}
+columns {
+  node: 1
+  index: 2
+}
+)";
+
 // relation 1: [abc, time_]
 // relation 2: [time_, abc]
 // maps to output relation:
@@ -1478,6 +1498,13 @@ planpb::Operator CreateTestDropLimit1PB() {
   return op;
 }
 
+planpb::Operator CreateTestTopK1PB() {
+  planpb::Operator op;
+  auto op_proto = absl::Substitute(kOperatorProtoTmpl, "TOPK_OPERATOR", "topk_op", kTopKOperator1);
+  CHECK(google::protobuf::TextFormat::MergeFromString(op_proto, &op)) << "Failed to parse proto";
+  return op;
+}
+
 planpb::Operator CreateTestJoinWithTimePB() {
   planpb::Operator op;
   auto op_proto = absl::Substitute(kOperatorProtoTmpl, "JOIN_OPERATOR", "join_op", kJoinOperator1);
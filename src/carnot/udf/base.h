@@ -19,6 +19,10 @@
 #pragma once
 
 #include <memory>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/exec/ml/model_pool.h"
@@ -41,9 +45,43 @@ class FunctionContext {
   const px::md::AgentMetadataState* metadata_state() const { return metadata_state_.get(); }
   exec::ml::ModelPool* model_pool() { return model_pool_; }
 
+  /**
+   * The number of the input batch being evaluated, which the expression evaluators increment for
+   * every batch. Together with exec_arg_column(), it identifies the column an argument comes from.
+   */
+  int64_t batch_idx() const { return batch_idx_; }
+  void StartBatch() { ++batch_idx_; }
+
+  /**
+   * The index of the input column passed as argument arg_idx of the ExecBatch call in progress, or
+   * -1 if the argument is not an input column (e.g. a constant or the result of another function).
+   */
+  int64_t exec_arg_column(size_t arg_idx) const {
+    return arg_idx < exec_arg_columns_.size() ? exec_arg_columns_[arg_idx] : -1;
+  }
+  void set_exec_arg_columns(std::vector<int64_t> columns) {
+    exec_arg_columns_ = std::move(columns);
+  }
+
+  /**
+   * Returns the state of type TState shared by all the UDF calls that use this context, and
+   * creates it on first use. UDFs use it to share work between calls on the same input column.
+   */
+  template <typename TState>
+  TState* GetOrCreateSharedState() {
+    auto& state = shared_states_[std::type_index(typeid(TState))];
+    if (state == nullptr) {
+      state = std::make_shared<TState>();
+    }
+    return static_cast<TState*>(state.get());
+  }
+
  private:
   std::shared_ptr<const px::md::AgentMetadataState> metadata_state_;
   exec::ml::ModelPool* model_pool_;
+  int64_t batch_idx_ = 0;
+  std::vector<int64_t> exec_arg_columns_;
+  std::unordered_map<std::type_index, std::shared_ptr<void>> shared_states_;
 };
 
 /**
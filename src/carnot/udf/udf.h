@@ -74,6 +74,12 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * UDFs for which per-record calls are expensive (e.g. model inference) can _optionally_ implement:
+ *      Status ExecBatch(FunctionContext *ctx, size_t count, UDFValue* out,
+ *                       const UDFValue*... values) {}
+ *  If present, it is called once per record batch instead of Exec, with arrays of count values.
+ *  Exec must still be implemented with the same types, since it defines the UDF's signature.
  */
 class ScalarUDF : public AnyUDF {
  public:
@@ -143,6 +149,13 @@ static constexpr bool IsValidExecFunc(ReturnType (TUDF::*)(FunctionContext*, Typ
   return true;
 }
 
+// SFINAE test for ExecBatch fn.
+template <typename T, typename = void>
+struct has_udf_exec_batch_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_exec_batch_fn<T, std::void_t<decltype(&T::ExecBatch)>> : std::true_type {};
+
 /**
  * Checks to see if a valid looking Executor function exists.
  */
@@ -223,6 +236,12 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasInit() { return has_udf_init_fn<T>::value; }
 
+  /**
+   * Checks if the UDF has an ExecBatch function, which replaces the per-record Exec calls.
+   * @return true if it has an ExecBatch function.
+   */
+  static constexpr bool HasExecBatch() { return has_udf_exec_batch_fn<T>::value; }
+
   /**
    * Returns the executor type of this UDF.
    */
@@ -51,6 +51,23 @@ class AddUDF : public ScalarUDF {
   }
 };
 
+// Records the number of ExecBatch calls in the output, to check that Exec is not used.
+class BatchSubStrUDF : public ScalarUDF {
+ public:
+  types::StringValue Exec(FunctionContext*, types::StringValue) { return "exec"; }
+  Status ExecBatch(FunctionContext*, size_t count, types::StringValue* out,
+                   const types::StringValue* strs) {
+    ++num_batches_;
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = absl::StrCat(strs[i].substr(1, 2), num_batches_);
+    }
+    return Status::OK();
+  }
+
+ private:
+  int num_batches_ = 0;
+};
+
 class InitArgUDF : public ScalarUDF {
  public:
   Status Init(FunctionContext*, types::StringValue str, types::Int64Value i) {
@@ -136,6 +153,30 @@ TEST(UDFDefinition, arrow_write) {
   EXPECT_EQ(6, resArr->Value(1));
 }
 
+TEST(UDFDefinition, exec_batch) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("batch_substr");
+  EXPECT_OK(def.Init<BatchSubStrUDF>());
+  EXPECT_THAT(def.exec_arguments(), ElementsAre(types::STRING));
+
+  types::StringValueColumnWrapper v1({"abcd", "defg", "hello"});
+  types::StringValueColumnWrapper out(v1.Size());
+  auto u = def.Make();
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1}, &out, v1.Size()));
+  EXPECT_EQ("bc1", out[0]);
+  EXPECT_EQ("ef1", out[1]);
+  EXPECT_EQ("el1", out[2]);
+
+  auto v1a = ToArrow(std::vector<types::StringValue>{"abcd", "defg"}, arrow::default_memory_pool());
+  auto output_builder = std::make_shared<arrow::StringBuilder>();
+  EXPECT_OK(def.ExecBatchArrow(u.get(), &ctx, {v1a.get()}, output_builder.get(), 2));
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_TRUE(output_builder->Finish(&res).ok());
+  auto* res_arr = static_cast<arrow::StringArray*>(res.get());
+  EXPECT_EQ("bc2", res_arr->GetString(0));
+  EXPECT_EQ("ef2", res_arr->GetString(1));
+}
+
 TEST(UDFDefinition, init_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("initargudf");
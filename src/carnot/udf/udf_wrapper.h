@@ -62,10 +62,14 @@ Status ExecWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
                    const std::vector<const types::BaseValueType*>& args,
                    std::index_sequence<I...>) {
   [[maybe_unused]] constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
-  for (size_t idx = 0; idx < count; ++idx) {
-    out[idx] = udf->Exec(ctx, CastToUDFValueType<exec_argument_types[I]>(args[I])[idx]...);
+  if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+    return udf->ExecBatch(ctx, count, out, CastToUDFValueType<exec_argument_types[I]>(args[I])...);
+  } else {
+    for (size_t idx = 0; idx < count; ++idx) {
+      out[idx] = udf->Exec(ctx, CastToUDFValueType<exec_argument_types[I]>(args[I])[idx]...);
+    }
+    return Status::OK();
   }
-  return Status::OK();
 }
 
 template <typename TUDF, std::size_t... I>
@@ -95,6 +99,19 @@ inline auto UnWrap<types::StringValue>(const types::StringValue& s) {
   return s;
 }
 
+/**
+ * Copies the values of an arrow array into UDF values, for UDFs that execute on whole batches.
+ */
+template <types::DataType TExecArgType>
+auto ArrowArrayToUDFValues(arrow::Array* arr, size_t count) {
+  std::vector<typename types::DataTypeTraits<TExecArgType>::value_type> values;
+  values.reserve(count);
+  for (size_t idx = 0; idx < count; ++idx) {
+    values.emplace_back(types::GetValueFromArrowArray<TExecArgType>(arr, idx));
+  }
+  return values;
+}
+
 /**
  * This is the inner wrapper for the arrow type.
  * This performs type casting and storing the data in the output builder.
@@ -113,9 +130,25 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
     CHECK(out->ReserveData(reserved).ok());
   }
+
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  [[maybe_unused]] std::vector<typename types::DataTypeTraits<return_type>::value_type> results;
+  if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+    results.resize(count);
+    PL_RETURN_IF_ERROR(udf->ExecBatch(
+        ctx, count, results.data(),
+        ArrowArrayToUDFValues<exec_argument_types[I]>(args[I], count).data()...));
+  }
+
   for (size_t idx = 0; idx < count; ++idx) {
-    auto res = UnWrap(
-        udf->Exec(ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...));
+    auto res = [&]() {
+      if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+        return UnWrap(results[idx]);
+      } else {
+        return UnWrap(udf->Exec(
+            ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...));
+      }
+    }();
 
     // We use doubling to make sure we minimize the number of allocations.
     // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
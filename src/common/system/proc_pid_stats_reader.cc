@@ -0,0 +1,282 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/system/proc_pid_stats_reader.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/str_split.h>
+
+#include "src/common/system/proc_pid_path.h"
+
+namespace px {
+namespace system {
+
+namespace {
+
+// The stat and io files of a process.
+constexpr size_t kFDsPerPID = 2;
+
+// The share of the limit on open files that the reader may use.
+constexpr uint64_t kFDLimitDivisor = 4;
+
+// The stat and io files are a few hundred bytes long.
+constexpr size_t kReadBufSize = 4096;
+
+// The indexes of the fields of /proc/<pid>/stat, counting from 0. See proc(5).
+constexpr int kStatStateField = 2;
+constexpr int kStatMinorFaultsField = 9;
+constexpr int kStatMajorFaultsField = 11;
+constexpr int kStatUTimeField = 13;
+constexpr int kStatKTimeField = 14;
+constexpr int kStatNumThreadsField = 19;
+constexpr int kStatVSizeField = 22;
+constexpr int kStatRSSField = 23;
+
+int OpenFile(int32_t pid, const char* name) {
+  return open(ProcPidPath(pid, name).c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+// Reads the whole file from its start into buf, and returns its contents.
+StatusOr<std::string_view> ReadFile(int fd, char* buf, size_t buf_size) {
+  ssize_t n = pread(fd, buf, buf_size, 0);
+  if (n < 0) {
+    return error::Internal("pread() failed: $0.", std::strerror(errno));
+  }
+  if (static_cast<size_t>(n) == buf_size) {
+    return error::Internal("File is larger than $0 bytes.", buf_size);
+  }
+  return std::string_view(buf, n);
+}
+
+template <typename TIntType>
+bool ParseInt(std::string_view str, TIntType* val) {
+  const char* end = str.data() + str.size();
+  auto [ptr, ec] = std::from_chars(str.data(), end, *val);
+  return ec == std::errc() && ptr == end;
+}
+
+}  // namespace
+
+ProcPIDStatsReader::ProcPIDStatsReader(int64_t page_size_bytes, int64_t kernel_tick_time_ns,
+                                       size_t max_open_pids)
+    : page_size_bytes_(page_size_bytes),
+      kernel_tick_time_ns_(kernel_tick_time_ns),
+      max_open_pids_(max_open_pids) {}
+
+ProcPIDStatsReader::~ProcPIDStatsReader() {
+  for (const auto& [pid, files] : files_) {
+    CloseFiles(files);
+  }
+}
+
+Status ProcPIDStatsReader::ReadStats(int32_t pid, ProcParser::ProcessStats* out) {
+  DCHECK(out != nullptr);
+
+  auto iter = files_.find(pid);
+  if (iter != files_.end()) {
+    iter->second.read = true;
+    if (ReadFiles(pid, iter->second, out).ok()) {
+      return Status::OK();
+    }
+    // The process has exited. If the PID was reused since then, the files of the new process
+    // have to be opened.
+    CloseFiles(iter->second);
+    files_.erase(iter);
+  }
+
+  PIDFiles files;
+  files.stat_fd = OpenFile(pid, "stat");
+  files.io_fd = OpenFile(pid, "io");
+  files.read = true;
+
+  Status s = ReadFiles(pid, files, out);
+  if (!s.ok() || files_.size() >= max_open_pids_) {
+    CloseFiles(files);
+    return s;
+  }
+  files_.emplace(pid, files);
+  return Status::OK();
+}
+
+size_t ProcPIDStatsReader::CapMaxOpenPIDs(size_t max_open_pids,
+                                          std::optional<uint64_t> fd_limit) {
+  if (!fd_limit.has_value()) {
+    struct rlimit rlim;
+    if (getrlimit(RLIMIT_NOFILE, &rlim) != 0) {
+      LOG(WARNING) << absl::Substitute("getrlimit(RLIMIT_NOFILE) failed: $0.",
+                                       std::strerror(errno));
+      return max_open_pids;
+    }
+    if (rlim.rlim_cur == RLIM_INFINITY) {
+      return max_open_pids;
+    }
+    fd_limit = rlim.rlim_cur;
+  }
+  return std::min<uint64_t>(max_open_pids, fd_limit.value() / kFDLimitDivisor / kFDsPerPID);
+}
+
+void ProcPIDStatsReader::CloseUnreadFiles() {
+  for (auto iter = files_.begin(); iter != files_.end();) {
+    if (!iter->second.read) {
+      CloseFiles(iter->second);
+      files_.erase(iter++);
+      continue;
+    }
+    iter->second.read = false;
+    ++iter;
+  }
+}
+
+Status ProcPIDStatsReader::ReadFiles(int32_t pid, const PIDFiles& files,
+                                     ProcParser::ProcessStats* out) {
+  if (files.stat_fd < 0) {
+    return error::Internal("Failed to open file: $0.", ProcPidPath(pid, "stat").string());
+  }
+  if (files.io_fd < 0) {
+    return error::Internal("Failed to open file: $0.", ProcPidPath(pid, "io").string());
+  }
+
+  char buf[kReadBufSize];
+  PL_ASSIGN_OR_RETURN(std::string_view stat_contents, ReadFile(files.stat_fd, buf, sizeof(buf)));
+  PL_RETURN_IF_ERROR(ParseStat(stat_contents, page_size_bytes_, kernel_tick_time_ns_, out));
+  PL_ASSIGN_OR_RETURN(std::string_view io_contents, ReadFile(files.io_fd, buf, sizeof(buf)));
+  return ParseStatIO(io_contents, out);
+}
+
+void ProcPIDStatsReader::CloseFiles(const PIDFiles& files) {
+  if (files.stat_fd >= 0) {
+    close(files.stat_fd);
+  }
+  if (files.io_fd >= 0) {
+    close(files.io_fd);
+  }
+}
+
+Status ProcPIDStatsReader::ParseStat(std::string_view contents, int64_t page_size_bytes,
+                                     int64_t kernel_tick_time_ns, ProcParser::ProcessStats* out) {
+  // See ProcParser::ParseProcPIDStat() for a sample file.
+  // The command name is surrounded by (), and may itself contain spaces and parentheses.
+  size_t open_paren_idx = contents.find('(');
+  size_t close_paren_idx = contents.rfind(')');
+  if (open_paren_idx == std::string_view::npos || close_paren_idx == std::string_view::npos ||
+      close_paren_idx < open_paren_idx) {
+    return error::Internal("Invalid command name in stat file.");
+  }
+
+  bool ok = ParseInt(absl::StripAsciiWhitespace(contents.substr(0, open_paren_idx)), &out->pid);
+  out->process_name.assign(
+      contents.substr(open_paren_idx + 1, close_paren_idx - open_paren_idx - 1));
+
+  // Scan the space separated fields that follow the command name, up to the last one needed.
+  std::string_view fields = contents.substr(close_paren_idx + 1);
+  int field_idx = kStatStateField;
+  size_t pos = 0;
+  while (ok && field_idx <= kStatRSSField) {
+    pos = fields.find_first_not_of(" \n", pos);
+    if (pos == std::string_view::npos) {
+      break;
+    }
+    size_t end = std::min(fields.find_first_of(" \n", pos), fields.size());
+    std::string_view field = fields.substr(pos, end - pos);
+    pos = end;
+
+    switch (field_idx) {
+      case kStatMinorFaultsField:
+        ok = ParseInt(field, &out->minor_faults);
+        break;
+      case kStatMajorFaultsField:
+        ok = ParseInt(field, &out->major_faults);
+        break;
+      case kStatUTimeField:
+        ok = ParseInt(field, &out->utime_ns);
+        break;
+      case kStatKTimeField:
+        ok = ParseInt(field, &out->ktime_ns);
+        break;
+      case kStatNumThreadsField:
+        ok = ParseInt(field, &out->num_threads);
+        break;
+      case kStatVSizeField:
+        ok = ParseInt(field, &out->vsize_bytes);
+        break;
+      case kStatRSSField:
+        ok = ParseInt(field, &out->rss_bytes);
+        break;
+      default:
+        break;
+    }
+    ++field_idx;
+  }
+
+  if (!ok) {
+    return error::Internal("Failed to parse stat file. ATOI failed.");
+  }
+  if (field_idx <= kStatRSSField) {
+    return error::Internal("Incorrect number of fields in stat file.");
+  }
+
+  // The kernel tracks utime and ktime in kernel ticks.
+  out->utime_ns *= kernel_tick_time_ns;
+  out->ktime_ns *= kernel_tick_time_ns;
+  // RSS is in pages.
+  out->rss_bytes *= page_size_bytes;
+  return Status::OK();
+}
+
+Status ProcPIDStatsReader::ParseStatIO(std::string_view contents, ProcParser::ProcessStats* out) {
+  // See ProcParser::ParseProcPIDStatIO() for a sample file. Like there, missing fields are left
+  // untouched.
+  for (std::string_view line : absl::StrSplit(contents, '\n')) {
+    size_t colon_idx = line.find(':');
+    if (colon_idx == std::string_view::npos) {
+      continue;
+    }
+    std::string_view key = line.substr(0, colon_idx);
+
+    int64_t* val = nullptr;
+    if (key == "rchar") {
+      val = &out->rchar_bytes;
+    } else if (key == "wchar") {
+      val = &out->wchar_bytes;
+    } else if (key == "read_bytes") {
+      val = &out->read_bytes;
+    } else if (key == "write_bytes") {
+      val = &out->write_bytes;
+    } else {
+      continue;
+    }
+
+    if (!ParseInt(absl::StripAsciiWhitespace(line.substr(colon_idx + 1)), val)) {
+      return error::Internal("Failed to parse io file. ATOI failed.");
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace system
+}  // namespace px
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/common/system/proc_parser.h"
+
+namespace px {
+namespace system {
+
+/**
+ * ProcPIDStatsReader reads the /proc/<pid>/stat and /proc/<pid>/io files of processes that are
+ * sampled repeatedly, as an alternative to ProcParser::ParseProcPIDStat() and
+ * ProcParser::ParseProcPIDStatIO().
+ *
+ * The files of a process are kept open between samples and re-read with pread(), which saves the
+ * open() and close() syscalls of every sample. The contents are parsed in place, without
+ * splitting them into strings.
+ *
+ * The files of a process that has exited fail to read, and are then closed. Not thread-safe, but
+ * separate instances can be used concurrently for disjoint sets of processes.
+ */
+class ProcPIDStatsReader : public NotCopyable {
+ public:
+  /**
+   * @param max_open_pids The maximum number of processes whose files are kept open. The files of
+   * any other process are opened and closed on every read.
+   */
+  ProcPIDStatsReader(int64_t page_size_bytes, int64_t kernel_tick_time_ns, size_t max_open_pids);
+  ~ProcPIDStatsReader();
+
+  /**
+   * Reads the stats of a process from /proc/<pid>/stat and /proc/<pid>/io.
+   */
+  Status ReadStats(int32_t pid, ProcParser::ProcessStats* out);
+
+  /**
+   * Closes the files of the processes that were not read since the previous call, which
+   * presumably have exited.
+   */
+  void CloseUnreadFiles();
+
+  size_t num_open_pids() const { return files_.size(); }
+
+  /**
+   * Lowers max_open_pids so that the files kept open take at most a quarter of the file
+   * descriptors allowed by fd_limit, since the rest of the process needs descriptors too.
+   * @param fd_limit The limit on open files. Uses the RLIMIT_NOFILE soft limit if not given.
+   */
+  static size_t CapMaxOpenPIDs(size_t max_open_pids, std::optional<uint64_t> fd_limit = {});
+
+  /**
+   * Parses the contents of a /proc/<pid>/stat file.
+   */
+  static Status ParseStat(std::string_view contents, int64_t page_size_bytes,
+                          int64_t kernel_tick_time_ns, ProcParser::ProcessStats* out);
+
+  /**
+   * Parses the contents of a /proc/<pid>/io file.
+   */
+  static Status ParseStatIO(std::string_view contents, ProcParser::ProcessStats* out);
+
+ private:
+  struct PIDFiles {
+    int stat_fd = -1;
+    int io_fd = -1;
+    // Whether the files were read since the last call to CloseUnreadFiles().
+    bool read = false;
+  };
+
+  Status ReadFiles(int32_t pid, const PIDFiles& files, ProcParser::ProcessStats* out);
+  static void CloseFiles(const PIDFiles& files);
+
+  const int64_t page_size_bytes_;
+  const int64_t kernel_tick_time_ns_;
+  const size_t max_open_pids_;
+
+  absl::flat_hash_map<int32_t, PIDFiles> files_;
+};
+
+}  // namespace system
+}  // namespace px
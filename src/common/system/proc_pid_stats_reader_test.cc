@@ -0,0 +1,140 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/common/system/proc_pid_stats_reader.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <string>
+
+#include "src/common/system/proc_pid_path.h"
+#include "src/common/testing/test_environment.h"
+#include "src/common/testing/testing.h"
+
+DECLARE_string(proc_path);
+
+namespace px {
+namespace system {
+
+constexpr int64_t kBytesPerPage = 4096;
+constexpr int64_t kKernelTickTimeNS = 100;
+
+void ExpectSameStats(const ProcParser::ProcessStats& expected,
+                     const ProcParser::ProcessStats& actual) {
+  EXPECT_EQ(expected.pid, actual.pid);
+  EXPECT_EQ(expected.process_name, actual.process_name);
+  EXPECT_EQ(expected.minor_faults, actual.minor_faults);
+  EXPECT_EQ(expected.major_faults, actual.major_faults);
+  EXPECT_EQ(expected.utime_ns, actual.utime_ns);
+  EXPECT_EQ(expected.ktime_ns, actual.ktime_ns);
+  EXPECT_EQ(expected.num_threads, actual.num_threads);
+  EXPECT_EQ(expected.vsize_bytes, actual.vsize_bytes);
+  EXPECT_EQ(expected.rss_bytes, actual.rss_bytes);
+  EXPECT_EQ(expected.rchar_bytes, actual.rchar_bytes);
+  EXPECT_EQ(expected.wchar_bytes, actual.wchar_bytes);
+  EXPECT_EQ(expected.read_bytes, actual.read_bytes);
+  EXPECT_EQ(expected.write_bytes, actual.write_bytes);
+}
+
+// Tests that the results are the same as those of ProcParser.
+TEST(ProcPIDStatsReaderTest, MatchesProcParser) {
+  PL_SET_FOR_SCOPE(FLAGS_proc_path,
+                   testing::BazelRunfilePath("src/common/system/testdata/proc").string());
+  ProcParser parser;
+  ProcParser::ProcessStats expected;
+  ASSERT_OK(parser.ParseProcPIDStat(123, kBytesPerPage, kKernelTickTimeNS, &expected));
+  ASSERT_OK(parser.ParseProcPIDStatIO(123, &expected));
+
+  ProcPIDStatsReader reader(kBytesPerPage, kKernelTickTimeNS, /*max_open_pids*/ 10);
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(reader.ReadStats(123, &stats));
+  ExpectSameStats(expected, stats);
+  EXPECT_EQ(stats.process_name, "npm (start)");
+
+  // Reading again re-reads the open files.
+  ProcParser::ProcessStats stats2;
+  ASSERT_OK(reader.ReadStats(123, &stats2));
+  ExpectSameStats(expected, stats2);
+  EXPECT_EQ(reader.num_open_pids(), 1);
+
+  // There is no io file for this process.
+  EXPECT_NOT_OK(parser.ParseProcPIDStatIO(456, &expected));
+  EXPECT_NOT_OK(reader.ReadStats(456, &stats));
+  EXPECT_EQ(reader.num_open_pids(), 1);
+}
+
+TEST(ProcPIDStatsReaderTest, MatchesProcParserOnLiveProcess) {
+  const int32_t pid = getpid();
+
+  ProcPIDStatsReader reader(kBytesPerPage, kKernelTickTimeNS, /*max_open_pids*/ 10);
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(reader.ReadStats(pid, &stats));
+
+  ProcParser parser;
+  ProcParser::ProcessStats expected;
+  ASSERT_OK(parser.ParseProcPIDStat(pid, kBytesPerPage, kKernelTickTimeNS, &expected));
+
+  // Only compare the fields that do not change between the two reads.
+  EXPECT_EQ(stats.pid, pid);
+  EXPECT_EQ(stats.process_name, expected.process_name);
+  EXPECT_EQ(stats.num_threads, expected.num_threads);
+}
+
+TEST(ProcPIDStatsReaderTest, ClosesUnreadFiles) {
+  PL_SET_FOR_SCOPE(FLAGS_proc_path,
+                   testing::BazelRunfilePath("src/common/system/testdata/proc").string());
+  ProcPIDStatsReader reader(kBytesPerPage, kKernelTickTimeNS, /*max_open_pids*/ 10);
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(reader.ReadStats(123, &stats));
+
+  reader.CloseUnreadFiles();
+  EXPECT_EQ(reader.num_open_pids(), 1);
+  reader.CloseUnreadFiles();
+  EXPECT_EQ(reader.num_open_pids(), 0);
+}
+
+TEST(ProcPIDStatsReaderTest, MaxOpenPIDs) {
+  PL_SET_FOR_SCOPE(FLAGS_proc_path,
+                   testing::BazelRunfilePath("src/common/system/testdata/proc").string());
+  ProcPIDStatsReader reader(kBytesPerPage, kKernelTickTimeNS, /*max_open_pids*/ 0);
+  ProcParser::ProcessStats stats;
+  ASSERT_OK(reader.ReadStats(123, &stats));
+  EXPECT_EQ(stats.rchar_bytes, 5405203);
+  EXPECT_EQ(reader.num_open_pids(), 0);
+}
+
+TEST(ProcPIDStatsReaderTest, CapMaxOpenPIDs) {
+  EXPECT_EQ(ProcPIDStatsReader::CapMaxOpenPIDs(4096, /*fd_limit*/ 1024), 128);
+  EXPECT_EQ(ProcPIDStatsReader::CapMaxOpenPIDs(4096, /*fd_limit*/ 1048576), 4096);
+  EXPECT_EQ(ProcPIDStatsReader::CapMaxOpenPIDs(4096, /*fd_limit*/ 0), 0);
+  EXPECT_LE(ProcPIDStatsReader::CapMaxOpenPIDs(4096), 4096);
+}
+
+TEST(ProcPIDStatsReaderTest, ParseStatRejectsTruncatedFile) {
+  ProcParser::ProcessStats stats;
+  EXPECT_NOT_OK(ProcPIDStatsReader::ParseStat("4602 (npm) S 3260 4602", kBytesPerPage,
+                                              kKernelTickTimeNS, &stats));
+  EXPECT_NOT_OK(ProcPIDStatsReader::ParseStat("4602 npm S 3260 4602", kBytesPerPage,
+                                              kKernelTickTimeNS, &stats));
+}
+
+}  // namespace system
+}  // namespace px
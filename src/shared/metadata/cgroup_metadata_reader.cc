@@ -17,12 +17,18 @@
  */
 
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/strings/str_split.h>
 
 #include "src/common/base/base.h"
 #include "src/common/base/file.h"
+#include "src/common/system/proc_pid_path.h"
 #include "src/shared/metadata/cgroup_metadata_reader.h"
 #include "src/shared/metadata/k8s_objects.h"
 
@@ -103,5 +109,41 @@ Status CGroupMetadataReader::ReadPIDs(PodQOSClass qos_class, std::string_view po
   return Status::OK();
 }
 
+StatusOr<std::string> CGroupMetadataReader::ContainerCGroupName(
+    PodQOSClass qos_class, std::string_view pod_id, std::string_view container_id,
+    ContainerType container_type) const {
+  PL_ASSIGN_OR_RETURN(std::string fpath, PodPath(qos_class, pod_id, container_id, container_type));
+  // The path is that of the cgroup.procs file in the cgroup directory of the container.
+  return std::filesystem::path(fpath).parent_path().filename().string();
+}
+
+Status CGroupMetadataReader::ReadCGroupNames(
+    uint32_t pid, absl::flat_hash_set<std::string>* cgroup_names) const {
+  CHECK(cgroup_names != nullptr);
+
+  const std::filesystem::path fpath = system::ProcPidPath(pid, "cgroup");
+  std::ifstream ifs(fpath);
+  if (!ifs) {
+    // The process has probably exited already.
+    return error::NotFound("Failed to open file $0", fpath.string());
+  }
+
+  // Each line is formatted as hierarchy-ID:controller-list:cgroup-path. The cgroup path itself may
+  // contain colons.
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::vector<std::string_view> fields = absl::StrSplit(line, absl::MaxSplits(':', 2));
+    if (fields.size() != 3) {
+      continue;
+    }
+    std::string_view cgroup_path = fields[2];
+    std::string_view cgroup_name = cgroup_path.substr(cgroup_path.find_last_of('/') + 1);
+    if (!cgroup_name.empty()) {
+      cgroup_names->emplace(cgroup_name);
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace md
 }  // namespace px
@@ -25,6 +25,8 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
+
 #include "src/common/base/base.h"
 #include "src/common/system/system.h"
 #include "src/shared/metadata/cgroup_path_resolver.h"
@@ -55,6 +57,22 @@ class CGroupMetadataReader : public NotCopyable {
                           std::string_view container_id, ContainerType container_type,
                           absl::flat_hash_set<uint32_t>* pid_set) const;
 
+  /**
+   * ContainerCGroupName returns the name of the cgroup of a container, which is the last component
+   * of its cgroup path. The name is unique to the container, and is also the last component of the
+   * paths listed in /proc/<pid>/cgroup by the processes of the container.
+   */
+  virtual StatusOr<std::string> ContainerCGroupName(PodQOSClass qos_class, std::string_view pod_id,
+                                                    std::string_view container_id,
+                                                    ContainerType container_type) const;
+
+  /**
+   * ReadCGroupNames reads the names of the cgroups that a process belongs to from
+   * /proc/<pid>/cgroup. Like ReadPIDs(), this races with the process exiting.
+   */
+  virtual Status ReadCGroupNames(uint32_t pid,
+                                 absl::flat_hash_set<std::string>* cgroup_names) const;
+
  private:
   StatusOr<std::string> PodPath(PodQOSClass qos_class, std::string_view pod_id,
                                 std::string_view container_id, ContainerType container_type) const;
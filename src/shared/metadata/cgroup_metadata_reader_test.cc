@@ -17,8 +17,11 @@
  */
 #include "src/shared/metadata/cgroup_metadata_reader.h"
 
+#include <string>
+
 #include <absl/container/flat_hash_set.h>
 
+#include "src/common/system/proc_pid_path.h"
 #include "src/common/testing/testing.h"
 
 namespace px {
@@ -43,5 +46,29 @@ TEST_F(CGroupMetadataReaderTest, read_pid_list) {
   EXPECT_THAT(pid_set, ::testing::UnorderedElementsAre(123, 456, 789));
 }
 
+TEST_F(CGroupMetadataReaderTest, container_cgroup_name) {
+  ASSERT_OK_AND_EQ(md_reader_->ContainerCGroupName(PodQOSClass::kBestEffort, "abcd", "c123",
+                                                   ContainerType::kDocker),
+                   "c123");
+}
+
+TEST_F(CGroupMetadataReaderTest, read_cgroup_names) {
+  const auto proc_path = testing::BazelRunfilePath("src/shared/metadata/testdata/proc");
+  PL_SET_FOR_SCOPE(FLAGS_proc_path, proc_path.string());
+
+  absl::flat_hash_set<std::string> cgroup_names;
+  ASSERT_OK(md_reader_->ReadCGroupNames(100, &cgroup_names));
+  EXPECT_THAT(cgroup_names, ::testing::UnorderedElementsAre("container_id1"));
+
+  // The cgroup path contains colons.
+  cgroup_names.clear();
+  ASSERT_OK(md_reader_->ReadCGroupNames(300, &cgroup_names));
+  EXPECT_THAT(cgroup_names,
+              ::testing::UnorderedElementsAre(
+                  "kubepods-burstable-podpod_id1.slice:cri-containerd:container_id2"));
+
+  EXPECT_NOT_OK(md_reader_->ReadCGroupNames(400, &cgroup_names));
+}
+
 }  // namespace md
 }  // namespace px
@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <absl/container/flat_hash_set.h>
 
@@ -78,6 +79,14 @@ const ContainerInfo* K8sMetadataState::ContainerInfoByID(CIDView id) const {
   return it->second.get();
 }
 
+ContainerInfo* K8sMetadataState::MutableContainerInfoByID(CIDView id) {
+  ContainerInfoSPtr* container_info = containers_by_id_.FindMutable(id);
+  if (container_info == nullptr) {
+    return nullptr;
+  }
+  return internal::MutableObject(container_info);
+}
+
 UID K8sMetadataState::PodIDByName(K8sNameIdentView pod_name) const {
   auto it = pods_by_name_.find(pod_name);
   return (it == pods_by_name_.end()) ? "" : it->second;
@@ -124,16 +133,8 @@ std::unique_ptr<K8sMetadataState> K8sMetadataState::Clone() const {
   other->pod_cidrs_ = pod_cidrs_;
   other->service_cidr_ = service_cidr_;
 
-  other->k8s_objects_by_id_.reserve(k8s_objects_by_id_.size());
-  for (const auto& [k, v] : k8s_objects_by_id_) {
-    other->k8s_objects_by_id_[k] = v->Clone();
-  }
-
-  other->containers_by_id_.reserve(containers_by_id_.size());
-  for (const auto& [k, v] : containers_by_id_) {
-    other->containers_by_id_[k] = v->Clone();
-  }
-
+  other->k8s_objects_by_id_ = k8s_objects_by_id_;
+  other->containers_by_id_ = containers_by_id_;
   other->pods_by_name_ = pods_by_name_;
   other->services_by_name_ = services_by_name_;
   other->namespaces_by_name_ = namespaces_by_name_;
@@ -201,13 +202,13 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(object_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  K8sMetadataObjectSPtr* obj = k8s_objects_by_id_.FindMutable(object_uid);
+  if (obj == nullptr) {
     auto pod = std::make_unique<PodInfo>(update);
     VLOG(1) << "Adding Pod: " << pod->DebugString();
-    it = k8s_objects_by_id_.try_emplace(object_uid, std::move(pod)).first;
+    obj = k8s_objects_by_id_.try_emplace(object_uid, std::move(pod)).first;
   }
-  auto pod_info = static_cast<PodInfo*>(it->second.get());
+  auto pod_info = static_cast<PodInfo*>(internal::MutableObject(obj));
 
   // We always just add to the container set even if the container is stopped.
   // We expect all cleanup to happen periodically to allow stale objects to be queried for some
@@ -216,7 +217,8 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   // state might be periodically inconsistent.
 
   for (const auto& cid : update.container_ids()) {
-    if (containers_by_id_.find(cid) == containers_by_id_.end()) {
+    const ContainerInfo* container_info = ContainerInfoByID(cid);
+    if (container_info == nullptr) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
@@ -225,7 +227,10 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
     }
 
     pod_info->AddContainer(cid);
-    containers_by_id_[cid]->set_pod_id(object_uid);
+    // Avoid copying containers that are already assigned to this pod.
+    if (container_info->pod_id() != object_uid) {
+      MutableContainerInfoByID(cid)->set_pod_id(object_uid);
+    }
   }
 
   for (const auto& owner_ref : update.owner_references()) {
@@ -243,10 +248,10 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
   pod_info->set_phase_reason(update.reason());
   pod_info->set_pod_labels(update.labels());
 
-  pods_by_name_[{ns, name}] = object_uid;
+  pods_by_name_.Set({ns, name}, object_uid);
   // Filter out daemonsets which don't have their own, unique podIP.
   if (update.host_ip() != update.pod_ip() && update.pod_ip() != "") {
-    pods_by_ip_[update.pod_ip()] = object_uid;
+    pods_by_ip_.Set(update.pod_ip(), object_uid);
   }
 
   return Status::OK();
@@ -255,21 +260,21 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
 Status K8sMetadataState::HandleContainerUpdate(const ContainerUpdate& update) {
   const CID& cid = update.cid();
 
-  auto it = containers_by_id_.find(cid);
-  if (it == containers_by_id_.end()) {
-    auto container = std::make_unique<ContainerInfo>(update);
-    VLOG(1) << "Adding Container: " << container->DebugString();
-    it = containers_by_id_.try_emplace(cid, std::move(container)).first;
+  ContainerInfoSPtr* container = containers_by_id_.FindMutable(cid);
+  if (container == nullptr) {
+    auto new_container = std::make_unique<ContainerInfo>(update);
+    VLOG(1) << "Adding Container: " << new_container->DebugString();
+    container = containers_by_id_.try_emplace(cid, std::move(new_container)).first;
   }
   VLOG(1) << "container update: " << update.name();
 
-  auto* container_info = it->second.get();
+  auto* container_info = internal::MutableObject(container);
   container_info->set_stop_time_ns(update.stop_timestamp_ns());
   container_info->set_state(ConvertToContainerState(update.container_state()));
   container_info->set_state_message(update.message());
   container_info->set_state_reason(update.reason());
 
-  containers_by_name_[update.name()] = cid;
+  containers_by_name_.Set(update.name(), cid);
 
   return Status::OK();
 }
@@ -279,27 +284,34 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(service_uid);
-  if (it == k8s_objects_by_id_.end()) {
-    auto service = std::make_unique<ServiceInfo>(service_uid, ns, name);
-    VLOG(1) << "Adding Service: " << service->DebugString();
-    it = k8s_objects_by_id_.try_emplace(service_uid, std::move(service)).first;
-  }
-  auto service_info = static_cast<ServiceInfo*>(it->second.get());
-
   for (const auto& uid : update.pod_ids()) {
-    if (k8s_objects_by_id_.find(uid) == k8s_objects_by_id_.end()) {
+    auto pod_it = k8s_objects_by_id_.find(uid);
+    if (pod_it == k8s_objects_by_id_.end()) {
       // We should be resilient to the case where we happened to miss a pod update
       // in the stream of events. If we did miss a pod update, just skip adding the
       // pod to this particular service to avoid dangling references.
       LOG(INFO) << absl::Substitute("Didn't find pod UID $0 for service $1/$2", uid, ns, name);
       continue;
     }
-    ECHECK(k8s_objects_by_id_[uid]->type() == K8sObjectType::kPod);
+    ECHECK(pod_it->second->type() == K8sObjectType::kPod);
+    // Avoid copying pods that already reference this service.
+    if (static_cast<const PodInfo*>(pod_it->second.get())->services().contains(service_uid)) {
+      continue;
+    }
     // We add the service uid to the pod. Lifetime of service still handled by the service object.
-    PodInfo* pod_info = static_cast<PodInfo*>(k8s_objects_by_id_[uid].get());
+    auto* pod_info =
+        static_cast<PodInfo*>(internal::MutableObject(k8s_objects_by_id_.FindMutable(uid)));
     pod_info->AddService(service_uid);
   }
+
+  K8sMetadataObjectSPtr* obj = k8s_objects_by_id_.FindMutable(service_uid);
+  if (obj == nullptr) {
+    auto service = std::make_unique<ServiceInfo>(service_uid, ns, name);
+    VLOG(1) << "Adding Service: " << service->DebugString();
+    obj = k8s_objects_by_id_.try_emplace(service_uid, std::move(service)).first;
+  }
+  auto service_info = static_cast<ServiceInfo*>(internal::MutableObject(obj));
+
   if (update.start_timestamp_ns() != 0) {
     service_info->set_start_time_ns(update.start_timestamp_ns());
   }
@@ -307,7 +319,7 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
     service_info->set_stop_time_ns(update.stop_timestamp_ns());
   }
   if (update.cluster_ip() != "") {
-    services_by_cluster_ip_[update.cluster_ip()] = service_uid;
+    services_by_cluster_ip_.Set(update.cluster_ip(), service_uid);
     service_info->set_cluster_ip(update.cluster_ip());
   }
   if (update.external_ips().size()) {
@@ -317,7 +329,7 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
   }
 
   VLOG(1) << "service update: " << update.name();
-  services_by_name_[{ns, name}] = service_uid;
+  services_by_name_.Set({ns, name}, service_uid);
   return Status::OK();
 }
 
@@ -326,20 +338,20 @@ Status K8sMetadataState::HandleNamespaceUpdate(const NamespaceUpdate& update) {
   const std::string& name = update.name();
   const std::string& ns = update.name();
 
-  auto it = k8s_objects_by_id_.find(namespace_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  K8sMetadataObjectSPtr* obj = k8s_objects_by_id_.FindMutable(namespace_uid);
+  if (obj == nullptr) {
     auto ns_obj = std::make_unique<NamespaceInfo>(namespace_uid, ns, name);
     VLOG(1) << "Adding Namespace: " << ns_obj->DebugString();
-    it = k8s_objects_by_id_.try_emplace(namespace_uid, std::move(ns_obj)).first;
+    obj = k8s_objects_by_id_.try_emplace(namespace_uid, std::move(ns_obj)).first;
   }
-  auto ns_info = static_cast<NamespaceInfo*>(it->second.get());
+  auto ns_info = static_cast<NamespaceInfo*>(internal::MutableObject(obj));
 
   ns_info->set_start_time_ns(update.start_timestamp_ns());
   ns_info->set_stop_time_ns(update.stop_timestamp_ns());
 
   VLOG(1) << "namespace update: " << update.name();
 
-  namespaces_by_name_[{ns, name}] = namespace_uid;
+  namespaces_by_name_.Set({ns, name}, namespace_uid);
   return Status::OK();
 }
 
@@ -355,13 +367,13 @@ Status K8sMetadataState::HandleReplicaSetUpdate(const ReplicaSetUpdate& update)
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(replica_set_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  K8sMetadataObjectSPtr* obj = k8s_objects_by_id_.FindMutable(replica_set_uid);
+  if (obj == nullptr) {
     auto replica_set = std::make_unique<ReplicaSetInfo>(update);
     VLOG(1) << "Adding ReplicaSet: " << replica_set->DebugString();
-    it = k8s_objects_by_id_.try_emplace(replica_set_uid, std::move(replica_set)).first;
+    obj = k8s_objects_by_id_.try_emplace(replica_set_uid, std::move(replica_set)).first;
   }
-  auto replica_set_info = static_cast<ReplicaSetInfo*>(it->second.get());
+  auto replica_set_info = static_cast<ReplicaSetInfo*>(internal::MutableObject(obj));
 
   for (const auto& owner_ref : update.owner_references()) {
     replica_set_info->AddOwnerReference(owner_ref.uid(), owner_ref.name(), owner_ref.kind());
@@ -379,7 +391,7 @@ Status K8sMetadataState::HandleReplicaSetUpdate(const ReplicaSetUpdate& update)
 
   VLOG(1) << "replica set update: " << update.name();
 
-  replica_sets_by_name_[{ns, name}] = replica_set_uid;
+  replica_sets_by_name_.Set({ns, name}, replica_set_uid);
   return Status::OK();
 }
 
@@ -388,13 +400,13 @@ Status K8sMetadataState::HandleDeploymentUpdate(const DeploymentUpdate& update)
   const std::string& name = update.name();
   const std::string& ns = update.namespace_();
 
-  auto it = k8s_objects_by_id_.find(deployment_uid);
-  if (it == k8s_objects_by_id_.end()) {
+  K8sMetadataObjectSPtr* obj = k8s_objects_by_id_.FindMutable(deployment_uid);
+  if (obj == nullptr) {
     auto deployment = std::make_unique<DeploymentInfo>(update);
     VLOG(1) << "Adding Deployment: " << deployment->DebugString();
-    it = k8s_objects_by_id_.try_emplace(deployment_uid, std::move(deployment)).first;
+    obj = k8s_objects_by_id_.try_emplace(deployment_uid, std::move(deployment)).first;
   }
-  auto deployment_info = static_cast<DeploymentInfo*>(it->second.get());
+  auto deployment_info = static_cast<DeploymentInfo*>(internal::MutableObject(obj));
 
   deployment_info->set_start_time_ns(update.start_timestamp_ns());
   deployment_info->set_stop_time_ns(update.stop_timestamp_ns());
@@ -409,7 +421,7 @@ Status K8sMetadataState::HandleDeploymentUpdate(const DeploymentUpdate& update)
 
   VLOG(1) << "deployment update: " << update.name();
 
-  deployments_by_name_[{ns, name}] = deployment_uid;
+  deployments_by_name_.Set({ns, name}, deployment_uid);
   return Status::OK();
 }
 
@@ -427,14 +439,15 @@ bool IsExpired(const T& obj, int64_t retention_time, int64_t now) {
 Status K8sMetadataState::CleanupExpiredMetadata(int64_t retention_time_ns) {
   int64_t now = CurrentTimeNS();
 
-  for (auto iter = k8s_objects_by_id_.begin(); iter != k8s_objects_by_id_.end();) {
-    const auto& k8s_object = iter->second;
-
-    if (!IsExpired(*k8s_object, retention_time_ns, now)) {
-      ++iter;
-      continue;
+  // The maps cannot be modified while iterating over them, so collect the expired objects first.
+  std::vector<K8sMetadataObjectSPtr> expired_objects;
+  for (const auto& [uid, k8s_object] : k8s_objects_by_id_) {
+    if (IsExpired(*k8s_object, retention_time_ns, now)) {
+      expired_objects.push_back(k8s_object);
     }
+  }
 
+  for (const auto& k8s_object : expired_objects) {
     switch (k8s_object->type()) {
       case K8sObjectType::kPod:
         if (PodIDByName(std::make_pair(k8s_object->ns(), k8s_object->name())) ==
@@ -465,19 +478,19 @@ Status K8sMetadataState::CleanupExpiredMetadata(int64_t retention_time_ns) {
                                         static_cast<int>(k8s_object->type()));
     }
 
-    k8s_objects_by_id_.erase(iter++);
+    k8s_objects_by_id_.erase(k8s_object->uid());
   }
 
-  for (auto iter = containers_by_id_.begin(); iter != containers_by_id_.end();) {
-    const auto& cinfo = iter->second;
-
-    if (!IsExpired(*cinfo, retention_time_ns, now)) {
-      ++iter;
-      continue;
+  std::vector<ContainerInfoSPtr> expired_containers;
+  for (const auto& [cid, cinfo] : containers_by_id_) {
+    if (IsExpired(*cinfo, retention_time_ns, now)) {
+      expired_containers.push_back(cinfo);
     }
+  }
 
+  for (const auto& cinfo : expired_containers) {
     containers_by_name_.erase(cinfo->name());
-    containers_by_id_.erase(iter++);
+    containers_by_id_.erase(cinfo->cid());
   }
 
   return Status::OK();
@@ -489,10 +502,7 @@ std::shared_ptr<AgentMetadataState> AgentMetadataState::CloneToShared() const {
   state->last_update_ts_ns_ = last_update_ts_ns_;
   state->epoch_id_ = epoch_id_;
   state->k8s_metadata_state_ = k8s_metadata_state_->Clone();
-  state->pids_by_upid_.reserve(pids_by_upid_.size());
-  for (const auto& [k, v] : pids_by_upid_) {
-    state->pids_by_upid_[k] = v->Clone();
-  }
+  state->pids_by_upid_ = pids_by_upid_;
   state->upids_ = upids_;
   return state;
 }
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -30,19 +31,44 @@
 #include "src/common/base/base.h"
 #include "src/shared/k8s/metadatapb/metadata.pb.h"
 #include "src/shared/metadata/k8s_objects.h"
+#include "src/shared/metadata/persistent_hash_map.h"
 #include "src/shared/metadata/pids.h"
 #include "src/shared/upid/upid.h"
 
 namespace px {
 namespace md {
 
-using K8sMetadataObjectUPtr = std::unique_ptr<K8sMetadataObject>;
-using ContainerInfoUPtr = std::unique_ptr<ContainerInfo>;
-using PIDInfoUPtr = std::unique_ptr<PIDInfo>;
+// The metadata objects are shared between consecutive versions of the metadata state. They must
+// only be modified through internal::MutableObject(), which copies them while they are shared.
+using K8sMetadataObjectSPtr = std::shared_ptr<K8sMetadataObject>;
+using ContainerInfoSPtr = std::shared_ptr<ContainerInfo>;
+using PIDInfoSPtr = std::shared_ptr<PIDInfo>;
+using PIDInfoMap = PersistentHashMap<UPID, PIDInfoSPtr>;
 using AgentID = sole::uuid;
 
+namespace internal {
+/**
+ * Returns a mutable pointer to the object, after replacing it with a copy if it is still shared
+ * with another version of the metadata state.
+ */
+template <typename T>
+T* MutableObject(std::shared_ptr<T>* obj) {
+  if (obj->use_count() > 1) {
+    *obj = (*obj)->Clone();
+  } else {
+    // use_count() is a relaxed load, so order the reads of another version that just released
+    // the object before the writes of the caller. See PersistentHashMap::MutableShard().
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  return obj->get();
+}
+}  // namespace internal
+
 /**
  * This class contains all kubernetes relate metadata.
+ *
+ * All maps are persistent: Clone() shares the maps and the objects they hold with the original,
+ * and each update only copies the map shards and objects that it modifies.
  */
 class K8sMetadataState : NotCopyable {
  public:
@@ -95,16 +121,18 @@ class K8sMetadataState : NotCopyable {
     };
   };
   using K8sEntityByNameMap =
-      absl::flat_hash_map<K8sNameIdent, UID, K8sIdentHashEq::Hash, K8sIdentHashEq::Eq>;
+      PersistentHashMap<K8sNameIdent, UID, K8sIdentHashEq::Hash, K8sIdentHashEq::Eq>;
 
   using PodsByNameMap = K8sEntityByNameMap;
   using ServicesByNameMap = K8sEntityByNameMap;
   using ReplicaSetByNameMap = K8sEntityByNameMap;
   using DeploymentByNameMap = K8sEntityByNameMap;
   using NamespacesByNameMap = K8sEntityByNameMap;
-  using ContainersByNameMap = absl::flat_hash_map<std::string, CID>;
-  using PodsByPodIpMap = absl::flat_hash_map<std::string, UID>;
-  using ServicesByServiceIpMap = absl::flat_hash_map<std::string, UID>;
+  using ContainersByNameMap = PersistentHashMap<std::string, CID>;
+  using PodsByPodIpMap = PersistentHashMap<std::string, UID>;
+  using ServicesByServiceIpMap = PersistentHashMap<std::string, UID>;
+  using K8sObjectsByIDMap = PersistentHashMap<UID, K8sMetadataObjectSPtr>;
+  using ContainersByIDMap = PersistentHashMap<CID, ContainerInfoSPtr>;
 
   void set_service_cidr(CIDRBlock cidr) {
     if (!service_cidr_.has_value() || service_cidr_.value() != cidr) {
@@ -223,6 +251,10 @@ class K8sMetadataState : NotCopyable {
    */
   UID DeploymentIDByName(K8sNameIdentView deployment_name) const;
 
+  /**
+   * Clone returns a copy of the state, which shares all unmodified data with this one.
+   * The cost is independent of the number of objects.
+   */
   std::unique_ptr<K8sMetadataState> Clone() const;
 
   Status HandlePodUpdate(const PodUpdate& update);
@@ -235,7 +267,16 @@ class K8sMetadataState : NotCopyable {
 
   Status CleanupExpiredMetadata(int64_t retention_time_ns);
 
-  absl::flat_hash_map<CID, ContainerInfoUPtr>& containers_by_id() { return containers_by_id_; }
+  const ContainersByIDMap& containers_by_id() const { return containers_by_id_; }
+
+  /**
+   * MutableContainerInfoByID returns the container info by ID, for modification. The container is
+   * copied first if it is still shared with another version of the state.
+   * @param id The ID of the container.
+   * @return ContainerInfo or nullptr if not found.
+   */
+  ContainerInfo* MutableContainerInfoByID(CIDView id);
+
   std::string DebugString(int indent_level = 0) const;
 
  private:
@@ -248,10 +289,10 @@ class K8sMetadataState : NotCopyable {
   std::vector<CIDRBlock> pod_cidrs_;
 
   // This stores K8s native objects (services, pods, etc).
-  absl::flat_hash_map<UID, K8sMetadataObjectUPtr> k8s_objects_by_id_;
+  K8sObjectsByIDMap k8s_objects_by_id_;
 
   // This stores container objects, complementing k8s_objects_by_id_.
-  absl::flat_hash_map<CID, ContainerInfoUPtr> containers_by_id_;
+  ContainersByIDMap containers_by_id_;
 
   /**
    * Mapping of pods by name.
@@ -331,9 +372,13 @@ class AgentMetadataState : NotCopyable {
   K8sMetadataState* k8s_metadata_state() { return k8s_metadata_state_.get(); }
   const K8sMetadataState& k8s_metadata_state() const { return *k8s_metadata_state_; }
 
+  /**
+   * CloneToShared returns a copy of the state to apply the next updates to. Like
+   * K8sMetadataState::Clone(), it shares all unmodified data with this one.
+   */
   std::shared_ptr<AgentMetadataState> CloneToShared() const;
 
-  PIDInfo* GetPIDByUPID(UPID upid) const {
+  const PIDInfo* GetPIDByUPID(UPID upid) const {
     auto it = pids_by_upid_.find(upid);
     if (it != pids_by_upid_.end()) {
       return it->second.get();
@@ -350,16 +395,16 @@ class AgentMetadataState : NotCopyable {
   }
 
   void MarkUPIDAsStopped(UPID upid, int64_t ts) {
-    auto* pid_info = GetPIDByUPID(upid);
+    PIDInfoSPtr* pid_info = pids_by_upid_.FindMutable(upid);
     if (pid_info != nullptr) {
-      pid_info->set_stop_time_ns(ts);
+      internal::MutableObject(pid_info)->set_stop_time_ns(ts);
       upids_.erase(upid);
     } else {
       DCHECK(!upids_.contains(upid));
     }
   }
 
-  const absl::flat_hash_map<UPID, PIDInfoUPtr>& pids_by_upid() const { return pids_by_upid_; }
+  const PIDInfoMap& pids_by_upid() const { return pids_by_upid_; }
 
   const absl::flat_hash_set<md::UPID>& upids() const { return upids_; }
 
@@ -393,7 +438,7 @@ class AgentMetadataState : NotCopyable {
   /**
    * Mapping of PIDs by UPID for active pods on the system.
    */
-  absl::flat_hash_map<UPID, PIDInfoUPtr> pids_by_upid_;
+  PIDInfoMap pids_by_upid_;
 
   /**
    * All active UPIDs. Unlike pids_by_upid_, this does not contain stopped pids.
@@ -278,6 +278,37 @@ TEST(K8sMetadataStateTest, CloneCopiedCIDR) {
   EXPECT_EQ(service_cidr.prefix_length, state_copy->service_cidr()->prefix_length);
 }
 
+TEST(K8sMetadataStateTest, CloneSharesUnmodifiedObjects) {
+  K8sMetadataState state;
+
+  K8sMetadataState::ContainerUpdate container_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kContainer0UpdatePbTxt, &container_update));
+  K8sMetadataState::PodUpdate pod_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod0UpdatePbTxt, &pod_update));
+  EXPECT_OK(state.HandleContainerUpdate(container_update));
+  EXPECT_OK(state.HandlePodUpdate(pod_update));
+
+  auto state_copy = state.Clone();
+  EXPECT_EQ(state.PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ(state.ContainerInfoByID("container0_uid"),
+            state_copy->ContainerInfoByID("container0_uid"));
+
+  // Updating the copy leaves the original untouched.
+  pod_update.set_pod_ip("4.3.2.1");
+  EXPECT_OK(state_copy->HandlePodUpdate(pod_update));
+
+  EXPECT_NE(state.PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ("1.2.3.4", state.PodInfoByID("pod0_uid")->pod_ip());
+  EXPECT_EQ("4.3.2.1", state_copy->PodInfoByID("pod0_uid")->pod_ip());
+  EXPECT_EQ("", state.PodIDByIP("4.3.2.1"));
+  EXPECT_EQ("pod0_uid", state_copy->PodIDByIP("4.3.2.1"));
+  EXPECT_EQ("pod0_uid", state_copy->PodIDByIP("1.2.3.4"));
+
+  // The container already belonged to the pod, so it was not copied.
+  EXPECT_EQ(state.ContainerInfoByID("container0_uid"),
+            state_copy->ContainerInfoByID("container0_uid"));
+}
+
 TEST(K8sMetadataStateTest, HandleContainerUpdate) {
   K8sMetadataState state;
 
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace md {
+
+/**
+ * A hash map whose copies share their storage until they are modified.
+ *
+ * The entries are spread over a fixed number of shards by hash, and each shard is an immutable
+ * flat_hash_map held through a shared_ptr. Copying the map only copies the shard pointers. A
+ * modification copies the one shard that it touches, if that shard is still shared with another
+ * copy of the map. A new version of a map with N entries that differs in a few keys therefore
+ * costs O(N / kNumShards) per modified shard, instead of O(N).
+ *
+ * Reading a map is thread-safe as long as nothing modifies that same copy of the map; other copies
+ * can be modified concurrently. Iterators are invalidated by any modification of the map.
+ */
+template <typename TKey, typename TValue,
+          typename THash = typename absl::flat_hash_map<TKey, TValue>::hasher,
+          typename TEq = typename absl::flat_hash_map<TKey, TValue, THash>::key_equal>
+class PersistentHashMap {
+ public:
+  using ShardMap = absl::flat_hash_map<TKey, TValue, THash, TEq>;
+  using key_type = TKey;
+  using mapped_type = TValue;
+  using value_type = typename ShardMap::value_type;
+  using hasher = THash;
+  using key_equal = TEq;
+
+  static constexpr int kNumShardBits = 6;
+  static constexpr size_t kNumShards = 1 << kNumShardBits;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename ShardMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    const_iterator() = default;
+
+    reference operator*() const { return *iter_; }
+    pointer operator->() const { return &*iter_; }
+
+    const_iterator& operator++() {
+      ++iter_;
+      SkipEmptyShards();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==(const const_iterator& a, const const_iterator& b) {
+      if (a.shard_idx_ != b.shard_idx_) {
+        return false;
+      }
+      return a.shard_idx_ == kNumShards || a.iter_ == b.iter_;
+    }
+    friend bool operator!=(const const_iterator& a, const const_iterator& b) { return !(a == b); }
+
+   private:
+    friend class PersistentHashMap;
+
+    const_iterator(const PersistentHashMap* map, size_t shard_idx,
+                   typename ShardMap::const_iterator iter)
+        : map_(map), shard_idx_(shard_idx), iter_(iter) {}
+
+    // Moves to the first entry of the next non-empty shard, if the current one is exhausted.
+    void SkipEmptyShards() {
+      while (shard_idx_ < kNumShards) {
+        const auto& shard = map_->shards_[shard_idx_];
+        if (shard != nullptr && iter_ != shard->end()) {
+          return;
+        }
+        if (++shard_idx_ < kNumShards && map_->shards_[shard_idx_] != nullptr) {
+          iter_ = map_->shards_[shard_idx_]->begin();
+        }
+      }
+      iter_ = typename ShardMap::const_iterator();
+    }
+
+    const PersistentHashMap* map_ = nullptr;
+    size_t shard_idx_ = kNumShards;
+    typename ShardMap::const_iterator iter_;
+  };
+  using iterator = const_iterator;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const_iterator begin() const {
+    const_iterator iter(this, 0, shards_[0] == nullptr ? typename ShardMap::const_iterator()
+                                                       : shards_[0]->begin());
+    iter.SkipEmptyShards();
+    return iter;
+  }
+  const_iterator end() const { return const_iterator(); }
+
+  template <typename TLookupKey>
+  const_iterator find(const TLookupKey& key) const {
+    const size_t shard_idx = ShardIndex(key);
+    const auto& shard = shards_[shard_idx];
+    if (shard == nullptr) {
+      return end();
+    }
+    auto iter = shard->find(key);
+    if (iter == shard->end()) {
+      return end();
+    }
+    return const_iterator(this, shard_idx, iter);
+  }
+
+  template <typename TLookupKey>
+  bool contains(const TLookupKey& key) const {
+    const auto& shard = shards_[ShardIndex(key)];
+    return shard != nullptr && shard->contains(key);
+  }
+
+  /**
+   * Returns a mutable pointer to the value of key, or nullptr if the key is not present.
+   * The value is no longer shared with other copies of the map afterwards.
+   */
+  template <typename TLookupKey>
+  TValue* FindMutable(const TLookupKey& key) {
+    const size_t shard_idx = ShardIndex(key);
+    if (shards_[shard_idx] == nullptr || !shards_[shard_idx]->contains(key)) {
+      return nullptr;
+    }
+    return &MutableShard(shard_idx)->find(key)->second;
+  }
+
+  TValue& operator[](const TKey& key) {
+    ShardMap* shard = MutableShard(ShardIndex(key));
+    auto [iter, inserted] = shard->try_emplace(key);
+    size_ += inserted;
+    return iter->second;
+  }
+
+  /**
+   * Inserts the value if the key is not present yet, and returns a mutable pointer to the value of
+   * key, along with whether the insertion took place.
+   */
+  template <typename... TArgs>
+  std::pair<TValue*, bool> try_emplace(const TKey& key, TArgs&&... args) {
+    ShardMap* shard = MutableShard(ShardIndex(key));
+    auto [iter, inserted] = shard->try_emplace(key, std::forward<TArgs>(args)...);
+    size_ += inserted;
+    return {&iter->second, inserted};
+  }
+
+  /**
+   * Sets the value of key. The map is left untouched if it already holds an equal value, so that
+   * the shard stays shared with the other copies of the map.
+   */
+  void Set(const TKey& key, TValue value) {
+    auto iter = find(key);
+    if (iter != end() && iter->second == value) {
+      return;
+    }
+    (*this)[key] = std::move(value);
+  }
+
+  size_t erase(const TKey& key) {
+    const size_t shard_idx = ShardIndex(key);
+    if (shards_[shard_idx] == nullptr || !shards_[shard_idx]->contains(key)) {
+      return 0;
+    }
+    MutableShard(shard_idx)->erase(key);
+    --size_;
+    return 1;
+  }
+
+ private:
+  template <typename TLookupKey>
+  static size_t ShardIndex(const TLookupKey& key) {
+    // The shard maps use the low bits of the same hash to place the entries, so use the high bits.
+    return static_cast<size_t>(THash{}(key)) >> (sizeof(size_t) * 8 - kNumShardBits);
+  }
+
+  // Copies the shard first if any other copy of the map still refers to it.
+  ShardMap* MutableShard(size_t shard_idx) {
+    auto& shard = shards_[shard_idx];
+    if (shard == nullptr) {
+      shard = std::make_shared<ShardMap>();
+    } else if (shard.use_count() > 1) {
+      shard = std::make_shared<ShardMap>(*shard);
+    } else {
+      // use_count() is a relaxed load. Another thread may just have released the last other copy
+      // after reading the shard, so order those reads before the writes of the caller.
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return shard.get();
+  }
+
+  std::array<std::shared_ptr<ShardMap>, kNumShards> shards_;
+  size_t size_ = 0;
+};
+
+}  // namespace md
+}  // namespace px
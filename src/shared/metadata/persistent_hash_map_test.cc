@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+
+#include "src/shared/metadata/persistent_hash_map.h"
+
+namespace px {
+namespace md {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(PersistentHashMapTest, BasicOperations) {
+  PersistentHashMap<std::string, int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+
+  map["a"] = 1;
+  map["b"] = 2;
+  EXPECT_TRUE(map.try_emplace("c", 3).second);
+  EXPECT_FALSE(map.try_emplace("c", 4).second);
+
+  EXPECT_EQ(map.size(), 3);
+  EXPECT_THAT(map, UnorderedElementsAre(Pair("a", 1), Pair("b", 2), Pair("c", 3)));
+  EXPECT_TRUE(map.contains(std::string_view("a")));
+  ASSERT_NE(map.find(std::string_view("b")), map.end());
+  EXPECT_EQ(map.find(std::string_view("b"))->second, 2);
+  EXPECT_EQ(map.find("d"), map.end());
+  EXPECT_EQ(map.FindMutable("d"), nullptr);
+
+  *map.FindMutable("a") = 10;
+  EXPECT_EQ(map.erase("b"), 1);
+  EXPECT_EQ(map.erase("b"), 0);
+  EXPECT_THAT(map, UnorderedElementsAre(Pair("a", 10), Pair("c", 3)));
+}
+
+TEST(PersistentHashMapTest, CopiesAreIndependent) {
+  PersistentHashMap<int, int> map;
+  for (int i = 0; i < 1000; ++i) {
+    map[i] = i;
+  }
+
+  PersistentHashMap<int, int> copy = map;
+  copy[0] = -1;
+  *copy.FindMutable(1) = -1;
+  copy.erase(2);
+  copy[1000] = 1000;
+
+  EXPECT_EQ(map.size(), 1000);
+  EXPECT_EQ(map.find(0)->second, 0);
+  EXPECT_EQ(map.find(1)->second, 1);
+  EXPECT_TRUE(map.contains(2));
+  EXPECT_FALSE(map.contains(1000));
+
+  EXPECT_EQ(copy.size(), 1000);
+  EXPECT_EQ(copy.find(0)->second, -1);
+  EXPECT_EQ(copy.find(1)->second, -1);
+  EXPECT_FALSE(copy.contains(2));
+  EXPECT_EQ(copy.find(1000)->second, 1000);
+
+  int count = 0;
+  for (const auto& [k, v] : copy) {
+    EXPECT_EQ(copy.find(k)->second, v);
+    ++count;
+  }
+  EXPECT_EQ(count, 1000);
+}
+
+}  // namespace md
+}  // namespace px
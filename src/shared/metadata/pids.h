@@ -146,6 +146,23 @@ struct PIDTerminatedEvent : public PIDStatusEvent {
   const int64_t stop_time_ns;
 };
 
+/**
+ * The process lifecycle event type.
+ */
+enum class ProcessLifecycleEventType : uint8_t { kStarted, kExited };
+
+/**
+ * ProcessLifecycleEvent reports the creation (fork or exec) or the exit of a process on the host,
+ * as observed by a BPF probe. These events let the metadata track the PIDs of the containers
+ * without rescanning their cgroups.
+ */
+struct ProcessLifecycleEvent {
+  ProcessLifecycleEventType type;
+  uint32_t pid;
+  // The start time of the process in clock ticks, as in /proc/<pid>/stat.
+  uint64_t start_time_ticks;
+};
+
 /**
  * Print and compare functions.
  */
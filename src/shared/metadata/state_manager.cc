@@ -17,6 +17,7 @@
  */
 
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -38,6 +39,38 @@ constexpr uint64_t kEpochsBetweenObjectDeletion = 100;
  */
 constexpr uint64_t kMinObjectRetentionAfterDeathNS = 24ULL * 3600ULL * 1'000'000'000ULL;
 
+/**
+ * kEpochsBetweenPIDReconciliation is the interval between full rescans of the cgroups of the
+ * containers, when their PIDs are otherwise tracked from process lifecycle events. The rescan
+ * catches up on any event that was lost.
+ */
+constexpr uint64_t kEpochsBetweenPIDReconciliation = 12;
+
+void ContainerCGroupIndex::Add(CIDView cid, std::string cgroup_name) {
+  Remove(cid);
+  cids_by_cgroup_name_[cgroup_name] = CID(cid);
+  cgroup_names_by_cid_.emplace(cid, std::move(cgroup_name));
+}
+
+void ContainerCGroupIndex::Remove(CIDView cid) {
+  auto iter = cgroup_names_by_cid_.find(cid);
+  if (iter == cgroup_names_by_cid_.end()) {
+    return;
+  }
+  cids_by_cgroup_name_.erase(iter->second);
+  cgroup_names_by_cid_.erase(iter);
+}
+
+void ContainerCGroupIndex::Clear() {
+  cgroup_names_by_cid_.clear();
+  cids_by_cgroup_name_.clear();
+}
+
+const CID* ContainerCGroupIndex::FindContainer(std::string_view cgroup_name) const {
+  auto iter = cids_by_cgroup_name_.find(cgroup_name);
+  return iter == cids_by_cgroup_name_.end() ? nullptr : &iter->second;
+}
+
 std::shared_ptr<const AgentMetadataState>
 AgentMetadataStateManagerImpl::CurrentAgentMetadataState() {
   absl::base_internal::SpinLockHolder lock(&agent_metadata_state_lock_);
@@ -57,6 +90,14 @@ Status AgentMetadataStateManagerImpl::AddK8sUpdate(std::unique_ptr<ResourceUpdat
   return Status::OK();
 }
 
+void AgentMetadataStateManagerImpl::AddProcessLifecycleEvent(ProcessLifecycleEvent event) {
+  if (!collects_data_) {
+    return;
+  }
+  process_events_enabled_ = true;
+  incoming_process_events_.enqueue(event);
+}
+
 Status AgentMetadataStateManagerImpl::PerformMetadataStateUpdate() {
   // There should never be more than one update, but this just here for safety.
   std::lock_guard<std::mutex> state_update_lock(metadata_state_update_lock_);
@@ -65,6 +106,8 @@ Status AgentMetadataStateManagerImpl::PerformMetadataStateUpdate() {
    *   1. Create a copy of the current metadata state.
    *   2. Drain the incoming update queue from the metadata service and apply the updates.
    *   3. For each container pull the pid information. Diff this with the existing pids and update.
+   *      Once process lifecycle events are available, only new containers are scanned, and the
+   *      PIDs of the others are updated from the events, except for a periodic full rescan.
    *   4. Send diff of pids to the outgoing update Q.
    *   5. Set current update time and increment the epoch.
    *   6. Update pod/service CIDR information if it has changed.
@@ -90,8 +133,24 @@ Status AgentMetadataStateManagerImpl::PerformMetadataStateUpdate() {
 
   if (collects_data_) {
     // Update PID information.
-    PL_RETURN_IF_ERROR(
-        ProcessPIDUpdates(ts, proc_parser_, shadow_state.get(), md_reader_.get(), &pid_updates_));
+    std::vector<ProcessLifecycleEvent> process_events;
+    ProcessLifecycleEvent process_event;
+    while (incoming_process_events_.try_dequeue(process_event)) {
+      process_events.push_back(process_event);
+    }
+
+    if (!process_events_enabled_ || epoch_id % kEpochsBetweenPIDReconciliation == 0) {
+      // The rescan reflects all the events received so far, so they are dropped.
+      PL_RETURN_IF_ERROR(ProcessPIDUpdates(ts, proc_parser_, shadow_state.get(), md_reader_.get(),
+                                           &pid_updates_, &container_cgroup_index_));
+    } else {
+      PL_RETURN_IF_ERROR(ProcessPIDUpdates(ts, proc_parser_, shadow_state.get(), md_reader_.get(),
+                                           &pid_updates_, &container_cgroup_index_,
+                                           /*skip_indexed_containers*/ true));
+      PL_RETURN_IF_ERROR(ProcessLifecycleEvents(ts, proc_parser_, shadow_state.get(),
+                                                md_reader_.get(), container_cgroup_index_,
+                                                process_events, &pid_updates_));
+    }
   }
 
   // Update the pod/service CIDRs if they have been updated.
@@ -177,6 +236,20 @@ StatusOr<UPID> InitUPID(const system::ProcParser& proc_parser, uint32_t asid, ui
   return UPID(asid, pid, pid_start_time);
 }
 
+// Returns whether the PIDs in the cgroups of a container differ from the ones it is tracking.
+bool ContainerPIDsChanged(const StartTimeOrderedUPIDSet& upids,
+                          const absl::flat_hash_set<uint32_t>& cgroups_pids) {
+  if (upids.size() != cgroups_pids.size()) {
+    return true;
+  }
+  for (const auto& upid : upids) {
+    if (!cgroups_pids.contains(upid.pid())) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 void ProcessContainerPIDUpdates(
@@ -235,8 +308,21 @@ void ProcessContainerPIDUpdates(
 Status ProcessPIDUpdates(
     int64_t ts, const system::ProcParser& proc_parser, AgentMetadataState* md,
     CGroupMetadataReader* md_reader,
-    moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates) {
-  const auto& k8s_md_state = md->k8s_metadata_state();
+    moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates,
+    ContainerCGroupIndex* cgroup_index, bool skip_indexed_containers) {
+  DCHECK(!skip_indexed_containers || cgroup_index != nullptr);
+  K8sMetadataState* k8s_md_state = md->k8s_metadata_state();
+
+  if (cgroup_index != nullptr && !skip_indexed_containers) {
+    cgroup_index->Clear();
+  }
+
+  // Containers are shared with the previous version of the metadata state, and modifying one
+  // copies it, which modifies containers_by_id(). So the loop below only collects the changes,
+  // which are applied afterwards to the few containers that actually changed.
+  std::vector<std::pair<CID, int64_t>> containers_in_deleted_pods;
+  std::vector<CID> missing_containers;
+  std::vector<std::pair<CID, absl::flat_hash_set<uint32_t>>> containers_with_new_pids;
 
   for (const auto& [cid, cinfo] : k8s_md_state->containers_by_id()) {
     if (cinfo->stop_time_ns() != 0) {
@@ -244,6 +330,9 @@ Status ProcessPIDUpdates(
       // TODO(zasgar): Come up with a cleaner way of doing this. Probably by using active/inactive
       // containers.
       VLOG(1) << "Ignore dead container: " << cinfo->DebugString();
+      if (cgroup_index != nullptr) {
+        cgroup_index->Remove(cid);
+      }
       continue;
     }
 
@@ -264,7 +353,15 @@ Status ProcessPIDUpdates(
     if (pod_info->stop_time_ns() != 0) {
       VLOG(1) << absl::Substitute("Found a running container in a deleted pod [cid=$0, pod_id=$1]",
                                   cid, pod_id);
-      cinfo->set_stop_time_ns(pod_info->stop_time_ns());
+      containers_in_deleted_pods.emplace_back(cid, pod_info->stop_time_ns());
+      if (cgroup_index != nullptr) {
+        cgroup_index->Remove(cid);
+      }
+      continue;
+    }
+
+    if (skip_indexed_containers && cgroup_index->Contains(cid)) {
+      // The PIDs of this container are tracked from process lifecycle events.
       continue;
     }
 
@@ -282,15 +379,43 @@ Status ProcessPIDUpdates(
       // NOTE: Currently, MDS sends pods that do no belong to this Agent, so this is actually
       // required to avoid repeatedly printing out the warning message above.
       if (error::IsNotFound(s)) {
-        cinfo->set_stop_time_ns(ts);
-        for (const auto& upid : cinfo->active_upids()) {
-          md->MarkUPIDAsStopped(upid, ts);
-        }
-        cinfo->mutable_active_upids()->clear();
+        missing_containers.push_back(cid);
+      }
+      if (cgroup_index != nullptr) {
+        cgroup_index->Remove(cid);
       }
       continue;
     }
 
+    // A container without processes may not be fully set up yet, so it keeps being scanned.
+    if (cgroup_index != nullptr && !cgroups_active_pids.empty()) {
+      StatusOr<std::string> cgroup_name =
+          md_reader->ContainerCGroupName(pod_info->qos_class(), pod_id, cid, cinfo->type());
+      if (cgroup_name.ok()) {
+        cgroup_index->Add(cid, cgroup_name.ConsumeValueOrDie());
+      }
+    }
+
+    if (ContainerPIDsChanged(cinfo->active_upids(), cgroups_active_pids)) {
+      containers_with_new_pids.emplace_back(cid, std::move(cgroups_active_pids));
+    }
+  }
+
+  for (const auto& [cid, stop_time_ns] : containers_in_deleted_pods) {
+    k8s_md_state->MutableContainerInfoByID(cid)->set_stop_time_ns(stop_time_ns);
+  }
+
+  for (const auto& cid : missing_containers) {
+    ContainerInfo* cinfo = k8s_md_state->MutableContainerInfoByID(cid);
+    cinfo->set_stop_time_ns(ts);
+    for (const auto& upid : cinfo->active_upids()) {
+      md->MarkUPIDAsStopped(upid, ts);
+    }
+    cinfo->mutable_active_upids()->clear();
+  }
+
+  for (auto& [cid, cgroups_active_pids] : containers_with_new_pids) {
+    ContainerInfo* cinfo = k8s_md_state->MutableContainerInfoByID(cid);
     ProcessContainerPIDUpdates(cid, ts, proc_parser, md, cinfo->mutable_active_upids(),
                                &cgroups_active_pids, pid_updates);
   }
@@ -298,6 +423,95 @@ Status ProcessPIDUpdates(
   return Status::OK();
 }
 
+namespace {
+
+void HandleProcessStarted(
+    const ProcessLifecycleEvent& event, const system::ProcParser& proc_parser,
+    AgentMetadataState* md, CGroupMetadataReader* md_reader,
+    const ContainerCGroupIndex& cgroup_index,
+    moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates) {
+  UPID upid(md->asid(), event.pid, event.start_time_ticks);
+  if (md->GetPIDByUPID(upid) != nullptr) {
+    // Already tracked, e.g. a process that called exec after being forked.
+    return;
+  }
+
+  absl::flat_hash_set<std::string> cgroup_names;
+  if (!md_reader->ReadCGroupNames(event.pid, &cgroup_names).ok()) {
+    return;
+  }
+  const CID* cid = nullptr;
+  for (const auto& cgroup_name : cgroup_names) {
+    cid = cgroup_index.FindContainer(cgroup_name);
+    if (cid != nullptr) {
+      break;
+    }
+  }
+  if (cid == nullptr) {
+    // Not a process of a running container. If its container is new, the process is found
+    // when the container is first scanned.
+    return;
+  }
+
+  K8sMetadataState* k8s_md_state = md->k8s_metadata_state();
+  const ContainerInfo* cinfo = k8s_md_state->ContainerInfoByID(*cid);
+  if (cinfo == nullptr || cinfo->stop_time_ns() != 0) {
+    return;
+  }
+  k8s_md_state->MutableContainerInfoByID(*cid)->mutable_active_upids()->emplace(upid);
+
+  std::string exe_path = proc_parser.GetExePath(event.pid).ValueOr("");
+  std::string cmdline = proc_parser.GetPIDCmdline(event.pid);
+  auto pid_info = std::make_unique<PIDInfo>(upid, std::move(exe_path), std::move(cmdline), *cid);
+
+  // Push creation events to the queue.
+  pid_updates->enqueue(std::make_unique<PIDStartedEvent>(*pid_info));
+
+  md->AddUPID(upid, std::move(pid_info));
+}
+
+void HandleProcessExited(
+    const ProcessLifecycleEvent& event, int64_t ts, AgentMetadataState* md,
+    moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates) {
+  UPID upid(md->asid(), event.pid, event.start_time_ticks);
+  const PIDInfo* pid_info = md->GetPIDByUPID(upid);
+  if (pid_info == nullptr || pid_info->stop_time_ns() != 0) {
+    // Not a process of a container, or one that was not tracked yet.
+    return;
+  }
+
+  ContainerInfo* cinfo = md->k8s_metadata_state()->MutableContainerInfoByID(pid_info->cid());
+  if (cinfo != nullptr) {
+    cinfo->mutable_active_upids()->erase(upid);
+  }
+  md->MarkUPIDAsStopped(upid, ts);
+
+  // Push deletion events to the queue.
+  pid_updates->enqueue(std::make_unique<PIDTerminatedEvent>(upid, ts));
+}
+
+}  // namespace
+
+Status ProcessLifecycleEvents(
+    int64_t ts, const system::ProcParser& proc_parser, AgentMetadataState* md,
+    CGroupMetadataReader* md_reader, const ContainerCGroupIndex& cgroup_index,
+    const std::vector<ProcessLifecycleEvent>& events,
+    moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates) {
+  // The events are applied in order, so that a process that started and exited since the last
+  // update ends up stopped.
+  for (const auto& event : events) {
+    switch (event.type) {
+      case ProcessLifecycleEventType::kStarted:
+        HandleProcessStarted(event, proc_parser, md, md_reader, cgroup_index, pid_updates);
+        break;
+      case ProcessLifecycleEventType::kExited:
+        HandleProcessExited(event, ts, md, pid_updates);
+        break;
+    }
+  }
+  return Status::OK();
+}
+
 Status DeleteMetadataForDeadObjects(AgentMetadataState* state, int64_t retention_time) {
   PL_RETURN_IF_ERROR(state->k8s_metadata_state()->CleanupExpiredMetadata(retention_time));
   return Status::OK();
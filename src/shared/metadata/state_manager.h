@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -109,6 +110,39 @@ class AgentMetadataStateManager {
    * @return unique_ptr with the PIDStatusEvent or nullptr.
    */
   virtual std::unique_ptr<PIDStatusEvent> GetNextPIDStatusEvent() = 0;
+
+  /**
+   * Adds a process lifecycle event that will be processed the next time MetadataStateUpdate is
+   * called. Once events are being added, the PIDs of the containers are tracked from these events,
+   * and their cgroups are only rescanned periodically to catch up on any missed event.
+   * @param event the process lifecycle event.
+   */
+  virtual void AddProcessLifecycleEvent(ProcessLifecycleEvent event) = 0;
+};
+
+/**
+ * ContainerCGroupIndex maps the cgroup names of the running containers to their container IDs.
+ * It is used to find the container of a new process from /proc/<pid>/cgroup, instead of scanning
+ * the cgroups of every container.
+ */
+class ContainerCGroupIndex {
+ public:
+  void Add(CIDView cid, std::string cgroup_name);
+  void Remove(CIDView cid);
+  void Clear();
+
+  bool Contains(CIDView cid) const { return cgroup_names_by_cid_.contains(cid); }
+
+  /**
+   * Returns the ID of the container with the given cgroup name, or nullptr if there is none.
+   */
+  const CID* FindContainer(std::string_view cgroup_name) const;
+
+  size_t size() const { return cgroup_names_by_cid_.size(); }
+
+ private:
+  absl::flat_hash_map<CID, std::string> cgroup_names_by_cid_;
+  absl::flat_hash_map<std::string, CID> cids_by_cgroup_name_;
 };
 
 /**
@@ -151,6 +185,8 @@ class AgentMetadataStateManagerImpl : public AgentMetadataStateManager {
 
   std::unique_ptr<PIDStatusEvent> GetNextPIDStatusEvent() override;
 
+  void AddProcessLifecycleEvent(ProcessLifecycleEvent event) override;
+
  private:
   /**
    * The number of PID events to send upstream.
@@ -175,6 +211,13 @@ class AgentMetadataStateManagerImpl : public AgentMetadataStateManager {
   moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>> incoming_k8s_updates_;
   moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>> pid_updates_;
 
+  moodycamel::BlockingConcurrentQueue<ProcessLifecycleEvent> incoming_process_events_;
+  // Set once the first process lifecycle event is received. Until then, the cgroups of every
+  // container are rescanned on each update.
+  std::atomic<bool> process_events_enabled_ = false;
+  // Only accessed by PerformMetadataStateUpdate(), under metadata_state_update_lock_.
+  ContainerCGroupIndex container_cgroup_index_;
+
   absl::base_internal::SpinLock cidr_lock_;
   std::optional<CIDRBlock> service_cidr_;
   std::optional<std::vector<CIDRBlock>> pod_cidrs_;
@@ -195,10 +238,24 @@ Status ApplyK8sUpdates(
 void RemoveDeadPods(int64_t ts, AgentMetadataState* md, CGroupMetadataReader* md_reader);
 
 /**
- * Processes PID updates.
+ * Processes PID updates, by scanning the cgroups of the running containers.
+ *
+ * If cgroup_index is provided, it is updated with the cgroups of the running containers. If
+ * skip_indexed_containers is also set, only the containers that are not in the index yet are
+ * scanned; the PIDs of the others are expected to be maintained by ProcessLifecycleEvents().
  */
 Status ProcessPIDUpdates(
     int64_t ts, const system::ProcParser& proc_parser, AgentMetadataState*, CGroupMetadataReader*,
+    moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates,
+    ContainerCGroupIndex* cgroup_index = nullptr, bool skip_indexed_containers = false);
+
+/**
+ * Processes PID updates from process lifecycle events. New processes are attributed to their
+ * container through the cgroup index.
+ */
+Status ProcessLifecycleEvents(
+    int64_t ts, const system::ProcParser& proc_parser, AgentMetadataState*, CGroupMetadataReader*,
+    const ContainerCGroupIndex& cgroup_index, const std::vector<ProcessLifecycleEvent>& events,
     moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates);
 
 /**
@@ -186,12 +186,28 @@ class FakePIDData : public MockCGroupMetadataReader {
                   ContainerType type, absl::flat_hash_set<uint32_t>* pid_set) const override {
     if (qos == PodQOSClass::kBurstable && pod_id == "pod_id1" && container_id == "container_id1" &&
         type == ContainerType::kDocker) {
-      *pid_set = {100, 200};
+      *pid_set = pids_;
       return Status::OK();
     }
 
     return error::NotFound("no found");
   }
+
+  StatusOr<std::string> ContainerCGroupName(PodQOSClass, std::string_view,
+                                            std::string_view container_id,
+                                            ContainerType) const override {
+    return std::string(container_id);
+  }
+
+  Status ReadCGroupNames(uint32_t pid,
+                         absl::flat_hash_set<std::string>* cgroup_names) const override {
+    return CGroupMetadataReader::ReadCGroupNames(pid, cgroup_names);
+  }
+
+  void set_pids(absl::flat_hash_set<uint32_t> pids) { pids_ = std::move(pids); }
+
+ private:
+  absl::flat_hash_set<uint32_t> pids_ = {100, 200};
 };
 
 // Generates some test updates for entry into the AgentMetadataState.
@@ -385,6 +401,65 @@ TEST_F(AgentMetadataStateTest, pid_created) {
   EXPECT_THAT(pids_started, UnorderedElementsAre(PIDStartedEvent{pid1}, PIDStartedEvent{pid2}));
 }
 
+TEST_F(AgentMetadataStateTest, process_lifecycle_events) {
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>> updates;
+  GenerateTestUpdateEvents(&updates);
+
+  EXPECT_OK(ApplyK8sUpdates(2000 /*ts*/, &metadata_state_, &md_filter_, &updates));
+
+  const auto proc_path = testing::BazelRunfilePath("src/shared/metadata/testdata/proc");
+  PL_SET_FOR_SCOPE(FLAGS_proc_path, proc_path.string());
+  system::ProcParser proc_parser;
+
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>> events;
+  FakePIDData md_reader;
+  md_reader.set_pids({100});
+  ContainerCGroupIndex cgroup_index;
+
+  // The container is not indexed yet, so it is scanned.
+  EXPECT_OK(ProcessPIDUpdates(1000, proc_parser, &metadata_state_, &md_reader, &events,
+                              &cgroup_index, /*skip_indexed_containers*/ true));
+  ASSERT_EQ(1, cgroup_index.size());
+  ASSERT_NE(nullptr, cgroup_index.FindContainer("container_id1"));
+  EXPECT_EQ("container_id1", *cgroup_index.FindContainer("container_id1"));
+
+  // From now on, the PIDs of the container are only updated from the events.
+  md_reader.set_pids({});
+  std::vector<ProcessLifecycleEvent> process_events = {
+      {ProcessLifecycleEventType::kStarted, 200, /*start_time_ticks*/ 2000},
+      {ProcessLifecycleEventType::kExited, 100, /*start_time_ticks*/ 1000},
+      // Not a process of a container.
+      {ProcessLifecycleEventType::kExited, 300, /*start_time_ticks*/ 3000},
+  };
+  EXPECT_OK(ProcessPIDUpdates(3000, proc_parser, &metadata_state_, &md_reader, &events,
+                              &cgroup_index, /*skip_indexed_containers*/ true));
+  EXPECT_OK(ProcessLifecycleEvents(3000, proc_parser, &metadata_state_, &md_reader, cgroup_index,
+                                   process_events, &events));
+
+  std::unique_ptr<PIDStatusEvent> event;
+  std::vector<PIDStartedEvent> pids_started;
+  std::vector<PIDTerminatedEvent> pids_terminated;
+  while (events.try_dequeue(event)) {
+    if (event->type == PIDStatusEventType::kStarted) {
+      pids_started.emplace_back(*static_cast<PIDStartedEvent*>(event.get()));
+    } else {
+      pids_terminated.emplace_back(*static_cast<PIDTerminatedEvent*>(event.get()));
+    }
+  }
+
+  PIDInfo pid1(UPID(kASID, 100 /*pid*/, 1000 /*ts*/), "", "cmdline100", "container_id1");
+  PIDInfo pid2(UPID(kASID, 200 /*pid*/, 2000 /*ts*/), "", "cmdline200", "container_id1");
+  EXPECT_THAT(pids_started, ElementsAre(PIDStartedEvent{pid1}, PIDStartedEvent{pid2}));
+  EXPECT_THAT(pids_terminated,
+              ElementsAre(PIDTerminatedEvent{UPID(kASID, 100, 1000), /*stop_time_ns*/ 3000}));
+
+  const ContainerInfo* container_info =
+      metadata_state_.k8s_metadata_state()->ContainerInfoByID("container_id1");
+  ASSERT_NE(nullptr, container_info);
+  EXPECT_THAT(container_info->active_upids(), ElementsAre(UPID(kASID, 200, 2000)));
+  EXPECT_THAT(metadata_state_.upids(), UnorderedElementsAre(UPID(kASID, 200, 2000)));
+}
+
 TEST_F(AgentMetadataStateTest, insert_into_filter) {
   moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>> updates;
   GenerateTestUpdateEvents(&updates);
@@ -28,6 +28,7 @@
 #include "src/shared/metadata/metadata_state.h"
 #include "src/shared/types/types.h"
 #include "src/shared/upid/upid.h"
+#include "src/stirling/core/types.h"
 #include "src/stirling/utils/proc_tracker.h"
 
 namespace px {
@@ -53,7 +54,7 @@ class ConnectorContext {
   /**
    * Return detailed information on UPIDs.
    */
-  virtual const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const = 0;
+  virtual const md::PIDInfoMap& GetPIDInfoMap() const = 0;
 
   /**
    * Return K8s information (Pod and container information)
@@ -67,6 +68,12 @@ class ConnectorContext {
    * tracing.
    */
   virtual std::vector<CIDRBlock> GetClusterCIDRs() = 0;
+
+  /**
+   * Reports the creation or the exit of a process. The agent uses these events to track the PIDs
+   * of the containers. Ignored unless Stirling is part of the agent.
+   */
+  virtual void ReportProcessLifecycleEvent(const md::ProcessLifecycleEvent& /*event*/) {}
 };
 
 /**
@@ -78,9 +85,13 @@ class AgentContext : public ConnectorContext {
    * ConnectorContext with metadata state.
    * @param agent_metadata_state A read-only snapshot view of the metadata state. This state
    * should not be held onto for extended periods of time.
+   * @param process_lifecycle_callback The function to which process lifecycle events are reported,
+   * if any.
    */
-  explicit AgentContext(std::shared_ptr<const md::AgentMetadataState> agent_metadata_state)
-      : agent_metadata_state_(std::move(agent_metadata_state)) {
+  explicit AgentContext(std::shared_ptr<const md::AgentMetadataState> agent_metadata_state,
+                        ProcessLifecycleCallback process_lifecycle_callback = nullptr)
+      : agent_metadata_state_(std::move(agent_metadata_state)),
+        process_lifecycle_callback_(std::move(process_lifecycle_callback)) {
     DCHECK(agent_metadata_state_ != nullptr);
   }
 
@@ -90,7 +101,7 @@ class AgentContext : public ConnectorContext {
     return agent_metadata_state_->upids();
   }
 
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const override {
+  const md::PIDInfoMap& GetPIDInfoMap() const override {
     return agent_metadata_state_->pids_by_upid();
   }
 
@@ -100,8 +111,15 @@ class AgentContext : public ConnectorContext {
 
   std::vector<CIDRBlock> GetClusterCIDRs() override;
 
+  void ReportProcessLifecycleEvent(const md::ProcessLifecycleEvent& event) override {
+    if (process_lifecycle_callback_ != nullptr) {
+      process_lifecycle_callback_(event);
+    }
+  }
+
  private:
   std::shared_ptr<const md::AgentMetadataState> agent_metadata_state_;
+  ProcessLifecycleCallback process_lifecycle_callback_;
 };
 
 /**
@@ -117,9 +135,7 @@ class StandaloneContext : public ConnectorContext {
 
   const absl::flat_hash_set<md::UPID>& GetUPIDs() const override { return upids_; }
 
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& GetPIDInfoMap() const override {
-    return upid_pidinfo_map_;
-  }
+  const md::PIDInfoMap& GetPIDInfoMap() const override { return upid_pidinfo_map_; }
 
   const md::K8sMetadataState& GetK8SMetadata() override {
     static const md::K8sMetadataState kEmpty;
@@ -132,7 +148,7 @@ class StandaloneContext : public ConnectorContext {
 
  protected:
   absl::flat_hash_set<md::UPID> upids_;
-  absl::flat_hash_map<md::UPID, md::PIDInfoUPtr> upid_pidinfo_map_;
+  md::PIDInfoMap upid_pidinfo_map_;
 
  private:
   std::vector<CIDRBlock> cidrs_;
@@ -43,6 +43,11 @@ using AgentMetadataType = std::shared_ptr<const px::md::AgentMetadataState>;
  */
 using AgentMetadataCallback = std::function<AgentMetadataType()>;
 
+/**
+ * The callback function signature to report process lifecycle events to the agent.
+ */
+using ProcessLifecycleCallback = std::function<void(px::md::ProcessLifecycleEvent)>;
+
 class DataElement {
  public:
   constexpr DataElement() = delete;
@@ -24,6 +24,10 @@
 #include <llvm/Support/TargetSelect.h>
 
 #include <absl/container/flat_hash_set.h>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <numeric>
 #include <set>
 #include <utility>
 
@@ -159,6 +163,109 @@ Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir
   return error::Internal("Could not find debug symbols for $0", binary_path_);
 }
 
+namespace {
+
+StatusOr<std::string> ReadBytes(std::ifstream* ifs, uint64_t offset, size_t size) {
+  std::string buf(size, '\0');
+  if (!ifs->seekg(offset) || !ifs->read(buf.data(), size)) {
+    return error::Internal("Failed to read size=$0 bytes from offset=$1", size, offset);
+  }
+  return buf;
+}
+
+}  // namespace
+
+StatusOr<std::string> ElfReader::ReadBuildID(const std::string& binary_path) {
+  // Offsets into the ELF64 file header and program header, as defined in <elf.h>.
+  constexpr size_t kEhdrSize = 64;
+  constexpr size_t kEhdrPhoffPos = 32;
+  constexpr size_t kEhdrPhentsizePos = 54;
+  constexpr size_t kEhdrPhnumPos = 56;
+  constexpr size_t kPhdrOffsetPos = 8;
+  constexpr size_t kPhdrFileszPos = 32;
+  constexpr uint32_t kPTNote = 4;
+  constexpr uint32_t kNTGNUBuildID = 3;
+  constexpr uint32_t kNTGoBuildID = 4;
+  // Notes larger than this are not build-ids; avoids reading huge segments of corrupt files.
+  constexpr uint64_t kMaxNoteSegmentSize = 64 * 1024;
+
+  std::ifstream ifs(binary_path, std::ios::binary);
+  if (!ifs) {
+    return error::Internal("Failed to open binary=$0", binary_path);
+  }
+
+  PL_ASSIGN_OR_RETURN(std::string ehdr, ReadBytes(&ifs, 0, kEhdrSize));
+  if (ehdr.compare(0, 4, "\x7f" "ELF") != 0 || ehdr[4] != 2 /* ELFCLASS64 */ ||
+      ehdr[5] != 1 /* ELFDATA2LSB */) {
+    return error::Unimplemented("Binary=$0 is not a little-endian 64-bit ELF file", binary_path);
+  }
+  std::string_view ehdr_view(ehdr);
+  const auto phoff = utils::LEndianBytesToInt<uint64_t>(ehdr_view.substr(kEhdrPhoffPos));
+  const auto phentsize = utils::LEndianBytesToInt<uint16_t>(ehdr_view.substr(kEhdrPhentsizePos));
+  const auto phnum = utils::LEndianBytesToInt<uint16_t>(ehdr_view.substr(kEhdrPhnumPos));
+  if (phentsize < kPhdrFileszPos + sizeof(uint64_t)) {
+    return error::Internal("Unexpected program header size in binary=$0", binary_path);
+  }
+
+  PL_ASSIGN_OR_RETURN(std::string phdrs, ReadBytes(&ifs, phoff, phentsize * phnum));
+
+  std::string go_build_id;
+  for (int i = 0; i < phnum; ++i) {
+    std::string_view phdr = std::string_view(phdrs).substr(i * phentsize, phentsize);
+    if (utils::LEndianBytesToInt<uint32_t>(phdr) != kPTNote) {
+      continue;
+    }
+    const auto offset = utils::LEndianBytesToInt<uint64_t>(phdr.substr(kPhdrOffsetPos));
+    const auto filesz = utils::LEndianBytesToInt<uint64_t>(phdr.substr(kPhdrFileszPos));
+    if (filesz > kMaxNoteSegmentSize) {
+      continue;
+    }
+    PL_ASSIGN_OR_RETURN(std::string notes, ReadBytes(&ifs, offset, filesz));
+
+    // Each note is: namesz, descsz, type (32-bits each), then name and desc padded to 4 bytes.
+    std::string_view buf(notes);
+    constexpr size_t kNoteHeaderSize = 3 * sizeof(uint32_t);
+    while (buf.size() >= kNoteHeaderSize) {
+      const auto name_size = utils::LEndianBytesToInt<uint32_t>(buf);
+      const auto desc_size = utils::LEndianBytesToInt<uint32_t>(buf.substr(4));
+      const auto type = utils::LEndianBytesToInt<uint32_t>(buf.substr(8));
+      const size_t name_padded = (static_cast<size_t>(name_size) + 3) & ~size_t{3};
+      const size_t desc_padded = (static_cast<size_t>(desc_size) + 3) & ~size_t{3};
+      if (buf.size() < kNoteHeaderSize + name_padded + desc_padded) {
+        break;
+      }
+      std::string_view name = buf.substr(kNoteHeaderSize, name_size);
+      std::string_view desc = buf.substr(kNoteHeaderSize + name_padded, desc_size);
+
+      if (type == kNTGNUBuildID && name == std::string_view("GNU\0", 4)) {
+        return BytesToString<LowercaseHex>(desc);
+      }
+      if (type == kNTGoBuildID && name == std::string_view("Go\0\0", 4)) {
+        go_build_id = BytesToString<LowercaseHex>(desc);
+      }
+      buf.remove_prefix(kNoteHeaderSize + name_padded + desc_padded);
+    }
+  }
+
+  if (!go_build_id.empty()) {
+    return go_build_id;
+  }
+  return error::NotFound("No build-id found in binary=$0", binary_path);
+}
+
+StatusOr<std::string> ElfReader::BinaryIdentity(const std::string& binary_path) {
+  StatusOr<std::string> build_id = ReadBuildID(binary_path);
+  if (build_id.ok()) {
+    return absl::StrCat("build-id:", build_id.ValueOrDie());
+  }
+  PL_ASSIGN_OR_RETURN(struct stat sb, fs::Stat(binary_path));
+  // Inode numbers are only unique within a device, so the device is part of the key. This gives
+  // up sharing between containers on overlay filesystems, which report a device per container,
+  // but binaries without a build-id are rare.
+  return absl::Substitute("inode:$0:$1:$2:$3.$4", sb.st_dev, sb.st_ino, sb.st_size,
+                          sb.st_mtim.tv_sec, sb.st_mtim.tv_nsec);
+}
+
 // TODO(oazizi): Consider changing binary_path to std::filesystem::path.
 StatusOr<std::unique_ptr<ElfReader>> ElfReader::Create(const std::string& binary_path,
                                                        const std::filesystem::path& debug_file_dir,
@@ -383,6 +490,15 @@ StatusOr<std::optional<std::string>> ElfReader::InstrAddrToSymbol(size_t sym_add
 }
 
 StatusOr<std::unique_ptr<ElfReader::Symbolizer>> ElfReader::GetSymbolizer() {
+  return CreateSymbolizer(/* use_binary_addrs */ false);
+}
+
+StatusOr<std::unique_ptr<ElfReader::Symbolizer>> ElfReader::GetBinaryAddrSymbolizer() {
+  return CreateSymbolizer(/* use_binary_addrs */ true);
+}
+
+StatusOr<std::unique_ptr<ElfReader::Symbolizer>> ElfReader::CreateSymbolizer(
+    bool use_binary_addrs) {
   PL_ASSIGN_OR_RETURN(ELFIO::section * symtab_section, SymtabSection());
 
   auto symbolizer = std::make_unique<ElfReader::Symbolizer>();
@@ -402,34 +518,81 @@ StatusOr<std::unique_ptr<ElfReader::Symbolizer>> ElfReader::GetSymbolizer() {
     symbols.get_symbol(j, name, addr, size, bind, type, section_index, other);
 
     if (type == ELFIO::STT_FUNC) {
-      PL_ASSIGN_OR_RETURN(addr, BinaryAddrToVirtualAddr(addr));
+      if (!use_binary_addrs) {
+        PL_ASSIGN_OR_RETURN(addr, BinaryAddrToVirtualAddr(addr));
+      }
       symbolizer->AddEntry(addr, size, llvm::demangle(name));
     }
   }
 
+  symbolizer->Finalize();
   return symbolizer;
 }
 
-void ElfReader::Symbolizer::AddEntry(size_t addr, size_t size, std::string name) {
-  symbols_.emplace(addr, SymbolAddrInfo{size, std::move(name)});
+void ElfReader::Symbolizer::AddEntry(uintptr_t addr, size_t size, std::string_view name) {
+  // Symbols larger than 4GB do not exist in practice; clamp rather than widen every entry.
+  constexpr size_t kMaxSize = std::numeric_limits<uint32_t>::max();
+  addrs_.push_back(addr);
+  infos_.push_back(SymbolAddrInfo{static_cast<uint32_t>(std::min(size, kMaxSize)),
+                                  static_cast<uint32_t>(std::min(name.size(), kMaxSize)),
+                                  names_.size()});
+  names_.append(name.data(), infos_.back().name_size);
 }
 
-std::string_view ElfReader::Symbolizer::Lookup(size_t addr) const {
+void ElfReader::Symbolizer::Finalize() {
+  if (!std::is_sorted(addrs_.begin(), addrs_.end())) {
+    std::vector<uint32_t> order(addrs_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [this](uint32_t a, uint32_t b) { return addrs_[a] < addrs_[b]; });
+
+    std::vector<uintptr_t> sorted_addrs;
+    std::vector<SymbolAddrInfo> sorted_infos;
+    sorted_addrs.reserve(order.size());
+    sorted_infos.reserve(order.size());
+    for (uint32_t i : order) {
+      sorted_addrs.push_back(addrs_[i]);
+      sorted_infos.push_back(infos_[i]);
+    }
+    addrs_ = std::move(sorted_addrs);
+    infos_ = std::move(sorted_infos);
+  }
+
+  // Aliases share an address, e.g. a function and its weak alias. Keep the first one added, since
+  // Lookup() would otherwise return the last one.
+  size_t num_unique = 0;
+  for (size_t i = 0; i < addrs_.size(); ++i) {
+    if (num_unique > 0 && addrs_[i] == addrs_[num_unique - 1]) {
+      continue;
+    }
+    addrs_[num_unique] = addrs_[i];
+    infos_[num_unique] = infos_[i];
+    ++num_unique;
+  }
+  addrs_.resize(num_unique);
+  infos_.resize(num_unique);
+
+  addrs_.shrink_to_fit();
+  infos_.shrink_to_fit();
+  names_.shrink_to_fit();
+}
+
+std::string_view ElfReader::Symbolizer::Lookup(uintptr_t addr, uint64_t addr_offset) const {
   static std::string symbol_str;
 
-  // Find the first symbol for which the address_range_start > addr.
-  auto iter = symbols_.upper_bound(addr);
+  const uintptr_t lookup_addr = addr + addr_offset;
 
-  if (iter == symbols_.begin() || symbols_.empty()) {
-    symbol_str = absl::StrFormat("0x%016llx", addr);
-    return symbol_str;
-  }
+  // Find the first symbol for which the address_range_start > lookup_addr.
+  auto iter = std::upper_bound(addrs_.begin(), addrs_.end(), lookup_addr);
 
-  // std::upper_bound will make us overshoot our potential match,
-  // so go back by one, and check if it is indeed a match.
-  --iter;
-  if (addr >= iter->first && addr < iter->first + iter->second.size) {
-    return iter->second.name;
+  if (iter != addrs_.begin()) {
+    // std::upper_bound will make us overshoot our potential match,
+    // so go back by one, and check if it is indeed a match.
+    --iter;
+    const SymbolAddrInfo& info = infos_[iter - addrs_.begin()];
+    if (lookup_addr < *iter + info.size) {
+      return std::string_view(names_).substr(info.name_offset, info.name_size);
+    }
   }
 
   // Couldn't find the address.
@@ -488,7 +651,8 @@ std::vector<uint64_t> FindRetInsts(utils::u8string_view byte_code) {
 
   // TODO(yzhao): This is a short-term quick way to avoid unnecessary overheads.
   // We should create LLVMDisasmContext object inside SocketTraceConnector and pass it around.
-  static const LLVMDisasmContext kLLVMDisasmContext;
+  // The context is not safe to share between threads, and binaries may be analyzed concurrently.
+  static thread_local const LLVMDisasmContext kLLVMDisasmContext;
 
   // Size of the buffer to hold disassembled assembly code. Since we do not really use the assembly
   // code, we just provide a small buffer.
@@ -604,22 +768,33 @@ Status ElfReader::CalculateVirtToBinaryAddrConversion() {
     return {statuspb::INVALID_ARGUMENT,
             "Must specify PID to use symbol resolution functions in ElfReader"};
   }
+  PL_ASSIGN_OR_RETURN(uint64_t mapped_segment_start, ProcMappedSegmentStart(pid_));
+  PL_ASSIGN_OR_RETURN(uint64_t elf_segment_start, ElfSegmentStart());
+
+  virtual_to_binary_addr_offset_ = elf_segment_start - mapped_segment_start;
+  return Status::OK();
+}
+
+StatusOr<uint64_t> ElfReader::ProcMappedSegmentStart(int64_t pid) {
   system::ProcParser parser;
   std::vector<system::ProcParser::ProcessSMaps> map_entries;
   // This is a little inefficient as we only need the first entry.
-  PL_RETURN_IF_ERROR(parser.ParseProcPIDMaps(pid_, &map_entries));
+  PL_RETURN_IF_ERROR(parser.ParseProcPIDMaps(pid, &map_entries));
   if (map_entries.size() < 1) {
-    return {statuspb::INTERNAL, "Failed to parse /proc/$pid/maps to work out address conversion"};
+    return Status(statuspb::INTERNAL,
+                  "Failed to parse /proc/$pid/maps to work out address conversion");
   }
   auto mapped_virt_addr = map_entries[0].vmem_start;
   uint64_t mapped_offset;
   if (!absl::SimpleHexAtoi(map_entries[0].offset, &mapped_offset)) {
-    return {statuspb::INTERNAL,
-            "Failed to parse offset in /proc/$pid/maps to work out address conversion"};
+    return Status(statuspb::INTERNAL,
+                  "Failed to parse offset in /proc/$pid/maps to work out address conversion");
   }
 
-  uint64_t mapped_segment_start = mapped_virt_addr - mapped_offset;
+  return mapped_virt_addr - mapped_offset;
+}
 
+StatusOr<uint64_t> ElfReader::ElfSegmentStart() {
   const ELFIO::segment* first_loadable_segment = nullptr;
   for (int i = 0; i < elf_reader_.segments.size(); i++) {
     ELFIO::segment* segment = elf_reader_.segments[i];
@@ -630,16 +805,13 @@ Status ElfReader::CalculateVirtToBinaryAddrConversion() {
   }
 
   if (first_loadable_segment == nullptr) {
-    return {statuspb::INTERNAL,
-            "Calculating virtual to binary offset failed because there are no loadable segments in "
-            "elf file"};
+    return Status(statuspb::INTERNAL,
+                  "Calculating virtual to binary offset failed because there are no loadable "
+                  "segments in elf file");
   }
   uint64_t elf_virt_addr = first_loadable_segment->get_virtual_address();
   uint64_t elf_offset = first_loadable_segment->get_offset();
-  uint64_t elf_segment_start = elf_virt_addr - elf_offset;
-
-  virtual_to_binary_addr_offset_ = elf_segment_start - mapped_segment_start;
-  return Status::OK();
+  return elf_virt_addr - elf_offset;
 }
 
 }  // namespace obj_tools
@@ -23,7 +23,6 @@
 #include <string>
 #include <vector>
 
-#include <absl/container/btree_map.h>
 #include <absl/container/flat_hash_map.h>
 
 #include <elfio/elfio.hpp>
@@ -59,6 +58,29 @@ class ElfReader {
     return elf_reader;
   }
 
+  /**
+   * Reads the build-id of a binary from its PT_NOTE segments, without loading the rest of the ELF.
+   * The GNU build-id is preferred; the Go build-id is used as a fall-back.
+   *
+   * @return The build-id as a lowercase hex string, or NotFound if the binary has none.
+   */
+  static StatusOr<std::string> ReadBuildID(const std::string& binary_path);
+
+  /**
+   * Returns a key that identifies the contents of a binary, so that work derived from the binary
+   * can be shared between processes (and containers) that run the same file.
+   * The build-id is used when present; otherwise the key is derived from the file's device, inode,
+   * size and modification time.
+   */
+  static StatusOr<std::string> BinaryIdentity(const std::string& binary_path);
+
+  /**
+   * Returns the address at which the first loadable segment of the process would start if it
+   * were mapped from file offset 0. Comparing this with the same value in the ELF file gives the
+   * offset between virtual and binary addresses. See CalculateVirtToBinaryAddrConversion().
+   */
+  static StatusOr<uint64_t> ProcMappedSegmentStart(int64_t pid);
+
   std::filesystem::path& debug_symbols_path() { return debug_symbols_path_; }
 
   struct SymbolInfo {
@@ -136,27 +158,67 @@ class ElfReader {
     /**
      * Associate the address range [addr, addr+size] with the provided symbol name.
      * No checking is performed for overlapping regions, which will result in undefined behavior.
+     * Finalize() must be called after the last entry is added, and before any Lookup().
+     */
+    void AddEntry(uintptr_t addr, size_t size, std::string_view name);
+
+    /**
+     * Sorts the entries by address, keeps only the first entry added at each address, and
+     * releases excess capacity.
      */
-    void AddEntry(uintptr_t addr, size_t size, std::string name);
+    void Finalize();
 
     /**
-     * Lookup the symbol for the specified address. The address should be a virtual address (as
-     * opposed to a "binary" address).
+     * Lookup the symbol for the specified address.
+     *
+     * @param addr The address to symbolize.
+     * @param addr_offset Offset added to addr before the lookup. This allows a symbolizer that
+     *                    holds "binary" addresses to be used with virtual addresses.
      */
-    std::string_view Lookup(uintptr_t addr) const;
+    std::string_view Lookup(uintptr_t addr, uint64_t addr_offset = 0) const;
+
+    size_t num_entries() const { return addrs_.size(); }
+
+    // Approximate heap usage of the symbol table, in bytes.
+    size_t MemoryUsage() const {
+      return addrs_.capacity() * sizeof(uintptr_t) + infos_.capacity() * sizeof(SymbolAddrInfo) +
+             names_.capacity();
+    }
 
    private:
     struct SymbolAddrInfo {
-      size_t size;
-      std::string name;
+      uint32_t size;
+      uint32_t name_size;
+      uint64_t name_offset;
     };
 
-    // Key is an address.
-    absl::btree_map<uintptr_t, SymbolAddrInfo> symbols_;
+    // Sorted start addresses, kept separate from the other fields so the binary search only
+    // touches this array. infos_[i] describes the symbol starting at addrs_[i].
+    std::vector<uintptr_t> addrs_;
+    std::vector<SymbolAddrInfo> infos_;
+
+    // All symbol names, concatenated.
+    std::string names_;
   };
 
+  /**
+   * Returns a symbolizer for the function symbols of the binary, keyed on virtual addresses.
+   * Requires the ElfReader to have been created with a PID.
+   */
   StatusOr<std::unique_ptr<Symbolizer>> GetSymbolizer();
 
+  /**
+   * Like GetSymbolizer(), but keyed on "binary" addresses (what `nm` would display).
+   * The result does not depend on where the binary was loaded, so it can be shared by all
+   * processes running the same binary.
+   */
+  StatusOr<std::unique_ptr<Symbolizer>> GetBinaryAddrSymbolizer();
+
+  /**
+   * Returns the virtual address of the first loadable segment, minus its file offset.
+   */
+  StatusOr<uint64_t> ElfSegmentStart();
+
   /**
    * Returns the address of the return instructions of the function.
    */
@@ -202,6 +264,8 @@ class ElfReader {
   Status CalculateVirtToBinaryAddrConversion();
   Status EnsureVirtToBinaryCalculated();
 
+  StatusOr<std::unique_ptr<Symbolizer>> CreateSymbolizer(bool use_binary_addrs);
+
   std::string binary_path_;
 
   std::filesystem::path debug_symbols_path_;
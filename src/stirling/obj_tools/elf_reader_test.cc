@@ -18,6 +18,9 @@
 
 #include "src/stirling/obj_tools/elf_reader.h"
 
+#include <sys/stat.h>
+
+#include "src/common/base/file.h"
 #include "src/common/exec/exec.h"
 #include "src/common/testing/test_environment.h"
 #include "src/common/testing/testing.h"
@@ -197,6 +200,67 @@ TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
                      ElementsAre(SymbolNameIs("CanYouFindThis")));
 }
 
+TEST(ElfReaderTest, ReadBuildID) {
+  const std::string stripped_bin =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
+  EXPECT_OK_AND_EQ(ElfReader::ReadBuildID(stripped_bin), "7deb0e3f89deba61");
+  EXPECT_NOT_OK(ElfReader::ReadBuildID("/bogus"));
+}
+
+TEST(ElfReaderTest, BinaryIdentity) {
+  const std::string stripped_bin =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
+  EXPECT_OK_AND_EQ(ElfReader::BinaryIdentity(stripped_bin), "build-id:7deb0e3f89deba61");
+
+  // Without a build-id, the key is made from the stat of the file, including its device.
+  px::testing::TempDir temp_dir;
+  const std::string path = (temp_dir.path() / "no_build_id").string();
+  ASSERT_OK(WriteFileFromString(path, "not an ELF file"));
+  struct stat sb;
+  ASSERT_EQ(stat(path.c_str(), &sb), 0);
+  ASSERT_OK_AND_ASSIGN(std::string key, ElfReader::BinaryIdentity(path));
+  EXPECT_THAT(key, ::testing::StartsWith(absl::Substitute("inode:$0:$1:", sb.st_dev, sb.st_ino)));
+  EXPECT_NOT_OK(ElfReader::BinaryIdentity("/bogus"));
+}
+
+TEST(ElfReaderTest, SymbolizerLookup) {
+  ElfReader::Symbolizer symbolizer;
+  // Entries are intentionally added out of order.
+  symbolizer.AddEntry(0x3000, 0x10, "baz");
+  symbolizer.AddEntry(0x1000, 0x100, "foo");
+  symbolizer.AddEntry(0x2000, 0x100, "bar");
+  symbolizer.Finalize();
+
+  EXPECT_EQ(symbolizer.num_entries(), 3);
+  EXPECT_EQ(symbolizer.Lookup(0x1000), "foo");
+  EXPECT_EQ(symbolizer.Lookup(0x10ff), "foo");
+  EXPECT_EQ(symbolizer.Lookup(0x2080), "bar");
+  EXPECT_EQ(symbolizer.Lookup(0x300f), "baz");
+  EXPECT_EQ(symbolizer.Lookup(0x1100), "0x0000000000001100");
+  EXPECT_EQ(symbolizer.Lookup(0x10), "0x0000000000000010");
+
+  // The offset is applied before the lookup, but the original address is reported on a miss.
+  EXPECT_EQ(symbolizer.Lookup(0x80, 0x1000), "foo");
+  EXPECT_EQ(symbolizer.Lookup(0x180, 0x1000), "0x0000000000000180");
+}
+
+TEST(ElfReaderTest, SymbolizerLookupAliases) {
+  ElfReader::Symbolizer symbolizer;
+  symbolizer.AddEntry(0x2000, 0x100, "bar");
+  symbolizer.AddEntry(0x1000, 0x100, "foo");
+  // Aliases of foo and bar, e.g. weak symbols.
+  symbolizer.AddEntry(0x1000, 0x100, "foo_alias");
+  symbolizer.AddEntry(0x2000, 0x10, "bar_alias");
+  symbolizer.Finalize();
+
+  // The first symbol added at an address wins.
+  EXPECT_EQ(symbolizer.num_entries(), 2);
+  EXPECT_EQ(symbolizer.Lookup(0x1000), "foo");
+  EXPECT_EQ(symbolizer.Lookup(0x10ff), "foo");
+  EXPECT_EQ(symbolizer.Lookup(0x2000), "bar");
+  EXPECT_EQ(symbolizer.Lookup(0x2080), "bar");
+}
+
 TEST(ElfReaderTest, ExternalDebugSymbolsDebugLink) {
   const std::string stripped_bin =
       px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/test_exe_debuglink");
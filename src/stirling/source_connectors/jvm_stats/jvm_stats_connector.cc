@@ -69,21 +69,23 @@ void JVMStatsConnector::FindJavaUPIDs(const ConnectorContext& ctx) {
   }
 }
 
-Status JVMStatsConnector::ExportStats(const md::UPID& upid,
-                                      const std::filesystem::path& hsperf_data_path,
-                                      DataTable* data_table) const {
-  PL_ASSIGN_OR_RETURN(std::string hsperf_data_str, ReadFileToString(hsperf_data_path));
-
-  if (hsperf_data_str.empty()) {
-    // Assume this is a transient failure.
-    return Status::OK();
+Status JVMStatsConnector::ExportStats(const md::UPID& upid, JavaProcInfo* java_proc,
+                                      DataTable* data_table) {
+  if (java_proc->stats_reader == nullptr) {
+    auto stats_reader_or = java::StatsReader::Create(java_proc->hsperf_data_path);
+    if (error::IsResourceUnavailable(stats_reader_or.status())) {
+      // The file is still empty. Assume this is a transient failure.
+      return Status::OK();
+    }
+    PL_ASSIGN_OR_RETURN(java_proc->stats_reader, std::move(stats_reader_or));
   }
 
-  java::Stats stats(std::move(hsperf_data_str));
-  if (!stats.Parse().ok()) {
+  auto stats_or = java_proc->stats_reader->Read();
+  if (!stats_or.ok()) {
     // Assumes this is a transient failure.
     return Status::OK();
   }
+  const java::Stats& stats = stats_or.ValueOrDie();
 
   uint64_t time = AdjustedSteadyClockNowNS();
 
@@ -114,7 +116,7 @@ void JVMStatsConnector::TransferDataImpl(ConnectorContext* ctx) {
     JavaProcInfo& java_proc = iter->second;
 
     md::UPID upid_with_asid(ctx->GetASID(), upid.pid(), upid.start_ts());
-    auto status = ExportStats(upid_with_asid, java_proc.hsperf_data_path, data_table);
+    auto status = ExportStats(upid_with_asid, &java_proc, data_table);
     if (!status.ok()) {
       ++java_proc.export_failure_count;
     }
@@ -19,7 +19,13 @@
 #include "src/stirling/source_connectors/jvm_stats/utils/java.h"
 
 #include <absl/strings/match.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <string>
@@ -43,6 +49,46 @@ using ::px::system::ProcParser;
 using ::px::system::ProcPidRootPath;
 using ::px::utils::LEndianBytesToInt;
 
+namespace {
+
+constexpr std::string_view kYoungGCTimeSuffix = "gc.collector.0.time";
+constexpr std::string_view kFullGCTimeSuffix = "gc.collector.1.time";
+constexpr std::string_view kUsedHeapSizeSuffixes[] = {
+    "gc.generation.0.space.0.used",
+    "gc.generation.0.space.1.used",
+    "gc.generation.0.space.2.used",
+    "gc.generation.1.space.0.used",
+};
+constexpr std::string_view kTotalHeapSizeSuffixes[] = {
+    "gc.generation.0.space.0.capacity",
+    "gc.generation.0.space.1.capacity",
+    "gc.generation.0.space.2.capacity",
+    "gc.generation.1.space.0.capacity",
+};
+constexpr std::string_view kMaxHeapSizeSuffixes[] = {
+    "gc.generation.0.maxCapacity",
+    "gc.generation.1.maxCapacity",
+};
+
+// The suffixes of all the counters used by Stats.
+std::vector<std::string_view> AllStatSuffixes() {
+  std::vector<std::string_view> suffixes = {kYoungGCTimeSuffix, kFullGCTimeSuffix};
+  suffixes.insert(suffixes.end(), std::begin(kUsedHeapSizeSuffixes),
+                  std::end(kUsedHeapSizeSuffixes));
+  suffixes.insert(suffixes.end(), std::begin(kTotalHeapSizeSuffixes),
+                  std::end(kTotalHeapSizeSuffixes));
+  suffixes.insert(suffixes.end(), std::begin(kMaxHeapSizeSuffixes),
+                  std::end(kMaxHeapSizeSuffixes));
+  return suffixes;
+}
+
+const std::vector<std::string_view>& StatSuffixes() {
+  static const std::vector<std::string_view> kSuffixes = AllStatSuffixes();
+  return kSuffixes;
+}
+
+}  // namespace
+
 Stats::Stats(std::vector<Stat> stats) : stats_(std::move(stats)) {}
 
 Stats::Stats(std::string hsperf_data_str) : hsperf_data_(std::move(hsperf_data_str)) {}
@@ -60,33 +106,20 @@ Status Stats::Parse() {
   return Status::OK();
 }
 
-uint64_t Stats::YoungGCTimeNanos() const { return StatForSuffix("gc.collector.0.time"); }
+uint64_t Stats::YoungGCTimeNanos() const { return StatForSuffix(kYoungGCTimeSuffix); }
 
-uint64_t Stats::FullGCTimeNanos() const { return StatForSuffix("gc.collector.1.time"); }
+uint64_t Stats::FullGCTimeNanos() const { return StatForSuffix(kFullGCTimeSuffix); }
 
 uint64_t Stats::UsedHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.space.0.used",
-      "gc.generation.0.space.1.used",
-      "gc.generation.0.space.2.used",
-      "gc.generation.1.space.0.used",
-  });
+  return SumStatsForSuffixes(kUsedHeapSizeSuffixes);
 }
 
 uint64_t Stats::TotalHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.space.0.capacity",
-      "gc.generation.0.space.1.capacity",
-      "gc.generation.0.space.2.capacity",
-      "gc.generation.1.space.0.capacity",
-  });
+  return SumStatsForSuffixes(kTotalHeapSizeSuffixes);
 }
 
 uint64_t Stats::MaxHeapSizeBytes() const {
-  return SumStatsForSuffixes({
-      "gc.generation.0.maxCapacity",
-      "gc.generation.1.maxCapacity",
-  });
+  return SumStatsForSuffixes(kMaxHeapSizeSuffixes);
 }
 
 uint64_t Stats::StatForSuffix(std::string_view suffix) const {
@@ -98,7 +131,7 @@ uint64_t Stats::StatForSuffix(std::string_view suffix) const {
   return 0;
 }
 
-uint64_t Stats::SumStatsForSuffixes(const std::vector<std::string_view>& suffixes) const {
+uint64_t Stats::SumStatsForSuffixes(absl::Span<const std::string_view> suffixes) const {
   uint64_t sum = 0;
   for (const auto& suffix : suffixes) {
     sum += StatForSuffix(suffix);
@@ -106,6 +139,106 @@ uint64_t Stats::SumStatsForSuffixes(const std::vector<std::string_view>& suffixe
   return sum;
 }
 
+StatusOr<std::unique_ptr<StatsReader>> StatsReader::Create(
+    const std::filesystem::path& hsperf_data_path) {
+  int fd = open(hsperf_data_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Failed to open file $0: $1.", hsperf_data_path.string(),
+                           std::strerror(errno));
+  }
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) != 0) {
+    close(fd);
+    return error::Internal("Failed to stat file $0: $1.", hsperf_data_path.string(),
+                           std::strerror(errno));
+  }
+  if (static_cast<size_t>(statbuf.st_size) < sizeof(hsperf::Prologue)) {
+    close(fd);
+    // The JVM creates the file before setting its size.
+    return error::ResourceUnavailable("File $0 is not initialized yet.", hsperf_data_path.string());
+  }
+  return std::unique_ptr<StatsReader>(new StatsReader(fd));
+}
+
+StatsReader::~StatsReader() { close(fd_); }
+
+Status StatsReader::ReadAt(size_t offset, size_t size, std::string* buf) const {
+  buf->resize(size);
+  ssize_t n = pread(fd_, buf->data(), size, offset);
+  if (n < 0) {
+    return error::Internal("pread() failed: $0.", std::strerror(errno));
+  }
+  if (static_cast<size_t>(n) < size) {
+    return error::Internal("hsperfdata file ends at $0, before the $1 bytes at offset $2.",
+                           offset + n, size, offset);
+  }
+  return Status::OK();
+}
+
+Status StatsReader::ResolveOffsets() {
+  struct stat statbuf;
+  if (fstat(fd_, &statbuf) != 0) {
+    return error::Internal("Failed to stat hsperfdata file: $0.", std::strerror(errno));
+  }
+  std::string file;
+  PL_RETURN_IF_ERROR(ReadAt(0, statbuf.st_size, &file));
+  hsperf::HsperfData hsperf_data = {};
+  PL_RETURN_IF_ERROR(ParseHsperfData(file, &hsperf_data));
+
+  const std::vector<std::string_view>& suffixes = StatSuffixes();
+  value_offsets_.assign(suffixes.size(), std::string_view::npos);
+  values_begin_ = file.size();
+  values_end_ = 0;
+  for (const auto& entry : hsperf_data.data_entries) {
+    if (entry.header->data_type != static_cast<uint8_t>(hsperf::DataType::kLong) ||
+        entry.data.size() < sizeof(uint64_t)) {
+      continue;
+    }
+    for (size_t i = 0; i < suffixes.size(); ++i) {
+      // Like Stats::StatForSuffix(), the first matching entry wins.
+      if (value_offsets_[i] == std::string_view::npos && absl::EndsWith(entry.name, suffixes[i])) {
+        value_offsets_[i] = entry.data.data() - file.data();
+        values_begin_ = std::min(values_begin_, value_offsets_[i]);
+        values_end_ = std::max(values_end_, value_offsets_[i] + sizeof(uint64_t));
+      }
+    }
+  }
+
+  resolved_mod_timestamp_ = hsperf_data.prologue->mod_timestamp;
+  resolved_num_entries_ = hsperf_data.prologue->num_entries;
+  offsets_resolved_ = true;
+  return Status::OK();
+}
+
+StatusOr<Stats> StatsReader::Read() {
+  PL_RETURN_IF_ERROR(ReadAt(0, sizeof(hsperf::Prologue), &buf_));
+  const auto* prologue = reinterpret_cast<const hsperf::Prologue*>(buf_.data());
+  if (prologue->accessible == 0) {
+    return error::ResourceUnavailable("The JVM has not finished initializing hsperfdata.");
+  }
+  if (!offsets_resolved_ || prologue->mod_timestamp != resolved_mod_timestamp_ ||
+      prologue->num_entries != resolved_num_entries_) {
+    PL_RETURN_IF_ERROR(ResolveOffsets());
+  }
+
+  std::vector<Stats::Stat> stats;
+  if (values_begin_ >= values_end_) {
+    return Stats(std::move(stats));
+  }
+  PL_RETURN_IF_ERROR(ReadAt(values_begin_, values_end_ - values_begin_, &buf_));
+
+  const std::vector<std::string_view>& suffixes = StatSuffixes();
+  stats.reserve(suffixes.size());
+  for (size_t i = 0; i < suffixes.size(); ++i) {
+    if (value_offsets_[i] == std::string_view::npos) {
+      continue;
+    }
+    std::string_view value(buf_.data() + value_offsets_[i] - values_begin_, sizeof(uint64_t));
+    stats.push_back({suffixes[i], LEndianBytesToInt<uint64_t>(value)});
+  }
+  return Stats(std::move(stats));
+}
+
 StatusOr<std::filesystem::path> HsperfdataPath(pid_t pid) {
   ProcParser parser;
 
@@ -19,11 +19,15 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include <absl/types/span.h>
+
+#include "src/common/base/base.h"
 #include "src/common/base/statusor.h"
 
 namespace px {
@@ -58,12 +62,63 @@ class Stats {
 
  private:
   uint64_t StatForSuffix(std::string_view suffix) const;
-  uint64_t SumStatsForSuffixes(const std::vector<std::string_view>& suffixes) const;
+  uint64_t SumStatsForSuffixes(absl::Span<const std::string_view> suffixes) const;
 
   std::string hsperf_data_;
   std::vector<Stat> stats_;
 };
 
+/**
+ * StatsReader keeps the hsperfdata file of a JVM open, and reads the stats from it with pread().
+ *
+ * The data entries are only parsed on the first read, and again whenever the JVM has created new
+ * entries since. The parsing records the offsets of the values of the counters that Stats uses, so
+ * that other reads only load the prologue and the range holding those values, instead of reading
+ * and parsing the whole file. A file that shrinks under the reader fails the read, rather than
+ * faulting as a mapping of it would.
+ */
+class StatsReader : public NotCopyable {
+ public:
+  static StatusOr<std::unique_ptr<StatsReader>> Create(
+      const std::filesystem::path& hsperf_data_path);
+
+  ~StatsReader();
+
+  /**
+   * Reads the current values of the stats. Returns ResourceUnavailable if the JVM has not finished
+   * initializing the file yet.
+   */
+  StatusOr<Stats> Read();
+
+ private:
+  explicit StatsReader(int fd) : fd_(fd) {}
+
+  // Reads size bytes from the offset into buf. Fails if the file ends before, e.g. when it was
+  // truncated.
+  Status ReadAt(size_t offset, size_t size, std::string* buf) const;
+
+  // Parses the data entries, and records the offsets of the values of the needed counters.
+  Status ResolveOffsets();
+
+  const int fd_;
+
+  // The modification timestamp and entry count of the file when the offsets were resolved.
+  // The JVM updates both whenever it creates new entries.
+  bool offsets_resolved_ = false;
+  uint64_t resolved_mod_timestamp_ = 0;
+  uint32_t resolved_num_entries_ = 0;
+
+  // The offset of the value of each counter in the file, or std::string_view::npos if the file
+  // has no such counter.
+  std::vector<size_t> value_offsets_;
+  // The range of the file that holds all the values, read at once.
+  size_t values_begin_ = 0;
+  size_t values_end_ = 0;
+
+  // Reused between reads.
+  std::string buf_;
+};
+
 /**
  * Returns the path of the hsperfdata for a JVM process.
  */
@@ -22,6 +22,7 @@
 #include <gtest/gtest.h>
 
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <string_view>
 
@@ -59,6 +60,67 @@ TEST(StatsTest, CommonValues) {
   EXPECT_EQ(2, stats.MaxHeapSizeBytes());
 }
 
+constexpr char kTestHsperfdataPath[] =
+    "src/stirling/source_connectors/jvm_stats/utils/test_hsperfdata";
+
+// Tests that StatsReader reads the same values as parsing the whole file.
+TEST(StatsReaderTest, MatchesParsedStats) {
+  const std::filesystem::path hsperfdata_path = testing::BazelRunfilePath(kTestHsperfdataPath);
+  ASSERT_OK_AND_ASSIGN(std::string content, ReadFileToString(hsperfdata_path));
+  Stats expected(std::move(content));
+  ASSERT_OK(expected.Parse());
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<StatsReader> reader, StatsReader::Create(hsperfdata_path));
+  // The second read uses the offsets resolved by the first one.
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK_AND_ASSIGN(Stats stats, reader->Read());
+    EXPECT_EQ(stats.YoungGCTimeNanos(), expected.YoungGCTimeNanos());
+    EXPECT_EQ(stats.FullGCTimeNanos(), expected.FullGCTimeNanos());
+    EXPECT_EQ(stats.UsedHeapSizeBytes(), expected.UsedHeapSizeBytes());
+    EXPECT_EQ(stats.TotalHeapSizeBytes(), expected.TotalHeapSizeBytes());
+    EXPECT_EQ(stats.MaxHeapSizeBytes(), expected.MaxHeapSizeBytes());
+  }
+  EXPECT_GT(expected.MaxHeapSizeBytes(), 0);
+}
+
+// Tests that StatsReader does not read a file that the JVM has not finished initializing.
+TEST(StatsReaderTest, NotAccessible) {
+  ASSERT_OK_AND_ASSIGN(std::string content,
+                       ReadFileToString(testing::BazelRunfilePath(kTestHsperfdataPath)));
+  // See hsperf::Prologue.
+  constexpr size_t kAccessibleOffset = 7;
+  content[kAccessibleOffset] = 0;
+
+  testing::TempDir temp_dir;
+  const std::filesystem::path hsperfdata_path = temp_dir.path() / "hsperfdata";
+  ASSERT_OK(WriteFileFromString(hsperfdata_path, content));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<StatsReader> reader, StatsReader::Create(hsperfdata_path));
+  EXPECT_TRUE(error::IsResourceUnavailable(reader->Read().status()));
+
+  const std::filesystem::path empty_path = temp_dir.path() / "empty";
+  ASSERT_OK(WriteFileFromString(empty_path, ""));
+  EXPECT_TRUE(error::IsResourceUnavailable(StatsReader::Create(empty_path).status()));
+}
+
+// Tests that StatsReader fails the reads of a file that was truncated under it.
+TEST(StatsReaderTest, Truncated) {
+  ASSERT_OK_AND_ASSIGN(std::string content,
+                       ReadFileToString(testing::BazelRunfilePath(kTestHsperfdataPath)));
+  testing::TempDir temp_dir;
+  const std::filesystem::path hsperfdata_path = temp_dir.path() / "hsperfdata";
+  ASSERT_OK(WriteFileFromString(hsperfdata_path, content));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<StatsReader> reader, StatsReader::Create(hsperfdata_path));
+  ASSERT_OK(reader->Read());
+
+  // Keep the prologue, so that only the values are missing.
+  std::filesystem::resize_file(hsperfdata_path, 64);
+  EXPECT_NOT_OK(reader->Read());
+  std::filesystem::resize_file(hsperfdata_path, 0);
+  EXPECT_NOT_OK(reader->Read());
+}
+
 TEST(HsperfdataPathTest, ResultIsAsExpected) {
   const char kClassPath[] = "src/stirling/source_connectors/jvm_stats/testing/HelloWorld.jar";
   const std::string class_path = testing::BazelRunfilePath(kClassPath);
@@ -17,10 +17,13 @@
  */
 
 #include <memory>
+#include <string>
+#include <utility>
 
 #include <absl/functional/bind_front.h>
 
 #include "src/common/base/base.h"
+#include "src/common/system/proc_parser.h"
 #include "src/common/system/proc_pid_path.h"
 #include "src/stirling/obj_tools/elf_reader.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/elf_symbolizer.h"
@@ -38,14 +41,53 @@ StatusOr<std::unique_ptr<Symbolizer>> ElfSymbolizer::Create() {
   return symbolizer;
 }
 
-void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) { symbolizers_.erase(upid); }
+void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) {
+  auto iter = symbolizers_.find(upid);
+  if (iter == symbolizers_.end()) {
+    return;
+  }
+  std::string binary_key = std::move(iter->second->binary_key);
+  symbolizers_.erase(iter);
 
-StatusOr<std::unique_ptr<ElfReader::Symbolizer>> CreateUPIDSymbolizer(const struct upid_t& upid) {
+  auto binary_iter = binary_symbolizers_.find(binary_key);
+  if (binary_iter != binary_symbolizers_.end() && binary_iter->second.expired()) {
+    binary_symbolizers_.erase(binary_iter);
+  }
+}
+
+StatusOr<std::unique_ptr<ElfSymbolizer::UPIDSymbolizer>> ElfSymbolizer::CreateUPIDSymbolizer(
+    const struct upid_t& upid) {
   const pid_t pid = upid.pid;
   const system::ProcParser proc_parser;
   PL_ASSIGN_OR_RETURN(const auto proc_exe, proc_parser.GetExePath(pid));
-  PL_ASSIGN_OR_RETURN(auto elf_reader, ElfReader::Create(ProcPidRootPath(pid, proc_exe.string())));
-  return elf_reader->GetSymbolizer();
+  const std::string binary_path = ProcPidRootPath(pid, proc_exe.string());
+
+  auto upid_symbolizer = std::make_unique<UPIDSymbolizer>();
+  PL_ASSIGN_OR_RETURN(upid_symbolizer->binary_key, ElfReader::BinaryIdentity(binary_path));
+
+  std::shared_ptr<const BinarySymbolizer> binary_symbolizer;
+  auto iter = binary_symbolizers_.find(upid_symbolizer->binary_key);
+  if (iter != binary_symbolizers_.end()) {
+    binary_symbolizer = iter->second.lock();
+  }
+  if (binary_symbolizer == nullptr) {
+    PL_ASSIGN_OR_RETURN(auto elf_reader, ElfReader::Create(binary_path));
+    auto new_binary_symbolizer = std::make_shared<BinarySymbolizer>();
+    PL_ASSIGN_OR_RETURN(new_binary_symbolizer->symbolizer, elf_reader->GetBinaryAddrSymbolizer());
+    PL_ASSIGN_OR_RETURN(new_binary_symbolizer->elf_segment_start, elf_reader->ElfSegmentStart());
+    VLOG(1) << absl::Substitute("Created symbol table for $0 [key=$1 entries=$2 bytes=$3]",
+                                binary_path, upid_symbolizer->binary_key,
+                                new_binary_symbolizer->symbolizer->num_entries(),
+                                new_binary_symbolizer->symbolizer->MemoryUsage());
+    binary_symbolizer = std::move(new_binary_symbolizer);
+    binary_symbolizers_[upid_symbolizer->binary_key] = binary_symbolizer;
+  }
+
+  PL_ASSIGN_OR_RETURN(uint64_t mapped_segment_start, ElfReader::ProcMappedSegmentStart(pid));
+  upid_symbolizer->virtual_to_binary_addr_offset =
+      binary_symbolizer->elf_segment_start - mapped_segment_start;
+  upid_symbolizer->binary_symbolizer = std::move(binary_symbolizer);
+  return upid_symbolizer;
 }
 
 std::string_view EmptySymbolizerFn(const uintptr_t addr) {
@@ -62,20 +104,20 @@ profiler::SymbolizerFn ElfSymbolizer::GetSymbolizerFn(const struct upid_t& upid)
     return profiler::SymbolizerFn(&(BogusKernelSymbolizerFn));
   }
 
-  std::unique_ptr<ElfReader::Symbolizer>& upid_symbolizer = symbolizers_[upid];
+  std::unique_ptr<UPIDSymbolizer>& upid_symbolizer = symbolizers_[upid];
   if (upid_symbolizer == nullptr) {
-    StatusOr<std::unique_ptr<ElfReader::Symbolizer>> upid_symbolizer_status =
-        CreateUPIDSymbolizer(upid);
+    StatusOr<std::unique_ptr<UPIDSymbolizer>> upid_symbolizer_status = CreateUPIDSymbolizer(upid);
     if (!upid_symbolizer_status.ok()) {
       VLOG(1) << absl::Substitute("Failed to create Symbolizer function for $0 [error=$1]",
                                   upid.pid, upid_symbolizer_status.ToString());
+      symbolizers_.erase(upid);
       return profiler::SymbolizerFn(&(EmptySymbolizerFn));
     }
 
     upid_symbolizer = upid_symbolizer_status.ConsumeValueOrDie();
   }
 
-  return absl::bind_front(&ElfReader::Symbolizer::Lookup, upid_symbolizer.get());
+  return absl::bind_front(&UPIDSymbolizer::Lookup, upid_symbolizer.get());
 }
 
 }  // namespace stirling
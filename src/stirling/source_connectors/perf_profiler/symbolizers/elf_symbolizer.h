@@ -19,6 +19,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
 
@@ -37,13 +38,39 @@ class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
   void DeleteUPID(const struct upid_t& upid) override;
   bool Uncacheable(const struct upid_t& /*upid*/) override { return false; }
 
+  // Number of distinct binaries for which a symbol table is currently held.
+  size_t num_binary_symbolizers() const { return binary_symbolizers_.size(); }
+
  private:
   ElfSymbolizer() = default;
 
+  // The symbol table of a binary, in binary addresses. Shared by all processes running it.
+  struct BinarySymbolizer {
+    std::unique_ptr<obj_tools::ElfReader::Symbolizer> symbolizer;
+    // See ElfReader::ElfSegmentStart().
+    uint64_t elf_segment_start;
+  };
+
+  // Applies the load address of a process to a shared symbol table.
+  struct UPIDSymbolizer {
+    std::string binary_key;
+    std::shared_ptr<const BinarySymbolizer> binary_symbolizer;
+    // Added to a virtual address to get the binary address.
+    uint64_t virtual_to_binary_addr_offset;
+
+    std::string_view Lookup(uintptr_t addr) const {
+      return binary_symbolizer->symbolizer->Lookup(addr, virtual_to_binary_addr_offset);
+    }
+  };
+
+  StatusOr<std::unique_ptr<UPIDSymbolizer>> CreateUPIDSymbolizer(const struct upid_t& upid);
+
   // A symbolizer per UPID.
-  absl::flat_hash_map<struct upid_t,
-                      std::unique_ptr<px::stirling::obj_tools::ElfReader::Symbolizer>>
-      symbolizers_;
+  absl::flat_hash_map<struct upid_t, std::unique_ptr<UPIDSymbolizer>> symbolizers_;
+
+  // Symbol tables keyed by binary identity (build-id, or inode/size/mtime as a fall-back).
+  // Entries expire once the last UPID using them is deleted.
+  absl::flat_hash_map<std::string, std::weak_ptr<const BinarySymbolizer>> binary_symbolizers_;
 };
 
 }  // namespace stirling
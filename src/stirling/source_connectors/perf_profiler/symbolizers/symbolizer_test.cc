@@ -83,6 +83,27 @@ TYPED_TEST(SymbolizerTest, UserSymbols) {
   EXPECT_EQ(symbolize(2), std::string("0x0000000000000002"));
 }
 
+// Two UPIDs running the same binary should share one symbol table.
+TEST_F(ElfSymbolizerTest, SharedSymbolTables) {
+  auto* elf_symbolizer = static_cast<ElfSymbolizer*>(symbolizer_.get());
+
+  struct upid_t upid1 = {{static_cast<uint32_t>(getpid())}, 0};
+  struct upid_t upid2 = {{static_cast<uint32_t>(getpid())}, 1};
+
+  auto symbolize1 = symbolizer_->GetSymbolizerFn(upid1);
+  auto symbolize2 = symbolizer_->GetSymbolizerFn(upid2);
+  EXPECT_EQ(elf_symbolizer->num_binary_symbolizers(), 1);
+  EXPECT_EQ(symbolize1(kFooAddr), "test::foo()");
+  EXPECT_EQ(symbolize2(kFooAddr), "test::foo()");
+
+  symbolizer_->DeleteUPID(upid1);
+  EXPECT_EQ(elf_symbolizer->num_binary_symbolizers(), 1);
+  EXPECT_EQ(symbolize2(kBarAddr), "test::bar()");
+
+  symbolizer_->DeleteUPID(upid2);
+  EXPECT_EQ(elf_symbolizer->num_binary_symbolizers(), 0);
+}
+
 TEST_F(BCCSymbolizerTest, KernelSymbols) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<Symbolizer> symbolizer, BCCSymbolizer::Create());
 
@@ -25,7 +25,13 @@
 #include "src/stirling/source_connectors/proc_exit/bcc_bpf_intf/proc_exit.h"
 #include "src/stirling/upid/upid.h"
 
-BPF_PERF_OUTPUT(proc_exit_events);
+// Carries both proc_exit_event_t and proc_start_event_t, which are told apart by their type.
+BPF_PERF_OUTPUT(proc_events);
+
+// Holds the PID of a process created by fork() or clone(), between the task:task_newtask tracepoint
+// and the wake_up_new_task() kprobe, which are both called on the parent thread.
+// Key is {tgid, pid} of the parent thread.
+BPF_HASH(active_newtask_pid_map, uint64_t, uint32_t);
 
 // This array records singular values that are used by probes. We group them together to reduce the
 // number of arrays with only 1 element. Use of per-cpu array shall be the most efficient way,
@@ -55,6 +61,7 @@ TRACEPOINT_PROBE(sched, sched_process_exit) {
   bool is_thread_group_leader = tgid == tid;
   if (is_thread_group_leader) {
     struct proc_exit_event_t event = {};
+    event.type = kProcExitEvent;
     struct task_struct* task = (struct task_struct*)bpf_get_current_task();
 
     event.timestamp_ns = bpf_ktime_get_ns();
@@ -63,8 +70,64 @@ TRACEPOINT_PROBE(sched, sched_process_exit) {
     event.exit_code = read_exit_code(task);
     bpf_get_current_comm(&event.comm, sizeof(event.comm));
 
-    proc_exit_events.perf_submit(args, &event, sizeof(event));
+    proc_events.perf_submit(args, &event, sizeof(event));
+  }
+
+  return 0;
+}
+
+// A probe for the sched:sched_process_exec tracepoint.
+// Together with the probes for the creation and the exit of processes, this lets user space track
+// the processes on the host without rescanning /proc.
+TRACEPOINT_PROBE(sched, sched_process_exec) {
+  uint64_t id = bpf_get_current_pid_tgid();
+
+  struct proc_start_event_t event = {};
+  event.type = kProcStartEvent;
+  event.upid.tgid = id >> 32;
+  event.upid.start_time_ticks = get_tgid_start_time();
+
+  proc_events.perf_submit(args, &event, sizeof(event));
+
+  return 0;
+}
+
+// A probe for the task:task_newtask tracepoint, which fires when fork() or clone() creates a task.
+// The task_struct of the child is not accessible from this tracepoint, so its PID is recorded for
+// probe_entry_wake_up_new_task(), which reads the start time of the child.
+TRACEPOINT_PROBE(task, task_newtask) {
+  // New threads do not create a process.
+  if (args->clone_flags & CLONE_THREAD) {
+    return 0;
   }
 
+  uint64_t id = bpf_get_current_pid_tgid();
+  uint32_t pid = args->pid;
+  active_newtask_pid_map.update(&id, &pid);
+
+  return 0;
+}
+
+// A probe for the kernel function:
+// void wake_up_new_task(struct task_struct *p)
+// which is called by the parent, once the child of fork() or clone() is fully set up.
+int probe_entry_wake_up_new_task(struct pt_regs* ctx) {
+  uint64_t id = bpf_get_current_pid_tgid();
+
+  uint32_t* pid = active_newtask_pid_map.lookup(&id);
+  if (pid == NULL) {
+    return 0;
+  }
+
+  struct proc_start_event_t event = {};
+  event.type = kProcStartEvent;
+  event.upid.tgid = *pid;
+  // The child is the group leader of the new process, so this is its own start time.
+  event.upid.start_time_ticks = read_start_boottime((struct task_struct*)PT_REGS_PARM1(ctx));
+
+  active_newtask_pid_map.delete(&id);
+
+  proc_events.perf_submit(ctx, &event, sizeof(event));
+
   return 0;
 }
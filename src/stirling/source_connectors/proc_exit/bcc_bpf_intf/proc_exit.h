@@ -22,8 +22,16 @@
 
 #define MAX_CMD_SIZE 32
 
+// The types of the events in the perf buffer. Each event starts with its type.
+enum proc_event_type_t {
+  kProcExitEvent = 1,
+  kProcStartEvent,
+};
+
 // For reporting process exit. These information is read from task_struct.
 struct proc_exit_event_t {
+  enum proc_event_type_t type;
+
   // The time when this was captured in the BPF time.
   uint64_t timestamp_ns;
 
@@ -39,6 +47,14 @@ struct proc_exit_event_t {
   char comm[MAX_CMD_SIZE];
 };
 
+// For reporting the creation of a process, by fork() or exec().
+struct proc_start_event_t {
+  enum proc_event_type_t type;
+
+  // The unique identifier of the process.
+  struct upid_t upid;
+};
+
 // Specifies the corresponding indexes of the entries of a per-cpu array.
 enum proc_exit_trace_control_value_index_t {
   TASK_STRUCT_EXIT_CODE_OFFSET_INDEX,
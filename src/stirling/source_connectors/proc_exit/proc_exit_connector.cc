@@ -39,22 +39,40 @@ namespace proc_exit_tracer {
 
 constexpr uint32_t kPerfBufferPerCPUSizeBytes = 5 * 1024 * 1024;
 
-const auto kTracepointSpecs =
-    MakeArray<bpf_tools::TracepointSpec>({{std::string("sched:sched_process_exit"),
-                                           std::string("tracepoint__sched__sched_process_exit")}});
-
-void HandleProcExitEvent(void* cb_cookie, void* data, int /*data_size*/) {
+const auto kTracepointSpecs = MakeArray<bpf_tools::TracepointSpec>(
+    {{std::string("sched:sched_process_exit"),
+      std::string("tracepoint__sched__sched_process_exit")},
+     {std::string("sched:sched_process_exec"),
+      std::string("tracepoint__sched__sched_process_exec")},
+     {std::string("task:task_newtask"), std::string("tracepoint__task__task_newtask")}});
+
+// Process creations whose start time is read from the child's task_struct. See
+// probe_entry_wake_up_new_task().
+const auto kKProbeSpecs = MakeArray<bpf_tools::KProbeSpec>(
+    {{"wake_up_new_task", bpf_tools::BPFProbeAttachType::kEntry, "probe_entry_wake_up_new_task",
+      /*is_syscall*/ false}});
+
+void HandleProcEvent(void* cb_cookie, void* data, int /*data_size*/) {
   auto* connector = reinterpret_cast<ProcExitConnector*>(cb_cookie);
-  auto* event = reinterpret_cast<struct proc_exit_event_t*>(data);
-  connector->AcceptProcExitEvent(*event);
+  switch (*reinterpret_cast<enum proc_event_type_t*>(data)) {
+    case kProcExitEvent:
+      connector->AcceptProcExitEvent(*reinterpret_cast<struct proc_exit_event_t*>(data));
+      break;
+    case kProcStartEvent:
+      connector->AcceptProcStartEvent(*reinterpret_cast<struct proc_start_event_t*>(data));
+      break;
+  }
 }
 
-void HandleProcExitEventLoss(void* /*cb_cookie*/, uint64_t /*lost*/) {
+void HandleProcEventLoss(void* /*cb_cookie*/, uint64_t /*lost*/) {
   // TODO(yzhao): Add stats counter.
+  // Lost start and exit events are made up for by the periodic rescan of the cgroups by the
+  // metadata.
 }
 
+// The starts and the exits of processes share one perf buffer.
 const auto kPerfBufferSpecs = MakeArray<bpf_tools::PerfBufferSpec>({
-    {"proc_exit_events", HandleProcExitEvent, HandleProcExitEventLoss, kPerfBufferPerCPUSizeBytes,
+    {"proc_events", HandleProcEvent, HandleProcEventLoss, kPerfBufferPerCPUSizeBytes,
      bpf_tools::PerfBufferSizeCategory::kControl},
 });
 
@@ -78,6 +96,10 @@ void ProcExitConnector::AcceptProcExitEvent(const struct proc_exit_event_t& even
   events_.push_back(event);
 }
 
+void ProcExitConnector::AcceptProcStartEvent(const struct proc_start_event_t& event) {
+  start_events_.push_back(event);
+}
+
 Status ProcExitConnector::InitImpl() {
   sampling_freq_mgr_.set_period(kSamplingPeriod);
   push_freq_mgr_.set_period(kPushPeriod);
@@ -100,6 +122,7 @@ Status ProcExitConnector::InitImpl() {
   }
 
   PL_RETURN_IF_ERROR(AttachTracepoints(kTracepointSpecs));
+  PL_RETURN_IF_ERROR(AttachKProbes(kKProbeSpecs));
   PL_RETURN_IF_ERROR(OpenPerfBuffers(kPerfBufferSpecs, this));
 
   return Status::OK();
@@ -116,6 +139,18 @@ void ProcExitConnector::TransferDataImpl(ConnectorContext* ctx) {
 
   PollPerfBuffers();
 
+  // Report the starts first, so that a process that started and exited since the last poll ends
+  // up exited.
+  for (const auto& event : start_events_) {
+    ctx->ReportProcessLifecycleEvent({md::ProcessLifecycleEventType::kStarted, event.upid.pid,
+                                      event.upid.start_time_ticks});
+  }
+  start_events_.clear();
+  for (const auto& event : events_) {
+    ctx->ReportProcessLifecycleEvent(
+        {md::ProcessLifecycleEventType::kExited, event.upid.pid, event.upid.start_time_ticks});
+  }
+
   DataTable* data_table = data_tables_[0];
   for (auto& event : events_) {
     event.timestamp_ns = ConvertToRealTime(event.timestamp_ns);
@@ -135,9 +170,8 @@ void ProcExitConnector::TransferDataImpl(ConnectorContext* ctx) {
   events_.clear();
 }
 
-void ProcExitConnector::UpdateCrashedJavaProcCounters(
-    uint32_t asid, const proc_exit_event_t& event,
-    const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& upid_pid_info_map) {
+void ProcExitConnector::UpdateCrashedJavaProcCounters(uint32_t asid, const proc_exit_event_t& event,
+                                                      const md::PIDInfoMap& upid_pid_info_map) {
   const uint8_t exit_signal = GetExitSignal(event.exit_code);
 
   const bool is_sig_abrt = exit_signal == SIGABRT;
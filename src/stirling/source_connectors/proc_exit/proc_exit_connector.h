@@ -52,6 +52,7 @@ class ProcExitConnector : public SourceConnector, public bpf_tools::BCCWrapper {
   ~ProcExitConnector() override = default;
 
   void AcceptProcExitEvent(const struct proc_exit_event_t& event);
+  void AcceptProcStartEvent(const struct proc_start_event_t& event);
 
  protected:
   explicit ProcExitConnector(std::string_view name);
@@ -62,12 +63,12 @@ class ProcExitConnector : public SourceConnector, public bpf_tools::BCCWrapper {
 
  private:
   std::vector<struct proc_exit_event_t> events_;
+  std::vector<struct proc_start_event_t> start_events_;
 
  private:
   // Update counters related to java process.
-  void UpdateCrashedJavaProcCounters(
-      uint32_t asid, const proc_exit_event_t& event,
-      const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& upid_pid_info_map);
+  void UpdateCrashedJavaProcCounters(uint32_t asid, const proc_exit_event_t& event,
+                                     const md::PIDInfoMap& upid_pid_info_map);
 
   prometheus::Counter& java_proc_crashed_counter_;
   prometheus::Counter& java_proc_crashed_with_profiler_counter_;
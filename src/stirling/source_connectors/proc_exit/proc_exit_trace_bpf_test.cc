@@ -18,6 +18,8 @@
 
 #include "src/stirling/source_connectors/proc_exit/proc_exit_connector.h"
 
+#include <vector>
+
 #include "src/common/exec/subprocess.h"
 #include "src/common/testing/testing.h"
 #include "src/stirling/core/connector_context.h"
@@ -30,6 +32,8 @@ namespace proc_exit_tracer {
 using ::px::SubProcess;
 using ::px::stirling::testing::RecordBatchSizeIs;
 using ::px::testing::BazelRunfilePath;
+using ::testing::ElementsAre;
+using ::testing::Field;
 using ::testing::SizeIs;
 
 // Tests that ProcExitConnector::TransferData() does not throw any failures.
@@ -64,6 +68,55 @@ TEST(ProcExitConnectorTest, TransferData) {
   EXPECT_EQ(result[proc_exit_tracer::kCommIdx]->Get<types::StringValue>(0), "sleep");
 }
 
+// A context that records the reported process lifecycle events.
+class ProcessLifecycleRecordingContext : public StandaloneContext {
+ public:
+  ProcessLifecycleRecordingContext() : StandaloneContext({}) {}
+
+  void ReportProcessLifecycleEvent(const md::ProcessLifecycleEvent& event) override {
+    events.push_back(event);
+  }
+
+  std::vector<md::ProcessLifecycleEvent> events;
+};
+
+// Tests that the fork, the exec and the exit of a process are reported to the context.
+TEST(ProcExitConnectorTest, ReportsProcessLifecycleEvents) {
+  auto connector = ProcExitConnector::Create("test_proc_exit_connector");
+  ASSERT_TRUE(connector != nullptr);
+  EXPECT_OK(connector->Init());
+  ProcessLifecycleRecordingContext context;
+
+  testing::DataTables data_tables{ProcExitConnector::kTables};
+  connector->set_data_tables(data_tables.tables());
+
+  const std::filesystem::path sleep_path =
+      BazelRunfilePath("src/stirling/source_connectors/proc_exit/testing/sleep");
+  SubProcess proc;
+  ASSERT_OK(proc.Start({sleep_path.string()}));
+  ASSERT_TRUE(proc.IsRunning());
+  proc.Kill();
+  proc.Wait();
+  connector->TransferData(&context);
+
+  std::vector<md::ProcessLifecycleEvent> child_events;
+  for (const auto& event : context.events) {
+    if (event.pid == static_cast<uint32_t>(proc.child_pid())) {
+      child_events.push_back(event);
+    }
+  }
+  // The fork, the exec and the exit all report the start time of the child.
+  using md::ProcessLifecycleEvent;
+  using md::ProcessLifecycleEventType;
+  ASSERT_THAT(child_events,
+              ElementsAre(Field(&ProcessLifecycleEvent::type, ProcessLifecycleEventType::kStarted),
+                          Field(&ProcessLifecycleEvent::type, ProcessLifecycleEventType::kStarted),
+                          Field(&ProcessLifecycleEvent::type, ProcessLifecycleEventType::kExited)));
+  EXPECT_NE(child_events[0].start_time_ticks, 0);
+  EXPECT_EQ(child_events[1].start_time_ticks, child_events[0].start_time_ticks);
+  EXPECT_EQ(child_events[2].start_time_ticks, child_events[0].start_time_ticks);
+}
+
 }  // namespace proc_exit_tracer
 }  // namespace stirling
 }  // namespace px
@@ -18,79 +18,125 @@
 
 #include "src/stirling/source_connectors/process_stats/process_stats_connector.h"
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "src/common/base/base.h"
 #include "src/common/system/proc_parser.h"
 #include "src/shared/metadata/metadata.h"
 
+DEFINE_uint32(stirling_process_stats_threads, 1,
+              "Number of threads that read the /proc files of the processes for process_stats.");
+DEFINE_uint32(stirling_process_stats_max_open_pids, 4096,
+              "Maximum number of processes whose /proc files process_stats keeps open between "
+              "samples. Each process takes two file descriptors, and the processes take at most a "
+              "quarter of the limit on open files (RLIMIT_NOFILE).");
+
 namespace px {
 namespace stirling {
 
 using system::ProcParser;
+using system::ProcPIDStatsReader;
+
+ProcessStatsConnector::~ProcessStatsConnector() = default;
 
 Status ProcessStatsConnector::InitImpl() {
   sampling_freq_mgr_.set_period(kSamplingPeriod);
   push_freq_mgr_.set_period(kPushPeriod);
+
+  const uint32_t num_readers = std::max(FLAGS_stirling_process_stats_threads, 1U);
+  const size_t max_open_pids =
+      ProcPIDStatsReader::CapMaxOpenPIDs(FLAGS_stirling_process_stats_max_open_pids);
+  if (max_open_pids < FLAGS_stirling_process_stats_max_open_pids) {
+    LOG(INFO) << absl::Substitute(
+        "Keeping the /proc files of at most $0 processes open, due to the limit on open files.",
+        max_open_pids);
+  }
+  for (uint32_t i = 0; i < num_readers; ++i) {
+    stats_readers_.push_back(std::make_unique<ProcPIDStatsReader>(
+        system::Config::GetInstance().PageSizeBytes(),
+        system::Config::GetInstance().KernelTickTimeNS(), max_open_pids / num_readers));
+  }
+  reader_threads_ = std::make_unique<WorkerThreads>(num_readers);
   return Status::OK();
 }
 
-Status ProcessStatsConnector::StopImpl() { return Status::OK(); }
+Status ProcessStatsConnector::StopImpl() {
+  reader_threads_.reset();
+  stats_readers_.clear();
+  return Status::OK();
+}
 
 void ProcessStatsConnector::TransferProcessStatsTable(ConnectorContext* ctx,
                                                       DataTable* data_table) {
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& pid_info_by_upid = ctx->GetPIDInfoMap();
+  const md::PIDInfoMap& pid_info_by_upid = ctx->GetPIDInfoMap();
 
   int64_t timestamp = AdjustedSteadyClockNowNS();
 
+  const size_t num_readers = stats_readers_.size();
+  std::vector<std::vector<md::UPID>> upids_by_reader(num_readers);
   for (const auto& [upid, pid_info] : pid_info_by_upid) {
     // TODO(zasgar): Fix condition for dead pids after helper function is added.
     if (pid_info == nullptr || pid_info->stop_time_ns() > 0) {
       // PID has been stopped.
       continue;
     }
+    upids_by_reader[upid.pid() % num_readers].push_back(upid);
+  }
 
-    ProcParser::ProcessStats stats;
-    int32_t pid = upid.pid();
-    // TODO(zasgar): We should double check the process start time to make sure it still the same
-    // PID.
-    auto s1 =
-        proc_parser_->ParseProcPIDStat(pid, system::Config::GetInstance().PageSizeBytes(),
-                                       system::Config::GetInstance().KernelTickTimeNS(), &stats);
-    if (!s1.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to fetch cpu stat info for PID ($0). Error=\"$1\" skipping.", pid, s1.msg());
-      continue;
+  std::vector<std::vector<std::pair<md::UPID, ProcParser::ProcessStats>>> stats_by_reader(
+      num_readers);
+  std::function<void(size_t)> read_stats = [&](size_t reader_idx) {
+    ProcPIDStatsReader* reader = stats_readers_[reader_idx].get();
+    auto& stats_list = stats_by_reader[reader_idx];
+    stats_list.reserve(upids_by_reader[reader_idx].size());
+    for (const md::UPID& upid : upids_by_reader[reader_idx]) {
+      ProcParser::ProcessStats stats;
+      int32_t pid = upid.pid();
+      // TODO(zasgar): We should double check the process start time to make sure it still the
+      // same PID.
+      Status s = reader->ReadStats(pid, &stats);
+      if (!s.ok()) {
+        VLOG(1) << absl::Substitute(
+            "Failed to fetch stat info for PID ($0). Error=\"$1\" skipping.", pid, s.msg());
+        continue;
+      }
+      stats_list.emplace_back(upid, std::move(stats));
     }
-
-    auto s2 = proc_parser_->ParseProcPIDStatIO(pid, &stats);
-    if (!s2.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to fetch IO stat info for PID ($0). Error=\"$1\" skipping.", pid, s2.msg());
-      continue;
+    reader->CloseUnreadFiles();
+  };
+
+  // The data table is not thread-safe, so the threads only read the stats, which are appended to
+  // the table afterwards.
+  reader_threads_->Run(read_stats);
+
+  for (const auto& stats_list : stats_by_reader) {
+    for (const auto& [upid, stats] : stats_list) {
+      DataTable::RecordBuilder<&kProcessStatsTable> r(data_table, timestamp);
+      // TODO(oazizi): Enable version below, once rest of the agent supports tabletization.
+      //  DataTable::RecordBuilder<&kProcessStatsTable> r(data_table, upid.value(), timestamp);
+      r.Append<r.ColIndex("time_")>(timestamp);
+      // Tabletization key must also be appended as a column value.
+      // See note in RecordBuilder class.
+      r.Append<r.ColIndex("upid")>(upid.value());
+      r.Append<r.ColIndex("major_faults")>(stats.major_faults);
+      r.Append<r.ColIndex("minor_faults")>(stats.minor_faults);
+      r.Append<r.ColIndex("cpu_utime_ns")>(stats.utime_ns);
+      r.Append<r.ColIndex("cpu_ktime_ns")>(stats.ktime_ns);
+      r.Append<r.ColIndex("num_threads")>(stats.num_threads);
+      r.Append<r.ColIndex("vsize_bytes")>(stats.vsize_bytes);
+      r.Append<r.ColIndex("rss_bytes")>(stats.rss_bytes);
+      r.Append<r.ColIndex("rchar_bytes")>(stats.rchar_bytes);
+      r.Append<r.ColIndex("wchar_bytes")>(stats.wchar_bytes);
+      r.Append<r.ColIndex("read_bytes")>(stats.read_bytes);
+      r.Append<r.ColIndex("write_bytes")>(stats.write_bytes);
     }
-
-    DataTable::RecordBuilder<&kProcessStatsTable> r(data_table, timestamp);
-    // TODO(oazizi): Enable version below, once rest of the agent supports tabletization.
-    //  DataTable::RecordBuilder<&kProcessStatsTable> r(data_table, upid.value(), timestamp);
-    r.Append<r.ColIndex("time_")>(timestamp);
-    // Tabletization key must also be appended as a column value.
-    // See note in RecordBuilder class.
-    r.Append<r.ColIndex("upid")>(upid.value());
-    r.Append<r.ColIndex("major_faults")>(stats.major_faults);
-    r.Append<r.ColIndex("minor_faults")>(stats.minor_faults);
-    r.Append<r.ColIndex("cpu_utime_ns")>(stats.utime_ns);
-    r.Append<r.ColIndex("cpu_ktime_ns")>(stats.ktime_ns);
-    r.Append<r.ColIndex("num_threads")>(stats.num_threads);
-    r.Append<r.ColIndex("vsize_bytes")>(stats.vsize_bytes);
-    r.Append<r.ColIndex("rss_bytes")>(stats.rss_bytes);
-    r.Append<r.ColIndex("rchar_bytes")>(stats.rchar_bytes);
-    r.Append<r.ColIndex("wchar_bytes")>(stats.wchar_bytes);
-    r.Append<r.ColIndex("read_bytes")>(stats.read_bytes);
-    r.Append<r.ColIndex("write_bytes")>(stats.write_bytes);
   }
 }
 
@@ -25,11 +25,13 @@
 #include <vector>
 
 #include "src/common/base/base.h"
+#include "src/common/system/proc_pid_stats_reader.h"
 #include "src/common/system/system.h"
 #include "src/shared/metadata/metadata.h"
 #include "src/stirling/core/canonical_types.h"
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/source_connectors/process_stats/process_stats_table.h"
+#include "src/stirling/utils/worker_threads.h"
 
 namespace px {
 namespace stirling {
@@ -43,7 +45,7 @@ class ProcessStatsConnector : public SourceConnector {
   static constexpr uint32_t kProcStatsTableNum = TableNum(kTables, kProcessStatsTable);
 
   ProcessStatsConnector() = delete;
-  ~ProcessStatsConnector() override = default;
+  ~ProcessStatsConnector() override;
 
   static std::unique_ptr<SourceConnector> Create(std::string_view name) {
     return std::unique_ptr<SourceConnector>(new ProcessStatsConnector(name));
@@ -57,14 +59,17 @@ class ProcessStatsConnector : public SourceConnector {
 
  protected:
   explicit ProcessStatsConnector(std::string_view source_name)
-      : SourceConnector(source_name, kTables) {
-    proc_parser_ = std::make_unique<system::ProcParser>();
-  }
+      : SourceConnector(source_name, kTables) {}
 
  private:
   void TransferProcessStatsTable(ConnectorContext* ctx, DataTable* data_table);
 
-  std::unique_ptr<system::ProcParser> proc_parser_;
+  // One reader per thread. The processes are assigned to the readers by PID, so that each reader
+  // keeps the files of the same processes open across samples.
+  std::vector<std::unique_ptr<system::ProcPIDStatsReader>> stats_readers_;
+
+  // The threads that run the readers other than the first one, which the connector thread runs.
+  std::unique_ptr<WorkerThreads> reader_threads_;
 };
 
 }  // namespace stirling
@@ -0,0 +1,255 @@
+/*
+ * This code runs using bpf in the Linux kernel.
+ * Copyright 2018- The Pixie Authors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * SPDX-License-Identifier: GPL-2.0
+ */
+
+// LINT_C_FILE: Do not remove this line. It ensures cpplint treats this as a C file.
+
+#pragma once
+
+#include "src/stirling/bpf_tools/bcc_bpf/utils.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/common.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.h"
+
+// Payload truncation keeps track of the frames of simple framed protocols, so that only the
+// header and the first few bytes of the payload of each frame are submitted to user space. The
+// rest of the frame is reported as filler, which user space replaces with zeros
+// (see SocketDataEvent::ExtractFillerEvent()). The position of each frame is tracked with a
+// frame_cursor_t per direction of the connection. HTTP bodies are cut to max_body_bytes, and
+// MySQL/PgSQL payloads only when --stirling_bpf_db_payload_prefix_bytes is set.
+//
+// NOTE: The HTTP header scan uses a bounded loop, which requires kernel 5.3 or newer.
+
+// The number of bytes of an HTTP message searched for the end of its headers. The scan runs for
+// every frame of a syscall, so the window is kept small. Messages with larger headers are not
+// truncated.
+#define HTTP_HEADER_SCAN_LIMIT 512
+
+// The maximum number of frames processed in a single syscall.
+#define FRAME_LOOP_LIMIT 16
+
+struct frame_header_t {
+  bool valid;
+  // The size of the header of the frame, all of which is submitted to user space.
+  uint32_t header_size;
+  // The size of the entire frame, including the header.
+  uint64_t frame_size;
+};
+
+// HTTP bodies are truncated whenever truncation is enabled. The payloads of MySQL and PostgreSQL
+// hold the queries and rows that their parsers decode, so they are only truncated on request.
+static __inline bool is_truncatable_protocol(enum traffic_protocol_t protocol,
+                                             bool truncate_db_payloads) {
+  if (protocol == kProtocolHTTP) {
+    return true;
+  }
+  return truncate_db_payloads && (protocol == kProtocolMySQL || protocol == kProtocolPGSQL);
+}
+
+// Whether a response with the status code in the 3 digits at buf has a body. 1xx, 204 and 304
+// responses never have one, whatever their headers say.
+static __inline bool http_status_allows_body(const char* buf) {
+  if (buf[0] == '1') {
+    return false;
+  }
+  return !((buf[0] == '2' || buf[0] == '3') && buf[1] == '0' && buf[2] == '4');
+}
+
+// Parses the headers of an HTTP/1.x message, which must be entirely in buf, and finds the size of
+// the body from the Content-Length header. Messages without Content-Length (e.g. chunked encoding)
+// cannot be truncated, unless they cannot have a body at all.
+//
+// *head_request is the per-connection record of whether the last request was HEAD. It is updated
+// when buf holds a request, and consulted when buf holds a response, because the response to HEAD
+// carries the Content-Length of a body that is not sent.
+// NOTE: With pipelined requests, the response to a HEAD request can be framed by the method
+// of a later request. The cursor then resynchronizes at the next inferred message start.
+//
+// The first HTTP_HEADER_SCAN_LIMIT bytes of buf are copied to scratch, which must be at least that
+// large, and scanned there.
+static __inline struct frame_header_t parse_http_frame_header(const char* buf, size_t count,
+                                                              char* scratch, bool* head_request) {
+  const char kContentLength[] = "content-length:";
+  const int kContentLengthSize = sizeof(kContentLength) - 1;
+
+  struct frame_header_t header = {};
+
+  // The last 4 bytes scanned, to find the \r\n\r\n at the end of the headers.
+  uint32_t window = 0;
+  // The number of characters of kContentLength matched at the start of the current line,
+  // or -1 if the current line is not Content-Length.
+  int match_idx = -1;
+  bool at_line_start = false;
+  bool has_content_length = false;
+  uint64_t content_length = 0;
+
+  // Copy the window at once, rather than reading the user buffer one byte at a time.
+  size_t scan_size = min_size_t(count, HTTP_HEADER_SCAN_LIMIT);
+  if (scan_size == 0) {
+    return header;
+  }
+  bpf_probe_read(scratch, scan_size, buf);
+
+  // A response starts with the status line "HTTP/1.x NNN", anything else is a request.
+  bool has_body = true;
+  if (scan_size >= 12 && scratch[0] == 'H' && scratch[1] == 'T' && scratch[2] == 'T' &&
+      scratch[3] == 'P' && scratch[4] == '/') {
+    has_body = !*head_request && http_status_allows_body(scratch + 9);
+  } else {
+    *head_request = scan_size >= 5 && scratch[0] == 'H' && scratch[1] == 'E' &&
+                    scratch[2] == 'A' && scratch[3] == 'D' && scratch[4] == ' ';
+  }
+
+  for (size_t i = 0; i < HTTP_HEADER_SCAN_LIMIT && i < scan_size; ++i) {
+    char c = scratch[i];
+    window = (window << 8) | (uint8_t)c;
+    if (window == 0x0d0a0d0a) {
+      header.header_size = i + 1;
+      break;
+    }
+
+    if (at_line_start) {
+      match_idx = 0;
+    }
+    at_line_start = (c == '\n');
+
+    if (match_idx >= 0 && match_idx < kContentLengthSize) {
+      // Header names are case-insensitive.
+      char lower = (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+      match_idx = (lower == kContentLength[match_idx]) ? match_idx + 1 : -1;
+    } else if (match_idx == kContentLengthSize) {
+      // In the value of Content-Length.
+      if (c >= '0' && c <= '9') {
+        content_length = content_length * 10 + (c - '0');
+        has_content_length = true;
+      } else if (c != ' ' && c != '\r' && c != '\n') {
+        return header;
+      }
+    }
+  }
+
+  if (header.header_size == 0) {
+    return header;
+  }
+  if (!has_body) {
+    header.frame_size = header.header_size;
+    header.valid = true;
+    return header;
+  }
+  if (!has_content_length) {
+    return header;
+  }
+  header.frame_size = header.header_size + content_length;
+  header.valid = true;
+  return header;
+}
+
+// MySQL packets start with a 3-byte little-endian payload length and a 1-byte sequence number.
+static __inline struct frame_header_t parse_mysql_frame_header(const char* buf, size_t count) {
+  struct frame_header_t header = {};
+  if (count < 4) {
+    return header;
+  }
+  uint32_t len = (uint8_t)buf[0] | ((uint8_t)buf[1] << 8) | ((uint8_t)buf[2] << 16);
+  if (len == 0) {
+    return header;
+  }
+  header.header_size = 4;
+  header.frame_size = 4 + len;
+  header.valid = true;
+  return header;
+}
+
+// PostgreSQL regular messages start with a 1-byte tag and a 4-byte big-endian length, which counts
+// itself but not the tag. The startup message has no tag, and is never large enough to truncate.
+static __inline struct frame_header_t parse_pgsql_frame_header(const char* buf, size_t count) {
+  struct frame_header_t header = {};
+  if (count < 5) {
+    return header;
+  }
+  char tag = buf[0];
+  if (!((tag >= 'A' && tag <= 'Z') || (tag >= 'a' && tag <= 'z'))) {
+    return header;
+  }
+  int32_t len = read_big_endian_int32(buf + 1);
+  if (len < 4) {
+    return header;
+  }
+  header.header_size = 5;
+  header.frame_size = 1 + len;
+  header.valid = true;
+  return header;
+}
+
+static __inline struct frame_header_t parse_frame_header(struct conn_info_t* conn_info,
+                                                         const char* buf, size_t count,
+                                                         char* scratch) {
+  enum traffic_protocol_t protocol = conn_info->protocol;
+  if (protocol == kProtocolHTTP) {
+    return parse_http_frame_header(buf, count, scratch, &conn_info->http_head_request);
+  }
+  if (protocol == kProtocolMySQL) {
+    return parse_mysql_frame_header(buf, count);
+  }
+  if (protocol == kProtocolPGSQL) {
+    return parse_pgsql_frame_header(buf, count);
+  }
+  struct frame_header_t header = {};
+  return header;
+}
+
+// Splits off the next segment of buf, which holds the bytes at positions [pos, pos + count) of the
+// given direction of a connection. The first *keep bytes of the segment are to be submitted to
+// user space, and the following *skip bytes to be reported as filler. keep + skip is never 0 for a
+// non-empty buf. The segment ends at the end of a frame, or at the end of buf.
+//
+// A frame header is only parsed where the previous frame ended, or where protocol inference found
+// the start of a message (at_message_start). The latter takes precedence over the current frame,
+// so that a cursor that overestimated the size of a frame resynchronizes at the next message.
+// See parse_http_frame_header() for scratch.
+static __inline void next_payload_segment(struct conn_info_t* conn_info,
+                                          enum traffic_direction_t direction, const char* buf,
+                                          uint64_t pos, size_t count, bool at_message_start,
+                                          size_t prefix_bytes, char* scratch, size_t* keep,
+                                          size_t* skip) {
+  struct frame_cursor_t* cursor =
+      (direction == kEgress) ? &conn_info->wr_cursor : &conn_info->rd_cursor;
+
+  if (pos >= cursor->frame_end_pos || at_message_start) {
+    struct frame_header_t header = {};
+    if (pos == cursor->frame_end_pos || at_message_start) {
+      header = parse_frame_header(conn_info, buf, count, scratch);
+    }
+    if (!header.valid) {
+      // The frames cannot be followed from here on.
+      cursor->frame_end_pos = 0;
+      cursor->keep_end_pos = 0;
+      *keep = count;
+      *skip = 0;
+      return;
+    }
+    cursor->frame_end_pos = pos + header.frame_size;
+    cursor->keep_end_pos = pos + header.header_size + prefix_bytes;
+  }
+
+  uint64_t segment_end = min_uint64_t(cursor->frame_end_pos, pos + count);
+  uint64_t keep_end = min_uint64_t(cursor->keep_end_pos, segment_end);
+  *keep = keep_end > pos ? keep_end - pos : 0;
+  *skip = segment_end - pos - *keep;
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// This must be the first include.
+#include "src/stirling/bpf_tools/bcc_bpf/stubs.h"
+
+#include <string>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf/payload_truncation.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/common.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.h"
+
+constexpr size_t kPrefixBytes = 4;
+
+struct Segment {
+  size_t keep;
+  size_t skip;
+};
+
+Segment NextSegment(conn_info_t* conn_info, traffic_direction_t direction, std::string_view buf,
+                    uint64_t pos, bool at_message_start) {
+  char scratch[HTTP_HEADER_SCAN_LIMIT];
+  Segment segment = {};
+  next_payload_segment(conn_info, direction, buf.data(), pos, buf.size(), at_message_start,
+                       kPrefixBytes, scratch, &segment.keep, &segment.skip);
+  return segment;
+}
+
+frame_header_t ParseHTTPFrameHeader(std::string_view buf, bool head_request = false) {
+  char scratch[HTTP_HEADER_SCAN_LIMIT];
+  return parse_http_frame_header(buf.data(), buf.size(), scratch, &head_request);
+}
+
+TEST(PayloadTruncationTest, HTTPFrameHeader) {
+  constexpr std::string_view kResp =
+      "HTTP/1.1 200 OK\r\n"
+      "content-type: text/plain\r\n"
+      "Content-Length: 12\r\n"
+      "\r\n"
+      "hello world!";
+  frame_header_t header = ParseHTTPFrameHeader(kResp);
+  EXPECT_TRUE(header.valid);
+  EXPECT_EQ(header.header_size, kResp.size() - 12);
+  EXPECT_EQ(header.frame_size, kResp.size());
+
+  // Chunked encoding has no Content-Length.
+  constexpr std::string_view kChunked =
+      "HTTP/1.1 200 OK\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n";
+  EXPECT_FALSE(ParseHTTPFrameHeader(kChunked).valid);
+
+  // The headers are not complete.
+  constexpr std::string_view kPartial =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 12\r\n";
+  EXPECT_FALSE(ParseHTTPFrameHeader(kPartial).valid);
+
+  // The headers do not end within the scanned window.
+  std::string large_headers = absl::StrCat("HTTP/1.1 200 OK\r\nContent-Length: 12\r\n",
+                                           "Cookie: ", std::string(HTTP_HEADER_SCAN_LIMIT, 'a'),
+                                           "\r\n\r\nhello world!");
+  EXPECT_FALSE(ParseHTTPFrameHeader(large_headers).valid);
+}
+
+// Tests that responses that cannot have a body end with their headers, whatever their
+// Content-Length says.
+TEST(PayloadTruncationTest, HTTPResponsesWithoutBody) {
+  constexpr std::string_view kHeadResp =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 100\r\n"
+      "\r\n";
+  frame_header_t header = ParseHTTPFrameHeader(kHeadResp, /*head_request*/ true);
+  EXPECT_TRUE(header.valid);
+  EXPECT_EQ(header.frame_size, kHeadResp.size());
+  EXPECT_EQ(ParseHTTPFrameHeader(kHeadResp).frame_size, kHeadResp.size() + 100);
+
+  for (std::string_view status : {"100 Continue", "204 No Content", "304 Not Modified"}) {
+    std::string resp = absl::StrCat("HTTP/1.1 ", status, "\r\nContent-Length: 100\r\n\r\n");
+    header = ParseHTTPFrameHeader(resp);
+    EXPECT_TRUE(header.valid) << status;
+    EXPECT_EQ(header.frame_size, resp.size()) << status;
+  }
+}
+
+// Tests that the method of each request is recorded for the response that follows it.
+TEST(PayloadTruncationTest, HTTPRecordsHeadRequests) {
+  char scratch[HTTP_HEADER_SCAN_LIMIT];
+  bool head_request = false;
+
+  constexpr std::string_view kHeadReq = "HEAD /index.html HTTP/1.1\r\n\r\n";
+  parse_http_frame_header(kHeadReq.data(), kHeadReq.size(), scratch, &head_request);
+  EXPECT_TRUE(head_request);
+
+  constexpr std::string_view kGetReq = "GET /index.html HTTP/1.1\r\n\r\n";
+  parse_http_frame_header(kGetReq.data(), kGetReq.size(), scratch, &head_request);
+  EXPECT_FALSE(head_request);
+}
+
+TEST(PayloadTruncationTest, MySQLFrameHeader) {
+  constexpr char kPacket[] = "\x05\x00\x00\x00\x03SELECT";
+  frame_header_t header = parse_mysql_frame_header(kPacket, sizeof(kPacket) - 1);
+  EXPECT_TRUE(header.valid);
+  EXPECT_EQ(header.header_size, 4);
+  EXPECT_EQ(header.frame_size, 9);
+}
+
+TEST(PayloadTruncationTest, PGSQLFrameHeader) {
+  constexpr char kQuery[] = "Q\x00\x00\x00\x0dSELECT 1;\x00";
+  frame_header_t header = parse_pgsql_frame_header(kQuery, sizeof(kQuery) - 1);
+  EXPECT_TRUE(header.valid);
+  EXPECT_EQ(header.header_size, 5);
+  EXPECT_EQ(header.frame_size, 14);
+
+  EXPECT_FALSE(parse_pgsql_frame_header("\x00\x00\x00\x08\x04\xd2\x16\x2f", 8).valid);
+}
+
+// Tests that frames are split into the kept header and prefix, and the skipped rest,
+// across multiple frames in the same buffer.
+TEST(PayloadTruncationTest, MultipleFramesInOneBuffer) {
+  // Two MySQL packets with 10 bytes of payload each.
+  const std::string buf = std::string("\x0a\x00\x00\x00", 4) + "0123456789" +
+                          std::string("\x0a\x00\x00\x01", 4) + "abcdefghij";
+  conn_info_t conn_info = {};
+  conn_info.protocol = kProtocolMySQL;
+
+  Segment segment = NextSegment(&conn_info, kIngress, buf, 0, true);
+  EXPECT_EQ(segment.keep, 4 + kPrefixBytes);
+  EXPECT_EQ(segment.skip, 10 - kPrefixBytes);
+
+  segment = NextSegment(&conn_info, kIngress, std::string_view(buf).substr(14), 14, false);
+  EXPECT_EQ(segment.keep, 4 + kPrefixBytes);
+  EXPECT_EQ(segment.skip, 10 - kPrefixBytes);
+  EXPECT_EQ(conn_info.rd_cursor.frame_end_pos, 28);
+}
+
+// Tests that a frame that spans multiple buffers is followed by the cursor.
+TEST(PayloadTruncationTest, FrameAcrossBuffers) {
+  const std::string packet = std::string("\x14\x00\x00\x00", 4) + std::string(20, 'x');
+  conn_info_t conn_info = {};
+  conn_info.protocol = kProtocolMySQL;
+
+  // The first buffer holds the header and 2 bytes of payload.
+  Segment segment = NextSegment(&conn_info, kIngress, std::string_view(packet).substr(0, 6), 0,
+                                true);
+  EXPECT_EQ(segment.keep, 6);
+  EXPECT_EQ(segment.skip, 0);
+
+  // The second buffer holds the rest of the prefix, followed by bytes to skip.
+  segment = NextSegment(&conn_info, kIngress, std::string_view(packet).substr(6), 6, false);
+  EXPECT_EQ(segment.keep, 2);
+  EXPECT_EQ(segment.skip, 16);
+}
+
+// Tests that data not at a frame boundary is kept in full, until a message start is inferred.
+TEST(PayloadTruncationTest, ResynchronizesAtMessageStart) {
+  const std::string packet = std::string("\x14\x00\x00\x00", 4) + std::string(20, 'x');
+  conn_info_t conn_info = {};
+  conn_info.protocol = kProtocolMySQL;
+
+  Segment segment = NextSegment(&conn_info, kIngress, "garbage", 100, false);
+  EXPECT_EQ(segment.keep, 7);
+  EXPECT_EQ(segment.skip, 0);
+  EXPECT_EQ(conn_info.rd_cursor.frame_end_pos, 0);
+
+  // Not a message start, so the bytes are not parsed as a header.
+  segment = NextSegment(&conn_info, kIngress, packet, 107, false);
+  EXPECT_EQ(segment.keep, packet.size());
+  EXPECT_EQ(segment.skip, 0);
+
+  segment = NextSegment(&conn_info, kIngress, packet, 131, true);
+  EXPECT_EQ(segment.keep, 4 + kPrefixBytes);
+  EXPECT_EQ(segment.skip, 20 - kPrefixBytes);
+}
+
+// Tests that the response to a HEAD request is framed without a body, so that the response after
+// it on the same connection is truncated rather than reported as filler.
+TEST(PayloadTruncationTest, HTTPHeadResponseFollowedByResponse) {
+  constexpr std::string_view kHeadReq = "HEAD /index.html HTTP/1.1\r\n\r\n";
+  constexpr std::string_view kHeadResp =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 12\r\n"
+      "\r\n";
+  constexpr std::string_view kGetReq = "GET /index.html HTTP/1.1\r\n\r\n";
+  constexpr std::string_view kGetResp =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 12\r\n"
+      "\r\n"
+      "hello world!";
+  conn_info_t conn_info = {};
+  conn_info.protocol = kProtocolHTTP;
+
+  // Requests have no Content-Length, so they are kept in full.
+  Segment segment = NextSegment(&conn_info, kEgress, kHeadReq, 0, true);
+  EXPECT_EQ(segment.keep, kHeadReq.size());
+  EXPECT_TRUE(conn_info.http_head_request);
+
+  segment = NextSegment(&conn_info, kIngress, kHeadResp, 0, true);
+  EXPECT_EQ(segment.keep, kHeadResp.size());
+  EXPECT_EQ(segment.skip, 0);
+  EXPECT_EQ(conn_info.rd_cursor.frame_end_pos, kHeadResp.size());
+
+  segment = NextSegment(&conn_info, kEgress, kGetReq, kHeadReq.size(), true);
+  EXPECT_EQ(segment.keep, kGetReq.size());
+  EXPECT_FALSE(conn_info.http_head_request);
+
+  // The response starts where the previous one ended, so it is parsed without inference.
+  segment = NextSegment(&conn_info, kIngress, kGetResp, kHeadResp.size(), false);
+  EXPECT_EQ(segment.keep, kGetResp.size() - 12 + kPrefixBytes);
+  EXPECT_EQ(segment.skip, 12 - kPrefixBytes);
+}
+
+// Tests that an inferred message start resets a cursor that is still inside a frame.
+TEST(PayloadTruncationTest, MessageStartResetsCursorInsideFrame) {
+  const std::string packet = std::string("\x14\x00\x00\x00", 4) + std::string(20, 'x');
+  conn_info_t conn_info = {};
+  conn_info.protocol = kProtocolMySQL;
+
+  // A frame of 100 bytes, of which only the first 24 are seen.
+  const std::string large_packet = std::string("\x60\x00\x00\x00", 4) + std::string(20, 'y');
+  NextSegment(&conn_info, kIngress, large_packet, 0, true);
+  EXPECT_EQ(conn_info.rd_cursor.frame_end_pos, 100);
+
+  Segment segment = NextSegment(&conn_info, kIngress, packet, 24, true);
+  EXPECT_EQ(segment.keep, 4 + kPrefixBytes);
+  EXPECT_EQ(segment.skip, 20 - kPrefixBytes);
+  EXPECT_EQ(conn_info.rd_cursor.frame_end_pos, 48);
+}
@@ -30,6 +30,7 @@
 
 #include "src/stirling/bpf_tools/bcc_bpf/task_struct_utils.h"
 #include "src/stirling/bpf_tools/bcc_bpf/utils.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf/payload_truncation.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf/protocol_inference.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.h"
 #include "src/stirling/upid/upid.h"
@@ -40,10 +41,6 @@
 
 const int32_t kInvalidFD = -1;
 
-// This is the amount of activity required on a connection before a new ConnStats event
-// is reported to user-space. It applies to read and write traffic combined.
-const int kConnStatsDataThreshold = 65536;
-
 // This is the perf buffer for BPF program to export data from kernel to user space.
 BPF_PERF_OUTPUT(socket_data_events);
 BPF_PERF_OUTPUT(socket_control_events);
@@ -254,20 +251,22 @@ static __inline enum target_tgid_match_result_t match_trace_tgid(const uint32_t
   return TARGET_TGID_UNMATCHED;
 }
 
-static __inline void update_traffic_class(struct conn_info_t* conn_info,
-                                          enum traffic_direction_t direction, const char* buf,
-                                          size_t count) {
+// Returns the message inferred from the data, if any.
+static __inline struct protocol_message_t update_traffic_class(struct conn_info_t* conn_info,
+                                                               enum traffic_direction_t direction,
+                                                               const char* buf, size_t count) {
+  struct protocol_message_t inferred_protocol = {};
   if (conn_info == NULL) {
-    return;
+    return inferred_protocol;
   }
   conn_info->protocol_total_count += 1;
 
   // Try to infer connection type (protocol) based on data.
-  struct protocol_message_t inferred_protocol = infer_protocol(buf, count, conn_info);
+  inferred_protocol = infer_protocol(buf, count, conn_info);
 
   // Could not infer the traffic.
   if (inferred_protocol.protocol == kProtocolUnknown || conn_info->protocol == kProtocolMongo) {
-    return;
+    return inferred_protocol;
   }
 
   // Update protocol if not set.
@@ -291,6 +290,8 @@ static __inline void update_traffic_class(struct conn_info_t* conn_info,
                           ? kRoleClient
                           : kRoleServer;
   }
+
+  return inferred_protocol;
 }
 
 /***********************************************************
@@ -461,6 +462,59 @@ static __inline void perf_submit_wrapper(struct pt_regs* ctx,
   }
 }
 
+// Submits only the frame headers and the first HTTP_PAYLOAD_PREFIX_BYTES (DB_PAYLOAD_PREFIX_BYTES
+// for MySQL/PgSQL) bytes of the payload of each frame in buf. The rest of each frame is submitted
+// as filler events, which carry no data. See payload_truncation.h.
+static __inline void perf_submit_truncated(struct pt_regs* ctx,
+                                           const enum traffic_direction_t direction,
+                                           const char* buf, const size_t buf_size,
+                                           bool at_message_start, struct conn_info_t* conn_info,
+                                           struct socket_data_event_t* event) {
+  struct frame_cursor_t* cursor =
+      (direction == kEgress) ? &conn_info->wr_cursor : &conn_info->rd_cursor;
+  const uint64_t start_pos = event->attr.pos;
+  const size_t prefix_bytes =
+      (conn_info->protocol == kProtocolHTTP) ? HTTP_PAYLOAD_PREFIX_BYTES : DB_PAYLOAD_PREFIX_BYTES;
+
+  // The bytes in [kept_offset, offset) are yet to be submitted.
+  size_t kept_offset = 0;
+  size_t offset = 0;
+
+  // Bounded loop, which requires kernel 5.3+. ENABLE_PAYLOAD_TRUNCATION is only set on those.
+  for (int i = 0; i < FRAME_LOOP_LIMIT && offset < buf_size; ++i) {
+    size_t keep = 0;
+    size_t skip = 0;
+    // The message buffer of the event is free until the next submission, which copies the data
+    // again, so the HTTP header scan uses it as scratch.
+    next_payload_segment(conn_info, direction, buf + offset, start_pos + offset,
+                         buf_size - offset, at_message_start && offset == 0, prefix_bytes,
+                         event->msg, &keep, &skip);
+    offset += keep;
+
+    if (skip > 0) {
+      perf_submit_wrapper(ctx, direction, buf + kept_offset, offset - kept_offset, conn_info,
+                          event);
+
+      event->attr.msg_size = skip;
+      event->attr.msg_buf_size = 0;
+      socket_data_events.perf_submit(ctx, event, sizeof(event->attr));
+      event->attr.pos += skip;
+
+      offset += skip;
+      kept_offset = offset;
+    }
+  }
+
+  if (offset < buf_size) {
+    // Ran out of iterations. The rest of the data is submitted in full, and the frames are no
+    // longer followed, until a new message is inferred.
+    cursor->frame_end_pos = 0;
+    cursor->keep_end_pos = 0;
+  }
+
+  perf_submit_wrapper(ctx, direction, buf + kept_offset, buf_size - kept_offset, conn_info, event);
+}
+
 static __inline void perf_submit_iovecs(struct pt_regs* ctx,
                                         const enum traffic_direction_t direction,
                                         const struct iovec* iov, const size_t iovlen,
@@ -665,6 +719,12 @@ static __inline void update_conn_stats(struct pt_regs* ctx, struct conn_info_t*
       break;
   }
 
+  // User-space reads the stats of open connections from conn_info_map directly.
+  // Only the final stats of a connection are sent, on close.
+  if (ENABLE_CONN_STATS_MAP) {
+    return;
+  }
+
   // Only send event if there's been enough of a change.
   // TODO(oazizi): Add elapsed time since last send as a triggering condition too.
   uint64_t total_bytes = conn_info->wr_bytes + conn_info->rd_bytes;
@@ -726,8 +786,9 @@ static __inline void process_data(const bool vecs, struct pt_regs* ctx, uint64_t
     // TODO(yzhao): Split the interface such that the singular buf case and multiple bufs in msghdr
     // are handled separately without mixed interface. The plan is to factor out helper functions
     // for lower-level functionalities, and call them separately for each case.
+    struct protocol_message_t inferred_message = {};
     if (!vecs) {
-      update_traffic_class(conn_info, direction, args->buf, bytes_count);
+      inferred_message = update_traffic_class(conn_info, direction, args->buf, bytes_count);
     } else {
       struct iovec iov_cpy;
       size_t buf_size = 0;
@@ -754,7 +815,16 @@ static __inline void process_data(const bool vecs, struct pt_regs* ctx, uint64_t
       }
 
       // TODO(yzhao): Same TODO for split the interface.
-      if (!vecs) {
+      if (!vecs && ENABLE_PAYLOAD_TRUNCATION &&
+          is_truncatable_protocol(conn_info->protocol, DB_PAYLOAD_PREFIX_BYTES > 0)) {
+        // A message inferred at the start of the data means that a frame starts there. Unless the
+        // header of the frame was read separately beforehand.
+        bool at_message_start = inferred_message.protocol == conn_info->protocol &&
+                                inferred_message.type != kUnknown &&
+                                !conn_info->prepend_length_header;
+        perf_submit_truncated(ctx, direction, args->buf, bytes_count, at_message_start, conn_info,
+                              event);
+      } else if (!vecs) {
         perf_submit_wrapper(ctx, direction, args->buf, bytes_count, conn_info, event);
       } else {
         // TODO(yzhao): iov[0] is copied twice, once in calling update_traffic_class(), and here.
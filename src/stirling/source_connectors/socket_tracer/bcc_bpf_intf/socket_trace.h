@@ -31,6 +31,10 @@ const char kControlValuesArrayName[] = "control_values";
 
 const int64_t kTraceAllTGIDs = -1;
 
+// This is the amount of activity required on a connection before a new ConnStats event
+// is reported to user-space. It applies to read and write traffic combined.
+const int kConnStatsDataThreshold = 65536;
+
 // Note: A value of 100 results in >4096 BPF instructions, which is too much for older kernels.
 #define CONN_CLEANUP_ITERS 85
 const int kMaxConnMapCleanupItems = CONN_CLEANUP_ITERS;
@@ -41,6 +45,16 @@ union sockaddr_t {
   struct sockaddr_in6 in6;
 };
 
+// Tracks the frames of a direction of a connection, for in-kernel payload truncation.
+// Positions are in the same coordinates as wr_bytes/rd_bytes of conn_info_t.
+struct frame_cursor_t {
+  // The position where the current frame ends, and the next frame header is expected.
+  // 0 if the frames are not being followed.
+  uint64_t frame_end_pos;
+  // The position up to which the bytes of the current frame are submitted to user space.
+  uint64_t keep_end_pos;
+};
+
 // This struct contains information collected when a connection is established,
 // via an accept() syscall.
 struct conn_info_t {
@@ -85,6 +99,13 @@ struct conn_info_t {
   size_t prev_count;
   char prev_buf[4];
   bool prepend_length_header;
+
+  // The frames being written/read on this connection. Only used by payload truncation.
+  struct frame_cursor_t wr_cursor;
+  struct frame_cursor_t rd_cursor;
+  // Whether the last HTTP request on this connection was HEAD, whose response has no body.
+  // Only used by payload truncation.
+  bool http_head_request;
 };
 
 // This struct is a subset of conn_info_t. It is used to communicate connect/accept events.
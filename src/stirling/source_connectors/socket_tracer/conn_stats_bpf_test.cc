@@ -16,6 +16,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "src/common/testing/testing.h"
 #include "src/stirling/core/output.h"
 #include "src/stirling/source_connectors/socket_tracer/testing/client_server_system.h"
@@ -203,6 +207,63 @@ TEST_F(ConnStatsBPFTest, RoleFromConnectAccept) {
   }
 }
 
+// Tests that the byte counts of open connections are read from conn_info_map, both with batched
+// lookups and one entry at a time, as on kernels without batched lookups.
+TEST_F(ConnStatsBPFTest, ReadConnInfos) {
+  TCPSocket server_listener;
+  server_listener.BindAndListen();
+  TCPSocket client;
+  client.Connect(server_listener);
+  std::unique_ptr<TCPSocket> server = server_listener.Accept();
+
+  std::string_view test_msg = "Hello World!";
+  EXPECT_EQ(test_msg.size(), client.Send(test_msg));
+  std::string text;
+  while (!server->Recv(&text)) {
+  }
+
+  auto find_conn_info = [](const std::vector<struct conn_info_t>& conn_infos,
+                           int fd) -> std::optional<struct conn_info_t> {
+    for (const auto& conn_info : conn_infos) {
+      if (conn_info.conn_id.upid.pid == static_cast<uint32_t>(getpid()) &&
+          conn_info.conn_id.fd == fd) {
+        return conn_info;
+      }
+    }
+    return std::nullopt;
+  };
+
+  ConnInfoMapManager* conn_info_map_mgr = source_->test_only_conn_info_map_mgr();
+  ASSERT_NE(conn_info_map_mgr, nullptr);
+
+  std::vector<struct conn_info_t> batched_conn_infos;
+  conn_info_map_mgr->ReadConnInfos(&batched_conn_infos);
+  LOG(INFO) << absl::Substitute("Batched lookups supported: $0",
+                                conn_info_map_mgr->batched_lookup_supported());
+
+  conn_info_map_mgr->test_only_disable_batched_lookup();
+  std::vector<struct conn_info_t> conn_infos;
+  conn_info_map_mgr->ReadConnInfos(&conn_infos);
+
+  for (const auto* read_conn_infos : {&batched_conn_infos, &conn_infos}) {
+    std::optional<struct conn_info_t> client_info =
+        find_conn_info(*read_conn_infos, client.sockfd());
+    ASSERT_TRUE(client_info.has_value());
+    EXPECT_EQ(client_info->wr_bytes, static_cast<int64_t>(test_msg.size()));
+    EXPECT_EQ(client_info->rd_bytes, 0);
+
+    std::optional<struct conn_info_t> server_info =
+        find_conn_info(*read_conn_infos, server->sockfd());
+    ASSERT_TRUE(server_info.has_value());
+    EXPECT_EQ(server_info->wr_bytes, 0);
+    EXPECT_EQ(server_info->rd_bytes, static_cast<int64_t>(test_msg.size()));
+  }
+
+  client.Close();
+  server->Close();
+  server_listener.Close();
+}
+
 // Test fixture that starts SocketTraceConnector after the connection was already established.
 class ConnStatsMidConnBPFTest
     : public testing::SocketTraceBPFTestFixture</* TClientSideTracing */ false> {
@@ -396,5 +396,41 @@ TEST_F(ConnStatsTest, DisabledConnTracker) {
               ElementsAre(Pair(AggKeyIs(11111, "1.1.1.1", 80), StatsIs(1, 1, 200, 100))));
 }
 
+// Tests that the close of a connection is counted, even if its final stats event is older than
+// the stats read from conn_info_map, which happens if the map is read between the submission of
+// the final event and the removal of the map entry.
+TEST_F(ConnStatsTest, CloseEventOlderThanMapStats) {
+  constexpr struct conn_id_t kConnID0 = {
+      .upid = {.pid = 11111, .start_time_ticks = 1000},
+      .fd = 3,
+      .tsid = 10000,
+  };
+
+  struct conn_stats_event_t conn_stats_event;
+  conn_stats_event.timestamp_ns = 0;
+  conn_stats_event.conn_id = kConnID0;
+  conn_stats_event.role = kRoleClient;
+  conn_stats_event.addr.in4.sin_family = AF_INET;
+  conn_stats_event.addr.in4.sin_port = htons(80);
+  conn_stats_event.addr.in4.sin_addr.s_addr = 0x01010101;  // 1.1.1.1
+  conn_stats_event.conn_events = 0;
+  conn_stats_event.rd_bytes = 100;
+  conn_stats_event.wr_bytes = 200;
+
+  ConnTracker& tracker = conn_trackers_mgr_.GetOrCreateConnTracker(conn_stats_event.conn_id);
+
+  // The stats read from the map.
+  conn_stats_event.timestamp_ns = 2;
+  tracker.AddConnStats(conn_stats_event);
+
+  // The final stats event, submitted right before the map was read.
+  conn_stats_event.timestamp_ns = 1;
+  conn_stats_event.conn_events |= CONN_CLOSE;
+  tracker.AddConnStats(conn_stats_event);
+
+  EXPECT_THAT(conn_stats_.UpdateStats(),
+              ElementsAre(Pair(AggKeyIs(11111, "1.1.1.1", 80), StatsIs(1, 1, 200, 100))));
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -42,6 +42,7 @@
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
 #include "src/stirling/source_connectors/socket_tracer/metrics.h"
 #include "src/stirling/utils/enum_map.h"
+#include "src/stirling/utils/slab_allocator.h"
 
 DEFINE_bool(treat_loopback_as_in_cluster, true,
             "Whether loopback is treated as inside the cluster of not");
@@ -73,6 +74,40 @@ constexpr double kStitchFailureRateThreshold = 0.5;
 // ConnTracker
 //--------------------------------------------------------------
 
+namespace {
+
+using ConnTrackerSlabAllocator = SlabAllocator<sizeof(ConnTracker)>;
+
+ConnTrackerSlabAllocator& GetSlabAllocator() {
+  // Never destroyed, since trackers may outlive other static objects.
+  static auto* allocator = new ConnTrackerSlabAllocator();
+  return *allocator;
+}
+
+}  // namespace
+
+void* ConnTracker::operator new(size_t size) {
+  // Derived classes do not fit in the slots.
+  if (size != sizeof(ConnTracker)) {
+    return ::operator new(size);
+  }
+  return GetSlabAllocator().Allocate();
+}
+
+void ConnTracker::operator delete(void* ptr, size_t size) {
+  if (size != sizeof(ConnTracker)) {
+    ::operator delete(ptr);
+    return;
+  }
+  GetSlabAllocator().Deallocate(ptr);
+}
+
+size_t ConnTracker::MemoryUsage() const {
+  return ConnTrackerSlabAllocator::kBytesPerObj + send_data_.MemoryUsage() +
+         recv_data_.MemoryUsage() + http2_client_streams_.StreamsSize() +
+         http2_server_streams_.StreamsSize();
+}
+
 ConnTracker::~ConnTracker() {
   CONN_TRACE(2) << "Being destroyed";
   if (conn_info_map_mgr_ != nullptr) {
@@ -190,9 +225,19 @@ void UpdateProtocolMetrics(traffic_protocol_t protocol, const conn_stats_event_t
 }  // namespace
 
 void ConnTracker::AddConnStats(const conn_stats_event_t& event) {
+  UpdateTimestamps(event.timestamp_ns);
+  UpdateConnStats(event);
+}
+
+void ConnTracker::AddConnStatsSnapshot(const conn_stats_event_t& event) {
+  // Snapshots are taken periodically, even of idle connections, so they must not count as activity.
+  // Otherwise idle connections would never be flushed, or checked for a close in /proc.
+  UpdateConnStats(event);
+}
+
+void ConnTracker::UpdateConnStats(const conn_stats_event_t& event) {
   SetRole(event.role, "inferred from conn_stats event");
   SetRemoteAddr(event.addr, "conn_stats event");
-  UpdateTimestamps(event.timestamp_ns);
 
   CONN_TRACE(1) << absl::Substitute("ConnStats timestamp=$0 wr=$1 rd=$2 close=$3",
                                     event.timestamp_ns, event.wr_bytes, event.rd_bytes,
@@ -212,7 +257,12 @@ void ConnTracker::AddConnStats(const conn_stats_event_t& event) {
 
     last_conn_stats_update_ = event.timestamp_ns;
   } else {
-    DCHECK_LE(static_cast<bool>(event.conn_events & CONN_CLOSE), conn_stats_.closed());
+    // The stats read from conn_info_map can be newer than the final stats event of a connection,
+    // if read after the event was submitted, but before the map entry was removed.
+    // The close still has to be counted.
+    if (event.conn_events & CONN_CLOSE) {
+      conn_stats_.set_closed(true);
+    }
     DCHECK_LE(event.rd_bytes, conn_stats_.bytes_recv());
     DCHECK_LE(event.wr_bytes, conn_stats_.bytes_sent());
   }
@@ -198,6 +198,14 @@ class ConnTracker : NotCopyMoveable {
 
   ~ConnTracker();
 
+  // There is a ConnTracker for every connection on the host, and most of them are long-lived, so
+  // they are packed into slabs instead of being allocated individually.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+  // ObjPool re-initializes recycled trackers in place.
+  static void* operator new(size_t, void* ptr) noexcept { return ptr; }
+  static void operator delete(void*, void*) noexcept {}
+
   /**
    * Registers a BPF connection control event into the tracker.
    *
@@ -219,6 +227,15 @@ class ConnTracker : NotCopyMoveable {
    */
   void AddConnStats(const conn_stats_event_t& event);
 
+  /**
+   * Registers connection stats read from a periodic snapshot of the BPF conn_info_map.
+   * Unlike AddConnStats(), a snapshot is not a sign of activity on the connection, so it only
+   * updates the stats, and leaves the inactivity tracking of the tracker untouched.
+   *
+   * @param event The stats of the connection, as read from the map.
+   */
+  void AddConnStatsSnapshot(const conn_stats_event_t& event);
+
   /**
    * Add a recorded HTTP2 header (name-value pair).
    * The struct should contain stream ID and other meta-data so it can matched with other HTTP2
@@ -282,6 +299,28 @@ class ConnTracker : NotCopyMoveable {
     return std::move(result.records);
   }
 
+  /**
+   * Returns true if the tracker holds no unprocessed data or parsed frames, as is the case for
+   * connections that are kept open without traffic.
+   */
+  bool IsIdle() const {
+    return send_data_.IsIdle() && recv_data_.IsIdle() && http2_client_streams_.streams().empty() &&
+           http2_server_streams_.streams().empty();
+  }
+
+  /**
+   * Does the bookkeeping of ProcessToRecords() for an idle tracker, without allocating anything.
+   */
+  void ProcessIdle() {
+    send_data_.ProcessIdle();
+    recv_data_.ProcessIdle();
+  }
+
+  /**
+   * Approximate number of bytes allocated for this tracker, including the tracker itself.
+   */
+  size_t MemoryUsage() const;
+
   /**
    * Returns reference to current set of unconsumed requests.
    * Note: A call to ProcessBytesToFrames() is required to parse new requests.
@@ -637,6 +676,7 @@ class ConnTracker : NotCopyMoveable {
   void AddConnCloseEvent(const socket_control_event_t& close_event);
 
   void UpdateTimestamps(uint64_t bpf_timestamp);
+  void UpdateConnStats(const conn_stats_event_t& event);
 
   // Called when any events were received for a connection.
   void CheckTracker();
@@ -827,6 +827,49 @@ TEST_F(ConnTrackerTest, ConnStats) {
   }
 }
 
+// Tests that stats from snapshots of conn_info_map are not treated as activity on the connection,
+// so that an idle connection stays idle while its stats keep being read.
+TEST_F(ConnTrackerTest, ConnStatsSnapshotIsNotActivity) {
+  ConnTracker tracker;
+
+  constexpr struct conn_id_t kConnID0 = {
+      .upid = {.pid = 12345, .start_time_ticks = 1000},
+      .fd = 3,
+      .tsid = 111110,
+  };
+
+  struct conn_stats_event_t conn_stats_event = {};
+  conn_stats_event.timestamp_ns = 1;
+  conn_stats_event.conn_id = kConnID0;
+  conn_stats_event.role = kRoleClient;
+  reinterpret_cast<struct sockaddr_in*>(&conn_stats_event.addr)->sin_family = AF_INET;
+  reinterpret_cast<struct sockaddr_in*>(&conn_stats_event.addr)->sin_port = htons(80);
+  reinterpret_cast<struct sockaddr_in*>(&conn_stats_event.addr)->sin_addr.s_addr =
+      0x01010101;  // 1.1.1.1
+  conn_stats_event.conn_events = CONN_OPEN;
+  conn_stats_event.rd_bytes = 10;
+  conn_stats_event.wr_bytes = 20;
+
+  const auto start = now();
+  tracker.set_current_time(start);
+  tracker.AddConnStats(conn_stats_event);
+  EXPECT_EQ(tracker.last_update_timestamp(), start);
+
+  for (int i = 1; i <= 3; ++i) {
+    tracker.IterationPreTick(start + std::chrono::seconds(5 * i), /* cluster_cidrs */ {},
+                             /* proc_parser */ nullptr, /* socket_info_mgr */ nullptr);
+    conn_stats_event.timestamp_ns += 1;
+    conn_stats_event.rd_bytes += 10;
+    tracker.AddConnStatsSnapshot(conn_stats_event);
+    tracker.IterationPostTick();
+  }
+
+  // The stats were updated, but the connection was idle since the first event.
+  EXPECT_EQ(tracker.conn_stats().BytesRecvSinceLastRead(), 40);
+  EXPECT_EQ(tracker.conn_stats().BytesSentSinceLastRead(), 20);
+  EXPECT_EQ(tracker.last_update_timestamp(), start);
+}
+
 struct UpdateStateParam {
   traffic_protocol_t protocol;
   endpoint_role_t role;
@@ -18,6 +18,9 @@
 
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
 
+#include <algorithm>
+#include <iterator>
+
 DEFINE_double(
     stirling_conn_tracker_cleanup_threshold, 0.2,
     "Percentage of trackers that are ready for destruction that will trigger a memory cleanup");
@@ -152,16 +155,11 @@ StatusOr<const ConnTracker*> ConnTrackersManager::GetConnTracker(uint32_t pid, i
 
 void ConnTrackersManager::CleanupTrackers() {
   {
-    auto iter = active_trackers_.begin();
-    while (iter != active_trackers_.end()) {
-      const auto& tracker = *iter;
-      if (tracker->ReadyForDestruction()) {
-        active_trackers_.erase(iter++);
-        stats_.Increment(StatKey::kReadyForDestruction);
-      } else {
-        ++iter;
-      }
-    }
+    auto iter =
+        std::remove_if(active_trackers_.begin(), active_trackers_.end(),
+                       [](const ConnTracker* tracker) { return tracker->ReadyForDestruction(); });
+    stats_.Increment(StatKey::kReadyForDestruction, std::distance(iter, active_trackers_.end()));
+    active_trackers_.erase(iter, active_trackers_.end());
   }
 
   // As a performance optimization, we only clean up trackers once we reach a certain threshold
@@ -215,14 +213,33 @@ std::string ConnTrackersManager::DebugInfo() const {
 }
 
 std::string ConnTrackersManager::StatsString() const {
-  return absl::StrCat(stats_.Print(), protocol_stats_.Print());
+  return absl::StrCat(stats_.Print(), protocol_stats_.Print(), memory_stats_.Print());
 }
 
 void ConnTrackersManager::ComputeProtocolStats() {
   absl::flat_hash_map<traffic_protocol_t, int> protocol_count;
+  int64_t num_idle = 0;
+  int64_t idle_bytes = 0;
+  int64_t total_bytes = 0;
   for (const auto* tracker : active_trackers_) {
     ++protocol_count[tracker->protocol()];
+
+    const size_t bytes = tracker->MemoryUsage();
+    total_bytes += bytes;
+    if (tracker->IsIdle()) {
+      ++num_idle;
+      idle_bytes += bytes;
+    }
   }
+  memory_stats_.Reset(MemoryStatKey::kIdle);
+  memory_stats_.Increment(MemoryStatKey::kIdle, num_idle);
+  memory_stats_.Reset(MemoryStatKey::kIdleBytes);
+  memory_stats_.Increment(MemoryStatKey::kIdleBytes, idle_bytes);
+  memory_stats_.Reset(MemoryStatKey::kBytesPerIdle);
+  memory_stats_.Increment(MemoryStatKey::kBytesPerIdle, num_idle == 0 ? 0 : idle_bytes / num_idle);
+  memory_stats_.Reset(MemoryStatKey::kTotalBytes);
+  memory_stats_.Increment(MemoryStatKey::kTotalBytes, total_bytes);
+
   for (auto protocol : magic_enum::enum_values<traffic_protocol_t>()) {
     protocol_stats_.Reset(protocol);
     auto iter = protocol_count.find(protocol);
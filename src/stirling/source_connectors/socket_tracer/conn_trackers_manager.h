@@ -18,7 +18,6 @@
 
 #pragma once
 
-#include <list>
 #include <map>
 #include <memory>
 #include <set>
@@ -97,6 +96,16 @@ class ConnTrackersManager {
     kDestroyedGens,
   };
 
+  enum class MemoryStatKey {
+    // The number of active trackers without any unprocessed data.
+    kIdle,
+    // The bytes allocated for the idle trackers, and per idle tracker.
+    kIdleBytes,
+    kBytesPerIdle,
+    // The bytes allocated for all active trackers.
+    kTotalBytes,
+  };
+
   ConnTrackersManager();
 
   /**
@@ -105,7 +114,7 @@ class ConnTrackersManager {
    */
   ConnTracker& GetOrCreateConnTracker(struct conn_id_t conn_id);
 
-  const std::list<ConnTracker*>& active_trackers() const { return active_trackers_; }
+  const std::vector<ConnTracker*>& active_trackers() const { return active_trackers_; }
 
   /**
    * Returns the latest generation of a connection tracker for the given pid and fd.
@@ -127,6 +136,7 @@ class ConnTrackersManager {
 
   /**
    * Computes the count of ConnTracker objects for each protocol and stores them into stats_.
+   * Also computes the memory used by the idle and all the active ConnTracker objects.
    */
   void ComputeProtocolStats();
 
@@ -144,7 +154,9 @@ class ConnTrackersManager {
   // Key is {PID, FD} for outer map, and tsid for inner map.
   absl::flat_hash_map<uint64_t, ConnTrackerGenerations> conn_id_tracker_generations_;
 
-  std::list<ConnTracker*> active_trackers_;
+  // The trackers that are not ReadyForDestruction(). A vector keeps the iteration over all
+  // trackers on every transfer cache-friendly; it is compacted in CleanupTrackers().
+  std::vector<ConnTracker*> active_trackers_;
 
   // A pool of unused trackers that can be recycled.
   // This is useful for avoiding memory reallocations.
@@ -153,6 +165,7 @@ class ConnTrackersManager {
   // Records statistics of ConnTracker for reporting and consistency check.
   utils::StatCounter<StatKey> stats_;
   utils::StatCounter<traffic_protocol_t> protocol_stats_;
+  utils::StatCounter<MemoryStatKey> memory_stats_;
 };
 
 }  // namespace stirling
@@ -112,6 +112,26 @@ TEST_F(ConnTrackersManagerTest, DebugInfo) {
   EXPECT_THAT(debug_info, HasSubstr("conn_tracker=conn_id=[upid=1:1 fd=1 gen=1]"));
 }
 
+// Tests that the stats include the memory used by idle trackers.
+TEST_F(ConnTrackersManagerTest, IdleTrackerStats) {
+  struct conn_id_t conn_id = {};
+
+  conn_id.upid.pid = 1;
+  conn_id.upid.start_time_ticks = 1;
+  conn_id.fd = 1;
+  conn_id.tsid = 1;
+
+  ConnTracker& tracker = trackers_mgr_.GetOrCreateConnTracker(conn_id);
+  EXPECT_TRUE(tracker.IsIdle());
+  // An idle tracker has no buffers or frames allocated.
+  EXPECT_LT(tracker.MemoryUsage(), 2 * sizeof(ConnTracker));
+
+  trackers_mgr_.ComputeProtocolStats();
+  EXPECT_THAT(trackers_mgr_.StatsString(),
+              HasSubstr(absl::Substitute("kIdle=1 kIdleBytes=$0 kBytesPerIdle=$0 kTotalBytes=$0",
+                                         tracker.MemoryUsage())));
+}
+
 class ConnTrackerGenerationsTest : public ::testing::Test {
  protected:
   ConnTrackerGenerationsTest() : tracker_pool(1024) {
@@ -203,12 +203,27 @@ template void DataStream::ProcessBytesToFrames<protocols::nats::Message, protoco
     message_type_t type, protocols::NoState* state);
 template void DataStream::ProcessBytesToFrames<protocols::amqp::Frame, protocols::NoState>(
     message_type_t type, protocols::NoState* state);
+size_t DataStream::MemoryUsage() const {
+  size_t usage = data_buffer_.MemoryUsage();
+  std::visit(
+      [&usage](const auto& frames) {
+        if constexpr (!std::is_same_v<std::decay_t<decltype(frames)>, std::monostate>) {
+          for (const auto& frame : frames) {
+            usage += frame.ByteSize();
+          }
+        }
+      },
+      frames_);
+  return usage;
+}
+
 void DataStream::Reset() {
   data_buffer_.Reset();
   has_new_events_ = false;
   UpdateLastProgressTime();
 
   frames_ = std::monostate();
+  released_frames_index_ = 0;
 }
 
 }  // namespace stirling
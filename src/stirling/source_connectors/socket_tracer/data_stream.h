@@ -74,12 +74,12 @@ class DataStream : NotCopyMoveable {
    */
   template <typename TFrameType>
   void InitFrames() {
-    DCHECK(std::holds_alternative<std::monostate>(frames_) ||
-           std::holds_alternative<std::deque<TFrameType>>(frames_))
+    DCHECK(std::holds_alternative<std::deque<TFrameType>>(frames_) ||
+           IsReleasedOrUnset<TFrameType>())
         << absl::Substitute(
                "Must hold the default std::monostate, or the same type as requested. "
                "I.e., ConnTracker cannot change the type it holds during runtime. $0 -> $1",
-               frames_.index(), typeid(TFrameType).name());
+               FramesIndex(), typeid(TFrameType).name());
     if (std::holds_alternative<std::monostate>(frames_)) {
       // Reset the type to the expected type.
       frames_ = std::deque<TFrameType>();
@@ -106,10 +106,17 @@ class DataStream : NotCopyMoveable {
 
   template <typename TFrameType>
   const std::deque<TFrameType>& Frames() const {
-    DCHECK(std::holds_alternative<std::deque<TFrameType>>(frames_)) << absl::Substitute(
-        "Must hold the same type as requested. "
-        "I.e., ConnTracker cannot change the type it holds during runtime. $0 -> $1",
-        frames_.index(), typeid(TFrameType).name());
+    DCHECK(std::holds_alternative<std::deque<TFrameType>>(frames_) ||
+           IsReleasedOrUnset<TFrameType>())
+        << absl::Substitute(
+               "Must hold the same type as requested. "
+               "I.e., ConnTracker cannot change the type it holds during runtime. $0 -> $1",
+               FramesIndex(), typeid(TFrameType).name());
+    // The frames are released while the stream is idle, which is the same as having none.
+    if (std::holds_alternative<std::monostate>(frames_)) {
+      static const std::deque<TFrameType> kNoFrames;
+      return kNoFrames;
+    }
     return std::get<std::deque<TFrameType>>(frames_);
   }
 
@@ -140,6 +147,32 @@ class DataStream : NotCopyMoveable {
                                     std::get<std::deque<TFrameType>>(frames_).empty());
   }
 
+  /**
+   * Checks if the DataStream holds no raw events, and has no frame container allocated.
+   * There is nothing to parse or clean up in an idle stream.
+   */
+  bool IsIdle() const {
+    return !has_new_events_ && data_buffer_.empty() &&
+           std::holds_alternative<std::monostate>(frames_);
+  }
+
+  /**
+   * Performs the bookkeeping that ProcessBytesToFrames() would do on an idle stream, without
+   * allocating the frame container.
+   */
+  void ProcessIdle() {
+    DCHECK(IsIdle());
+    UpdateLastProgressTime();
+    last_processed_pos_ = data_buffer_.position();
+    last_parse_state_ = ParseState::kNeedsMoreData;
+  }
+
+  /**
+   * Approximate number of bytes allocated by the raw events and the parsed frames, excluding
+   * this object itself.
+   */
+  size_t MemoryUsage() const;
+
   /**
    * If buffer has not been successfully processed in the past kSyncTimeout duration,
    * run ParseFrames() with a search for a new message boundary.
@@ -216,6 +249,10 @@ class DataStream : NotCopyMoveable {
   template <typename TFrameType>
   void CleanupFrames(size_t size_limit_bytes,
                      std::chrono::time_point<std::chrono::steady_clock> expiry_timestamp) {
+    if (std::holds_alternative<std::monostate>(frames_)) {
+      return;
+    }
+
     size_t size = FramesSize<TFrameType>();
     if (size > size_limit_bytes) {
       VLOG(1) << absl::Substitute("Messages cleared due to size limit ($0 > $1).", size,
@@ -223,6 +260,14 @@ class DataStream : NotCopyMoveable {
       Frames<TFrameType>().clear();
     }
     EraseExpiredFrames(expiry_timestamp, &Frames<TFrameType>());
+
+    // Release the frame container once everything has been consumed, so that idle connections
+    // do not hold on to it. It is re-created when new data arrives.
+    // The type it held is remembered, so that a switch to another type is still caught.
+    if (Frames<TFrameType>().empty() && data_buffer_.empty()) {
+      released_frames_index_ = frames_.index();
+      frames_ = std::monostate();
+    }
   }
 
   /**
@@ -252,6 +297,31 @@ class DataStream : NotCopyMoveable {
   protocols::DataStreamBuffer& data_buffer() { return data_buffer_; }
 
  private:
+  // The index of std::deque<TFrameType> in protocols::FrameDequeVariant.
+  template <typename TFrameType, size_t I = 0>
+  static constexpr size_t FrameDequeIndex() {
+    using TAlternative = std::variant_alternative_t<I, protocols::FrameDequeVariant>;
+    if constexpr (std::is_same_v<TAlternative, std::deque<TFrameType>>) {
+      return I;
+    } else {
+      return FrameDequeIndex<TFrameType, I + 1>();
+    }
+  }
+
+  // Checks that frames_ holds nothing, and that any frames it released were of type TFrameType.
+  template <typename TFrameType>
+  bool IsReleasedOrUnset() const {
+    return std::holds_alternative<std::monostate>(frames_) &&
+           (released_frames_index_ == 0 ||
+            released_frames_index_ == FrameDequeIndex<TFrameType>());
+  }
+
+  // The index of the type that frames_ holds, or held before it was released.
+  size_t FramesIndex() const {
+    return std::holds_alternative<std::monostate>(frames_) ? released_frames_index_
+                                                           : frames_.index();
+  }
+
   template <typename TFrameType>
   static void EraseExpiredFrames(
       std::chrono::time_point<std::chrono::steady_clock> expiry_timestamp,
@@ -285,6 +355,10 @@ class DataStream : NotCopyMoveable {
   // bug, so we add std::monostate as the default type. And switch to the right time in runtime.
   protocols::FrameDequeVariant frames_;
 
+  // The index of the type that frames_ held before CleanupFrames() released it, or 0 (i.e.
+  // std::monostate) if it was never released.
+  uint8_t released_frames_index_ = 0;
+
   // The following state keeps track of whether the raw events were touched or not since the last
   // call to ProcessBytesToFrames(). It enables ProcessToRecords() to exit early if nothing has
   // changed.
@@ -49,7 +49,7 @@ class DataStreamTest : public ::testing::Test {
 
   void TearDown() override {
     TestOnlyResetMetricsRegistry();
-    SocketTracerMetrics::TestOnlyResetProtocolMetrics(kProtocolHTTP);
+    SocketTracerMetrics::TestOnlyResetProtocolMetrics();
   }
 
   std::chrono::steady_clock::time_point now() {
@@ -397,6 +397,70 @@ TEST_F(DataStreamTest, CannotSwitchType) {
 #endif
 }
 
+TEST_F(DataStreamTest, ReleasesFramesOfIdleStream) {
+  const size_t size_limit_bytes = 1024 * 1024;
+  const auto expiry_timestamp = now() - std::chrono::seconds(10000);
+  protocols::http::StateWrapper state{};
+  DataStream stream;
+  stream.set_protocol(kProtocolHTTP);
+
+  // Nothing is allocated before any data arrives.
+  EXPECT_TRUE(stream.IsIdle());
+  EXPECT_EQ(stream.MemoryUsage(), 0);
+
+  stream.AddData(event_gen_.InitSendEvent<kProtocolHTTP>(kHTTPReq0));
+  EXPECT_FALSE(stream.IsIdle());
+  EXPECT_GT(stream.MemoryUsage(), 0);
+
+  stream.ProcessBytesToFrames<http::Message>(message_type_t::kRequest, &state);
+  EXPECT_THAT(stream.Frames<http::Message>(), SizeIs(1));
+
+  // The frame is not consumed yet, so the frames are kept.
+  stream.CleanupFrames<http::Message>(size_limit_bytes, expiry_timestamp);
+  EXPECT_FALSE(stream.IsIdle());
+  EXPECT_THAT(stream.Frames<http::Message>(), SizeIs(1));
+
+  // Once the frame is consumed, the frames are released.
+  stream.Frames<http::Message>().clear();
+  stream.CleanupFrames<http::Message>(size_limit_bytes, expiry_timestamp);
+  EXPECT_TRUE(stream.IsIdle());
+  EXPECT_THAT(std::as_const(stream).Frames<http::Message>(), IsEmpty());
+
+  // The frames are re-created when more data arrives.
+  stream.AddData(event_gen_.InitSendEvent<kProtocolHTTP>(kHTTPReq1));
+  stream.ProcessBytesToFrames<http::Message>(message_type_t::kRequest, &state);
+  EXPECT_THAT(stream.Frames<http::Message>(), SizeIs(1));
+}
+
+TEST_F(DataStreamTest, CannotSwitchTypeAfterReleasingFrames) {
+  protocols::http::StateWrapper http_state{};
+  DataStream stream;
+  stream.set_protocol(kProtocolHTTP);
+
+  stream.ProcessBytesToFrames<http::Message>(message_type_t::kRequest, &http_state);
+  stream.CleanupFrames<http::Message>(/*size_limit_bytes*/ 1024,
+                                      /*expiry_timestamp*/ now() - std::chrono::seconds(10000));
+  ASSERT_TRUE(stream.IsIdle());
+
+  // The same type can be used again.
+  stream.ProcessBytesToFrames<http::Message>(message_type_t::kRequest, &http_state);
+  stream.CleanupFrames<http::Message>(/*size_limit_bytes*/ 1024,
+                                      /*expiry_timestamp*/ now() - std::chrono::seconds(10000));
+  ASSERT_TRUE(stream.IsIdle());
+
+#if DCHECK_IS_ON()
+  protocols::mysql::StateWrapper mysql_state{};
+  EXPECT_DEATH(stream.ProcessBytesToFrames<mysql::Packet>(message_type_t::kRequest, &mysql_state),
+               "ConnTracker cannot change the type it holds during runtime");
+#endif
+
+  // A reset clears the type.
+  stream.Reset();
+  protocols::mysql::StateWrapper mysql_state{};
+  stream.ProcessBytesToFrames<mysql::Packet>(message_type_t::kRequest, &mysql_state);
+  EXPECT_THAT(stream.Frames<mysql::Packet>(), IsEmpty());
+}
+
 TEST_F(DataStreamTest, SpikeCapacityWithLargeDataChunk) {
   int spike_capacity_bytes = 1024;
   int retention_capacity_bytes = 16;
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/go_uprobe_deploy_pipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+void LogAnalysisFailure(const std::string& binary, const Status& status) {
+  LOG(WARNING) << absl::Substitute(
+      "Cannot analyze binary $0 for uprobe deployment. "
+      "If file is under /var/lib, container may have terminated. "
+      "Message = $1",
+      binary, status.msg());
+}
+
+}  // namespace
+
+int GoUProbeDeployPipeline::Run(const std::map<std::string, std::vector<int32_t>>& pids_by_binary) {
+  struct NewBinary {
+    const std::string* path;
+    const std::vector<int32_t>* pids;
+    std::string key;
+  };
+
+  // Stage 1: Identify the binaries, and look up the ones that have been analyzed before.
+  std::vector<NewBinary> new_binaries;
+  absl::flat_hash_map<std::string, std::shared_ptr<const GoBinaryAnalysis>> analyses;
+  // The distinct binaries to analyze, as (key, path of one copy).
+  std::vector<std::pair<std::string, const std::string*>> to_analyze;
+  absl::flat_hash_map<std::string, size_t> to_analyze_idx;
+  for (const auto& [binary, pids] : pids_by_binary) {
+    StatusOr<std::string> key_status = stages_.identify(binary);
+    if (!key_status.ok()) {
+      LogAnalysisFailure(binary, key_status.status());
+      continue;
+    }
+    std::string key = key_status.ConsumeValueOrDie();
+
+    if (!analyses.contains(key) && !to_analyze_idx.contains(key)) {
+      std::shared_ptr<const GoBinaryAnalysis> analysis = stages_.lookup(key);
+      if (analysis != nullptr) {
+        analyses[key] = std::move(analysis);
+      } else {
+        to_analyze_idx[key] = to_analyze.size();
+        to_analyze.emplace_back(key, &binary);
+      }
+    }
+    new_binaries.push_back({&binary, &pids, std::move(key)});
+  }
+
+  size_t queue_depth = new_binaries.size();
+  stages_.queue_depth(queue_depth);
+
+  // Stage 2: Analyze the distinct binaries that have not been seen before, in parallel.
+  if (!to_analyze.empty()) {
+    std::vector<StatusOr<GoBinaryAnalysis>> results(to_analyze.size());
+
+    // The analyses are independent, so the workers simply claim the next one.
+    std::atomic<size_t> next = 0;
+    auto worker = [this, &to_analyze, &results, &next]() {
+      for (size_t i = next++; i < to_analyze.size(); i = next++) {
+        results[i] = stages_.analyze(*to_analyze[i].second);
+      }
+    };
+    const size_t num_threads = std::clamp<size_t>(num_analysis_threads_, 1, to_analyze.size());
+    std::vector<std::thread> threads;
+    // The calling thread is one of the workers.
+    for (size_t i = 1; i < num_threads; ++i) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (size_t i = 0; i < to_analyze.size(); ++i) {
+      const auto& [key, binary] = to_analyze[i];
+      if (!results[i].ok()) {
+        LogAnalysisFailure(*binary, results[i].status());
+        continue;
+      }
+      analyses[key] = stages_.insert(key, results[i].ConsumeValueOrDie());
+    }
+  }
+
+  // Stage 3: Attach uprobes, one binary at a time.
+  int uprobe_count = 0;
+  for (const NewBinary& binary : new_binaries) {
+    stages_.queue_depth(--queue_depth);
+
+    auto iter = analyses.find(binary.key);
+    if (iter == analyses.end()) {
+      // The analysis failed, and was already logged.
+      continue;
+    }
+    if (!iter->second->common_symaddrs.has_value()) {
+      // Not a golang program, or one without the mandatory symbols.
+      continue;
+    }
+    uprobe_count += stages_.attach(*binary.path, *binary.pids, *iter->second);
+  }
+  return uprobe_count;
+}
+
+}  // namespace stirling
+}  // namespace px
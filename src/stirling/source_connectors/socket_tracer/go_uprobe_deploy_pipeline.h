@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * Deploys Go uprobes on a set of new binaries, in three stages:
+ *  1. The binaries are grouped by identity, and the analyses of the ones seen before are looked
+ *     up. Copies of the same binary (e.g. one per container) share a single analysis.
+ *  2. The distinct binaries that were not seen before are analyzed, on up to
+ *     num_analysis_threads threads.
+ *  3. The uprobes are attached one binary at a time, in order of path, once all the analyses are
+ *     done. Attachment stays on the calling thread, since BCC is not thread-safe.
+ *
+ * The work of each stage is injected, so that the pipeline can be tested without BPF.
+ */
+class GoUProbeDeployPipeline {
+ public:
+  struct Stages {
+    // Returns the identity of a binary, see ElfReader::BinaryIdentity().
+    std::function<StatusOr<std::string>(const std::string& binary)> identify;
+    // Returns the analysis of a binary seen before, or nullptr.
+    std::function<std::shared_ptr<const GoBinaryAnalysis>(const std::string& key)> lookup;
+    // Analyzes a binary. Called concurrently for different binaries.
+    std::function<StatusOr<GoBinaryAnalysis>(const std::string& binary)> analyze;
+    // Keeps a new analysis, so that it can be looked up later.
+    std::function<std::shared_ptr<const GoBinaryAnalysis>(const std::string& key,
+                                                          GoBinaryAnalysis analysis)>
+        insert;
+    // Attaches the uprobes of a Go binary, and returns their number.
+    std::function<int(const std::string& binary, const std::vector<int32_t>& pids,
+                      const GoBinaryAnalysis& analysis)>
+        attach;
+    // Called with the number of binaries waiting for attachment, as it changes.
+    std::function<void(size_t depth)> queue_depth;
+  };
+
+  GoUProbeDeployPipeline(Stages stages, size_t num_analysis_threads)
+      : stages_(std::move(stages)), num_analysis_threads_(num_analysis_threads) {}
+
+  /**
+   * Runs the pipeline.
+   * @param pids_by_binary The PIDs of the processes of each binary.
+   * @return The number of uprobes attached.
+   */
+  int Run(const std::map<std::string, std::vector<int32_t>>& pids_by_binary);
+
+ private:
+  const Stages stages_;
+  const size_t num_analysis_threads_;
+};
+
+}  // namespace stirling
+}  // namespace px
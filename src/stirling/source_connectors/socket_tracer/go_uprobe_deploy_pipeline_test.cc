@@ -0,0 +1,228 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/match.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_join.h>
+#include <absl/strings/substitute.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/socket_tracer/go_uprobe_deploy_pipeline.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+GoBinaryAnalysis GoAnalysis(int32_t sysfd_offset) {
+  GoBinaryAnalysis analysis;
+  analysis.common_symaddrs = go_common_symaddrs_t{};
+  analysis.common_symaddrs->FD_Sysfd_offset = sysfd_offset;
+  return analysis;
+}
+
+/**
+ * Stages that record what they are called with. Binaries are identified by the first character
+ * after their leading '/', so that /a1 and /a2 are copies of the same binary.
+ */
+class FakeStages {
+ public:
+  GoUProbeDeployPipeline::Stages Get() {
+    GoUProbeDeployPipeline::Stages stages;
+    stages.identify = [this](const std::string& binary) -> StatusOr<std::string> {
+      Record("identify " + binary);
+      if (identify_errors_.contains(binary)) {
+        return error::NotFound("No such file.");
+      }
+      return binary.substr(1, 1);
+    };
+    stages.lookup = [this](const std::string& key) -> std::shared_ptr<const GoBinaryAnalysis> {
+      auto iter = cache_.find(key);
+      return iter == cache_.end() ? nullptr : iter->second;
+    };
+    stages.analyze = [this](const std::string& binary) -> StatusOr<GoBinaryAnalysis> {
+      Record("analyze " + binary);
+      if (analyze_hook_) {
+        analyze_hook_(binary);
+      }
+      auto iter = analyses_.find(binary);
+      if (iter == analyses_.end()) {
+        return error::Internal("Cannot read DWARF.");
+      }
+      return iter->second;
+    };
+    stages.insert = [this](const std::string& key, GoBinaryAnalysis analysis) {
+      Record("insert " + key);
+      auto ptr = std::make_shared<const GoBinaryAnalysis>(std::move(analysis));
+      cache_[key] = ptr;
+      return ptr;
+    };
+    stages.attach = [this](const std::string& binary, const std::vector<int32_t>& pids,
+                           const GoBinaryAnalysis& analysis) {
+      Record(absl::Substitute("attach $0 $1 $2", binary, absl::StrJoin(pids, ","),
+                              analysis.common_symaddrs->FD_Sysfd_offset));
+      return 1;
+    };
+    stages.queue_depth = [this](size_t depth) { queue_depths_.push_back(depth); };
+    return stages;
+  }
+
+  void Record(std::string event) {
+    absl::MutexLock lock(&mu_);
+    events_.push_back(std::move(event));
+  }
+
+  // The events whose name starts with prefix, in order.
+  std::vector<std::string> Events(std::string_view prefix) {
+    absl::MutexLock lock(&mu_);
+    std::vector<std::string> events;
+    for (const auto& event : events_) {
+      if (absl::StartsWith(event, prefix)) {
+        events.push_back(event);
+      }
+    }
+    return events;
+  }
+
+  std::vector<std::string> AllEvents() {
+    absl::MutexLock lock(&mu_);
+    return events_;
+  }
+
+  absl::flat_hash_map<std::string, GoBinaryAnalysis> analyses_;
+  absl::flat_hash_map<std::string, std::shared_ptr<const GoBinaryAnalysis>> cache_;
+  absl::flat_hash_set<std::string> identify_errors_;
+  std::function<void(const std::string&)> analyze_hook_;
+  std::vector<size_t> queue_depths_;
+
+ private:
+  absl::Mutex mu_;
+  std::vector<std::string> events_ ABSL_GUARDED_BY(mu_);
+};
+
+TEST(GoUProbeDeployPipelineTest, AnalyzesCopiesOnceAndUsesCache) {
+  FakeStages fake;
+  fake.analyses_["/a1"] = GoAnalysis(1);
+  fake.analyses_["/a2"] = GoAnalysis(1);
+  fake.analyses_["/c1"] = GoAnalysis(3);
+  fake.cache_["b"] = std::make_shared<const GoBinaryAnalysis>(GoAnalysis(2));
+
+  GoUProbeDeployPipeline pipeline(fake.Get(), /*num_analysis_threads*/ 2);
+  EXPECT_EQ(pipeline.Run({{"/a1", {10}}, {"/a2", {11, 12}}, {"/b1", {20}}, {"/c1", {30}}}), 4);
+
+  EXPECT_THAT(fake.Events("analyze"), UnorderedElementsAre("analyze /a1", "analyze /c1"));
+  EXPECT_THAT(fake.Events("insert"), ElementsAre("insert a", "insert c"));
+  EXPECT_THAT(fake.Events("attach"), ElementsAre("attach /a1 10 1", "attach /a2 11,12 1",
+                                                 "attach /b1 20 2", "attach /c1 30 3"));
+
+  // The analyses are cached for the next run.
+  fake.analyses_.clear();
+  EXPECT_EQ(pipeline.Run({{"/a3", {13}}, {"/c2", {31}}}), 2);
+  EXPECT_THAT(fake.Events("analyze"), UnorderedElementsAre("analyze /a1", "analyze /c1"));
+}
+
+TEST(GoUProbeDeployPipelineTest, AttachesInPathOrderAfterAllAnalyses) {
+  FakeStages fake;
+  for (const char* binary : {"/d1", "/a1", "/c1", "/b1"}) {
+    fake.analyses_[binary] = GoAnalysis(1);
+  }
+
+  GoUProbeDeployPipeline pipeline(fake.Get(), /*num_analysis_threads*/ 3);
+  EXPECT_EQ(pipeline.Run({{"/d1", {4}}, {"/a1", {1}}, {"/c1", {3}}, {"/b1", {2}}}), 4);
+
+  std::vector<std::string> events = fake.AllEvents();
+  auto first_attach = std::find_if(events.begin(), events.end(), [](const std::string& event) {
+    return absl::StartsWith(event, "attach");
+  });
+  auto last_analyze = std::find_if(events.rbegin(), events.rend(), [](const std::string& event) {
+    return absl::StartsWith(event, "analyze");
+  });
+  ASSERT_NE(first_attach, events.end());
+  ASSERT_NE(last_analyze, events.rend());
+  EXPECT_LT(last_analyze.base() - events.begin(), first_attach - events.begin());
+
+  EXPECT_THAT(fake.Events("attach"), ElementsAre("attach /a1 1 1", "attach /b1 2 1",
+                                                 "attach /c1 3 1", "attach /d1 4 1"));
+  EXPECT_THAT(fake.queue_depths_, ElementsAre(4, 3, 2, 1, 0));
+}
+
+TEST(GoUProbeDeployPipelineTest, AnalyzesInParallel) {
+  constexpr size_t kNumThreads = 3;
+  FakeStages fake;
+  std::map<std::string, std::vector<int32_t>> pids_by_binary;
+  for (int i = 0; i < 9; ++i) {
+    std::string binary = absl::StrCat("/", std::string(1, 'a' + i));
+    fake.analyses_[binary] = GoAnalysis(1);
+    pids_by_binary[binary] = {i};
+  }
+
+  absl::Mutex mu;
+  size_t running = 0;
+  size_t max_running = 0;
+  fake.analyze_hook_ = [&](const std::string&) {
+    absl::MutexLock lock(&mu);
+    ++running;
+    max_running = std::max(max_running, running);
+    // Wait for the other threads to start an analysis too.
+    mu.AwaitWithTimeout(absl::Condition(
+                            +[](size_t* max_running) { return *max_running == kNumThreads; },
+                            &max_running),
+                        absl::Seconds(10));
+    --running;
+  };
+
+  GoUProbeDeployPipeline pipeline(fake.Get(), kNumThreads);
+  EXPECT_EQ(pipeline.Run(pids_by_binary), 9);
+  EXPECT_EQ(max_running, kNumThreads);
+  EXPECT_EQ(fake.Events("analyze").size(), 9);
+}
+
+TEST(GoUProbeDeployPipelineTest, SkipsFailedAndNonGoBinaries) {
+  FakeStages fake;
+  fake.identify_errors_.insert("/a1");
+  // /b1 has no analysis, so analyzing it fails.
+  fake.analyses_["/c1"] = GoBinaryAnalysis{};
+  fake.analyses_["/d1"] = GoAnalysis(4);
+
+  GoUProbeDeployPipeline pipeline(fake.Get(), /*num_analysis_threads*/ 1);
+  EXPECT_EQ(pipeline.Run({{"/a1", {1}}, {"/b1", {2}}, {"/c1", {3}}, {"/d1", {4}}}), 1);
+
+  EXPECT_THAT(fake.Events("analyze"), ElementsAre("analyze /b1", "analyze /c1", "analyze /d1"));
+  // Non-Go binaries are cached too, so that they are not analyzed again.
+  EXPECT_THAT(fake.Events("insert"), ElementsAre("insert c", "insert d"));
+  EXPECT_THAT(fake.Events("attach"), ElementsAre("attach /d1 4 4"));
+  EXPECT_THAT(fake.queue_depths_, ElementsAre(3, 2, 1, 0));
+}
+
+}  // namespace stirling
+}  // namespace px
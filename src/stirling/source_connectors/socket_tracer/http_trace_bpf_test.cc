@@ -146,6 +146,38 @@ TEST_F(GoHTTPTraceTest, LargePostMessage) {
               131096);
 }
 
+// Same as above, with the large body truncated in BPF. The result is unchanged, since only the
+// part of the body that user space would discard is replaced by filler.
+class GoHTTPPayloadTruncationTraceTest : public GoHTTPTraceTest {
+ protected:
+  GoHTTPPayloadTruncationTraceTest() { FLAGS_stirling_bpf_payload_truncation = true; }
+  ~GoHTTPPayloadTruncationTraceTest() override { FLAGS_stirling_bpf_payload_truncation = false; }
+};
+
+TEST_F(GoHTTPPayloadTruncationTraceTest, LargePostMessage) {
+  StartTransferDataThread();
+
+  go_http_fixture_.LaunchPostClient();
+
+  StopTransferDataThread();
+
+  std::vector<TaggedRecordBatch> tablets = ConsumeRecords(kHTTPTableNum);
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(const types::ColumnWrapperRecordBatch& record_batch, tablets);
+
+  const std::vector<size_t> target_record_indices =
+      testing::FindRecordIdxMatchesPID(record_batch, kHTTPUPIDIdx, go_http_fixture_.server_pid());
+  ASSERT_THAT(target_record_indices, SizeIs(1));
+  const size_t target_record_idx = target_record_indices.front();
+
+  EXPECT_THAT(
+      std::string(record_batch[kHTTPReqBodyIdx]->Get<types::StringValue>(target_record_idx)),
+      AllOf(HasSubstr("{\"data\":\"XVlBzgbaiCMRAjWwhTHctcuAxhxKQFDaFpLSjFbcXoEFfRsWxPLDnJOb"),
+            HasSubstr("... [TRUNCATED]")));
+  EXPECT_THAT(record_batch[kHTTPReqBodySizeIdx]->Get<types::Int64Value>(target_record_idx).val,
+              131096);
+  EXPECT_EQ(record_batch[kHTTPRespStatusIdx]->Get<types::Int64Value>(target_record_idx).val, 200);
+}
+
 struct TraceRoleTestParam {
   endpoint_role_t role;
   size_t client_records_count;
@@ -16,9 +16,9 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <array>
 #include <memory>
 #include <string>
-#include <unordered_map>
 
 #include <magic_enum.hpp>
 
@@ -43,23 +43,36 @@ SocketTracerMetrics::SocketTracerMetrics(prometheus::Registry* registry,
                            .Add({{"protocol", std::string(magic_enum::enum_name(protocol))}})) {}
 
 namespace {
-std::unordered_map<traffic_protocol_t, std::unique_ptr<SocketTracerMetrics>> g_protocol_metrics;
 
-void ResetProtocolMetrics(traffic_protocol_t protocol) {
-  g_protocol_metrics.insert_or_assign(
-      protocol, std::make_unique<SocketTracerMetrics>(&GetMetricsRegistry(), protocol));
+using ProtocolMetrics = std::array<std::unique_ptr<SocketTracerMetrics>,
+                                   magic_enum::enum_count<traffic_protocol_t>()>;
+
+void ResetProtocolMetrics(ProtocolMetrics* metrics) {
+  for (traffic_protocol_t protocol : magic_enum::enum_values<traffic_protocol_t>()) {
+    (*metrics)[magic_enum::enum_index(protocol).value()] =
+        std::make_unique<SocketTracerMetrics>(&GetMetricsRegistry(), protocol);
+  }
+}
+
+// The metrics of all the protocols are created together on first use, so that the lookups, which
+// happen on the parser threads of the socket tracer, never modify the table.
+ProtocolMetrics& GetAllProtocolMetrics() {
+  static ProtocolMetrics* metrics = [] {
+    auto* metrics = new ProtocolMetrics();
+    ResetProtocolMetrics(metrics);
+    return metrics;
+  }();
+  return *metrics;
 }
+
 }  // namespace
 
 SocketTracerMetrics& SocketTracerMetrics::GetProtocolMetrics(traffic_protocol_t protocol) {
-  if (g_protocol_metrics.find(protocol) == g_protocol_metrics.end()) {
-    ResetProtocolMetrics(protocol);
-  }
-  return *g_protocol_metrics[protocol];
+  return *GetAllProtocolMetrics()[magic_enum::enum_index(protocol).value()];
 }
 
-void SocketTracerMetrics::TestOnlyResetProtocolMetrics(traffic_protocol_t protocol) {
-  ResetProtocolMetrics(protocol);
+void SocketTracerMetrics::TestOnlyResetProtocolMetrics() {
+  ResetProtocolMetrics(&GetAllProtocolMetrics());
 }
 
 }  // namespace stirling
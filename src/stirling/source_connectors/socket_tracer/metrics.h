@@ -32,9 +32,11 @@ struct SocketTracerMetrics {
   prometheus::Counter& data_loss_bytes;
   prometheus::Counter& conn_stats_bytes;
 
+  // Thread-safe: the metrics of all the protocols are created on the first call.
   static SocketTracerMetrics& GetProtocolMetrics(traffic_protocol_t protocol);
 
-  static void TestOnlyResetProtocolMetrics(traffic_protocol_t protocol);
+  // Re-creates the metrics of all the protocols, e.g. after TestOnlyResetMetricsRegistry().
+  static void TestOnlyResetProtocolMetrics();
 };
 
 }  // namespace stirling
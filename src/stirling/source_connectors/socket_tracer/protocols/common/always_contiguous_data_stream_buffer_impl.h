@@ -58,6 +58,11 @@ class AlwaysContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
   void Reset() override;
 
   void ShrinkToFit() override { buffer_.shrink_to_fit(); }
+  size_t MemoryUsage() const override {
+    return sizeof(*this) + buffer_.capacity() +
+           (chunks_.size() + timestamps_.size()) *
+               (kMapNodeOverheadBytes + sizeof(std::pair<size_t, size_t>));
+  }
 
  private:
   std::map<size_t, size_t>::const_iterator GetChunkForPos(size_t pos) const;
@@ -40,14 +40,19 @@ namespace stirling {
 namespace protocols {
 
 DataStreamBuffer::DataStreamBuffer(size_t max_capacity, size_t max_gap_size,
-                                   size_t allow_before_gap_size) {
-  if (FLAGS_stirling_data_stream_buffer_always_contiguous_buffer) {
-    impl_ = std::unique_ptr<DataStreamBufferImpl>(new AlwaysContiguousDataStreamBufferImpl(
-        max_capacity, max_gap_size, allow_before_gap_size));
-  } else {
-    impl_ =
-        std::unique_ptr<DataStreamBufferImpl>(new LazyContiguousDataStreamBufferImpl(max_capacity));
+                                   size_t allow_before_gap_size)
+    : max_capacity_(max_capacity),
+      max_gap_size_(max_gap_size),
+      allow_before_gap_size_(allow_before_gap_size),
+      always_contiguous_buffer_(FLAGS_stirling_data_stream_buffer_always_contiguous_buffer) {}
+
+std::unique_ptr<DataStreamBufferImpl> DataStreamBuffer::CreateImpl() const {
+  if (always_contiguous_buffer_) {
+    return std::unique_ptr<DataStreamBufferImpl>(new AlwaysContiguousDataStreamBufferImpl(
+        max_capacity_, max_gap_size_, allow_before_gap_size_));
   }
+  return std::unique_ptr<DataStreamBufferImpl>(
+      new LazyContiguousDataStreamBufferImpl(max_capacity_, released_position_));
 }
 
 }  // namespace protocols
@@ -49,6 +49,12 @@ class DataStreamBufferImpl {
   virtual std::string DebugInfo() const = 0;
   virtual void Reset() = 0;
   virtual void ShrinkToFit() = 0;
+  // Approximate number of bytes allocated for this object, including the object itself.
+  virtual size_t MemoryUsage() const = 0;
+
+ protected:
+  // Besides the value, a std::map node holds three pointers and the color.
+  static constexpr size_t kMapNodeOverheadBytes = 4 * sizeof(void*);
 };
 
 /**
@@ -66,6 +72,9 @@ class DataStreamBufferImpl {
  *
  * The underlying implementation is currently a simple string buffer, but this could be changed
  * in the future, as long as the data is maintained in a contiguous buffer.
+ *
+ * The implementation is only allocated when data is first added, and is released by Reset(), so
+ * that the buffers of idle connections take no memory beyond this object.
  */
 class DataStreamBuffer {
  public:
@@ -81,21 +90,26 @@ class DataStreamBuffer {
    * @param timestamp Timestamp to associate with the data.
    */
   void Add(size_t pos, std::string_view data, uint64_t timestamp) {
-    impl_->Add(pos, data, timestamp);
+    MutableImpl()->Add(pos, data, timestamp);
   }
 
   /**
    * Get all the contiguous data at the head of the buffer.
    * @return A string_view to the data.
    */
-  std::string_view Head() { return impl_->Head(); }
+  std::string_view Head() { return impl_ == nullptr ? std::string_view() : impl_->Head(); }
 
   /**
    * Get timestamp recorded for the data at the specified position.
    * @param pos The logical position of the data.
    * @return The timestamp or error if the position does not contain valid data.
    */
-  StatusOr<uint64_t> GetTimestamp(size_t pos) const { return impl_->GetTimestamp(pos); }
+  StatusOr<uint64_t> GetTimestamp(size_t pos) const {
+    if (impl_ == nullptr) {
+      return error::Internal("Specified position not found");
+    }
+    return impl_->GetTimestamp(pos);
+  }
 
   /**
    * Remove n bytes from the head of the buffer.
@@ -103,51 +117,94 @@ class DataStreamBuffer {
    * Negative values for pos are invalid and will not remove anything.
    * In debug mode, negative values will cause a failure.
    */
-  void RemovePrefix(ssize_t n) { return impl_->RemovePrefix(n); }
+  void RemovePrefix(ssize_t n) {
+    // Removing bytes still advances the position of an empty buffer.
+    if (impl_ == nullptr && n == 0) {
+      return;
+    }
+    MutableImpl()->RemovePrefix(n);
+  }
 
   /**
    * If the head of the buffer contains any non-valid data (never populated),
    * then remove it until reaching the first data added.
    */
-  void Trim() { impl_->Trim(); }
+  void Trim() {
+    if (impl_ != nullptr) {
+      impl_->Trim();
+    }
+  }
 
   /**
    * Current size of the internal buffer. Not all bytes may be populated.
    */
-  size_t size() const { return impl_->size(); }
+  size_t size() const { return impl_ == nullptr ? 0 : impl_->size(); }
 
   /**
    * Current allocated space of the internal buffer.
    */
-  size_t capacity() const { return impl_->capacity(); }
+  size_t capacity() const { return impl_ == nullptr ? 0 : impl_->capacity(); }
 
   /**
    * Return true if the buffer is empty.
    */
-  bool empty() const { return impl_->empty(); }
+  bool empty() const { return impl_ == nullptr || impl_->empty(); }
 
   /**
    * Logical position of the head of the buffer.
    */
-  size_t position() const { return impl_->position(); }
+  size_t position() const { return impl_ == nullptr ? released_position_ : impl_->position(); }
 
-  std::string DebugInfo() const { return impl_->DebugInfo(); }
+  std::string DebugInfo() const {
+    return impl_ == nullptr ? "Unallocated buffer\n" : impl_->DebugInfo();
+  }
 
   /**
-   * Resets the entire buffer to an empty state.
+   * Resets the entire buffer to an empty state, and releases its memory.
    * Intended for hard recovery conditions.
    */
-  void Reset() { impl_->Reset(); }
+  void Reset() {
+    // Only the lazy implementation keeps its position across a reset.
+    released_position_ = always_contiguous_buffer_ ? 0 : position();
+    impl_.reset();
+  }
 
   /**
    * Shrink the internal buffer, so that the allocated memory matches its size.
    * Note this has to be an external API, because `RemovePrefix` is called in situations where it
    * doesn't make sense to shrink.
    */
-  void ShrinkToFit() { impl_->ShrinkToFit(); }
+  void ShrinkToFit() {
+    if (impl_ != nullptr) {
+      impl_->ShrinkToFit();
+    }
+  }
+
+  /**
+   * Approximate number of bytes allocated by the buffer, excluding this object itself.
+   */
+  size_t MemoryUsage() const { return impl_ == nullptr ? 0 : impl_->MemoryUsage(); }
 
  private:
+  DataStreamBufferImpl* MutableImpl() {
+    if (impl_ == nullptr) {
+      impl_ = CreateImpl();
+    }
+    return impl_.get();
+  }
+
+  std::unique_ptr<DataStreamBufferImpl> CreateImpl() const;
+
+  const size_t max_capacity_;
+  const size_t max_gap_size_;
+  const size_t allow_before_gap_size_;
+  // The implementation is chosen when the buffer is constructed, even though it is allocated later.
+  const bool always_contiguous_buffer_;
+
   std::unique_ptr<DataStreamBufferImpl> impl_;
+
+  // The position of the buffer while the implementation is released.
+  size_t released_position_ = 0;
 };
 
 }  // namespace protocols
@@ -268,6 +268,25 @@ TEST_P(DataStreamBufferTest, LargeGap) {
   }
 }
 
+TEST_P(DataStreamBufferTest, Reset) {
+  DataStreamBuffer stream_buffer(15, 15, 15);
+
+  stream_buffer.Add(0, "0123", 0);
+  EXPECT_EQ(stream_buffer.Head(), "0123");
+  stream_buffer.RemovePrefix(2);
+  EXPECT_EQ(stream_buffer.position(), 2);
+
+  stream_buffer.Reset();
+  EXPECT_TRUE(stream_buffer.empty());
+  EXPECT_EQ(stream_buffer.MemoryUsage(), 0);
+  // Releasing the memory does not change the position that each implementation reports.
+  const size_t position = FLAGS_stirling_data_stream_buffer_always_contiguous_buffer ? 0 : 2;
+  EXPECT_EQ(stream_buffer.position(), position);
+
+  stream_buffer.RemovePrefix(2);
+  EXPECT_EQ(stream_buffer.position(), position + 2);
+}
+
 INSTANTIATE_TEST_SUITE_P(DataStreamBufferImplTest, DataStreamBufferTest,
                          ::testing::Values(true, false),
                          [](const ::testing::TestParamInfo<DataStreamBufferTest::ParamType>& info) {
@@ -291,6 +291,16 @@ size_t LazyContiguousDataStreamBufferImpl::capacity() const {
   return head_->Capacity() + events_size_;
 }
 
+size_t LazyContiguousDataStreamBufferImpl::MemoryUsage() const {
+  size_t usage = sizeof(*this) + capacity();
+  if (head_ != nullptr) {
+    usage += sizeof(FixedSizeContiguousBuffer);
+  }
+  usage += head_pos_to_ts_.size() * (kMapNodeOverheadBytes + sizeof(std::pair<size_t, uint64_t>));
+  usage += events_.size() * (kMapNodeOverheadBytes + sizeof(std::pair<size_t, Event>));
+  return usage;
+}
+
 bool LazyContiguousDataStreamBufferImpl::empty() const { return size() == 0; }
 
 size_t LazyContiguousDataStreamBufferImpl::position() const {
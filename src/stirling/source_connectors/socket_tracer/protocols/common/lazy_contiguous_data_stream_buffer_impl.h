@@ -67,6 +67,10 @@ class LazyContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
       : capacity_(max_capacity) {}
   explicit LazyContiguousDataStreamBufferImpl(size_t max_capacity)
       : LazyContiguousDataStreamBufferImpl(max_capacity, 0, 0) {}
+  // Starts at the given position, so that a re-allocated buffer continues where the last one
+  // stopped.
+  LazyContiguousDataStreamBufferImpl(size_t max_capacity, size_t position)
+      : capacity_(max_capacity), head_position_(position) {}
 
   void Add(size_t pos, std::string_view data, uint64_t timestamp) override;
 
@@ -90,6 +94,7 @@ class LazyContiguousDataStreamBufferImpl : public DataStreamBufferImpl {
   void Trim() override {}
 
   void ShrinkToFit() override;
+  size_t MemoryUsage() const override;
 
  private:
   // Store individual events separately before lazyily merging them into a contiguous buffer when
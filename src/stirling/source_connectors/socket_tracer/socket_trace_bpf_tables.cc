@@ -18,6 +18,11 @@
 
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
 
+#include <bcc/libbpf.h>
+
+#include <cerrno>
+#include <cstring>
+
 #include "src/common/fs/fs_wrapper.h"
 #include "src/common/system/proc_pid_path.h"
 #include "src/stirling/bpf_tools/macros.h"
@@ -45,6 +50,24 @@ namespace stirling {
 
 using px::system::ProcPidPath;
 
+namespace {
+
+// The number of conn_info_map entries read per BPF_MAP_LOOKUP_BATCH syscall.
+constexpr uint32_t kConnInfoBatchSize = 1024;
+
+// ebpf::BPFHashTable does not expose the file descriptor of the map, which is needed for the
+// batch operations that it does not implement.
+template <typename TKeyType, typename TValueType>
+class BPFHashTableWithFD : public ebpf::BPFHashTable<TKeyType, TValueType> {
+ public:
+  explicit BPFHashTableWithFD(const ebpf::BPFHashTable<TKeyType, TValueType>& table)
+      : ebpf::BPFHashTable<TKeyType, TValueType>(table) {}
+
+  int fd() const { return this->desc.fd; }
+};
+
+}  // namespace
+
 ConnInfoMapManager::ConnInfoMapManager(bpf_tools::BCCWrapper* bcc)
     : conn_info_map_(bcc->GetHashTable<uint64_t, struct conn_info_t>("conn_info_map")),
       conn_disabled_map_(bcc->GetHashTable<uint64_t, uint64_t>("conn_disabled_map")) {
@@ -113,5 +136,55 @@ void ConnInfoMapManager::CleanupBPFMapLeaks(ConnTrackersManager* conn_trackers_m
   }
 }
 
+void ConnInfoMapManager::ReadConnInfos(std::vector<struct conn_info_t>* conn_infos) {
+  conn_infos->clear();
+
+  if (batched_lookup_supported_) {
+    Status s = LookupConnInfosBatched(conn_infos);
+    if (s.ok()) {
+      return;
+    }
+    LOG(INFO) << absl::Substitute(
+        "Batched lookups of conn_info_map failed, reading entries one at a time. Message: $0",
+        s.msg());
+    batched_lookup_supported_ = false;
+    conn_infos->clear();
+  }
+
+  for (const auto& [pid_fd, conn_info] : conn_info_map_.get_table_offline()) {
+    conn_infos->push_back(conn_info);
+  }
+}
+
+Status ConnInfoMapManager::LookupConnInfosBatched(std::vector<struct conn_info_t>* conn_infos) {
+  const int fd = BPFHashTableWithFD<uint64_t, struct conn_info_t>(conn_info_map_).fd();
+  batch_keys_.resize(kConnInfoBatchSize);
+
+  // The batch tokens are opaque to user-space. The first lookup must pass no token.
+  uint32_t in_batch = 0;
+  uint32_t out_batch = 0;
+  bool first_batch = true;
+
+  while (true) {
+    const size_t offset = conn_infos->size();
+    conn_infos->resize(offset + kConnInfoBatchSize);
+
+    uint32_t count = kConnInfoBatchSize;
+    int ret = bpf_lookup_batch(fd, first_batch ? nullptr : &in_batch, &out_batch,
+                               batch_keys_.data(), conn_infos->data() + offset, &count);
+    // ENOENT means that the end of the map was reached. The entries of the last batch are valid.
+    if (ret != 0 && errno != ENOENT) {
+      return error::Internal("BPF_MAP_LOOKUP_BATCH failed: $0.", std::strerror(errno));
+    }
+    conn_infos->resize(offset + count);
+    if (ret != 0) {
+      return Status::OK();
+    }
+
+    in_batch = out_batch;
+    first_batch = false;
+  }
+}
+
 }  // namespace stirling
 }  // namespace px
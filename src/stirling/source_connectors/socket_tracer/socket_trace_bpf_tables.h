@@ -42,12 +42,31 @@ class ConnInfoMapManager {
 
   void CleanupBPFMapLeaks(ConnTrackersManager* conn_trackers_mgr);
 
+  /**
+   * Reads all the entries of conn_info_map into conn_infos.
+   *
+   * The entries are read in batches with BPF_MAP_LOOKUP_BATCH, which takes one syscall per batch,
+   * instead of two per entry. Falls back to reading one entry at a time on kernels older than
+   * 5.6, which do not support batched lookups.
+   */
+  void ReadConnInfos(std::vector<struct conn_info_t>* conn_infos);
+
+  bool batched_lookup_supported() const { return batched_lookup_supported_; }
+  // Makes ReadConnInfos() read one entry at a time, as on kernels without batched lookups.
+  void test_only_disable_batched_lookup() { batched_lookup_supported_ = false; }
+
  private:
+  Status LookupConnInfosBatched(std::vector<struct conn_info_t>* conn_infos);
+
   ebpf::BPFHashTable<uint64_t, struct conn_info_t> conn_info_map_;
   ebpf::BPFHashTable<uint64_t, uint64_t> conn_disabled_map_;
 
   std::vector<struct conn_id_t> pending_release_queue_;
 
+  bool batched_lookup_supported_ = true;
+  // Scratch space for the keys of batched lookups, which are not needed.
+  std::vector<uint64_t> batch_keys_;
+
   // TODO(oazizi): Can we share this with the similar function in socket_trace.c?
   uint64_t id(struct conn_id_t conn_id) const {
     return (static_cast<uint64_t>(conn_id.upid.tgid) << 32) | conn_id.fd;
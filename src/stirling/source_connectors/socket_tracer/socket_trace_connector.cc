@@ -23,7 +23,9 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <thread>
 #include <utility>
 
 #include <absl/container/flat_hash_map.h>
@@ -55,6 +57,11 @@ DEFINE_uint32(
     stirling_conn_stats_sampling_ratio, 50,
     "Ratio of how frequently conn_stats_table is populated relative to the base sampling period.");
 
+DEFINE_bool(stirling_conn_stats_from_bpf_map,
+            gflags::BoolFromEnv("PL_STIRLING_CONN_STATS_FROM_BPF_MAP", true),
+            "If true, the byte counts of open connections are read from the BPF conn_info_map "
+            "every time conn_stats_table is populated, instead of being sent by BPF as events.");
+
 DEFINE_uint32(stirling_socket_tracer_stats_logging_ratio,
               std::chrono::minutes(10) / px::stirling::SocketTraceConnector::kSamplingPeriod,
               "Ratio of how frequently summary logging information is displayed.");
@@ -147,6 +154,22 @@ DEFINE_uint32(datastream_buffer_retention_size,
 DEFINE_uint64(max_body_bytes, gflags::Uint64FromEnv("PL_STIRLING_MAX_BODY_BYTES", 512),
               "The maximum number of bytes in the body of protocols like HTTP");
 
+DEFINE_bool(stirling_bpf_payload_truncation,
+            gflags::BoolFromEnv("PL_STIRLING_BPF_PAYLOAD_TRUNCATION", false),
+            "If true, BPF submits only the headers and the first max_body_bytes bytes of the "
+            "body of each HTTP/1.x message, and reports the rest as lost bytes. "
+            "Requires kernel 5.3 or newer; ignored on older kernels.");
+DEFINE_uint32(stirling_bpf_db_payload_prefix_bytes,
+              gflags::Uint32FromEnv("PL_STIRLING_BPF_DB_PAYLOAD_PREFIX_BYTES", 0),
+              "If non-zero, and --stirling_bpf_payload_truncation is set, BPF also truncates the "
+              "payload of each MySQL/PgSQL message to this many bytes. Truncated queries and rows "
+              "cannot be fully decoded, so this is off (0) by default.");
+
+DEFINE_uint32(stirling_socket_tracer_parser_threads,
+              gflags::Uint32FromEnv("PL_STIRLING_SOCKET_TRACER_PARSER_THREADS", 1),
+              "Number of threads that parse the data of the connections into records. "
+              "The records are appended to the data tables on the main thread.");
+
 OBJ_STRVIEW(socket_trace_bcc_script, socket_trace);
 
 namespace px {
@@ -336,6 +359,17 @@ void ResizePerfBufferSpecs(std::array<bpf_tools::PerfBufferSpec, N>* perf_buffer
                                   magic_enum::enum_name(category), size * kNCPUs);
   }
 }
+
+// Payload truncation uses bounded loops, which the BPF verifier accepts since kernel 5.3.
+bool KernelVersionAllowsPayloadTruncation() {
+  constexpr KernelVersion kKernelVersion5_3 = {5, 3, 0};
+  auto kernel_version_or = GetKernelVersion();
+  if (kernel_version_or.ok()) {
+    auto order = CompareKernelVersions(kernel_version_or.ValueOrDie(), kKernelVersion5_3);
+    return order == KernelVersionOrder::kSame || order == KernelVersionOrder::kNewer;
+  }
+  return false;
+}
 }  // namespace
 
 auto SocketTraceConnector::InitPerfBufferSpecs() {
@@ -402,6 +436,11 @@ Status SocketTraceConnector::InitBPF() {
       absl::StrCat("-DENABLE_NATS_TRACING=", protocol_transfer_specs_[kProtocolNATS].enabled),
       absl::StrCat("-DENABLE_AMQP_TRACING=", protocol_transfer_specs_[kProtocolAMQP].enabled),
       absl::StrCat("-DENABLE_MONGO_TRACING=", "true"),
+      absl::StrCat("-DENABLE_PAYLOAD_TRUNCATION=",
+                   FLAGS_stirling_bpf_payload_truncation && KernelVersionAllowsPayloadTruncation()),
+      absl::StrCat("-DHTTP_PAYLOAD_PREFIX_BYTES=", FLAGS_max_body_bytes),
+      absl::StrCat("-DDB_PAYLOAD_PREFIX_BYTES=", FLAGS_stirling_bpf_db_payload_prefix_bytes),
+      absl::StrCat("-DENABLE_CONN_STATS_MAP=", FLAGS_stirling_conn_stats_from_bpf_map),
   };
   PL_RETURN_IF_ERROR(InitBPFProgram(socket_trace_bcc_script, defines));
 
@@ -498,6 +537,7 @@ Status SocketTraceConnector::StopImpl() {
   // Wait for all threads to finish.
   while (uprobe_mgr_.ThreadsRunning()) {
   }
+  parser_threads_.reset();
 
   // Must call Close() after attach_uprobes_thread_ has joined,
   // otherwise the two threads will cause concurrent accesses to BCC,
@@ -625,6 +665,9 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
   DataTable* conn_stats_table = data_tables_[kConnStatsTableNum];
   if (conn_stats_table != nullptr &&
       sampling_freq_mgr_.count() % FLAGS_stirling_conn_stats_sampling_ratio == 0) {
+    if (FLAGS_stirling_conn_stats_from_bpf_map) {
+      ReadConnStatsFromBPFMap();
+    }
     TransferConnStats(ctx, conn_stats_table);
   }
 
@@ -655,14 +698,14 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
     }
   }
 
+  // The trackers are processed in three phases:
+  //  1) Per-iteration updates that use state shared between trackers, e.g. socket_info_mgr_.
+  //  2) Parsing and stitching, which only touch the tracker, so they run on multiple threads.
+  //  3) Appending the records to the data tables, which are not thread-safe.
+  // The order in which records are appended does not matter: DataTable sorts them by time when
+  // they are consumed.
+  std::vector<ConnTracker*> trackers;
   for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
-    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
-
-    DataTable* data_table = nullptr;
-    if (transfer_spec.enabled) {
-      data_table = data_tables_[transfer_spec.table_num];
-    }
-
     UpdateTrackerTraceLevel(conn_tracker);
 
     // Once a known UPID, always a known UPID.
@@ -676,17 +719,18 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
 
     conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
                                    socket_info_mgr_.get());
+    trackers.push_back(conn_tracker);
+  }
 
-    if (transfer_spec.transfer_fn != nullptr) {
-      transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
-    } else {
-      // If there's no transfer function, then the tracker should not be holding any data.
-      // http::ProtocolTraits is used as a placeholder; the frames deque is expected to be
-      // std::monotstate.
-      ECHECK(conn_tracker->send_data().Empty<protocols::http::Message>());
-      ECHECK(conn_tracker->recv_data().Empty<protocols::http::Message>());
-    }
+  std::vector<std::unique_ptr<TrackerRecords>> records(trackers.size());
+  TransferStreams(trackers, &records);
 
+  for (size_t i = 0; i < trackers.size(); ++i) {
+    ConnTracker* conn_tracker = trackers[i];
+    if (records[i] != nullptr) {
+      const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
+      records[i]->AppendTo(ctx, *conn_tracker, data_tables_[transfer_spec.table_num]);
+    }
     conn_tracker->IterationPostTick();
   }
 
@@ -930,6 +974,45 @@ void SocketTraceConnector::AcceptConnStatsEvent(conn_stats_event_t event) {
   tracker.AddConnStats(event);
 }
 
+void SocketTraceConnector::ReadConnStatsFromBPFMap() {
+  if (conn_info_map_mgr_ == nullptr) {
+    return;
+  }
+
+  // The timestamp is taken before the read, so that the final stats event of any connection
+  // closed after the read is newer, and overrides these stats.
+  const uint64_t timestamp_ns = CurrentSteadyTimeNS();
+  conn_info_map_mgr_->ReadConnInfos(&conn_infos_);
+  AcceptConnStatsSnapshot(conn_infos_, timestamp_ns);
+}
+
+void SocketTraceConnector::AcceptConnStatsSnapshot(
+    const std::vector<struct conn_info_t>& conn_infos, uint64_t timestamp_ns) {
+  for (const auto& conn_info : conn_infos) {
+    const int64_t total_bytes = conn_info.wr_bytes + conn_info.rd_bytes;
+    if (total_bytes == 0) {
+      continue;
+    }
+    // Like BPF did when it sent the stats as events, skip connections with little traffic,
+    // unless they are tracked already. Their stats are reported when they are closed.
+    if (total_bytes < kConnStatsDataThreshold &&
+        !conn_trackers_mgr_.GetConnTracker(conn_info.conn_id.upid.pid, conn_info.conn_id.fd)
+             .ok()) {
+      continue;
+    }
+
+    conn_stats_event_t event = {};
+    event.timestamp_ns = timestamp_ns;
+    event.conn_id = conn_info.conn_id;
+    event.addr = conn_info.addr;
+    event.role = conn_info.role;
+    event.wr_bytes = conn_info.wr_bytes;
+    event.rd_bytes = conn_info.rd_bytes;
+    ConnTracker& tracker = conn_trackers_mgr_.GetOrCreateConnTracker(event.conn_id);
+    tracker.AddConnStatsSnapshot(event);
+  }
+}
+
 void SocketTraceConnector::AcceptHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> event) {
   ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
   tracker.AddHTTP2Header(std::move(event));
@@ -1518,25 +1601,51 @@ void SocketTraceConnector::WriteDataEvent(const SocketDataEvent& event) {
 // TransferData Helpers
 //-----------------------------------------------------------------------------
 
+template <typename TRecordType>
+class SocketTraceConnector::TrackerRecordsImpl : public SocketTraceConnector::TrackerRecords {
+ public:
+  explicit TrackerRecordsImpl(std::vector<TRecordType> records) : records_(std::move(records)) {}
+
+  void AppendTo(ConnectorContext* ctx, const ConnTracker& tracker,
+                DataTable* data_table) override {
+    for (auto& record : records_) {
+      AppendMessage(ctx, tracker, std::move(record), data_table);
+    }
+  }
+
+ private:
+  std::vector<TRecordType> records_;
+};
+
 template <typename TProtocolTraits>
-void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tracker,
-                                          DataTable* data_table) {
+std::unique_ptr<SocketTraceConnector::TrackerRecords> SocketTraceConnector::TransferStream(
+    ConnTracker* tracker, bool transfer_records) {
   using TFrameType = typename TProtocolTraits::frame_type;
+  using TRecordType = typename TProtocolTraits::record_type;
 
   VLOG(3) << absl::StrCat("Connection\n", DebugString<TProtocolTraits>(*tracker, ""));
 
-  // Make sure the tracker's frames containers have been properly initialized.
-  // This is a nop if the containers are already of the right type.
-  tracker->InitFrames<TFrameType>();
+  // Idle trackers (e.g. keep-alive connections without traffic) have nothing to parse, so skip
+  // them without allocating their frames containers. This keeps idle trackers small.
+  const bool idle = tracker->IsIdle();
+  if (!idle) {
+    // Make sure the tracker's frames containers have been properly initialized.
+    // This is a nop if the containers are already of the right type.
+    tracker->InitFrames<TFrameType>();
+  }
 
-  if (data_table != nullptr && tracker->state() == ConnTracker::State::kTransferring) {
-    // ProcessToRecords() parses raw events and produces messages in format that are expected by
-    // table store. But those messages are not cached inside ConnTracker.
-    auto records = tracker->ProcessToRecords<TProtocolTraits>();
+  std::vector<TRecordType> records;
+  if (transfer_records && tracker->state() == ConnTracker::State::kTransferring) {
+    if (idle) {
+      tracker->ProcessIdle();
+    } else {
+      // ProcessToRecords() parses raw events and produces messages in format that are expected
+      // by table store. But those messages are not cached inside ConnTracker.
+      records = tracker->ProcessToRecords<TProtocolTraits>();
+    }
     for (auto& record : records) {
       TProtocolTraits::ConvertTimestamps(
           &record, [&](uint64_t mono_time) { return ConvertToRealTime(mono_time); });
-      AppendMessage(ctx, *tracker, std::move(record), data_table);
     }
   }
 
@@ -1548,6 +1657,57 @@ void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tr
   tracker->Cleanup<TProtocolTraits>(FLAGS_messages_size_limit_bytes,
                                     FLAGS_datastream_buffer_retention_size,
                                     message_expiry_timestamp, buffer_expiry_timestamp);
+
+  if (records.empty()) {
+    return nullptr;
+  }
+  return std::make_unique<TrackerRecordsImpl<TRecordType>>(std::move(records));
+}
+
+void SocketTraceConnector::TransferStreams(
+    const std::vector<ConnTracker*>& trackers,
+    std::vector<std::unique_ptr<TrackerRecords>>* records_out) {
+  DCHECK_EQ(trackers.size(), records_out->size());
+
+  auto transfer = [this, &trackers, records_out](size_t i) {
+    ConnTracker* tracker = trackers[i];
+    const auto& transfer_spec = protocol_transfer_specs_[tracker->protocol()];
+    if (transfer_spec.transfer_fn == nullptr) {
+      // If there's no transfer function, then the tracker should not be holding any data.
+      // http::ProtocolTraits is used as a placeholder; the frames deque is expected to be
+      // std::monotstate.
+      ECHECK(tracker->send_data().Empty<protocols::http::Message>());
+      ECHECK(tracker->recv_data().Empty<protocols::http::Message>());
+      return;
+    }
+    bool transfer_records =
+        transfer_spec.enabled && data_tables_[transfer_spec.table_num] != nullptr;
+    (*records_out)[i] = transfer_spec.transfer_fn(*this, tracker, transfer_records);
+  };
+
+  // Only use the threads when each gets a meaningful amount of work.
+  constexpr size_t kMinTrackersPerThread = 64;
+  const size_t num_threads = FLAGS_stirling_socket_tracer_parser_threads;
+  if (num_threads <= 1 || trackers.size() < 2 * kMinTrackersPerThread) {
+    for (size_t i = 0; i < trackers.size(); ++i) {
+      transfer(i);
+    }
+    return;
+  }
+
+  // The threads persist across iterations, and are only re-created if the flag changes.
+  if (parser_threads_ == nullptr || parser_threads_->num_shards() != num_threads) {
+    parser_threads_ = std::make_unique<WorkerThreads>(num_threads);
+  }
+
+  // The cost of a tracker varies with its traffic, so the threads take the trackers one at a
+  // time, instead of each getting a fixed partition.
+  std::atomic<size_t> next_idx = 0;
+  parser_threads_->Run([&](size_t /*shard*/) {
+    for (size_t i = next_idx++; i < trackers.size(); i = next_idx++) {
+      transfer(i);
+    }
+  });
 }
 
 void SocketTraceConnector::TransferConnStats(ConnectorContext* ctx, DataTable* data_table) {
@@ -48,6 +48,7 @@
 #include "src/stirling/utils/linux_headers.h"
 #include "src/stirling/utils/proc_path_tools.h"
 #include "src/stirling/utils/proc_tracker.h"
+#include "src/stirling/utils/worker_threads.h"
 
 DECLARE_uint32(stirling_conn_stats_sampling_ratio);
 DECLARE_bool(stirling_enable_periodic_bpf_map_cleanup);
@@ -75,6 +76,9 @@ DECLARE_uint32(datastream_buffer_expiry_duration_secs);
 DECLARE_uint32(datastream_buffer_retention_size);
 
 DECLARE_uint64(max_body_bytes);
+DECLARE_bool(stirling_bpf_payload_truncation);
+DECLARE_uint32(stirling_bpf_db_payload_prefix_bytes);
+DECLARE_uint32(stirling_socket_tracer_parser_threads);
 
 namespace px {
 namespace stirling {
@@ -155,6 +159,9 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
     now_fn_ = now_fn;
   }
 
+  // Null until the BPF program is deployed.
+  ConnInfoMapManager* test_only_conn_info_map_mgr() { return conn_info_map_mgr_.get(); }
+
  private:
   // ReadPerfBuffers poll callback functions (must be static).
   // These are used by the static variables below, and have to be placed here.
@@ -200,9 +207,36 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
       bool outgoing,
       /* OUT */ struct go_grpc_http2_header_event_t* header_event_data_go_style);
 
+  // The records that a ConnTracker produced in one iteration, which are waiting to be appended to
+  // the data table of its protocol. Type-erased, so that the trackers of all protocols can be
+  // processed together.
+  class TrackerRecords {
+   public:
+    virtual ~TrackerRecords() = default;
+    virtual void AppendTo(ConnectorContext* ctx, const ConnTracker& tracker,
+                          DataTable* data_table) = 0;
+  };
+
+  template <typename TRecordType>
+  class TrackerRecordsImpl;
+
+  // Parses the data of the tracker into records, and cleans up its buffers.
+  // Only touches the tracker itself, so that different trackers can be processed concurrently.
   template <typename TProtocolTraits>
-  void TransferStream(ConnectorContext* ctx, ConnTracker* tracker, DataTable* data_table);
+  std::unique_ptr<TrackerRecords> TransferStream(ConnTracker* tracker, bool transfer_records);
+
+  // Calls the transfer_fn of each tracker, on --stirling_socket_tracer_parser_threads threads.
+  // Everything that transfer_fn reaches is either owned by the tracker, read-only during the
+  // transfer, or thread-safe (e.g. SocketTracerMetrics).
+  // records_out[i] receives the records of trackers[i].
+  void TransferStreams(const std::vector<ConnTracker*>& trackers,
+                       std::vector<std::unique_ptr<TrackerRecords>>* records_out);
   void TransferConnStats(ConnectorContext* ctx, DataTable* data_table);
+  // Passes the byte counts of the open connections in conn_info_map to their trackers.
+  void ReadConnStatsFromBPFMap();
+  // Passes the byte counts of a snapshot of conn_info_map, taken at timestamp_ns, to the trackers.
+  void AcceptConnStatsSnapshot(const std::vector<struct conn_info_t>& conn_infos,
+                               uint64_t timestamp_ns);
 
   void set_iteration_time(std::chrono::time_point<std::chrono::steady_clock> time) {
     DCHECK(time >= iteration_time_);
@@ -226,6 +260,10 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   ConnTrackersManager conn_trackers_mgr_;
 
+  // The threads that run TransferStreams(), created on first use if
+  // --stirling_socket_tracer_parser_threads > 1.
+  std::unique_ptr<WorkerThreads> parser_threads_;
+
   ConnStats conn_stats_;
 
   absl::flat_hash_set<int> pids_to_trace_disable_;
@@ -238,7 +276,7 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
     int32_t trace_mode = TraceMode::Off;
     uint32_t table_num = 0;
     std::vector<endpoint_role_t> trace_roles;
-    std::function<void(SocketTraceConnector&, ConnectorContext*, ConnTracker*, DataTable*)>
+    std::function<std::unique_ptr<TrackerRecords>(SocketTraceConnector&, ConnTracker*, bool)>
         transfer_fn = nullptr;
     bool enabled = false;
   };
@@ -280,6 +318,9 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   std::shared_ptr<ConnInfoMapManager> conn_info_map_mgr_;
 
+  // Reused by ReadConnStatsFromBPFMap().
+  std::vector<struct conn_info_t> conn_infos_;
+
   UProbeManager uprobe_mgr_;
 
   enum class StatKey {
@@ -18,6 +18,7 @@
 
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_connector.h"
 
+#include <algorithm>
 #include <memory>
 
 #include <absl/functional/bind_front.h>
@@ -40,6 +41,7 @@ namespace stirling {
 
 namespace http = protocols::http;
 
+using ::testing::Each;
 using ::testing::ElementsAre;
 
 using ::px::stirling::testing::RecordBatchSizeIs;
@@ -223,6 +225,31 @@ TEST_F(SocketTraceConnectorTest, Basic) {
   EXPECT_THAT(ToStringVector(records[kHTTPRespBodyIdx]), ElementsAre("foo"));
 }
 
+// Tests that the records of many connections parsed on multiple threads all end up in the table,
+// in time order.
+TEST_F(SocketTraceConnectorTest, ParallelParsing) {
+  PL_SET_FOR_SCOPE(FLAGS_stirling_socket_tracer_parser_threads, 4);
+
+  constexpr int kNumConns = 500;
+  for (int i = 0; i < kNumConns; ++i) {
+    testing::EventGenerator event_gen(&mock_clock_, kPID, kFD + i);
+    source_->AcceptControlEvent(event_gen.InitConn());
+    source_->AcceptDataEvent(event_gen.InitSendEvent<kProtocolHTTP>(kReq0));
+    source_->AcceptDataEvent(event_gen.InitRecvEvent<kProtocolHTTP>(kResp0));
+    source_->AcceptControlEvent(event_gen.InitClose());
+  }
+
+  connector_->TransferData(ctx_.get());
+
+  std::vector<TaggedRecordBatch> tablets = http_table_->ConsumeRecords();
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(RecordBatch & records, tablets);
+
+  ASSERT_THAT(records, RecordBatchSizeIs(kNumConns));
+  std::vector<int64_t> times = ToIntVector<types::Time64NSValue>(records[kHTTPTimeIdx]);
+  EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+  EXPECT_THAT(ToStringVector(records[kHTTPRespBodyIdx]), Each("foo"));
+}
+
 TEST_F(SocketTraceConnectorTest, HTTPDelayedRespBody) {
   struct socket_control_event_t conn = event_gen_.InitConn();
   std::unique_ptr<SocketDataEvent> event0_req = event_gen_.InitSendEvent<kProtocolHTTP>(kReq4);
@@ -811,6 +838,37 @@ TEST_F(SocketTraceConnectorTest, ConnectionCleanupInactiveDead) {
   EXPECT_NOT_OK(source_->GetConnTracker(impossible_pid, 1));
 }
 
+TEST_F(SocketTraceConnectorTest, ConnectionCleanupInactiveDeadWithConnStatsSnapshots) {
+  PL_SET_FOR_SCOPE(FLAGS_stirling_check_proc_for_conn_close, true);
+
+  const uint32_t impossible_pid = 1 << 23;
+
+  testing::EventGenerator event_gen(&mock_clock_, impossible_pid, 1);
+  struct socket_control_event_t conn0 = event_gen.InitConn();
+
+  std::unique_ptr<SocketDataEvent> conn0_req_event = event_gen.InitSendEvent<kProtocolHTTP>(kReq0);
+
+  source_->AcceptControlEvent(conn0);
+  source_->AcceptDataEvent(std::move(conn0_req_event));
+  EXPECT_OK(source_->GetConnTracker(impossible_pid, 1));
+
+  // The stats of the connection are read from conn_info_map in every iteration, while it is idle.
+  struct conn_info_t conn_info = {};
+  conn_info.conn_id = conn0.conn_id;
+  conn_info.addr = conn0.open.addr;
+  conn_info.role = kRoleClient;
+  conn_info.wr_bytes = kReq0.size();
+
+  for (int i = 0; i < 100; ++i) {
+    source_->AcceptConnStatsSnapshot({conn_info}, mock_clock_.now());
+    connector_->TransferData(ctx_.get());
+  }
+
+  // The snapshots do not count as activity, so the connection was still found idle, and a check
+  // of /proc/<pid>/<fd> triggered MarkForDeath().
+  EXPECT_NOT_OK(source_->GetConnTracker(impossible_pid, 1));
+}
+
 TEST_F(SocketTraceConnectorTest, ConnectionCleanupInactiveAlive) {
   PL_SET_FOR_SCOPE(FLAGS_stirling_check_proc_for_conn_close, true);
   std::chrono::seconds kInactivityDuration(1);
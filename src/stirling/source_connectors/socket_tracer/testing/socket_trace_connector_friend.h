@@ -18,6 +18,7 @@
 #pragma once
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "src/stirling/core/connector_context.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_connector.h"
@@ -45,6 +46,10 @@ class SocketTraceConnectorFriend : public SocketTraceConnector {
   void AcceptConnStatsEvent(conn_stats_event_t event) {
     SocketTraceConnector::AcceptConnStatsEvent(event);
   }
+  void AcceptConnStatsSnapshot(const std::vector<struct conn_info_t>& conn_infos,
+                               uint64_t timestamp_ns) {
+    SocketTraceConnector::AcceptConnStatsSnapshot(conn_infos, timestamp_ns);
+  }
   void AcceptHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> event) {
     SocketTraceConnector::AcceptHTTP2Header(std::move(event));
   }
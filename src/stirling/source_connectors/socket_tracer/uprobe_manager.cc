@@ -39,6 +39,7 @@
 #include "src/stirling/obj_tools/dwarf_reader.h"
 #include "src/stirling/obj_tools/go_syms.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
+#include "src/stirling/source_connectors/socket_tracer/go_uprobe_deploy_pipeline.h"
 #include "src/stirling/utils/linux_headers.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
@@ -51,6 +52,9 @@ DEFINE_bool(stirling_enable_grpc_c_tracing,
 DEFINE_double(stirling_rescan_exp_backoff_factor, 2.0,
               "Exponential backoff factor used in decided how often to rescan binaries for "
               "dynamically loaded libraries");
+DEFINE_uint32(stirling_uprobe_analysis_threads, 2,
+              "Number of threads used to analyze new Go binaries for uprobe deployment. "
+              "Each analysis indexes the binary's DWARF info, which can take a lot of memory.");
 
 namespace px {
 namespace stirling {
@@ -62,7 +66,13 @@ using ::px::stirling::utils::KernelVersion;
 using ::px::stirling::utils::KernelVersionOrder;
 using ::px::system::ProcPidRootPath;
 
-UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc) : bcc_(bcc) {
+UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc)
+    : bcc_(bcc),
+      go_binary_analyses_(
+          FLAGS_stirling_uprobe_symaddrs_cache_dir, FLAGS_stirling_uprobe_symaddrs_cache_size,
+          FLAGS_stirling_uprobe_symaddrs_cache_max_files,
+          std::chrono::hours(FLAGS_stirling_uprobe_symaddrs_cache_max_age_hours)),
+      md5_hashes_(FLAGS_stirling_uprobe_symaddrs_cache_size) {
   proc_parser_ = std::make_unique<system::ProcParser>();
 }
 
@@ -99,14 +109,13 @@ Status UProbeManager::LogAndAttachUProbe(const bpf_tools::UProbeSpec& spec) {
   return s;
 }
 
-StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
-                                              const std::string& binary,
-                                              obj_tools::ElfReader* elf_reader) {
+StatusOr<std::vector<bpf_tools::UProbeSpec>> UProbeManager::ResolveUProbeTmpls(
+    const ArrayView<UProbeTmpl>& probe_tmpls, obj_tools::ElfReader* elf_reader) {
   using bpf_tools::BPFProbeAttachType;
 
-  int uprobe_count = 0;
+  std::vector<bpf_tools::UProbeSpec> specs;
   for (const auto& tmpl : probe_tmpls) {
-    bpf_tools::UProbeSpec spec = {binary,
+    bpf_tools::UProbeSpec spec = {/*binary_path*/ {},
                                   /*symbol*/ {},
                                   /*address*/ 0,    bpf_tools::UProbeSpec::kDefaultPID,
                                   tmpl.attach_type, std::string(tmpl.probe_fn)};
@@ -125,8 +134,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
         case BPFProbeAttachType::kEntry:
         case BPFProbeAttachType::kReturn: {
           spec.symbol = symbol_info.name;
-          PL_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
-          ++uprobe_count;
+          specs.push_back(spec);
           break;
         }
         case BPFProbeAttachType::kReturnInsts: {
@@ -143,8 +151,7 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
           for (const uint64_t& addr : ret_inst_addrs) {
             spec.attach_type = BPFProbeAttachType::kEntry;
             spec.address = addr;
-            PL_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
-            ++uprobe_count;
+            specs.push_back(spec);
           }
           break;
         }
@@ -153,50 +160,32 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
       }
     }
   }
-  return uprobe_count;
-}
-
-Status UProbeManager::UpdateOpenSSLSymAddrs(obj_tools::RawFptrManager* fptr_manager,
-                                            std::filesystem::path libcrypto_path, uint32_t pid) {
-  PL_ASSIGN_OR_RETURN(struct openssl_symaddrs_t symaddrs,
-                      OpenSSLSymAddrs(fptr_manager, libcrypto_path, pid));
-
-  openssl_symaddrs_map_->UpdateValue(pid, symaddrs);
-
-  return Status::OK();
+  return specs;
 }
 
-Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                             const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_common_symaddrs_t symaddrs,
-                      GoCommonSymAddrs(elf_reader, dwarf_reader));
-
-  for (auto& pid : pids) {
-    go_common_symaddrs_map_->UpdateValue(pid, symaddrs);
+StatusOr<int> UProbeManager::AttachUProbeSpecs(const std::vector<bpf_tools::UProbeSpec>& specs,
+                                               const std::string& binary) {
+  for (auto spec : specs) {
+    spec.binary_path = binary;
+    PL_RETURN_IF_ERROR(LogAndAttachUProbe(spec));
   }
-
-  return Status::OK();
+  return specs.size();
 }
 
-Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                            const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_http2_symaddrs_t symaddrs,
-                      GoHTTP2SymAddrs(elf_reader, dwarf_reader));
-
-  for (auto& pid : pids) {
-    go_http2_symaddrs_map_->UpdateValue(pid, symaddrs);
-  }
-
-  return Status::OK();
+StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
+                                              const std::string& binary,
+                                              obj_tools::ElfReader* elf_reader) {
+  PL_ASSIGN_OR_RETURN(std::vector<bpf_tools::UProbeSpec> specs,
+                      ResolveUProbeTmpls(probe_tmpls, elf_reader));
+  return AttachUProbeSpecs(specs, binary);
 }
 
-Status UProbeManager::UpdateGoTLSSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                          const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_tls_symaddrs_t symaddrs, GoTLSSymAddrs(elf_reader, dwarf_reader));
+Status UProbeManager::UpdateOpenSSLSymAddrs(obj_tools::RawFptrManager* fptr_manager,
+                                            std::filesystem::path libcrypto_path, uint32_t pid) {
+  PL_ASSIGN_OR_RETURN(struct openssl_symaddrs_t symaddrs,
+                      OpenSSLSymAddrs(fptr_manager, libcrypto_path, pid));
 
-  for (auto& pid : pids) {
-    go_tls_symaddrs_map_->UpdateValue(pid, symaddrs);
-  }
+  openssl_symaddrs_map_->UpdateValue(pid, symaddrs);
 
   return Status::OK();
 }
@@ -414,45 +403,121 @@ StatusOr<int> UProbeManager::AttachNodeJsOpenSSLUprobes(const uint32_t pid) {
   return kOpenSSLUProbes.size() + count;
 }
 
+StatusOr<GoBinaryAnalysis> UProbeManager::AnalyzeGoBinary(const std::string& binary) {
+  GoBinaryAnalysis analysis;
+
+  // Read binary's symbols.
+  PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(binary));
+
+  // Avoid going past this point if not a golang program.
+  // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
+  if (!IsGoExecutable(elf_reader.get())) {
+    return analysis;
+  }
+
+  StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
+      DwarfReader::CreateIndexingAll(binary);
+  if (!dwarf_reader_status.ok()) {
+    VLOG(1) << absl::Substitute(
+        "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
+        "Message = $1",
+        binary, dwarf_reader_status.msg());
+    return analysis;
+  }
+  std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
+
+  StatusOr<struct go_common_symaddrs_t> common_symaddrs =
+      GoCommonSymAddrs(elf_reader.get(), dwarf_reader.get());
+  if (!common_symaddrs.ok()) {
+    VLOG(1) << absl::Substitute(
+        "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
+    return analysis;
+  }
+  analysis.common_symaddrs = common_symaddrs.ConsumeValueOrDie();
+
+  // GoTLS Probes.
+  // A binary without the symbols is not using crypto/tls, and is not of interest to probe.
+  StatusOr<struct go_tls_symaddrs_t> tls_symaddrs =
+      GoTLSSymAddrs(elf_reader.get(), dwarf_reader.get());
+  if (tls_symaddrs.ok()) {
+    StatusOr<std::vector<bpf_tools::UProbeSpec>> tls_uprobes =
+        ResolveUProbeTmpls(kGoTLSUProbeTmpls, elf_reader.get());
+    if (tls_uprobes.ok()) {
+      analysis.tls_symaddrs = tls_symaddrs.ConsumeValueOrDie();
+      analysis.tls_uprobes = tls_uprobes.ConsumeValueOrDie();
+    } else {
+      monitor_.AppendSourceStatusRecord("socket_tracer", tls_uprobes.status(),
+                                        "ResolveGoTLSUProbes");
+      LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to resolve GoTLS Uprobes in $0: $1",
+                                                   binary, tls_uprobes.ToString());
+    }
+  }
+
+  // Go HTTP2 Probes.
+  // These are resolved even if HTTP2 tracing is disabled, as the analysis may be persisted and
+  // used by a later instance of Stirling that has it enabled.
+  StatusOr<struct go_http2_symaddrs_t> http2_symaddrs =
+      GoHTTP2SymAddrs(elf_reader.get(), dwarf_reader.get());
+  if (http2_symaddrs.ok()) {
+    StatusOr<std::vector<bpf_tools::UProbeSpec>> http2_uprobes =
+        ResolveUProbeTmpls(kHTTP2ProbeTmpls, elf_reader.get());
+    if (http2_uprobes.ok()) {
+      analysis.http2_symaddrs = http2_symaddrs.ConsumeValueOrDie();
+      analysis.http2_uprobes = http2_uprobes.ConsumeValueOrDie();
+    } else {
+      monitor_.AppendSourceStatusRecord("socket_tracer", http2_uprobes.status(),
+                                        "ResolveGoHTTP2UProbes");
+      LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to resolve HTTP2 Uprobes in $0: $1",
+                                                   binary, http2_uprobes.ToString());
+    }
+  }
+
+  return analysis;
+}
+
 StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
-                                                obj_tools::ElfReader* elf_reader,
-                                                obj_tools::DwarfReader* dwarf_reader,
+                                                const GoBinaryAnalysis& analysis,
                                                 const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symbols_map on all new PIDs.
-  Status s = UpdateGoTLSSymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  if (!analysis.tls_symaddrs.has_value()) {
     // Doesn't appear to be a binary with the mandatory symbols.
     // Might not even be a golang binary.
     // Either way, not of interest to probe.
     return 0;
   }
 
+  // Step 1: Update BPF symbols_map on all new PIDs.
+  for (auto& pid : pids) {
+    go_tls_symaddrs_map_->UpdateValue(pid, analysis.tls_symaddrs.value());
+  }
+
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_tls_probed_binaries_.insert(binary);
   if (!result.second) {
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kGoTLSUProbeTmpls, binary, elf_reader);
+  return AttachUProbeSpecs(analysis.tls_uprobes, binary);
 }
 
 StatusOr<int> UProbeManager::AttachGoHTTP2UProbes(const std::string& binary,
-                                                  obj_tools::ElfReader* elf_reader,
-                                                  obj_tools::DwarfReader* dwarf_reader,
+                                                  const GoBinaryAnalysis& analysis,
                                                   const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symaddrs for this binary.
-  Status s = UpdateGoHTTP2SymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  if (!analysis.http2_symaddrs.has_value()) {
     return 0;
   }
 
+  // Step 1: Update BPF symaddrs for this binary.
+  for (auto& pid : pids) {
+    go_http2_symaddrs_map_->UpdateValue(pid, analysis.http2_symaddrs.value());
+  }
+
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_http2_probed_binaries_.insert(binary);
   if (!result.second) {
     // This is not a new binary, so nothing more to do.
     return 0;
   }
-  return AttachUProbeTmpl(kHTTP2ProbeTmpls, binary, elf_reader);
+  return AttachUProbeSpecs(analysis.http2_uprobes, binary);
 }
 
 namespace {
@@ -486,8 +551,8 @@ std::map<std::string, std::vector<int32_t>> ConvertPIDsListToMap(
 std::thread UProbeManager::RunDeployUProbesThread(const absl::flat_hash_set<md::UPID>& pids) {
   // Increment before starting thread to avoid race in case thread starts late.
   ++num_deploy_uprobes_threads_;
-  return std::thread([this, pids]() {
-    DeployUProbes(pids);
+  return std::thread([this, pids, request_time = std::chrono::steady_clock::now()]() {
+    DeployUProbes(pids, request_time);
     --num_deploy_uprobes_threads_;
   });
   return {};
@@ -548,6 +613,12 @@ int UProbeManager::DeployOpenSSLUProbes(const absl::flat_hash_set<md::UPID>& pid
 }
 
 StatusOr<std::string> UProbeManager::MD5onFile(const std::string& file) {
+  PL_ASSIGN_OR_RETURN(const std::string file_key, ElfReader::BinaryIdentity(file));
+  const std::string* cached_hash = md5_hashes_.Lookup(file_key);
+  if (cached_hash != nullptr) {
+    return *cached_hash;
+  }
+
   // Implementation based on
   // https://stackoverflow.com/questions/1220046/how-to-get-the-md5-hash-of-a-file-in-c
   unsigned char md5_hash[MD5_DIGEST_LENGTH] = {0};
@@ -588,6 +659,7 @@ StatusOr<std::string> UProbeManager::MD5onFile(const std::string& file) {
   std::string hash_str =
       absl::AsciiStrToLower(BytesToString<bytes_format::HexCompact>(md5_hash_str_view));
 
+  md5_hashes_.Insert(file_key, hash_str);
   return hash_str;
 }
 
@@ -696,12 +768,12 @@ int UProbeManager::DeployGrpcCUProbes(const absl::flat_hash_set<md::UPID>& pids)
   return uprobe_count;
 }
 
-int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
-  int uprobe_count = 0;
-
+int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids,
+                                   std::chrono::steady_clock::time_point request_time) {
   static int32_t kPID = getpid();
 
-  for (const auto& [binary, pid_vec] : ConvertPIDsListToMap(pids)) {
+  std::map<std::string, std::vector<int32_t>> new_binaries;
+  for (auto& [binary, pid_vec] : ConvertPIDsListToMap(pids)) {
     // Don't bother rescanning binaries that have been scanned before to avoid unnecessary work.
     if (!scanned_binaries_.insert(binary).second) {
       continue;
@@ -715,71 +787,66 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
       }
     }
 
-    // Read binary's symbols.
-    StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
-    if (!elf_reader_status.ok()) {
-      LOG(WARNING) << absl::Substitute(
-          "Cannot analyze binary $0 for uprobe deployment. "
-          "If file is under /var/lib, container may have terminated. "
-          "Message = $1",
-          binary, elf_reader_status.msg());
-      continue;
-    }
-    std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
+    new_binaries.emplace(binary, std::move(pid_vec));
+  }
 
-    // Avoid going past this point if not a golang program.
-    // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
-    if (!IsGoExecutable(elf_reader.get())) {
-      continue;
-    }
+  GoUProbeDeployPipeline::Stages stages;
+  stages.identify = &ElfReader::BinaryIdentity;
+  stages.lookup = [this](const std::string& key) { return go_binary_analyses_.Lookup(key); };
+  stages.analyze = [this](const std::string& binary) { return AnalyzeGoBinary(binary); };
+  stages.insert = [this](const std::string& key, GoBinaryAnalysis analysis) {
+    return go_binary_analyses_.Insert(key, std::move(analysis));
+  };
+  stages.attach = [this, request_time](const std::string& binary,
+                                       const std::vector<int32_t>& pid_vec,
+                                       const GoBinaryAnalysis& analysis) {
+    return AttachGoUProbes(binary, pid_vec, analysis, request_time);
+  };
+  stages.queue_depth = [this](size_t depth) { monitor_.NotifyUProbeDeployQueueDepth(depth); };
 
-    StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
-        DwarfReader::CreateIndexingAll(binary);
-    if (!dwarf_reader_status.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
-          "Message = $1",
-          binary, dwarf_reader_status.msg());
-      continue;
-    }
-    std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
-    Status s = UpdateGoCommonSymAddrs(elf_reader.get(), dwarf_reader.get(), pid_vec);
-    if (!s.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
-      continue;
-    }
+  GoUProbeDeployPipeline pipeline(std::move(stages), FLAGS_stirling_uprobe_analysis_threads);
+  return pipeline.Run(new_binaries);
+}
 
-    // GoTLS Probes.
-    {
-      StatusOr<int> attach_status =
-          AttachGoTLSUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
-      if (!attach_status.ok()) {
-        monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
-                                          "AttachGoTLSUProbes");
-        LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach GoTLS Uprobes to $0: $1",
-                                                     binary, attach_status.ToString());
-      } else {
-        uprobe_count += attach_status.ValueOrDie();
-      }
+int UProbeManager::AttachGoUProbes(const std::string& binary, const std::vector<int32_t>& pid_vec,
+                                   const GoBinaryAnalysis& analysis,
+                                   std::chrono::steady_clock::time_point request_time) {
+  for (auto& pid : pid_vec) {
+    go_common_symaddrs_map_->UpdateValue(pid, analysis.common_symaddrs.value());
+  }
+
+  int binary_uprobe_count = 0;
+
+  // GoTLS Probes.
+  {
+    StatusOr<int> attach_status = AttachGoTLSUProbes(binary, analysis, pid_vec);
+    if (!attach_status.ok()) {
+      monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
+                                        "AttachGoTLSUProbes");
+      LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach GoTLS Uprobes to $0: $1",
+                                                   binary, attach_status.ToString());
+    } else {
+      binary_uprobe_count += attach_status.ValueOrDie();
     }
+  }
 
-    // Go HTTP2 Probes.
-    if (cfg_enable_http2_tracing_) {
-      StatusOr<int> attach_status =
-          AttachGoHTTP2UProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
-      if (!attach_status.ok()) {
-        monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
-                                          "AttachGoHTTP2UProbes");
-        LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach HTTP2 Uprobes to $0: $1",
-                                                     binary, attach_status.ToString());
-      } else {
-        uprobe_count += attach_status.ValueOrDie();
-      }
+  // Go HTTP2 Probes.
+  if (cfg_enable_http2_tracing_) {
+    StatusOr<int> attach_status = AttachGoHTTP2UProbes(binary, analysis, pid_vec);
+    if (!attach_status.ok()) {
+      monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
+                                        "AttachGoHTTP2UProbes");
+      LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach HTTP2 Uprobes to $0: $1",
+                                                   binary, attach_status.ToString());
+    } else {
+      binary_uprobe_count += attach_status.ValueOrDie();
     }
   }
 
-  return uprobe_count;
+  if (binary_uprobe_count != 0) {
+    monitor_.NotifyUProbesAttached(std::chrono::steady_clock::now() - request_time);
+  }
+  return binary_uprobe_count;
 }
 
 absl::flat_hash_set<md::UPID> UProbeManager::PIDsToRescanForUProbes() {
@@ -839,7 +906,8 @@ bool KernelVersionAllowsGRPCCTracing() {
   return false;
 }
 
-void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids) {
+void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids,
+                                  std::chrono::steady_clock::time_point request_time) {
   const std::lock_guard<std::mutex> lock(deploy_uprobes_mutex_);
 
   proc_tracker_.Update(pids);
@@ -863,7 +931,7 @@ void UProbeManager::DeployUProbes(const absl::flat_hash_set<md::UPID>& pids) {
     }
   }
 
-  uprobe_count += DeployGoUProbes(proc_tracker_.new_upids());
+  uprobe_count += DeployGoUProbes(proc_tracker_.new_upids(), request_time);
 
   if (uprobe_count != 0) {
     LOG(INFO) << absl::Substitute("Number of uprobes deployed = $0", uprobe_count);
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <string>
@@ -37,7 +38,9 @@
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
 
 #include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs.h"
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
 #include "src/stirling/utils/detect_application.h"
+#include "src/stirling/utils/lru_cache.h"
 #include "src/stirling/utils/monitor.h"
 #include "src/stirling/utils/proc_path_tools.h"
 #include "src/stirling/utils/proc_tracker.h"
@@ -45,6 +48,7 @@
 DECLARE_bool(stirling_rescan_for_dlopen);
 DECLARE_bool(stirling_enable_grpc_c_tracing);
 DECLARE_double(stirling_rescan_exp_backoff_factor);
+DECLARE_uint32(stirling_uprobe_analysis_threads);
 
 namespace px {
 namespace stirling {
@@ -419,6 +423,7 @@ class UProbeManager {
   int DeployGrpcCUProbes(const absl::flat_hash_set<md::UPID>& pids);
   // We hash grpc-c libraries to know its version.
   // For further explanation see the definition of kGrpcCMD5HashToVersion.
+  // The hash is remembered per file identity, as the same library is mapped by many processes.
   StatusOr<std::string> MD5onFile(const std::string& file);
   StatusOr<int> AttachGrpcCUProbesOnDynamicPythonLib(uint32_t pid);
 
@@ -463,8 +468,10 @@ class UProbeManager {
   /**
    * Deploys all available uprobe types (HTTP2, OpenSSL, etc.) on new processes.
    * @param pids The list of pids to analyze and instrument with uprobes, if appropriate.
+   * @param request_time The time at which the pids were handed over for deployment.
    */
-  void DeployUProbes(const absl::flat_hash_set<md::UPID>& pids);
+  void DeployUProbes(const absl::flat_hash_set<md::UPID>& pids,
+                     std::chrono::steady_clock::time_point request_time);
 
   /**
    * Deploys all OpenSSL uprobes on new processes.
@@ -475,10 +482,29 @@ class UProbeManager {
 
   /**
    * Deploys all Go uprobes on new processes.
+   *
+   * This runs as a GoUProbeDeployPipeline: the binaries of the processes are grouped by identity,
+   * the distinct binaries that have not been analyzed before are analyzed in parallel, and then
+   * the uprobes are attached binary by binary.
+   *
    * @param pids The list of pids to analyze and instrument with Go uprobes, if appropriate.
+   * @param request_time The time at which the pids were handed over for deployment.
+   * @return Number of uprobes deployed.
+   */
+  int DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids,
+                      std::chrono::steady_clock::time_point request_time);
+
+  /**
+   * Attaches the Go uprobes of an analyzed Go binary; the last stage of DeployGoUProbes().
+   * @param binary The path to the binary.
+   * @param pids The list of PIDs that are new instances of the binary.
+   * @param analysis The analysis of the binary.
+   * @param request_time The time at which the pids were handed over for deployment.
    * @return Number of uprobes deployed.
    */
-  int DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids);
+  int AttachGoUProbes(const std::string& binary, const std::vector<int32_t>& pids,
+                      const GoBinaryAnalysis& analysis,
+                      std::chrono::steady_clock::time_point request_time);
 
   /**
    * Sets up the BPF maps used for GOID tracking. Required for general Go tracing.
@@ -488,21 +514,30 @@ class UProbeManager {
    */
   void SetupGOIDMaps(const std::string& binary, const std::vector<int32_t>& pids);
 
+  /**
+   * Reads the ELF and DWARF information of a binary to find the symbol addresses and uprobes
+   * needed for Go tracing. This is expensive, so results are cached in go_binary_analyses_.
+   * Thread-safe, since GoUProbeDeployPipeline analyzes several binaries concurrently.
+   *
+   * @param binary The path to the binary.
+   * @return The analysis, or error if the binary could not be read. It is not an error if the
+   *         binary is not a Go binary; instead the analysis is empty.
+   */
+  StatusOr<GoBinaryAnalysis> AnalyzeGoBinary(const std::string& binary);
+
   /**
    * Attaches the required uprobes for Go HTTP2 tracing to the specified binary, if it is a
    * compatible Go binary.
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param analysis The analysis of the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not considered an error if the binary
    *         is not a Go binary or doesn't use a Go HTTP2 library; instead the return value will be
    *         zero.
    */
-  StatusOr<int> AttachGoHTTP2UProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                     obj_tools::DwarfReader* dwarf_reader,
+  StatusOr<int> AttachGoHTTP2UProbes(const std::string& binary, const GoBinaryAnalysis& analysis,
                                      const std::vector<int32_t>& pids);
 
   /**
@@ -510,16 +545,14 @@ class UProbeManager {
    * Go binary.
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
-   * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param analysis The analysis of the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not an error if the binary
    *         is not a Go binary or doesn't use Go TLS; instead the return value will be zero.
    */
-  StatusOr<int> AttachGoTLSUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                   obj_tools::DwarfReader* dwarf_reader,
-                                   const std::vector<int32_t>& new_pids);
+  StatusOr<int> AttachGoTLSUProbes(const std::string& binary, const GoBinaryAnalysis& analysis,
+                                   const std::vector<int32_t>& pids);
 
   /**
    * Attaches the required probes for OpenSSL tracing to the specified PID, if it uses OpenSSL.
@@ -561,19 +594,25 @@ class UProbeManager {
   StatusOr<int> AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe_tmpls,
                                  const std::string& binary, obj_tools::ElfReader* elf_reader);
 
+  /**
+   * Finds the symbols that match the probe templates, and returns the uprobes to attach.
+   * The binary_path of the returned specs is left empty.
+   */
+  static StatusOr<std::vector<bpf_tools::UProbeSpec>> ResolveUProbeTmpls(
+      const ArrayView<UProbeTmpl>& probe_tmpls, obj_tools::ElfReader* elf_reader);
+
+  /**
+   * Attaches the given uprobes to a binary.
+   * @return Number of uprobes deployed, or error if uprobes failed to deploy.
+   */
+  StatusOr<int> AttachUProbeSpecs(const std::vector<bpf_tools::UProbeSpec>& specs,
+                                  const std::string& binary);
+
   // Returns set of PIDs that have had mmap called on them since the last call.
   absl::flat_hash_set<md::UPID> PIDsToRescanForUProbes();
 
   Status UpdateOpenSSLSymAddrs(px::stirling::obj_tools::RawFptrManager* fptrManager,
                                std::filesystem::path container_lib, uint32_t pid);
-  Status UpdateGoCommonSymAddrs(obj_tools::ElfReader* elf_reader,
-                                obj_tools::DwarfReader* dwarf_reader,
-                                const std::vector<int32_t>& pids);
-  Status UpdateGoHTTP2SymAddrs(obj_tools::ElfReader* elf_reader,
-                               obj_tools::DwarfReader* dwarf_reader,
-                               const std::vector<int32_t>& pids);
-  Status UpdateGoTLSSymAddrs(obj_tools::ElfReader* elf_reader, obj_tools::DwarfReader* dwarf_reader,
-                             const std::vector<int32_t>& pids);
   Status UpdateNodeTLSWrapSymAddrs(int32_t pid, const std::filesystem::path& node_exe,
                                    const SemVer& ver);
 
@@ -618,6 +657,13 @@ class UProbeManager {
   absl::flat_hash_set<std::string> nodejs_binaries_;
   absl::flat_hash_set<std::string> grpc_c_probed_binaries_;
 
+  // Analyses of Go binaries, keyed by the identity of the binary rather than its path, so that
+  // the expensive DWARF analysis is not repeated for every container that runs the same binary.
+  UProbeSymAddrsCache go_binary_analyses_;
+
+  // MD5 hashes of files, keyed by the identity of the file. See MD5onFile().
+  LRUCache<std::string, std::string> md5_hashes_;
+
   // BPF maps through which the addresses of symbols for a given pid are communicated to uprobes.
   std::unique_ptr<UserSpaceManagedBPFMap<uint32_t, struct openssl_symaddrs_t>>
       openssl_symaddrs_map_;
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/byte_utils.h"
+#include "src/common/base/file.h"
+#include "src/common/fs/fs_wrapper.h"
+#include "src/stirling/source_connectors/socket_tracer/go_binary_analysis_hash.h"
+#include "src/stirling/utils/binary_decoder.h"
+
+DEFINE_string(stirling_uprobe_symaddrs_cache_dir,
+              gflags::StringFromEnv("PL_STIRLING_UPROBE_SYMADDRS_CACHE_DIR", ""),
+              "Directory in which the results of analyzing Go binaries for uprobes are persisted, "
+              "so that they survive restarts. Empty disables persistence.");
+DEFINE_uint32(stirling_uprobe_symaddrs_cache_size, 1024,
+              "Number of analyzed Go binaries whose results are kept in memory.");
+DEFINE_uint32(stirling_uprobe_symaddrs_cache_max_files, 8192,
+              "Maximum number of analyses persisted in --stirling_uprobe_symaddrs_cache_dir. "
+              "The least recently used ones are removed first.");
+DEFINE_uint32(stirling_uprobe_symaddrs_cache_max_age_hours, 7 * 24,
+              "Persisted analyses that have not been used for this long are removed on startup.");
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+// Bump whenever the layout below changes. Changes to the symaddrs structs and to the analysis are
+// caught by the sizes and the PX_GO_BINARY_ANALYSIS_HASH that are also recorded in the header.
+constexpr uint32_t kFormatVersion = 2;
+
+template <typename TIntType>
+void AppendInt(TIntType val, std::string* buf) {
+  char bytes[sizeof(TIntType)];
+  utils::IntToBEndianBytes(static_cast<int64_t>(val), bytes);
+  buf->append(bytes, sizeof(bytes));
+}
+
+void AppendString(std::string_view str, std::string* buf) {
+  AppendInt<uint32_t>(str.size(), buf);
+  buf->append(str);
+}
+
+template <typename TStructType>
+void AppendStruct(const std::optional<TStructType>& val, std::string* buf) {
+  static_assert(std::is_trivially_copyable_v<TStructType>);
+  AppendInt<uint8_t>(val.has_value(), buf);
+  if (val.has_value()) {
+    buf->append(reinterpret_cast<const char*>(&val.value()), sizeof(TStructType));
+  }
+}
+
+void AppendUProbeSpecs(const std::vector<bpf_tools::UProbeSpec>& specs, std::string* buf) {
+  AppendInt<uint32_t>(specs.size(), buf);
+  for (const auto& spec : specs) {
+    AppendString(spec.symbol, buf);
+    AppendInt<uint64_t>(spec.address, buf);
+    AppendInt<uint8_t>(static_cast<uint8_t>(spec.attach_type), buf);
+    AppendString(spec.probe_fn, buf);
+  }
+}
+
+StatusOr<std::string> ExtractString(BinaryDecoder* decoder) {
+  PL_ASSIGN_OR_RETURN(uint32_t len, decoder->ExtractInt<uint32_t>());
+  PL_ASSIGN_OR_RETURN(std::string_view str, decoder->ExtractString(len));
+  return std::string(str);
+}
+
+template <typename TStructType>
+StatusOr<std::optional<TStructType>> ExtractStruct(BinaryDecoder* decoder) {
+  PL_ASSIGN_OR_RETURN(uint8_t has_value, decoder->ExtractInt<uint8_t>());
+  if (!has_value) {
+    return std::optional<TStructType>();
+  }
+  PL_ASSIGN_OR_RETURN(std::string_view bytes, decoder->ExtractString(sizeof(TStructType)));
+  TStructType val;
+  std::memcpy(&val, bytes.data(), sizeof(TStructType));
+  return std::optional<TStructType>(val);
+}
+
+StatusOr<std::vector<bpf_tools::UProbeSpec>> ExtractUProbeSpecs(BinaryDecoder* decoder) {
+  PL_ASSIGN_OR_RETURN(uint32_t num_specs, decoder->ExtractInt<uint32_t>());
+  std::vector<bpf_tools::UProbeSpec> specs;
+  for (uint32_t i = 0; i < num_specs; ++i) {
+    bpf_tools::UProbeSpec spec;
+    PL_ASSIGN_OR_RETURN(spec.symbol, ExtractString(decoder));
+    PL_ASSIGN_OR_RETURN(spec.address, decoder->ExtractInt<uint64_t>());
+    PL_ASSIGN_OR_RETURN(uint8_t attach_type, decoder->ExtractInt<uint8_t>());
+    spec.attach_type = static_cast<bpf_tools::BPFProbeAttachType>(attach_type);
+    PL_ASSIGN_OR_RETURN(spec.probe_fn, ExtractString(decoder));
+    specs.push_back(std::move(spec));
+  }
+  return specs;
+}
+
+}  // namespace
+
+std::string SerializeGoBinaryAnalysis(const GoBinaryAnalysis& analysis) {
+  std::string buf;
+  AppendInt<uint32_t>(kFormatVersion, &buf);
+  AppendString(PX_GO_BINARY_ANALYSIS_HASH, &buf);
+  AppendInt<uint32_t>(sizeof(struct go_common_symaddrs_t), &buf);
+  AppendInt<uint32_t>(sizeof(struct go_tls_symaddrs_t), &buf);
+  AppendInt<uint32_t>(sizeof(struct go_http2_symaddrs_t), &buf);
+
+  AppendStruct(analysis.common_symaddrs, &buf);
+  AppendStruct(analysis.tls_symaddrs, &buf);
+  AppendStruct(analysis.http2_symaddrs, &buf);
+  AppendUProbeSpecs(analysis.tls_uprobes, &buf);
+  AppendUProbeSpecs(analysis.http2_uprobes, &buf);
+  return buf;
+}
+
+StatusOr<GoBinaryAnalysis> DeserializeGoBinaryAnalysis(std::string_view buf) {
+  BinaryDecoder decoder(buf);
+
+  PL_ASSIGN_OR_RETURN(uint32_t format_version, decoder.ExtractInt<uint32_t>());
+  if (format_version != kFormatVersion) {
+    return error::FailedPrecondition("Stale entry [format_version=$0]", format_version);
+  }
+  PL_ASSIGN_OR_RETURN(std::string analysis_hash, ExtractString(&decoder));
+  PL_ASSIGN_OR_RETURN(uint32_t common_size, decoder.ExtractInt<uint32_t>());
+  PL_ASSIGN_OR_RETURN(uint32_t tls_size, decoder.ExtractInt<uint32_t>());
+  PL_ASSIGN_OR_RETURN(uint32_t http2_size, decoder.ExtractInt<uint32_t>());
+  if (analysis_hash != PX_GO_BINARY_ANALYSIS_HASH ||
+      common_size != sizeof(struct go_common_symaddrs_t) ||
+      tls_size != sizeof(struct go_tls_symaddrs_t) ||
+      http2_size != sizeof(struct go_http2_symaddrs_t)) {
+    return error::FailedPrecondition("Stale entry [analysis_hash=$0]", analysis_hash);
+  }
+
+  GoBinaryAnalysis analysis;
+  PL_ASSIGN_OR_RETURN(analysis.common_symaddrs,
+                      ExtractStruct<struct go_common_symaddrs_t>(&decoder));
+  PL_ASSIGN_OR_RETURN(analysis.tls_symaddrs, ExtractStruct<struct go_tls_symaddrs_t>(&decoder));
+  PL_ASSIGN_OR_RETURN(analysis.http2_symaddrs,
+                      ExtractStruct<struct go_http2_symaddrs_t>(&decoder));
+  PL_ASSIGN_OR_RETURN(analysis.tls_uprobes, ExtractUProbeSpecs(&decoder));
+  PL_ASSIGN_OR_RETURN(analysis.http2_uprobes, ExtractUProbeSpecs(&decoder));
+  if (!decoder.eof()) {
+    return error::DataLoss("$0 trailing bytes", decoder.BufSize());
+  }
+  return analysis;
+}
+
+UProbeSymAddrsCache::UProbeSymAddrsCache(std::filesystem::path dir, size_t capacity,
+                                         size_t max_files, std::chrono::seconds max_age)
+    : dir_(std::move(dir)), max_files_(max_files), max_age_(max_age), entries_(capacity) {
+  if (dir_.empty()) {
+    return;
+  }
+  Status s = fs::CreateDirectories(dir_);
+  if (!s.ok()) {
+    LOG(WARNING) << absl::Substitute("Uprobe symaddrs will not be persisted: $0", s.msg());
+    return;
+  }
+  PruneDir(max_files_);
+}
+
+std::shared_ptr<const GoBinaryAnalysis> UProbeSymAddrsCache::Lookup(const std::string& key) {
+  std::shared_ptr<const GoBinaryAnalysis>* cached = entries_.Lookup(key);
+  if (cached != nullptr) {
+    return *cached;
+  }
+
+  if (dir_.empty()) {
+    return nullptr;
+  }
+  const std::filesystem::path file_path = FilePath(key);
+  if (!fs::Exists(file_path)) {
+    return nullptr;
+  }
+  StatusOr<std::string> contents = ReadFileToString(file_path.string(), std::ios_base::binary);
+  if (!contents.ok()) {
+    return nullptr;
+  }
+  StatusOr<GoBinaryAnalysis> analysis = DeserializeGoBinaryAnalysis(contents.ValueOrDie());
+  if (!analysis.ok() || !analysis.ValueOrDie().common_symaddrs.has_value()) {
+    VLOG(1) << absl::Substitute("Discarding cached analysis $0: $1", file_path.string(),
+                                analysis.ok() ? "not a Go binary" : analysis.msg());
+    // A failure is harmless: the entry is rewritten once the binary has been analyzed again.
+    PL_UNUSED(fs::Remove(file_path));
+    return nullptr;
+  }
+  // The modification time records the last use, which is what the pruning goes by.
+  std::error_code ec;
+  std::filesystem::last_write_time(file_path, std::filesystem::file_time_type::clock::now(), ec);
+
+  auto shared_analysis = std::make_shared<const GoBinaryAnalysis>(analysis.ConsumeValueOrDie());
+  entries_.Insert(key, shared_analysis);
+  return shared_analysis;
+}
+
+std::shared_ptr<const GoBinaryAnalysis> UProbeSymAddrsCache::Insert(const std::string& key,
+                                                                    GoBinaryAnalysis analysis) {
+  if (!dir_.empty() && analysis.common_symaddrs.has_value()) {
+    Persist(key, analysis);
+  }
+
+  auto shared_analysis = std::make_shared<const GoBinaryAnalysis>(std::move(analysis));
+  entries_.Insert(key, shared_analysis);
+  return shared_analysis;
+}
+
+void UProbeSymAddrsCache::Persist(const std::string& key, const GoBinaryAnalysis& analysis) {
+  // Write to a temporary file first, so that a crash never leaves a partial entry behind.
+  const std::filesystem::path file_path = FilePath(key);
+  const std::filesystem::path tmp_path = absl::StrCat(file_path.string(), ".tmp");
+  const bool exists = fs::Exists(file_path);
+  Status s = WriteFileFromString(tmp_path.string(), SerializeGoBinaryAnalysis(analysis),
+                                 std::ios_base::out | std::ios_base::binary);
+  std::error_code ec;
+  if (s.ok()) {
+    std::filesystem::rename(tmp_path, file_path, ec);
+  }
+  if (!s.ok() || ec) {
+    LOG_FIRST_N(WARNING, 5) << absl::Substitute("Could not persist analysis to $0: $1",
+                                                file_path.string(),
+                                                s.ok() ? ec.message() : s.msg());
+    return;
+  }
+
+  if (!exists && ++num_files_ > max_files_) {
+    // Prune below the limit, so that the directory is not listed again on every insert.
+    PruneDir(max_files_ * 3 / 4);
+  }
+}
+
+void UProbeSymAddrsCache::PruneDir(size_t target_num_files) {
+  const auto now = std::filesystem::file_time_type::clock::now();
+  std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir_, ec)) {
+    std::error_code entry_ec;
+    if (!entry.is_regular_file(entry_ec)) {
+      continue;
+    }
+    auto mtime = entry.last_write_time(entry_ec);
+    // Leftovers of interrupted writes are removed too.
+    if (entry_ec || entry.path().extension() == ".tmp" || now - mtime > max_age_) {
+      std::filesystem::remove(entry.path(), entry_ec);
+      continue;
+    }
+    files.emplace_back(mtime, entry.path());
+  }
+  if (ec) {
+    LOG(WARNING) << absl::Substitute("Could not list $0: $1", dir_.string(), ec.message());
+  }
+
+  if (files.size() > target_num_files) {
+    // Keep the most recently used files.
+    std::nth_element(files.begin(), files.begin() + target_num_files, files.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (auto iter = files.begin() + target_num_files; iter != files.end(); ++iter) {
+      std::filesystem::remove(iter->second, ec);
+    }
+    files.resize(target_num_files);
+  }
+  num_files_ = files.size();
+}
+
+std::filesystem::path UProbeSymAddrsCache::FilePath(const std::string& key) const {
+  // Keys are made of hex digits, decimal numbers and the separators ':' and '.',
+  // all of which are valid in file names.
+  return dir_ / key;
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/bpf_tools/bcc_wrapper.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
+#include "src/stirling/utils/lru_cache.h"
+
+DECLARE_string(stirling_uprobe_symaddrs_cache_dir);
+DECLARE_uint32(stirling_uprobe_symaddrs_cache_size);
+DECLARE_uint32(stirling_uprobe_symaddrs_cache_max_files);
+DECLARE_uint32(stirling_uprobe_symaddrs_cache_max_age_hours);
+
+namespace px {
+namespace stirling {
+
+/**
+ * The outcome of analyzing a binary for Go uprobes: the symbol addresses that are communicated to
+ * the BPF probes through per-PID maps, and the uprobes to attach.
+ *
+ * All of this depends only on the contents of the binary, so it can be reused for every process
+ * that runs the same binary. The binary_path of the UProbeSpecs is left empty, and must be filled
+ * in before attaching.
+ */
+struct GoBinaryAnalysis {
+  // Unset if the binary is not a Go executable, or lacks the mandatory symbols (e.g. TCPConn).
+  // No other fields are populated in that case.
+  std::optional<struct go_common_symaddrs_t> common_symaddrs;
+
+  // Unset if the binary does not use the corresponding library.
+  std::optional<struct go_tls_symaddrs_t> tls_symaddrs;
+  std::optional<struct go_http2_symaddrs_t> http2_symaddrs;
+
+  std::vector<bpf_tools::UProbeSpec> tls_uprobes;
+  std::vector<bpf_tools::UProbeSpec> http2_uprobes;
+};
+
+/**
+ * Serializes an analysis into the on-disk format of UProbeSymAddrsCache.
+ * The format is only meant to be read back by the same build on the same host: the header records
+ * a hash of the sources of the analysis, so that a build with a different analysis discards it.
+ */
+std::string SerializeGoBinaryAnalysis(const GoBinaryAnalysis& analysis);
+
+/**
+ * Inverse of SerializeGoBinaryAnalysis(). Returns an error if the buffer is truncated, or was
+ * written with a different format version, analysis sources or struct layout.
+ */
+StatusOr<GoBinaryAnalysis> DeserializeGoBinaryAnalysis(std::string_view buf);
+
+/**
+ * A content-addressed cache of GoBinaryAnalysis, keyed by ElfReader::BinaryIdentity().
+ *
+ * The most recently used entries are held in memory, up to a fixed capacity. The entries of Go
+ * binaries are also written to a directory, so that the analysis survives restarts of Stirling;
+ * a miss in memory falls back to the directory before the caller has to rerun the analysis.
+ * An empty directory path disables persistence.
+ *
+ * Analyses without common_symaddrs are only held in memory: they are cheap to redo for binaries
+ * that are not Go, and may come from transient failures (e.g. unreadable debug info) that must
+ * not outlive a restart.
+ *
+ * The files that have not been used for max_age are removed when the cache is created, and the
+ * least recently used files are removed whenever there are more than max_files of them.
+ *
+ * Not thread-safe.
+ */
+class UProbeSymAddrsCache {
+ public:
+  UProbeSymAddrsCache(std::filesystem::path dir, size_t capacity, size_t max_files,
+                      std::chrono::seconds max_age);
+
+  /**
+   * Returns the analysis for the binary identified by key, or nullptr if it is not cached.
+   */
+  std::shared_ptr<const GoBinaryAnalysis> Lookup(const std::string& key);
+
+  /**
+   * Adds the analysis of the binary identified by key to the cache, and returns the cached copy.
+   */
+  std::shared_ptr<const GoBinaryAnalysis> Insert(const std::string& key,
+                                                 GoBinaryAnalysis analysis);
+
+  /**
+   * Number of entries held in memory.
+   */
+  size_t size() const { return entries_.size(); }
+
+ private:
+  void Persist(const std::string& key, const GoBinaryAnalysis& analysis);
+  // Removes the files that are expired, then the least recently used ones until at most
+  // target_num_files are left.
+  void PruneDir(size_t target_num_files);
+  std::filesystem::path FilePath(const std::string& key) const;
+
+  const std::filesystem::path dir_;
+  const size_t max_files_;
+  const std::chrono::seconds max_age_;
+
+  // Number of files in dir_, as of the last pruning plus the files written since.
+  size_t num_files_ = 0;
+
+  LRUCache<std::string, std::shared_ptr<const GoBinaryAnalysis>> entries_;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iterator>
+#include <string>
+
+#include "src/common/base/file.h"
+#include "src/common/testing/temp_dir.h"
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+namespace px {
+namespace stirling {
+
+using ::px::testing::TempDir;
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+constexpr std::chrono::hours kMaxAge{24};
+
+GoBinaryAnalysis TestAnalysis() {
+  GoBinaryAnalysis analysis;
+  analysis.common_symaddrs = go_common_symaddrs_t{};
+  analysis.common_symaddrs->FD_Sysfd_offset = 16;
+  analysis.tls_symaddrs = go_tls_symaddrs_t{};
+  analysis.tls_symaddrs->Write_c_loc = {kLocationTypeStack, 8};
+  analysis.tls_uprobes.push_back(bpf_tools::UProbeSpec{
+      .symbol = "crypto/tls.(*Conn).Write",
+      .attach_type = bpf_tools::BPFProbeAttachType::kEntry,
+      .probe_fn = "probe_entry_tls_conn_write",
+  });
+  analysis.tls_uprobes.push_back(bpf_tools::UProbeSpec{
+      .address = 0x4b1234,
+      .attach_type = bpf_tools::BPFProbeAttachType::kEntry,
+      .probe_fn = "probe_return_tls_conn_write",
+  });
+  return analysis;
+}
+
+size_t NumFiles(const std::filesystem::path& dir) {
+  auto iter = std::filesystem::directory_iterator(dir);
+  return std::distance(begin(iter), end(iter));
+}
+
+TEST(GoBinaryAnalysisTest, SerializeRoundTrip) {
+  const GoBinaryAnalysis analysis = TestAnalysis();
+
+  ASSERT_OK_AND_ASSIGN(GoBinaryAnalysis decoded,
+                       DeserializeGoBinaryAnalysis(SerializeGoBinaryAnalysis(analysis)));
+  ASSERT_TRUE(decoded.common_symaddrs.has_value());
+  EXPECT_EQ(decoded.common_symaddrs->FD_Sysfd_offset, 16);
+  ASSERT_TRUE(decoded.tls_symaddrs.has_value());
+  EXPECT_EQ(decoded.tls_symaddrs->Write_c_loc, (location_t{kLocationTypeStack, 8}));
+  EXPECT_FALSE(decoded.http2_symaddrs.has_value());
+  EXPECT_THAT(decoded.tls_uprobes,
+              ElementsAre(Field(&bpf_tools::UProbeSpec::symbol, "crypto/tls.(*Conn).Write"),
+                          Field(&bpf_tools::UProbeSpec::address, uint64_t{0x4b1234})));
+  EXPECT_EQ(decoded.tls_uprobes[1].probe_fn, "probe_return_tls_conn_write");
+  EXPECT_TRUE(decoded.http2_uprobes.empty());
+}
+
+TEST(GoBinaryAnalysisTest, RejectsTruncatedOrStaleEntries) {
+  const std::string buf = SerializeGoBinaryAnalysis(TestAnalysis());
+  EXPECT_NOT_OK(DeserializeGoBinaryAnalysis(buf.substr(0, buf.size() - 1)));
+
+  std::string stale = buf;
+  stale[3] = static_cast<char>(stale[3] + 1);
+  EXPECT_NOT_OK(DeserializeGoBinaryAnalysis(stale));
+
+  // The hash of the analysis sources follows the format version and its length.
+  std::string other_analysis = buf;
+  other_analysis[8] = static_cast<char>(other_analysis[8] + 1);
+  EXPECT_NOT_OK(DeserializeGoBinaryAnalysis(other_analysis));
+}
+
+TEST(UProbeSymAddrsCacheTest, EvictsLeastRecentlyUsed) {
+  UProbeSymAddrsCache cache(/*dir*/ "", /*capacity*/ 2, /*max_files*/ 0, kMaxAge);
+
+  cache.Insert("a", TestAnalysis());
+  cache.Insert("b", GoBinaryAnalysis{});
+  EXPECT_THAT(cache.Lookup("a"), NotNull());
+  cache.Insert("c", GoBinaryAnalysis{});
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_THAT(cache.Lookup("a"), NotNull());
+  EXPECT_THAT(cache.Lookup("b"), IsNull());
+  EXPECT_THAT(cache.Lookup("c"), NotNull());
+}
+
+TEST(UProbeSymAddrsCacheTest, PersistsAcrossInstances) {
+  TempDir cache_dir;
+
+  {
+    UProbeSymAddrsCache cache(cache_dir.path(), /*capacity*/ 1, /*max_files*/ 10, kMaxAge);
+    cache.Insert("build-id:abcd", TestAnalysis());
+    cache.Insert("inode:1:2:3:4.5", GoBinaryAnalysis{});
+    // Evicted from memory, but still on disk.
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_THAT(cache.Lookup("build-id:abcd"), NotNull());
+    // Held in memory only.
+    EXPECT_THAT(cache.Lookup("inode:1:2:3:4.5"), NotNull());
+  }
+
+  UProbeSymAddrsCache cache(cache_dir.path(), /*capacity*/ 1, /*max_files*/ 10, kMaxAge);
+  std::shared_ptr<const GoBinaryAnalysis> analysis = cache.Lookup("build-id:abcd");
+  ASSERT_THAT(analysis, NotNull());
+  ASSERT_TRUE(analysis->common_symaddrs.has_value());
+  EXPECT_EQ(analysis->common_symaddrs->FD_Sysfd_offset, 16);
+  EXPECT_EQ(analysis->tls_uprobes.size(), 2);
+
+  // Analyses without common symaddrs are not persisted.
+  EXPECT_THAT(cache.Lookup("inode:1:2:3:4.5"), IsNull());
+  EXPECT_THAT(cache.Lookup("build-id:ef01"), IsNull());
+}
+
+TEST(UProbeSymAddrsCacheTest, PrunesLeastRecentlyUsedFiles) {
+  TempDir cache_dir;
+  UProbeSymAddrsCache cache(cache_dir.path(), /*capacity*/ 1, /*max_files*/ 4, kMaxAge);
+  const auto now = std::filesystem::file_time_type::clock::now();
+  for (int i = 0; i < 4; ++i) {
+    std::string key = absl::StrCat("build-id:", i);
+    cache.Insert(key, TestAnalysis());
+    // Make the files used in order, regardless of the resolution of the file times.
+    std::filesystem::last_write_time(cache_dir.path() / key, now - std::chrono::minutes(10 - i));
+  }
+  EXPECT_EQ(NumFiles(cache_dir.path()), 4);
+
+  // Going over the limit prunes the directory down to 3 files, and keeps the most recently used.
+  ASSERT_THAT(cache.Lookup("build-id:0"), NotNull());
+  cache.Insert("build-id:4", TestAnalysis());
+  EXPECT_EQ(NumFiles(cache_dir.path()), 3);
+  EXPECT_TRUE(std::filesystem::exists(cache_dir.path() / "build-id:0"));
+  EXPECT_FALSE(std::filesystem::exists(cache_dir.path() / "build-id:1"));
+  EXPECT_FALSE(std::filesystem::exists(cache_dir.path() / "build-id:2"));
+  EXPECT_TRUE(std::filesystem::exists(cache_dir.path() / "build-id:3"));
+  EXPECT_TRUE(std::filesystem::exists(cache_dir.path() / "build-id:4"));
+}
+
+TEST(UProbeSymAddrsCacheTest, RemovesExpiredFiles) {
+  TempDir cache_dir;
+  {
+    UProbeSymAddrsCache cache(cache_dir.path(), /*capacity*/ 1, /*max_files*/ 10, kMaxAge);
+    cache.Insert("build-id:old", TestAnalysis());
+    cache.Insert("build-id:new", TestAnalysis());
+  }
+  std::filesystem::last_write_time(cache_dir.path() / "build-id:old",
+                                   std::filesystem::file_time_type::clock::now() - 2 * kMaxAge);
+  ASSERT_OK(WriteFileFromString((cache_dir.path() / "build-id:partial.tmp").string(), ""));
+
+  UProbeSymAddrsCache cache(cache_dir.path(), /*capacity*/ 1, /*max_files*/ 10, kMaxAge);
+  EXPECT_EQ(NumFiles(cache_dir.path()), 1);
+  EXPECT_THAT(cache.Lookup("build-id:old"), IsNull());
+  EXPECT_THAT(cache.Lookup("build-id:new"), NotNull());
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -203,6 +203,10 @@ class StirlingImpl final : public Stirling {
     DCHECK(f != nullptr);
     agent_metadata_callback_ = f;
   }
+  void RegisterProcessLifecycleCallback(ProcessLifecycleCallback f) override {
+    DCHECK(f != nullptr);
+    process_lifecycle_callback_ = f;
+  }
   std::unique_ptr<ConnectorContext> GetContext();
 
   void Run() override;
@@ -268,6 +272,8 @@ class StirlingImpl final : public Stirling {
   AgentMetadataCallback agent_metadata_callback_ = nullptr;
   AgentMetadataType agent_metadata_;
 
+  ProcessLifecycleCallback process_lifecycle_callback_ = nullptr;
+
   absl::base_internal::SpinLock dynamic_trace_status_map_lock_;
   absl::flat_hash_map<sole::uuid, StatusOr<stirlingpb::Publish>> dynamic_trace_status_map_
       ABSL_GUARDED_BY(dynamic_trace_status_map_lock_);
@@ -417,7 +423,8 @@ Status StirlingImpl::Init() {
 
 std::unique_ptr<ConnectorContext> StirlingImpl::GetContext() {
   if (agent_metadata_callback_ != nullptr) {
-    return std::unique_ptr<ConnectorContext>(new AgentContext(agent_metadata_callback_()));
+    return std::unique_ptr<ConnectorContext>(
+        new AgentContext(agent_metadata_callback_(), process_lifecycle_callback_));
   }
   return std::unique_ptr<ConnectorContext>(new SystemWideStandaloneContext());
 }
@@ -152,6 +152,13 @@ class Stirling : public NotCopyable {
    */
   virtual void RegisterAgentMetadataCallback(AgentMetadataCallback f) = 0;
 
+  /**
+   * Register a callback from the agent to receive process lifecycle events, which it uses to
+   * track the PIDs of the containers without rescanning their cgroups.
+   * The callback is invoked from the Stirling thread.
+   */
+  virtual void RegisterProcessLifecycleCallback(ProcessLifecycleCallback f) = 0;
+
   /**
    * Main data collection call. This version blocks, so make sure to wrap a thread around it.
    */
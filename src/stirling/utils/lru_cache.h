@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace stirling {
+
+/**
+ * LRUCache holds up to a fixed number of values, and evicts the least recently used one when a
+ * value is inserted beyond that capacity.
+ *
+ * Not thread-safe.
+ */
+template <typename TKey, typename TValue>
+class LRUCache {
+ public:
+  explicit LRUCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Returns the value of key, or nullptr if it is not cached. The returned pointer is valid until
+   * the next call to Insert().
+   */
+  TValue* Lookup(const TKey& key) {
+    auto iter = entries_.find(key);
+    if (iter == entries_.end()) {
+      return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, iter->second.lru_iter);
+    return &iter->second.value;
+  }
+
+  /**
+   * Sets the value of key, which becomes the most recently used one.
+   */
+  void Insert(const TKey& key, TValue value) {
+    auto iter = entries_.find(key);
+    if (iter != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, iter->second.lru_iter);
+      iter->second.value = std::move(value);
+      return;
+    }
+
+    lru_.push_front(key);
+    entries_.emplace(key, Entry{std::move(value), lru_.begin()});
+
+    while (entries_.size() > capacity_) {
+      entries_.erase(lru_.back());
+      lru_.pop_back();
+    }
+  }
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    TValue value;
+    typename std::list<TKey>::iterator lru_iter;
+  };
+
+  const size_t capacity_;
+
+  // Keys ordered from the most to the least recently used.
+  std::list<TKey> lru_;
+  absl::flat_hash_map<TKey, Entry> entries_;
+};
+
+}  // namespace stirling
+}  // namespace px
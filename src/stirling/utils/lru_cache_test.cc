@@ -0,0 +1,59 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/lru_cache.h"
+
+#include <string>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+TEST(LRUCacheTest, EvictsLeastRecentlyUsed) {
+  LRUCache<std::string, int> cache(2);
+  cache.Insert("a", 1);
+  cache.Insert("b", 2);
+  // Using "a" makes "b" the least recently used.
+  ASSERT_NE(cache.Lookup("a"), nullptr);
+  cache.Insert("c", 3);
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.Lookup("b"), nullptr);
+  ASSERT_NE(cache.Lookup("a"), nullptr);
+  EXPECT_EQ(*cache.Lookup("a"), 1);
+  ASSERT_NE(cache.Lookup("c"), nullptr);
+  EXPECT_EQ(*cache.Lookup("c"), 3);
+}
+
+TEST(LRUCacheTest, InsertReplacesValue) {
+  LRUCache<std::string, int> cache(2);
+  cache.Insert("a", 1);
+  cache.Insert("b", 2);
+  cache.Insert("a", 3);
+  // Replacing "a" also made it the most recently used.
+  cache.Insert("c", 4);
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.Lookup("b"), nullptr);
+  ASSERT_NE(cache.Lookup("a"), nullptr);
+  EXPECT_EQ(*cache.Lookup("a"), 3);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -28,12 +28,29 @@ namespace stirling {
 
 namespace {
 constexpr char kJavaProcCrashedDuringAttach[] = "java_proc_crashed_during_attach";
-}
+constexpr char kUProbeDeployQueueDepth[] = "uprobe_deploy_queue_depth";
+constexpr char kUProbeTimeToAttachSeconds[] = "uprobe_time_to_attach_seconds";
+}  // namespace
 
 StirlingMonitor::StirlingMonitor()
     : java_proc_crashed_during_attach_(
           BuildCounter(kJavaProcCrashedDuringAttach,
-                       "Count of Java process crashes during symbolization agent attach.")) {}
+                       "Count of Java process crashes during symbolization agent attach.")),
+      uprobe_deploy_queue_depth_(
+          prometheus::BuildGauge()
+              .Name(kUProbeDeployQueueDepth)
+              .Help("Number of binaries waiting for their uprobes to be attached.")
+              .Register(GetMetricsRegistry())
+              .Add({{"name", kUProbeDeployQueueDepth}})),
+      uprobe_time_to_attach_seconds_(
+          prometheus::BuildHistogram()
+              .Name(kUProbeTimeToAttachSeconds)
+              .Help("Time from handing a process to uprobe deployment until the uprobes of its "
+                    "binary were attached.")
+              .Register(GetMetricsRegistry())
+              .Add({{"name", kUProbeTimeToAttachSeconds}},
+                   prometheus::Histogram::BucketBoundaries{0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60,
+                                                           120})) {}
 
 void StirlingMonitor::ResetJavaProcessAttachTrackers() { java_proc_attach_times_.clear(); }
 
@@ -59,6 +76,14 @@ void StirlingMonitor::NotifyJavaProcessCrashed(const struct upid_t& upid) {
   }
 }
 
+void StirlingMonitor::NotifyUProbeDeployQueueDepth(size_t depth) {
+  uprobe_deploy_queue_depth_.Set(static_cast<double>(depth));
+}
+
+void StirlingMonitor::NotifyUProbesAttached(std::chrono::steady_clock::duration time_to_attach) {
+  uprobe_time_to_attach_seconds_.Observe(std::chrono::duration<double>(time_to_attach).count());
+}
+
 void StirlingMonitor::AppendSourceStatusRecord(const std::string& source_connector,
                                                const Status& status, const std::string& context) {
   absl::base_internal::SpinLockHolder lock(&source_status_lock_);
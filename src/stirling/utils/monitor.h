@@ -19,8 +19,11 @@
 #pragma once
 
 #include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <prometheus/histogram.h>
 
 #include <absl/container/flat_hash_map.h>
+#include <chrono>
 #include <string>
 #include <utility>
 #include <vector>
@@ -62,6 +65,12 @@ class StirlingMonitor : NotCopyMoveable {
   void NotifyJavaProcessCrashed(const struct upid_t& upid);
   void ResetJavaProcessAttachTrackers();
 
+  // UProbe deployment.
+  // Number of binaries waiting for their uprobes to be attached.
+  void NotifyUProbeDeployQueueDepth(size_t depth);
+  // Uprobes were attached to a binary, the given time after its process was handed to deployment.
+  void NotifyUProbesAttached(std::chrono::steady_clock::duration time_to_attach);
+
   // Stirling Error Reporting.
   void AppendProbeStatusRecord(const std::string& source_connector, const std::string& tracepoint,
                                const Status& status, const std::string& info);
@@ -87,6 +96,8 @@ class StirlingMonitor : NotCopyMoveable {
   absl::base_internal::SpinLock source_status_lock_;
 
   prometheus::Counter& java_proc_crashed_during_attach_;
+  prometheus::Gauge& uprobe_deploy_queue_depth_;
+  prometheus::Histogram& uprobe_time_to_attach_seconds_;
 };
 
 }  // namespace stirling
@@ -18,6 +18,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "src/common/metrics/metrics.h"
 #include "src/common/testing/testing.h"
 #include "src/stirling/testing/common.h"
 #include "src/stirling/utils/monitor.h"
@@ -66,5 +71,29 @@ TEST(MonitorTest, DoesNotDisableJavaIfNotInCrashInWindow) {
   EXPECT_TRUE(FLAGS_stirling_profiler_java_symbols);
 }
 
+TEST(MonitorTest, UProbeTimeToAttachHistogram) {
+  StirlingMonitor& monitor = *StirlingMonitor::GetInstance();
+  monitor.NotifyUProbesAttached(std::chrono::milliseconds{300});
+  monitor.NotifyUProbesAttached(std::chrono::seconds{20});
+
+  std::vector<prometheus::MetricFamily> families = GetMetricsRegistry().Collect();
+  auto iter = std::find_if(families.begin(), families.end(), [](const auto& family) {
+    return family.name == "uprobe_time_to_attach_seconds";
+  });
+  ASSERT_NE(iter, families.end());
+  ASSERT_EQ(iter->type, prometheus::MetricType::Histogram);
+  ASSERT_EQ(iter->metric.size(), 1);
+  const prometheus::ClientMetric::Histogram& histogram = iter->metric[0].histogram;
+  EXPECT_EQ(histogram.sample_count, 2);
+  EXPECT_DOUBLE_EQ(histogram.sample_sum, 20.3);
+  for (const auto& bucket : histogram.bucket) {
+    if (bucket.upper_bound == 0.5) {
+      EXPECT_EQ(bucket.cumulative_count, 1);
+    } else if (bucket.upper_bound == 30) {
+      EXPECT_EQ(bucket.cumulative_count, 2);
+    }
+  }
+}
+
 }  // namespace stirling
 }  // namespace px
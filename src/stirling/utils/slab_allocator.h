@@ -0,0 +1,192 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * SlabAllocator hands out fixed-size memory slots for objects of up to TObjSize bytes.
+ *
+ * Slots are carved out of slabs of TObjsPerSlab slots each, so that many small long-lived objects
+ * (e.g. ConnTrackers) are packed densely, instead of each paying for a separate malloc() chunk.
+ * Every slot is prefixed with a pointer to its slab, which lets Deallocate() find the slab in
+ * constant time. Slabs with free slots are kept in a list that Allocate() takes from. A slab is
+ * released as soon as all its slots are free, except for one that is kept to absorb churn.
+ *
+ * This class is thread-safe.
+ */
+template <size_t TObjSize, size_t TObjsPerSlab = 64>
+class SlabAllocator : public NotCopyMoveable {
+ private:
+  struct Slab;
+
+  struct Slot {
+    Slab* slab;
+    union {
+      // Only valid while the slot is free.
+      Slot* next_free;
+      alignas(std::max_align_t) unsigned char storage[TObjSize];
+    };
+  };
+
+  struct Slab {
+    // Links of the list of slabs with free slots.
+    Slab* prev = nullptr;
+    Slab* next = nullptr;
+
+    Slot* free_list = nullptr;
+    size_t num_used = 0;
+    Slot slots[TObjsPerSlab];
+  };
+
+ public:
+  /**
+   * The number of bytes taken by each object, including its share of the slab bookkeeping.
+   */
+  static constexpr size_t kBytesPerObj = sizeof(Slab) / TObjsPerSlab;
+
+  ~SlabAllocator() {
+    DCHECK_EQ(num_allocated_, 0U) << "Objects are still allocated from the slab allocator.";
+    delete empty_slab_;
+  }
+
+  /**
+   * Returns uninitialized memory for one object of up to TObjSize bytes.
+   */
+  void* Allocate() {
+    absl::MutexLock lock(&mu_);
+
+    if (partial_slabs_ == nullptr) {
+      Slab* slab = empty_slab_ != nullptr ? empty_slab_ : NewSlab();
+      empty_slab_ = nullptr;
+      PushPartial(slab);
+    }
+
+    Slab* slab = partial_slabs_;
+    Slot* slot = slab->free_list;
+    slab->free_list = slot->next_free;
+    ++slab->num_used;
+    if (slab->free_list == nullptr) {
+      RemovePartial(slab);
+    }
+
+    ++num_allocated_;
+    return slot->storage;
+  }
+
+  /**
+   * Returns the memory of an object previously returned by Allocate().
+   */
+  void Deallocate(void* ptr) {
+    if (ptr == nullptr) {
+      return;
+    }
+    auto* obj = static_cast<unsigned char*>(ptr);
+    Slot* slot = reinterpret_cast<Slot*>(obj - offsetof(Slot, storage));
+    Slab* slab = slot->slab;
+
+    absl::MutexLock lock(&mu_);
+
+    const bool was_full = slab->free_list == nullptr;
+    slot->next_free = slab->free_list;
+    slab->free_list = slot;
+    --slab->num_used;
+    --num_allocated_;
+
+    if (was_full) {
+      PushPartial(slab);
+    }
+
+    if (slab->num_used == 0) {
+      RemovePartial(slab);
+      if (empty_slab_ == nullptr) {
+        empty_slab_ = slab;
+      } else {
+        delete slab;
+        --num_slabs_;
+      }
+    }
+  }
+
+  size_t num_allocated() const {
+    absl::MutexLock lock(&mu_);
+    return num_allocated_;
+  }
+
+  size_t num_slabs() const {
+    absl::MutexLock lock(&mu_);
+    return num_slabs_;
+  }
+
+ private:
+  Slab* NewSlab() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto* slab = new Slab;
+    for (size_t i = 0; i < TObjsPerSlab; ++i) {
+      slab->slots[i].slab = slab;
+      slab->slots[i].next_free = i + 1 < TObjsPerSlab ? &slab->slots[i + 1] : nullptr;
+    }
+    slab->free_list = &slab->slots[0];
+    ++num_slabs_;
+    return slab;
+  }
+
+  void PushPartial(Slab* slab) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    slab->prev = nullptr;
+    slab->next = partial_slabs_;
+    if (partial_slabs_ != nullptr) {
+      partial_slabs_->prev = slab;
+    }
+    partial_slabs_ = slab;
+  }
+
+  void RemovePartial(Slab* slab) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (slab->prev != nullptr) {
+      slab->prev->next = slab->next;
+    } else {
+      partial_slabs_ = slab->next;
+    }
+    if (slab->next != nullptr) {
+      slab->next->prev = slab->prev;
+    }
+    slab->prev = nullptr;
+    slab->next = nullptr;
+  }
+
+  mutable absl::Mutex mu_;
+
+  // The head of the list of slabs that have both used and free slots.
+  Slab* partial_slabs_ ABSL_GUARDED_BY(mu_) = nullptr;
+
+  // A slab with no used slots, kept so that an alternating allocation and deallocation at a slab
+  // boundary does not allocate and free a slab every time.
+  Slab* empty_slab_ ABSL_GUARDED_BY(mu_) = nullptr;
+
+  size_t num_allocated_ ABSL_GUARDED_BY(mu_) = 0;
+  size_t num_slabs_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <absl/container/flat_hash_set.h>
+
+#include "src/common/testing/testing.h"
+
+#include "src/stirling/utils/slab_allocator.h"
+
+namespace px {
+namespace stirling {
+
+constexpr size_t kObjSize = 40;
+constexpr size_t kObjsPerSlab = 4;
+
+using TestSlabAllocator = SlabAllocator<kObjSize, kObjsPerSlab>;
+
+TEST(SlabAllocatorTest, AllocatesDistinctSlots) {
+  TestSlabAllocator allocator;
+
+  std::vector<void*> ptrs;
+  absl::flat_hash_set<void*> unique_ptrs;
+  for (size_t i = 0; i < 3 * kObjsPerSlab; ++i) {
+    void* ptr = allocator.Allocate();
+    // Writing the whole object must not corrupt the other slots.
+    std::memset(ptr, i, kObjSize);
+    ptrs.push_back(ptr);
+    unique_ptrs.insert(ptr);
+  }
+  EXPECT_EQ(unique_ptrs.size(), ptrs.size());
+  EXPECT_EQ(allocator.num_allocated(), 3 * kObjsPerSlab);
+  EXPECT_EQ(allocator.num_slabs(), 3);
+
+  for (size_t i = 0; i < ptrs.size(); ++i) {
+    EXPECT_EQ(*static_cast<unsigned char*>(ptrs[i]), i);
+    allocator.Deallocate(ptrs[i]);
+  }
+  EXPECT_EQ(allocator.num_allocated(), 0);
+  // One empty slab is kept.
+  EXPECT_EQ(allocator.num_slabs(), 1);
+}
+
+TEST(SlabAllocatorTest, ReusesFreedSlots) {
+  TestSlabAllocator allocator;
+
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < kObjsPerSlab; ++i) {
+    ptrs.push_back(allocator.Allocate());
+  }
+  EXPECT_EQ(allocator.num_slabs(), 1);
+
+  allocator.Deallocate(ptrs[1]);
+  EXPECT_EQ(allocator.Allocate(), ptrs[1]);
+  EXPECT_EQ(allocator.num_slabs(), 1);
+
+  for (void* ptr : ptrs) {
+    allocator.Deallocate(ptr);
+  }
+}
+
+TEST(SlabAllocatorTest, ReleasesEmptySlabs) {
+  TestSlabAllocator allocator;
+
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < 4 * kObjsPerSlab; ++i) {
+    ptrs.push_back(allocator.Allocate());
+  }
+  EXPECT_EQ(allocator.num_slabs(), 4);
+
+  // Free every other object; no slab becomes empty.
+  for (size_t i = 0; i < ptrs.size(); i += 2) {
+    allocator.Deallocate(ptrs[i]);
+  }
+  EXPECT_EQ(allocator.num_slabs(), 4);
+
+  // Free the rest; all but one of the slabs are released.
+  for (size_t i = 1; i < ptrs.size(); i += 2) {
+    allocator.Deallocate(ptrs[i]);
+  }
+  EXPECT_EQ(allocator.num_slabs(), 1);
+  EXPECT_EQ(allocator.num_allocated(), 0);
+}
+
+TEST(SlabAllocatorTest, ConcurrentAllocations) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumIters = 1000;
+
+  TestSlabAllocator allocator;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&allocator, t]() {
+      std::vector<void*> ptrs;
+      for (int i = 0; i < kNumIters; ++i) {
+        void* ptr = allocator.Allocate();
+        std::memset(ptr, t, kObjSize);
+        ptrs.push_back(ptr);
+        if (i % 3 == 0) {
+          allocator.Deallocate(ptrs.front());
+          ptrs.erase(ptrs.begin());
+        }
+      }
+      for (void* ptr : ptrs) {
+        // Any slot handed to another thread would have been overwritten.
+        ASSERT_EQ(*static_cast<unsigned char*>(ptr), t);
+        allocator.Deallocate(ptr);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(allocator.num_allocated(), 0);
+  EXPECT_EQ(allocator.num_slabs(), 1);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -18,9 +18,9 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <string>
-#include <vector>
 
 #include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
@@ -33,14 +33,14 @@ namespace utils {
 
 /**
  * Maintains a very simple mapping from enum keys and integer counters.
- * Internally it uses a vector instead of a map for faster access.
+ * Internally it uses an array instead of a map for faster access, and to avoid any allocation.
  * So the enum values of the key type cannot have custom values.
  */
 template <typename TKeyType>
 class StatCounter {
  public:
-  void Increment(TKeyType key, int count = 1) { counts_[static_cast<int>(key)] += count; }
-  void Decrement(TKeyType key, int count = 1) { counts_[static_cast<int>(key)] -= count; }
+  void Increment(TKeyType key, int64_t count = 1) { counts_[static_cast<int>(key)] += count; }
+  void Decrement(TKeyType key, int64_t count = 1) { counts_[static_cast<int>(key)] -= count; }
   void Reset(TKeyType key) { counts_[static_cast<int>(key)] = 0; }
   int64_t Get(TKeyType key) const { return counts_[static_cast<int>(key)]; }
   std::string Print() const {
@@ -52,7 +52,7 @@ class StatCounter {
   }
 
  private:
-  std::vector<int64_t> counts_ = std::vector<int64_t>(magic_enum::enum_count<TKeyType>(), 0);
+  std::array<int64_t, magic_enum::enum_count<TKeyType>()> counts_ = {};
 };
 
 }  // namespace utils
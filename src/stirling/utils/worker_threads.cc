@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/worker_threads.h"
+
+namespace px {
+namespace stirling {
+
+WorkerThreads::WorkerThreads(size_t num_shards) {
+  for (size_t shard = 1; shard < num_shards; ++shard) {
+    threads_.emplace_back(&WorkerThreads::RunShard, this, shard);
+  }
+}
+
+WorkerThreads::~WorkerThreads() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+    work_cv_.SignalAll();
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerThreads::Run(const std::function<void(size_t shard)>& fn) {
+  {
+    absl::MutexLock lock(&mu_);
+    fn_ = &fn;
+    num_running_ = threads_.size();
+    ++generation_;
+    work_cv_.SignalAll();
+  }
+  fn(0);
+  absl::MutexLock lock(&mu_);
+  while (num_running_ > 0) {
+    done_cv_.Wait(&mu_);
+  }
+  fn_ = nullptr;
+}
+
+void WorkerThreads::RunShard(size_t shard) {
+  uint64_t generation = 0;
+  while (true) {
+    const std::function<void(size_t)>* fn = nullptr;
+    {
+      absl::MutexLock lock(&mu_);
+      while (!stopping_ && generation_ == generation) {
+        work_cv_.Wait(&mu_);
+      }
+      if (stopping_) {
+        return;
+      }
+      generation = generation_;
+      fn = fn_;
+    }
+    (*fn)(shard);
+    absl::MutexLock lock(&mu_);
+    if (--num_running_ == 0) {
+      done_cv_.Signal();
+    }
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
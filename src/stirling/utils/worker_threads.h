@@ -0,0 +1,67 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * WorkerThreads runs a function on a fixed number of shards in parallel, on threads that persist
+ * across calls, so that a connector does not create threads on every sampling.
+ *
+ * Shard 0 is run by the calling thread, and each of the other shards by a thread of its own.
+ * Run() must not be called concurrently.
+ */
+class WorkerThreads : public NotCopyMoveable {
+ public:
+  explicit WorkerThreads(size_t num_shards);
+  ~WorkerThreads();
+
+  size_t num_shards() const { return threads_.size() + 1; }
+
+  /**
+   * Runs fn for all the shards, and returns once they are all done.
+   */
+  void Run(const std::function<void(size_t shard)>& fn);
+
+ private:
+  void RunShard(size_t shard);
+
+  std::vector<std::thread> threads_;
+
+  absl::Mutex mu_;
+  absl::CondVar work_cv_;
+  absl::CondVar done_cv_;
+  // Incremented for every call to Run(), which the threads wait for.
+  uint64_t generation_ ABSL_GUARDED_BY(mu_) = 0;
+  const std::function<void(size_t)>* fn_ ABSL_GUARDED_BY(mu_) = nullptr;
+  size_t num_running_ ABSL_GUARDED_BY(mu_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace stirling
+}  // namespace px
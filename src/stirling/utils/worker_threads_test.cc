@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/worker_threads.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::Each;
+
+TEST(WorkerThreadsTest, RunsEveryShardOncePerRun) {
+  constexpr size_t kNumShards = 4;
+  WorkerThreads threads(kNumShards);
+  EXPECT_EQ(threads.num_shards(), kNumShards);
+
+  std::vector<int> runs(kNumShards, 0);
+  std::vector<std::thread::id> thread_ids(kNumShards);
+  for (int i = 0; i < 100; ++i) {
+    threads.Run([&](size_t shard) {
+      ++runs[shard];
+      thread_ids[shard] = std::this_thread::get_id();
+    });
+  }
+  EXPECT_THAT(runs, Each(100));
+
+  // Shard 0 runs on the calling thread, the others on threads of their own.
+  EXPECT_EQ(thread_ids[0], std::this_thread::get_id());
+  for (size_t i = 1; i < kNumShards; ++i) {
+    EXPECT_NE(thread_ids[i], std::this_thread::get_id());
+  }
+}
+
+TEST(WorkerThreadsTest, SingleShardRunsOnCallingThread) {
+  WorkerThreads threads(1);
+  std::thread::id thread_id;
+  threads.Run([&](size_t shard) {
+    EXPECT_EQ(shard, 0);
+    thread_id = std::this_thread::get_id();
+  });
+  EXPECT_EQ(thread_id, std::this_thread::get_id());
+}
+
+TEST(WorkerThreadsTest, ShardsRunConcurrently) {
+  constexpr size_t kNumShards = 3;
+  WorkerThreads threads(kNumShards);
+
+  // Each shard waits for all of them to start, which only finishes if they run concurrently.
+  std::atomic<size_t> num_started = 0;
+  threads.Run([&](size_t) {
+    ++num_started;
+    while (num_started < kNumShards) {
+      std::this_thread::yield();
+    }
+  });
+  EXPECT_EQ(num_started, kNumShards);
+}
+
+}  // namespace stirling
+}  // namespace px
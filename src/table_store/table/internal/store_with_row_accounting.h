@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <optional>
@@ -62,7 +63,10 @@ void constexpr_else_static_assert_false() {
  * batch methods.
  *
  * Times are used to find row batch's within a given time
- * range. RowIDs are used in case table compaction occurs during query execution. Since the size of
+ * range. Cold batches are large, so they additionally keep a sparse index of the time of every
+ * kTimeIndexStride-th row. A search within a cold batch only touches the index and one stride of
+ * the time column, instead of binary searching the whole column.
+ * RowIDs are used in case table compaction occurs during query execution. Since the size of
  * the batches changes when they are compacted from the hot store to the cold store, the unique
  * RowIDs are necessary to ensure that the query doesn't receive duplicate rows if the rows have
  * the same timestamp.
@@ -72,6 +76,8 @@ class StoreWithRowTimeAccounting {
   using TBatch = typename StoreTypeTraits<TStoreType>::batch_type;
 
  public:
+  static constexpr size_t kTimeIndexStride = 128;
+
   StoreWithRowTimeAccounting(const schema::Relation& rel, int64_t time_col_idx)
       : rel_(rel), time_col_idx_(time_col_idx) {}
 
@@ -164,6 +170,7 @@ class StoreWithRowTimeAccounting {
 
     row_ids_.pop_front();
     if (time_col_idx_ != -1) times_.pop_front();
+    if (!time_indexes_.empty()) time_indexes_.pop_front();
 
     auto&& front = std::move(batches_.front());
     batches_.pop_front();
@@ -185,6 +192,9 @@ class StoreWithRowTimeAccounting {
       auto first_time = GetTimeValue(batch, 0);
       auto last_time = GetTimeValue(batch, BatchLength(batch) - 1);
       times_.emplace_back(first_time, last_time);
+      if constexpr (std::is_same_v<TBatch, ColdBatch>) {
+        time_indexes_.push_back(BuildTimeIndex(batch));
+      }
     }
     return batch;
   }
@@ -224,7 +234,7 @@ class StoreWithRowTimeAccounting {
       return std::nullopt;
     }
     size_t batch_index = std::distance(times_.begin(), it);
-    auto row_offset = FindTimeFirstGreaterThanOrEqual(batches_[batch_index], time);
+    auto row_offset = FindTimeFirstGreaterThanOrEqual(batch_index, time);
     return row_ids_[batch_index].first + row_offset;
   }
 
@@ -245,7 +255,7 @@ class StoreWithRowTimeAccounting {
       return std::nullopt;
     }
     size_t batch_index = std::distance(times_.begin(), it);
-    auto row_offset = FindTimeFirstGreaterThan(batches_[batch_index], time);
+    auto row_offset = FindTimeFirstGreaterThan(batch_index, time);
     return row_ids_[batch_index].first + row_offset;
   }
 
@@ -350,10 +360,15 @@ class StoreWithRowTimeAccounting {
     }
   }
 
-  size_t FindTimeFirstGreaterThanOrEqual(const TBatch& batch, Time time) const {
+  size_t FindTimeFirstGreaterThanOrEqual(size_t batch_index, Time time) const {
+    const auto& batch = batches_[batch_index];
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
-          batch[time_col_idx_].get(), time);
+      const auto& index = time_indexes_[batch_index];
+      auto k = std::distance(index.begin(), std::lower_bound(index.begin(), index.end(), time));
+      return SearchColdBatchTimes(batch, k, index.size(),
+                                  [time](const Time* begin, const Time* end) {
+                                    return std::lower_bound(begin, end, time);
+                                  });
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThanOrEqual(time_col_idx_, time);
     } else {
@@ -361,11 +376,15 @@ class StoreWithRowTimeAccounting {
     }
   }
 
-  size_t FindTimeFirstGreaterThan(const TBatch& batch, Time time) const {
+  size_t FindTimeFirstGreaterThan(size_t batch_index, Time time) const {
+    const auto& batch = batches_[batch_index];
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(
-                 batch[time_col_idx_].get(), time) +
-             1;
+      const auto& index = time_indexes_[batch_index];
+      auto k = std::distance(index.begin(), std::upper_bound(index.begin(), index.end(), time));
+      return SearchColdBatchTimes(batch, k, index.size(),
+                                  [time](const Time* begin, const Time* end) {
+                                    return std::upper_bound(begin, end, time);
+                                  });
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThan(time_col_idx_, time);
     } else {
@@ -373,6 +392,34 @@ class StoreWithRowTimeAccounting {
     }
   }
 
+  const Time* ColdBatchTimes(const ColdBatch& batch) const {
+    using ArrowArrayType = types::DataTypeTraits<types::DataType::TIME64NS>::arrow_array_type;
+    return static_cast<const ArrowArrayType*>(batch[time_col_idx_].get())->raw_values();
+  }
+
+  std::vector<Time> BuildTimeIndex(const ColdBatch& batch) const {
+    const Time* times = ColdBatchTimes(batch);
+    size_t length = BatchLength(batch);
+    std::vector<Time> index;
+    index.reserve((length + kTimeIndexStride - 1) / kTimeIndexStride);
+    for (size_t i = 0; i < length; i += kTimeIndexStride) {
+      index.push_back(times[i]);
+    }
+    return index;
+  }
+
+  // Searches the time column of a cold batch, given the position k of the searched time within
+  // the sparse index of the batch. The row is after the (k-1)-th indexed row, and at or before the
+  // k-th one, so only the rows between them are searched.
+  template <typename TSearchFn>
+  size_t SearchColdBatchTimes(const ColdBatch& batch, size_t k, size_t index_size,
+                              TSearchFn search_fn) const {
+    const Time* times = ColdBatchTimes(batch);
+    size_t begin = k == 0 ? 0 : (k - 1) * kTimeIndexStride;
+    size_t end = k == index_size ? BatchLength(batch) : k * kTimeIndexStride + 1;
+    return std::distance(times, search_fn(times + begin, times + end));
+  }
+
   Time GetTimeValue(const TBatch& batch, int64_t row_idx) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       return types::GetValueFromArrowArray<types::DataType::TIME64NS>(batch[time_col_idx_].get(),
@@ -406,6 +453,8 @@ class StoreWithRowTimeAccounting {
   std::deque<TBatch> batches_;
   std::deque<RowIDInterval> row_ids_;
   std::deque<TimeInterval> times_;
+  // The sparse time indexes of the batches, only for the Cold store.
+  std::deque<std::vector<Time>> time_indexes_;
 };
 
 }  // namespace internal
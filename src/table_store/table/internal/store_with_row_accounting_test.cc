@@ -124,6 +124,33 @@ TEST_F(ColdStoreTest, PushRowBatchesCheckProperties) {
   EXPECT_EQ(4, optional_row_id.value());
 }
 
+TEST_F(ColdStoreTest, FindRowIDInLargeBatch) {
+  // Each time is repeated 3 times, so that some runs of equal times span the strides of the time
+  // index.
+  constexpr int64_t kNumRows = 1000;
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::BoolValue> bools;
+  std::vector<types::StringValue> strings;
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    times.push_back(i / 3);
+    bools.push_back(true);
+    strings.push_back("a");
+  }
+  auto rb = MakeRowBatch(times, bools, strings);
+  store_->EmplaceBack(10, rb.columns());
+
+  EXPECT_EQ(10, store_->FindRowIDFromTimeFirstGreaterThanOrEqual(-1).value());
+  EXPECT_EQ(10, store_->FindRowIDFromTimeFirstGreaterThan(-1).value());
+  int64_t max_time = (kNumRows - 1) / 3;
+  for (int64_t t = 0; t < max_time; ++t) {
+    EXPECT_EQ(10 + 3 * t, store_->FindRowIDFromTimeFirstGreaterThanOrEqual(t).value());
+    EXPECT_EQ(10 + 3 * (t + 1), store_->FindRowIDFromTimeFirstGreaterThan(t).value());
+  }
+  EXPECT_EQ(10 + kNumRows - 1, store_->FindRowIDFromTimeFirstGreaterThanOrEqual(max_time).value());
+  EXPECT_FALSE(store_->FindRowIDFromTimeFirstGreaterThan(max_time).has_value());
+  EXPECT_FALSE(store_->FindRowIDFromTimeFirstGreaterThanOrEqual(max_time + 1).has_value());
+}
+
 TEST_P(HotStoreTest, PushRowBatchesCheckProperties) {
   std::vector<types::Time64NSValue> times = {1, 1, 10, 11};
   std::vector<types::BoolValue> bools = {true, false, true, false};
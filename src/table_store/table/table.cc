@@ -77,11 +77,14 @@ void Table::Cursor::UpdateStopStateForStopAtTime() {
     // to update it anymore.
     return;
   }
-  if (stop_.spec.stop_time < table_->MaxTime()) {
+  // The RowID is loaded before the time, so that if the time is not past the stop time, neither
+  // are any of the rows up to the RowID.
+  RowID last_row_id = table_->last_written_row_id_.load(std::memory_order_acquire);
+  if (stop_.spec.stop_time < table_->max_written_time_.load(std::memory_order_acquire)) {
     stop_.stop_row_id = table_->FindRowIDFromTimeFirstGreaterThan(stop_.spec.stop_time);
     stop_.stop_row_id_final = true;
   } else {
-    stop_.stop_row_id = table_->LastRowID() + 1;
+    stop_.stop_row_id = last_row_id + 1;
   }
 }
 
@@ -117,10 +120,11 @@ bool Table::Cursor::NextBatchReady() {
       return !Done();
     }
     case StopSpec::StopType::Infinite: {
-      return last_read_row_id_ < table_->LastRowID();
+      return last_read_row_id_ < table_->last_written_row_id_.load(std::memory_order_acquire);
     }
     case StopSpec::StopType::StopAtTime: {
-      return !Done() && last_read_row_id_ < table_->LastRowID();
+      return !Done() &&
+             last_read_row_id_ < table_->last_written_row_id_.load(std::memory_order_acquire);
     }
   }
   // This return is not necessary but GCC complains without it.
@@ -306,6 +310,10 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
     batch_size_accountant_->NewHotBatch(std::move(batch_stats));
     hot_store_->EmplaceBack(next_row_id_, std::move(record_or_row_batch));
     next_row_id_ += batch_length;
+    max_written_time_.store(std::max(max_written_time_.load(std::memory_order_relaxed),
+                                     hot_store_->MaxTime()),
+                            std::memory_order_release);
+    last_written_row_id_.store(next_row_id_ - 1, std::memory_order_release);
   }
 
   {
@@ -345,18 +353,6 @@ Table::RowID Table::LastRowID() const {
   return -1;
 }
 
-Table::Time Table::MaxTime() const {
-  absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
-  absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-  if (hot_store_->Size() > 0) {
-    return hot_store_->MaxTime();
-  }
-  if (cold_store_->Size() > 0) {
-    return cold_store_->MaxTime();
-  }
-  return -1;
-}
-
 Table::RowID Table::FindRowIDFromTimeFirstGreaterThanOrEqual(Time time) const {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   auto optional_row_id = cold_store_->FindRowIDFromTimeFirstGreaterThanOrEqual(time);
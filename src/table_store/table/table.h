@@ -22,6 +22,7 @@
 #include <arrow/array.h>
 #include <arrow/record_batch.h>
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <optional>
@@ -153,8 +154,8 @@ class Table : public NotCopyable {
         // Iterating a StopAtTime cursor will return all records with `timestamp <= stop_time`.
         // The cursor will not be considered `Done()` until a record with `timestamp > stop_time` is
         // added to the table.
-        // Note that StopAtTime is the most expensive of the StopTypes because it requires holding a
-        // table lock very briefly on each call to `Done()` or `NextBatchReady()`
+        // `Done()` and `NextBatchReady()` check the end of the table without locking it, until a
+        // record with `timestamp > stop_time` is added, which takes the table lock once.
         StopAtTime,
         // Iterating a StopAtTimeOrEndOfTable cursor will return all records with `timestamp <=
         // stop_time` that existed in the table at the time of cursor creation. The cursor will be
@@ -327,6 +328,13 @@ class Table : public NotCopyable {
   int64_t next_row_id_ ABSL_GUARDED_BY(hot_lock_) = 0;
   int64_t time_col_idx_ = -1;
 
+  // The RowID and time of the last row written to the table. They are written under hot_lock_, but
+  // read without locks by cursors that poll for new rows, so that the polling does not contend
+  // with writers. The time is stored before the RowID, so a reader that loads the RowID first
+  // sees a time at least as large as that of the row.
+  std::atomic<RowID> last_written_row_id_{-1};
+  std::atomic<Time> max_written_time_{-1};
+
   Status WriteHot(internal::RecordOrRowBatch&& record_or_row_batch);
 
   Status ExpireBatch();
@@ -337,8 +345,6 @@ class Table : public NotCopyable {
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_) ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
   Status UpdateTableMetricGauges();
 
-  Time MaxTime() const;
-
   std::unique_ptr<internal::BatchSizeAccountant> batch_size_accountant_ ABSL_GUARDED_BY(hot_lock_);
 
   internal::ArrowArrayCompactor compactor_;
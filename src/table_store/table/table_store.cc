@@ -74,6 +74,15 @@ table_store::Table* TableStore::GetTable(const std::string& table_name,
   return name_to_table_iter->second.get();
 }
 
+std::shared_ptr<table_store::Table> TableStore::GetSharedTable(
+    const std::string& table_name, const types::TabletID& tablet_id) const {
+  auto name_to_table_iter = name_to_table_map_.find(NameTablet{table_name, tablet_id});
+  if (name_to_table_iter == name_to_table_map_.end()) {
+    return nullptr;
+  }
+  return name_to_table_iter->second;
+}
+
 table_store::Table* TableStore::GetTable(uint64_t table_id,
                                          const types::TabletID& tablet_id) const {
   auto id_to_table_iter = id_to_table_map_.find(TableIDTablet{table_id, tablet_id});
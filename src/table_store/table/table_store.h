@@ -97,6 +97,16 @@ class TableStore {
   table_store::Table* GetTable(const std::string& table_name,
                                const types::TabletID& tablet_id = kDefaultTablet) const;
 
+  /**
+   * Like GetTable(), but shares the ownership of the table, so that a writer keeps its table
+   * alive if the table is replaced in the table store.
+   *
+   * @ param table_name the name of the table to get
+   * @ returns the associated table, or nullptr if there is none
+   */
+  std::shared_ptr<table_store::Table> GetSharedTable(
+      const std::string& table_name, const types::TabletID& tablet_id = kDefaultTablet) const;
+
   /**
    * @brief Get the Table according to table_id.
    *
@@ -94,6 +94,22 @@ TEST_F(TableStoreTest, get_table_ids) {
   EXPECT_THAT(table_store.GetTableIDs(), ::testing::UnorderedElementsAre(1, 20));
 }
 
+TEST_F(TableStoreTest, get_shared_table) {
+  auto table_store = TableStore();
+  table_store.AddTable(table1, "a");
+
+  std::shared_ptr<Table> shared = table_store.GetSharedTable("a");
+  EXPECT_EQ(table1, shared);
+  EXPECT_EQ(table_store.GetTable("a"), shared.get());
+  EXPECT_EQ(nullptr, table_store.GetSharedTable("b"));
+
+  // Replacing the table in the store leaves the shared table usable.
+  table_store.AddTable(Table::Create("test_table3", rel1), "a");
+  table1.reset();
+  EXPECT_NE(table_store.GetTable("a"), shared.get());
+  EXPECT_EQ(rel1, shared->GetRelation());
+}
+
 TEST_F(TableStoreTest, table_id_aliasing) {
   auto table_store = TableStore();
 
@@ -38,20 +38,24 @@ using ::px::event::AsyncTask;
 class ExecuteQueryMessageHandler::ExecuteQueryTask : public AsyncTask {
  public:
   ExecuteQueryTask(ExecuteQueryMessageHandler* h, carnot::Carnot* carnot,
-                   std::unique_ptr<messages::VizierMessage> msg)
+                   QueryScheduler* query_scheduler, std::unique_ptr<messages::VizierMessage> msg,
+                   carnot::exec::YieldFunc yield_func)
       : parent_(h),
         carnot_(carnot),
+        query_scheduler_(query_scheduler),
         msg_(std::move(msg)),
         req_(msg_->execute_query_request()),
-        query_id_(ParseUUID(req_.query_id()).ConsumeValueOrDie()) {}
+        query_id_(ParseUUID(req_.query_id()).ConsumeValueOrDie()),
+        yield_func_(std::move(yield_func)) {}
 
   sole::uuid query_id() { return query_id_; }
 
   void Work() override {
+    query_scheduler_->MarkStarted(query_id_);
     LOG(INFO) << absl::Substitute("Executing query: id=$0", query_id_.str());
     VLOG(1) << absl::Substitute("Query Plan: $0=$1", query_id_.str(), req_.plan().DebugString());
 
-    auto s = carnot_->ExecutePlan(req_.plan(), query_id_, req_.analyze());
+    auto s = carnot_->ExecutePlan(req_.plan(), query_id_, req_.analyze(), yield_func_);
     if (!s.ok()) {
       if (s.code() == px::statuspb::Code::CANCELLED) {
         LOG(WARNING) << absl::Substitute("Cancelled query: $0", query_id_.str());
@@ -69,18 +73,22 @@ class ExecuteQueryMessageHandler::ExecuteQueryTask : public AsyncTask {
  private:
   ExecuteQueryMessageHandler* parent_;
   carnot::Carnot* carnot_;
+  QueryScheduler* query_scheduler_;
 
   std::unique_ptr<messages::VizierMessage> msg_;
   const messages::ExecuteQueryRequest& req_;
   sole::uuid query_id_;
+  carnot::exec::YieldFunc yield_func_;
 };
 
 ExecuteQueryMessageHandler::ExecuteQueryMessageHandler(px::event::Dispatcher* dispatcher,
                                                        Info* agent_info,
                                                        Manager::VizierNATSConnector* nats_conn,
-                                                       carnot::Carnot* carnot)
+                                                       carnot::Carnot* carnot,
+                                                       QueryScheduler* query_scheduler)
     : MessageHandler(dispatcher, agent_info, nats_conn),
       carnot_(carnot),
+      query_scheduler_(query_scheduler),
       num_queries_in_flight_(prometheus::BuildGauge()
                                  .Name("num_queries_in_flight")
                                  .Help("The number of queries currently running.")
@@ -88,22 +96,35 @@ ExecuteQueryMessageHandler::ExecuteQueryMessageHandler(px::event::Dispatcher* di
                                  .Add({})) {}
 
 Status ExecuteQueryMessageHandler::HandleMessage(std::unique_ptr<messages::VizierMessage> msg) {
-  // Create a task and run it on the threadpool.
-  auto task = std::make_unique<ExecuteQueryTask>(this, carnot_, std::move(msg));
+  // Create a task, and run it on the threadpool when the scheduler admits it.
+  const auto& plan = msg->execute_query_request().plan();
+  auto query_class = QueryScheduler::ClassifyPlan(plan);
+  // The agent running the rest of the query drops the results of this one if it does not start
+  // in time, so it is never queued.
+  bool bypass_limit = QueryScheduler::FeedsRemoteAgent(plan);
+  auto task = std::make_unique<ExecuteQueryTask>(this, carnot_, query_scheduler_, std::move(msg),
+                                                 query_scheduler_->CreateYieldFunc(query_class));
 
   auto query_id = task->query_id();
   auto runnable = dispatcher()->CreateAsyncTask(std::move(task));
   auto runnable_ptr = runnable.get();
-  LOG(INFO) << "Queries in flight: " << running_queries_.size();
-  num_queries_in_flight_.Set(running_queries_.size());
+  LOG(INFO) << "Queries in flight, including queued: " << running_queries_.size() + 1;
   running_queries_[query_id] = std::move(runnable);
-  runnable_ptr->Run();
+  query_scheduler_->Submit(
+      query_id, query_class,
+      [this, runnable_ptr]() {
+        num_queries_in_flight_.Increment();
+        runnable_ptr->Run();
+      },
+      bypass_limit);
 
   return Status::OK();
 }
 
 void ExecuteQueryMessageHandler::HandleQueryExecutionComplete(sole::uuid query_id) {
   // Upon completion of the query, we makr the runnable task for deletion.
+  num_queries_in_flight_.Decrement();
+  query_scheduler_->Finish(query_id);
   auto node = running_queries_.extract(query_id);
   if (node.empty()) {
     LOG(ERROR) << "Attempting to delete non-existent query: " << query_id.str();
@@ -24,6 +24,7 @@
 #include <prometheus/registry.h>
 #include "src/carnot/plan/plan.h"
 #include "src/vizier/services/agent/manager/manager.h"
+#include "src/vizier/services/agent/manager/query_scheduler.h"
 
 namespace px {
 namespace vizier {
@@ -35,12 +36,14 @@ namespace agent {
  * otherwise only query execution is performed.
  *
  * This class runs all of it's work on a thread pool and tracks pending queries internally.
+ * The queries are started by the query scheduler, according to their class.
  */
 class ExecuteQueryMessageHandler : public Manager::MessageHandler {
  public:
   ExecuteQueryMessageHandler() = delete;
   ExecuteQueryMessageHandler(px::event::Dispatcher* dispatcher, Info* agent_info,
-                             Manager::VizierNATSConnector* nats_conn, carnot::Carnot* carnot);
+                             Manager::VizierNATSConnector* nats_conn, carnot::Carnot* carnot,
+                             QueryScheduler* query_scheduler);
   ~ExecuteQueryMessageHandler() override = default;
 
   Status HandleMessage(std::unique_ptr<messages::VizierMessage> msg) override;
@@ -57,7 +60,8 @@ class ExecuteQueryMessageHandler : public Manager::MessageHandler {
   class ExecuteQueryTask;
 
   carnot::Carnot* carnot_;
-  // Map from query_id -> Running query task.
+  QueryScheduler* query_scheduler_;
+  // Map from query_id -> Query task, queued or running.
   absl::flat_hash_map<sole::uuid, px::event::RunnableAsyncTaskUPtr> running_queries_;
 
   prometheus::Gauge& num_queries_in_flight_;
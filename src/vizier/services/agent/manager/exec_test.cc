@@ -0,0 +1,196 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+
+#include "src/common/event/api_impl.h"
+#include "src/common/event/libuv.h"
+#include "src/common/testing/event/simulated_time_system.h"
+#include "src/common/testing/testing.h"
+#include "src/common/uuid/uuid_utils.h"
+#include "src/vizier/services/agent/manager/exec.h"
+#include "src/vizier/services/agent/manager/query_scheduler.h"
+#include "src/vizier/services/agent/manager/test_utils.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+class ExecuteQueryMessageHandlerTest : public ::testing::Test {
+ protected:
+  void TearDown() override { dispatcher_->Exit(); }
+
+  ExecuteQueryMessageHandlerTest()
+      : carnot_([this](const planpb::Plan& plan, const sole::uuid& query_id,
+                       carnot::exec::YieldFunc yield_func) {
+          ExecutePlan(plan, query_id, std::move(yield_func));
+        }) {
+    start_monotonic_time_ = std::chrono::steady_clock::now();
+    start_system_time_ = std::chrono::system_clock::now();
+    time_system_ =
+        std::make_unique<event::SimulatedTimeSystem>(start_monotonic_time_, start_system_time_);
+    api_ = std::make_unique<px::event::APIImpl>(time_system_.get());
+    dispatcher_ = api_->AllocateDispatcher("manager");
+    nats_conn_ = std::make_unique<FakeNATSConnector<px::vizier::messages::VizierMessage>>();
+
+    QueryScheduler::Config config;
+    config.max_running = {1, 1, 1};
+    config.time_slice = std::chrono::milliseconds(0);
+    config.max_pause = std::chrono::milliseconds(0);
+    query_scheduler_ = std::make_unique<QueryScheduler>(config);
+
+    handler_ = std::make_unique<ExecuteQueryMessageHandler>(
+        dispatcher_.get(), &agent_info_, nats_conn_.get(), &carnot_, query_scheduler_.get());
+  }
+
+  struct Execution {
+    sole::uuid query_id;
+    bool has_yield_func;
+    // The number of running queries of the class of the query, when it was executed.
+    int num_running;
+  };
+
+  void ExecutePlan(const planpb::Plan& plan, const sole::uuid& query_id,
+                   carnot::exec::YieldFunc yield_func) {
+    if (query_id == blocked_query_id_) {
+      unblock_.WaitForNotification();
+    }
+    auto query_class = QueryScheduler::ClassifyPlan(plan);
+    absl::MutexLock lock(&mu_);
+    executions_.push_back(
+        Execution{query_id, yield_func != nullptr, query_scheduler_->num_running(query_class)});
+  }
+
+  std::unique_ptr<messages::VizierMessage> ExecuteQueryMsg(const sole::uuid& query_id,
+                                                           planpb::OperatorType sink_type,
+                                                           bool feeds_remote_agent = false) {
+    auto msg = std::make_unique<messages::VizierMessage>();
+    auto* req = msg->mutable_execute_query_request();
+    ToProto(query_id, req->mutable_query_id());
+    auto* fragment = req->mutable_plan()->add_nodes();
+    fragment->add_nodes()->mutable_op()->set_op_type(planpb::MEMORY_SOURCE_OPERATOR);
+    auto* sink = fragment->add_nodes()->mutable_op();
+    sink->set_op_type(sink_type);
+    if (sink_type == planpb::GRPC_SINK_OPERATOR) {
+      if (feeds_remote_agent) {
+        sink->mutable_grpc_sink_op()->set_grpc_source_id(1);
+      } else {
+        sink->mutable_grpc_sink_op()->mutable_output_table()->set_table_name("output");
+      }
+    }
+    return msg;
+  }
+
+  std::vector<Execution> executions() {
+    absl::MutexLock lock(&mu_);
+    return executions_;
+  }
+
+  // Runs the event loop until the condition holds, or for at most 10s.
+  template <typename TCondition>
+  bool RunUntil(TCondition condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!condition() && std::chrono::steady_clock::now() < deadline) {
+      dispatcher_->Run(event::Dispatcher::RunType::NonBlock);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return condition();
+  }
+
+  bool AllQueriesFinished() {
+    for (auto query_class :
+         {QueryClass::kInteractive, QueryClass::kBackground, QueryClass::kExport}) {
+      if (query_scheduler_->num_admitted(query_class) > 0 ||
+          query_scheduler_->num_queued(query_class) > 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  event::MonotonicTimePoint start_monotonic_time_;
+  event::SystemTimePoint start_system_time_;
+  std::unique_ptr<event::SimulatedTimeSystem> time_system_;
+  std::unique_ptr<event::APIImpl> api_;
+  std::unique_ptr<event::Dispatcher> dispatcher_;
+  std::unique_ptr<FakeNATSConnector<px::vizier::messages::VizierMessage>> nats_conn_;
+  agent::Info agent_info_;
+  FakeCarnot carnot_;
+  std::unique_ptr<QueryScheduler> query_scheduler_;
+  std::unique_ptr<ExecuteQueryMessageHandler> handler_;
+
+  // The query that waits for unblock_ before it completes.
+  sole::uuid blocked_query_id_;
+  absl::Notification unblock_;
+
+  absl::Mutex mu_;
+  std::vector<Execution> executions_ ABSL_GUARDED_BY(mu_);
+};
+
+TEST_F(ExecuteQueryMessageHandlerTest, RunsQueriesStartedByScheduler) {
+  auto q1 = sole::uuid4();
+  auto q2 = sole::uuid4();
+  ASSERT_OK(handler_->HandleMessage(ExecuteQueryMsg(q1, planpb::GRPC_SINK_OPERATOR)));
+  ASSERT_OK(handler_->HandleMessage(ExecuteQueryMsg(q2, planpb::OTEL_EXPORT_SINK_OPERATOR)));
+  ASSERT_TRUE(RunUntil([this]() { return executions().size() == 2 && AllQueriesFinished(); }));
+
+  for (const auto& execution : executions()) {
+    // The queries count as running from the start of their execution on the thread pool.
+    EXPECT_EQ(execution.num_running, 1);
+    // Only the export is time sliced.
+    EXPECT_EQ(execution.has_yield_func, execution.query_id == q2);
+  }
+  EXPECT_EQ(query_scheduler_->num_running(QueryClass::kInteractive), 0);
+  EXPECT_EQ(query_scheduler_->num_running(QueryClass::kExport), 0);
+}
+
+TEST_F(ExecuteQueryMessageHandlerTest, FragmentsFeedingRemoteAgentsAreNotQueued) {
+  blocked_query_id_ = sole::uuid4();
+  ASSERT_OK(
+      handler_->HandleMessage(ExecuteQueryMsg(blocked_query_id_, planpb::GRPC_SINK_OPERATOR)));
+  ASSERT_TRUE(RunUntil(
+      [this]() { return query_scheduler_->num_running(QueryClass::kInteractive) == 1; }));
+
+  // The interactive queries are limited to one at once, but a fragment of a distributed query
+  // must connect to its agent in time.
+  auto queued = sole::uuid4();
+  auto fragment = sole::uuid4();
+  ASSERT_OK(handler_->HandleMessage(ExecuteQueryMsg(queued, planpb::GRPC_SINK_OPERATOR)));
+  ASSERT_OK(handler_->HandleMessage(ExecuteQueryMsg(fragment, planpb::GRPC_SINK_OPERATOR,
+                                                    /* feeds_remote_agent */ true)));
+  EXPECT_EQ(query_scheduler_->num_queued(QueryClass::kInteractive), 1);
+  ASSERT_TRUE(RunUntil([this]() { return executions().size() == 1; }));
+  EXPECT_EQ(executions()[0].query_id, fragment);
+
+  unblock_.Notify();
+  ASSERT_TRUE(RunUntil([this]() { return executions().size() == 3 && AllQueriesFinished(); }));
+  EXPECT_EQ(executions()[1].query_id, blocked_query_id_);
+  EXPECT_EQ(executions()[2].query_id, queued);
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -102,6 +102,7 @@ Manager::Manager(sole::uuid agent_id, std::string_view pod_name, std::string_vie
       nats_addr_(nats_url),
       table_store_(std::make_shared<table_store::TableStore>()),
       relation_info_manager_(std::make_unique<RelationInfoManager>()),
+      query_scheduler_(std::make_unique<QueryScheduler>(QueryScheduler::DefaultConfig())),
       // TODO(zasgar): Not constructing the MDS by checking the url being empty is a bit janky. Fix
       // this.
       mds_channel_(mds_url.size() == 0
@@ -111,6 +112,9 @@ Manager::Manager(sole::uuid agent_id, std::string_view pod_name, std::string_vie
                     CreateCronScriptStub(mds_channel_), table_store_,
                     [](grpc::ClientContext* ctx) { AddServiceTokenToClientContext(ctx); }),
       memory_metrics_(&GetMetricsRegistry(), "agent_id", agent_id.str()) {
+  // The thread pool that runs the queries is created when its first task runs.
+  QueryScheduler::SizeThreadPool(QueryScheduler::DefaultConfig());
+
   if (!has_nats_connection()) {
     LOG(WARNING) << "--nats_url is empty, skip connecting to NATS.";
   }
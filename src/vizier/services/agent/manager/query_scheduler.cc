@@ -0,0 +1,321 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "src/vizier/services/agent/manager/query_scheduler.h"
+
+#include <cstdlib>
+#include <numeric>
+#include <string>
+#include <utility>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/substitute.h>
+#include <absl/time/time.h>
+
+#include "src/common/metrics/metrics.h"
+
+DEFINE_int32(query_scheduler_max_interactive_queries,
+             gflags::Int32FromEnv("PL_QUERY_SCHEDULER_MAX_INTERACTIVE_QUERIES", 8),
+             "The maximum number of interactive queries that an agent runs at once.");
+DEFINE_int32(query_scheduler_max_background_queries,
+             gflags::Int32FromEnv("PL_QUERY_SCHEDULER_MAX_BACKGROUND_QUERIES", 2),
+             "The maximum number of background queries (e.g. continuous queries) that an agent "
+             "runs at once.");
+DEFINE_int32(query_scheduler_max_export_queries,
+             gflags::Int32FromEnv("PL_QUERY_SCHEDULER_MAX_EXPORT_QUERIES", 2),
+             "The maximum number of queries exporting data (e.g. to OpenTelemetry) that an agent "
+             "runs at once.");
+DEFINE_int32(query_scheduler_time_slice_ms,
+             gflags::Int32FromEnv("PL_QUERY_SCHEDULER_TIME_SLICE_MS", 50),
+             "How long background and export queries run before they pause in favor of the "
+             "queries of higher priority classes.");
+DEFINE_int32(query_scheduler_max_pause_ms,
+             gflags::Int32FromEnv("PL_QUERY_SCHEDULER_MAX_PAUSE_MS", 200),
+             "The maximum time that background and export queries are paused for, per time "
+             "slice.");
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+namespace {
+
+constexpr char kThreadPoolSizeEnv[] = "UV_THREADPOOL_SIZE";
+
+template <typename TDuration>
+double ToSeconds(TDuration duration) {
+  return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+}
+
+}  // namespace
+
+std::string_view QueryClassName(QueryClass query_class) {
+  switch (query_class) {
+    case QueryClass::kInteractive:
+      return "interactive";
+    case QueryClass::kBackground:
+      return "background";
+    case QueryClass::kExport:
+      return "export";
+  }
+  return "unknown";
+}
+
+QueryScheduler::ClassMetrics::ClassMetrics(QueryClass query_class)
+    : queue_wait_seconds(prometheus::BuildCounter()
+                             .Name("query_scheduler_queue_wait_seconds")
+                             .Help("Total time that the queries of the class waited to start, "
+                                   "including the wait for a thread once admitted")
+                             .Register(GetMetricsRegistry())
+                             .Add({{"class", std::string(QueryClassName(query_class))}})),
+      run_seconds(prometheus::BuildCounter()
+                      .Name("query_scheduler_run_seconds")
+                      .Help("Total time that the queries of the class ran, including pauses")
+                      .Register(GetMetricsRegistry())
+                      .Add({{"class", std::string(QueryClassName(query_class))}})),
+      paused_seconds(prometheus::BuildCounter()
+                         .Name("query_scheduler_paused_seconds")
+                         .Help("Total time that the queries of the class were paused in favor "
+                               "of the queries of higher priority classes")
+                         .Register(GetMetricsRegistry())
+                         .Add({{"class", std::string(QueryClassName(query_class))}})),
+      completed_queries(prometheus::BuildCounter()
+                            .Name("query_scheduler_completed_queries")
+                            .Help("Total number of completed queries of the class")
+                            .Register(GetMetricsRegistry())
+                            .Add({{"class", std::string(QueryClassName(query_class))}})),
+      queued_queries(prometheus::BuildGauge()
+                         .Name("query_scheduler_queued_queries")
+                         .Help("The number of queries of the class waiting to start, queued or "
+                               "admitted")
+                         .Register(GetMetricsRegistry())
+                         .Add({{"class", std::string(QueryClassName(query_class))}})),
+      running_queries(prometheus::BuildGauge()
+                          .Name("query_scheduler_running_queries")
+                          .Help("The number of queries of the class currently running")
+                          .Register(GetMetricsRegistry())
+                          .Add({{"class", std::string(QueryClassName(query_class))}})) {}
+
+QueryScheduler::Config QueryScheduler::DefaultConfig() {
+  Config config;
+  config.max_running[static_cast<int>(QueryClass::kInteractive)] =
+      FLAGS_query_scheduler_max_interactive_queries;
+  config.max_running[static_cast<int>(QueryClass::kBackground)] =
+      FLAGS_query_scheduler_max_background_queries;
+  config.max_running[static_cast<int>(QueryClass::kExport)] =
+      FLAGS_query_scheduler_max_export_queries;
+  config.time_slice = std::chrono::milliseconds(FLAGS_query_scheduler_time_slice_ms);
+  config.max_pause = std::chrono::milliseconds(FLAGS_query_scheduler_max_pause_ms);
+  return config;
+}
+
+QueryScheduler::QueryScheduler(const Config& config)
+    : config_(config),
+      metrics_{ClassMetrics(QueryClass::kInteractive), ClassMetrics(QueryClass::kBackground),
+               ClassMetrics(QueryClass::kExport)} {
+  for (int max_running : config_.max_running) {
+    DCHECK_GT(max_running, 0);
+  }
+}
+
+void QueryScheduler::SizeThreadPool(const Config& config) {
+  int pool_size = std::accumulate(config.max_running.begin(), config.max_running.end(), 0);
+  // libuv reads the variable when the pool is created, on the first task it runs.
+  const char* current = std::getenv(kThreadPoolSizeEnv);
+  if (current == nullptr) {
+    setenv(kThreadPoolSizeEnv, std::to_string(pool_size).c_str(), /* overwrite */ 0);
+    return;
+  }
+  int current_size = 0;
+  if (!absl::SimpleAtoi(current, &current_size) || current_size < pool_size) {
+    LOG(WARNING) << absl::Substitute(
+        "$0=$1 is less than the $2 queries that the query scheduler admits at once, paused "
+        "queries can hold up the other queries.",
+        kThreadPoolSizeEnv, current, pool_size);
+  }
+}
+
+QueryClass QueryScheduler::ClassifyPlan(const planpb::Plan& plan) {
+  for (const auto& fragment : plan.nodes()) {
+    for (const auto& node : fragment.nodes()) {
+      if (node.op().op_type() == planpb::OTEL_EXPORT_SINK_OPERATOR) {
+        return QueryClass::kExport;
+      }
+    }
+  }
+  return QueryClass::kInteractive;
+}
+
+bool QueryScheduler::FeedsRemoteAgent(const planpb::Plan& plan) {
+  for (const auto& fragment : plan.nodes()) {
+    for (const auto& node : fragment.nodes()) {
+      if (node.op().op_type() == planpb::GRPC_SINK_OPERATOR &&
+          node.op().grpc_sink_op().destination_case() ==
+              planpb::GRPCSinkOperator::kGrpcSourceId) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void QueryScheduler::Submit(const sole::uuid& query_id, QueryClass query_class,
+                            std::function<void()> start_fn, bool bypass_limit) {
+  std::vector<std::function<void()>> start_fns;
+  {
+    absl::MutexLock lock(&mu_);
+    auto idx = static_cast<int>(query_class);
+    metrics_[idx].queued_queries.Increment();
+    if (bypass_limit) {
+      Admit(query_id, query_class, Clock::now());
+      start_fns.push_back(std::move(start_fn));
+    } else {
+      queued_[idx].push_back(QueuedQuery{query_id, Clock::now(), std::move(start_fn)});
+      start_fns = AdmitQueries();
+    }
+  }
+  for (auto& fn : start_fns) {
+    fn();
+  }
+}
+
+void QueryScheduler::MarkStarted(const sole::uuid& query_id) {
+  absl::MutexLock lock(&mu_);
+  auto it = admitted_.find(query_id);
+  if (it == admitted_.end() || it->second.start_time.has_value()) {
+    LOG(ERROR) << "Attempting to start a query that is not admitted: " << query_id.str();
+    return;
+  }
+  auto now = Clock::now();
+  auto idx = static_cast<int>(it->second.query_class);
+  it->second.start_time = now;
+  ++num_running_[idx];
+  metrics_[idx].queued_queries.Decrement();
+  metrics_[idx].running_queries.Increment();
+  metrics_[idx].queue_wait_seconds.Increment(ToSeconds(now - it->second.submit_time));
+}
+
+void QueryScheduler::Finish(const sole::uuid& query_id) {
+  std::vector<std::function<void()>> start_fns;
+  {
+    absl::MutexLock lock(&mu_);
+    auto node = admitted_.extract(query_id);
+    if (node.empty()) {
+      LOG(ERROR) << "Attempting to finish a query that is not admitted: " << query_id.str();
+      return;
+    }
+    const AdmittedQuery& query = node.mapped();
+    auto idx = static_cast<int>(query.query_class);
+    --num_admitted_[idx];
+    if (query.start_time.has_value()) {
+      --num_running_[idx];
+      metrics_[idx].running_queries.Decrement();
+      metrics_[idx].run_seconds.Increment(ToSeconds(Clock::now() - *query.start_time));
+    } else {
+      metrics_[idx].queued_queries.Decrement();
+    }
+    metrics_[idx].completed_queries.Increment();
+    start_fns = AdmitQueries();
+    query_finished_.SignalAll();
+  }
+  for (auto& fn : start_fns) {
+    fn();
+  }
+}
+
+std::vector<std::function<void()>> QueryScheduler::AdmitQueries() {
+  std::vector<std::function<void()>> start_fns;
+  for (int idx = 0; idx < kNumQueryClasses; ++idx) {
+    auto& queue = queued_[idx];
+    while (!queue.empty() && num_admitted_[idx] < config_.max_running[idx]) {
+      QueuedQuery query = std::move(queue.front());
+      queue.pop_front();
+      Admit(query.query_id, static_cast<QueryClass>(idx), query.submit_time);
+      start_fns.push_back(std::move(query.start_fn));
+    }
+  }
+  return start_fns;
+}
+
+void QueryScheduler::Admit(const sole::uuid& query_id, QueryClass query_class,
+                           Clock::time_point submit_time) {
+  ++num_admitted_[static_cast<int>(query_class)];
+  admitted_[query_id] = AdmittedQuery{query_class, submit_time, std::nullopt};
+}
+
+bool QueryScheduler::HigherClassRunning(QueryClass query_class) const {
+  for (int idx = 0; idx < static_cast<int>(query_class); ++idx) {
+    if (num_running_[idx] > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+carnot::exec::YieldFunc QueryScheduler::CreateYieldFunc(QueryClass query_class) {
+  if (query_class == QueryClass::kInteractive) {
+    return nullptr;
+  }
+  // Only ever called by the thread running the query, so the slice needs no synchronization.
+  return [this, query_class, slice_start = Clock::now()]() mutable {
+    if (Clock::now() - slice_start < config_.time_slice) {
+      return;
+    }
+    Pause(query_class);
+    slice_start = Clock::now();
+  };
+}
+
+void QueryScheduler::Pause(QueryClass query_class) {
+  auto idx = static_cast<int>(query_class);
+  auto start = Clock::now();
+  auto deadline = start + config_.max_pause;
+  {
+    absl::MutexLock lock(&mu_);
+    ++num_paused_[idx];
+    for (auto now = Clock::now(); now < deadline && HigherClassRunning(query_class);
+         now = Clock::now()) {
+      query_finished_.WaitWithTimeout(&mu_, absl::FromChrono(deadline - now));
+    }
+    --num_paused_[idx];
+  }
+  metrics_[idx].paused_seconds.Increment(ToSeconds(Clock::now() - start));
+}
+
+int QueryScheduler::num_queued(QueryClass query_class) const {
+  absl::MutexLock lock(&mu_);
+  return static_cast<int>(queued_[static_cast<int>(query_class)].size());
+}
+
+int QueryScheduler::num_admitted(QueryClass query_class) const {
+  absl::MutexLock lock(&mu_);
+  return num_admitted_[static_cast<int>(query_class)];
+}
+
+int QueryScheduler::num_running(QueryClass query_class) const {
+  absl::MutexLock lock(&mu_);
+  return num_running_[static_cast<int>(query_class)];
+}
+
+int QueryScheduler::num_paused(QueryClass query_class) const {
+  absl::MutexLock lock(&mu_);
+  return num_paused_[static_cast<int>(query_class)];
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
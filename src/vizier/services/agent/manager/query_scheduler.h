@@ -0,0 +1,200 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <prometheus/registry.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/common/uuid/uuid.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+/**
+ * The classes of queries run by an agent, in decreasing order of priority.
+ */
+enum class QueryClass {
+  // Queries of a user waiting for the results, e.g. the live views and ad-hoc scripts.
+  kInteractive = 0,
+  // Queries that the agent runs on its own, e.g. the continuous queries of the PEMs.
+  kBackground,
+  // Queries that export data to an external system, e.g. the OpenTelemetry exports.
+  kExport,
+};
+
+constexpr int kNumQueryClasses = 3;
+
+std::string_view QueryClassName(QueryClass query_class);
+
+/**
+ * QueryScheduler decides when the queries of an agent start, and lets the ones of the higher
+ * priority classes run ahead of the others.
+ *
+ * Each class has a limit on the number of its queries that are admitted at once. Queries over the
+ * limit are queued, and admitted in order when a query of their class finishes. Since queries of
+ * lower classes only queue behind their own class, a burst of exports or background queries never
+ * delays the start of an interactive query. Once admitted, the queries run on the thread pool of
+ * the agent, so the limits also bound the CPU that queries take away from the data collection.
+ * A query only counts as running once it calls MarkStarted() from that pool.
+ *
+ * The queries of lower classes are additionally time sliced: the execution graph calls the
+ * function returned by CreateYieldFunc() between batches, and when the query has used up its
+ * slice while queries of a higher class run, it pauses until they finish or for at most
+ * max_pause, whichever comes first. A paused query holds its thread of the pool, so the pool
+ * must have a thread for every query that can be admitted, see SizeThreadPool().
+ *
+ * Submit() and Finish() must be called from the event loop of the agent, while MarkStarted() and
+ * the yield functions are called from the threads that run the queries.
+ */
+class QueryScheduler : public NotCopyable {
+ public:
+  struct Config {
+    // The maximum number of running queries of each class, indexed by QueryClass.
+    std::array<int, kNumQueryClasses> max_running;
+    // How long a query of a lower class runs before it checks for queries of higher classes.
+    std::chrono::milliseconds time_slice;
+    // The maximum time that a query is paused for, per time slice.
+    std::chrono::milliseconds max_pause;
+  };
+
+  /**
+   * Returns the config set by the --query_scheduler_* flags.
+   */
+  static Config DefaultConfig();
+
+  /**
+   * Sizes the thread pool of libuv, which runs the queries, to the sum of the limits of the
+   * classes. Otherwise the paused queries of the lower classes could take all the threads, and
+   * hold up the queries they pause for. Must be called before the first task runs on the pool.
+   */
+  static void SizeThreadPool(const Config& config);
+
+  explicit QueryScheduler(const Config& config);
+
+  /**
+   * Returns the class of a query received from the query broker.
+   */
+  static QueryClass ClassifyPlan(const planpb::Plan& plan);
+
+  /**
+   * Returns whether the plan sends its results to the GRPC sources of another agent. The plans
+   * of these agents give up on the sources that are not connected within
+   * exec::kDefaultUpstreamResultConnectionTimeout, so such plans should not be queued.
+   */
+  static bool FeedsRemoteAgent(const planpb::Plan& plan);
+
+  /**
+   * Queues the query, and calls start_fn to start it as soon as its class is under its limit,
+   * possibly before returning. If bypass_limit is set, the query is admitted right away, but
+   * still counts against the limit of its class. Finish() must be called when the query
+   * completes.
+   */
+  void Submit(const sole::uuid& query_id, QueryClass query_class, std::function<void()> start_fn,
+              bool bypass_limit = false);
+
+  /**
+   * Records that the admitted query started running on the thread pool. Only running queries
+   * pause the queries of the lower classes.
+   */
+  void MarkStarted(const sole::uuid& query_id);
+
+  /**
+   * Records the completion of the query, and admits the queued queries that can now run.
+   */
+  void Finish(const sole::uuid& query_id);
+
+  /**
+   * Returns the function that the queries of the class pass to Carnot::ExecutePlan(). It is null
+   * for the interactive queries, which are never paused. Each query needs its own function.
+   */
+  carnot::exec::YieldFunc CreateYieldFunc(QueryClass query_class);
+
+  // The number of queries waiting for their class to be under its limit.
+  int num_queued(QueryClass query_class) const;
+  // The number of queries that count against the limit of their class, started or not.
+  int num_admitted(QueryClass query_class) const;
+  int num_running(QueryClass query_class) const;
+  int num_paused(QueryClass query_class) const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct QueuedQuery {
+    sole::uuid query_id;
+    Clock::time_point submit_time;
+    std::function<void()> start_fn;
+  };
+
+  struct AdmittedQuery {
+    QueryClass query_class;
+    Clock::time_point submit_time;
+    std::optional<Clock::time_point> start_time;
+  };
+
+  struct ClassMetrics {
+    explicit ClassMetrics(QueryClass query_class);
+
+    prometheus::Counter& queue_wait_seconds;
+    prometheus::Counter& run_seconds;
+    prometheus::Counter& paused_seconds;
+    prometheus::Counter& completed_queries;
+    prometheus::Gauge& queued_queries;
+    prometheus::Gauge& running_queries;
+  };
+
+  // Moves the queries that can run from the queues to admitted_, and returns their start
+  // functions, to be called without holding mu_.
+  std::vector<std::function<void()>> AdmitQueries() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Admit(const sole::uuid& query_id, QueryClass query_class, Clock::time_point submit_time)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool HigherClassRunning(QueryClass query_class) const ABSL_SHARED_LOCKS_REQUIRED(mu_);
+  void Pause(QueryClass query_class);
+
+  const Config config_;
+
+  mutable absl::Mutex mu_;
+  // Signalled whenever a query finishes, to resume the paused queries.
+  absl::CondVar query_finished_;
+  std::array<std::deque<QueuedQuery>, kNumQueryClasses> queued_ ABSL_GUARDED_BY(mu_);
+  std::array<int, kNumQueryClasses> num_admitted_ ABSL_GUARDED_BY(mu_) = {};
+  std::array<int, kNumQueryClasses> num_running_ ABSL_GUARDED_BY(mu_) = {};
+  std::array<int, kNumQueryClasses> num_paused_ ABSL_GUARDED_BY(mu_) = {};
+  absl::flat_hash_map<sole::uuid, AdmittedQuery> admitted_ ABSL_GUARDED_BY(mu_);
+
+  std::array<ClassMetrics, kNumQueryClasses> metrics_;
+};
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
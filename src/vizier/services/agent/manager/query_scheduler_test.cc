@@ -0,0 +1,220 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "src/vizier/services/agent/manager/query_scheduler.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+using ::testing::ElementsAre;
+
+class QuerySchedulerTest : public ::testing::Test {
+ protected:
+  static QueryScheduler::Config TestConfig(std::chrono::milliseconds max_pause) {
+    QueryScheduler::Config config;
+    config.max_running = {2, 1, 1};
+    config.time_slice = std::chrono::milliseconds(0);
+    config.max_pause = max_pause;
+    return config;
+  }
+
+  // Submits a query that records its admission in started_, and starts running right away
+  // unless mark_started is false.
+  sole::uuid Submit(QueryScheduler* scheduler, QueryClass query_class, bool mark_started = true,
+                    bool bypass_limit = false) {
+    auto query_id = sole::uuid4();
+    scheduler->Submit(
+        query_id, query_class,
+        [this, scheduler, query_id, mark_started]() {
+          started_.push_back(query_id);
+          if (mark_started) {
+            scheduler->MarkStarted(query_id);
+          }
+        },
+        bypass_limit);
+    return query_id;
+  }
+
+  std::vector<sole::uuid> started_;
+};
+
+TEST_F(QuerySchedulerTest, ClassifyPlan) {
+  planpb::Plan plan;
+  auto* fragment = plan.add_nodes();
+  fragment->add_nodes()->mutable_op()->set_op_type(planpb::MEMORY_SOURCE_OPERATOR);
+  fragment->add_nodes()->mutable_op()->set_op_type(planpb::GRPC_SINK_OPERATOR);
+  EXPECT_EQ(QueryScheduler::ClassifyPlan(plan), QueryClass::kInteractive);
+
+  fragment->add_nodes()->mutable_op()->set_op_type(planpb::OTEL_EXPORT_SINK_OPERATOR);
+  EXPECT_EQ(QueryScheduler::ClassifyPlan(plan), QueryClass::kExport);
+}
+
+TEST_F(QuerySchedulerTest, FeedsRemoteAgent) {
+  planpb::Plan plan;
+  auto* fragment = plan.add_nodes();
+  fragment->add_nodes()->mutable_op()->set_op_type(planpb::MEMORY_SOURCE_OPERATOR);
+  auto* op = fragment->add_nodes()->mutable_op();
+  op->set_op_type(planpb::GRPC_SINK_OPERATOR);
+  // The final results go to the query broker.
+  op->mutable_grpc_sink_op()->mutable_output_table()->set_table_name("output");
+  EXPECT_FALSE(QueryScheduler::FeedsRemoteAgent(plan));
+
+  op->mutable_grpc_sink_op()->set_grpc_source_id(2);
+  EXPECT_TRUE(QueryScheduler::FeedsRemoteAgent(plan));
+}
+
+TEST_F(QuerySchedulerTest, LimitsRunningQueriesPerClass) {
+  QueryScheduler scheduler(TestConfig(std::chrono::milliseconds(0)));
+  auto q1 = Submit(&scheduler, QueryClass::kInteractive);
+  auto q2 = Submit(&scheduler, QueryClass::kInteractive);
+  auto q3 = Submit(&scheduler, QueryClass::kInteractive);
+  EXPECT_THAT(started_, ElementsAre(q1, q2));
+  EXPECT_EQ(scheduler.num_admitted(QueryClass::kInteractive), 2);
+  EXPECT_EQ(scheduler.num_running(QueryClass::kInteractive), 2);
+  EXPECT_EQ(scheduler.num_queued(QueryClass::kInteractive), 1);
+
+  // The other classes have their own limits.
+  auto b1 = Submit(&scheduler, QueryClass::kBackground);
+  auto b2 = Submit(&scheduler, QueryClass::kBackground);
+  EXPECT_THAT(started_, ElementsAre(q1, q2, b1));
+
+  scheduler.Finish(q2);
+  EXPECT_THAT(started_, ElementsAre(q1, q2, b1, q3));
+  scheduler.Finish(b1);
+  EXPECT_THAT(started_, ElementsAre(q1, q2, b1, q3, b2));
+  EXPECT_EQ(scheduler.num_queued(QueryClass::kInteractive), 0);
+  EXPECT_EQ(scheduler.num_queued(QueryClass::kBackground), 0);
+
+  // Starting or finishing an unknown query is ignored.
+  scheduler.MarkStarted(sole::uuid4());
+  scheduler.Finish(sole::uuid4());
+  EXPECT_EQ(scheduler.num_running(QueryClass::kInteractive), 2);
+}
+
+TEST_F(QuerySchedulerTest, BypassLimit) {
+  QueryScheduler scheduler(TestConfig(std::chrono::milliseconds(0)));
+  auto q1 = Submit(&scheduler, QueryClass::kInteractive);
+  auto q2 = Submit(&scheduler, QueryClass::kInteractive);
+  auto q3 = Submit(&scheduler, QueryClass::kInteractive, /* mark_started */ true,
+                   /* bypass_limit */ true);
+  EXPECT_THAT(started_, ElementsAre(q1, q2, q3));
+  EXPECT_EQ(scheduler.num_admitted(QueryClass::kInteractive), 3);
+
+  // The bypassing query still counts against the limit.
+  auto q4 = Submit(&scheduler, QueryClass::kInteractive);
+  scheduler.Finish(q1);
+  EXPECT_THAT(started_, ElementsAre(q1, q2, q3));
+  scheduler.Finish(q3);
+  EXPECT_THAT(started_, ElementsAre(q1, q2, q3, q4));
+}
+
+TEST_F(QuerySchedulerTest, AdmittedQueriesRunOnceStarted) {
+  QueryScheduler scheduler(TestConfig(std::chrono::seconds(60)));
+  auto yield = scheduler.CreateYieldFunc(QueryClass::kBackground);
+
+  // The interactive query waits for a thread, so it does not pause the background query.
+  auto q1 = Submit(&scheduler, QueryClass::kInteractive, /* mark_started */ false);
+  EXPECT_THAT(started_, ElementsAre(q1));
+  EXPECT_EQ(scheduler.num_admitted(QueryClass::kInteractive), 1);
+  EXPECT_EQ(scheduler.num_running(QueryClass::kInteractive), 0);
+  auto start = std::chrono::steady_clock::now();
+  yield();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(60));
+
+  scheduler.MarkStarted(q1);
+  EXPECT_EQ(scheduler.num_running(QueryClass::kInteractive), 1);
+  scheduler.Finish(q1);
+  EXPECT_EQ(scheduler.num_admitted(QueryClass::kInteractive), 0);
+  EXPECT_EQ(scheduler.num_running(QueryClass::kInteractive), 0);
+
+  // A query that never started can still finish.
+  auto q2 = Submit(&scheduler, QueryClass::kInteractive, /* mark_started */ false);
+  scheduler.Finish(q2);
+  EXPECT_EQ(scheduler.num_admitted(QueryClass::kInteractive), 0);
+}
+
+TEST_F(QuerySchedulerTest, SizeThreadPool) {
+  unsetenv("UV_THREADPOOL_SIZE");
+  QueryScheduler::SizeThreadPool(TestConfig(std::chrono::milliseconds(0)));
+  ASSERT_NE(std::getenv("UV_THREADPOOL_SIZE"), nullptr);
+  EXPECT_STREQ(std::getenv("UV_THREADPOOL_SIZE"), "4");
+
+  // A size set by the user is kept.
+  setenv("UV_THREADPOOL_SIZE", "16", /* overwrite */ 1);
+  QueryScheduler::SizeThreadPool(TestConfig(std::chrono::milliseconds(0)));
+  EXPECT_STREQ(std::getenv("UV_THREADPOOL_SIZE"), "16");
+  unsetenv("UV_THREADPOOL_SIZE");
+}
+
+TEST_F(QuerySchedulerTest, InteractiveQueriesNeverPause) {
+  QueryScheduler scheduler(TestConfig(std::chrono::milliseconds(0)));
+  EXPECT_TRUE(scheduler.CreateYieldFunc(QueryClass::kInteractive) == nullptr);
+  EXPECT_TRUE(scheduler.CreateYieldFunc(QueryClass::kBackground) != nullptr);
+}
+
+TEST_F(QuerySchedulerTest, PausesWhileHigherClassRuns) {
+  constexpr auto kMaxPause = std::chrono::milliseconds(50);
+  QueryScheduler scheduler(TestConfig(kMaxPause));
+  auto yield = scheduler.CreateYieldFunc(QueryClass::kExport);
+
+  // Nothing to yield to.
+  Submit(&scheduler, QueryClass::kExport);
+  auto start = std::chrono::steady_clock::now();
+  yield();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, kMaxPause);
+
+  // A background query runs, so the export pauses for kMaxPause.
+  auto b1 = Submit(&scheduler, QueryClass::kBackground);
+  start = std::chrono::steady_clock::now();
+  yield();
+  auto paused = std::chrono::steady_clock::now() - start;
+  EXPECT_GE(paused, kMaxPause);
+  EXPECT_LT(paused, kMaxPause + std::chrono::seconds(5));
+  EXPECT_EQ(scheduler.num_paused(QueryClass::kExport), 0);
+  scheduler.Finish(b1);
+}
+
+TEST_F(QuerySchedulerTest, ResumesWhenHigherClassFinishes) {
+  QueryScheduler scheduler(TestConfig(std::chrono::seconds(60)));
+  auto yield = scheduler.CreateYieldFunc(QueryClass::kBackground);
+  auto q1 = Submit(&scheduler, QueryClass::kInteractive);
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread query_thread([&yield]() { yield(); });
+  while (scheduler.num_paused(QueryClass::kBackground) == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  scheduler.Finish(q1);
+  query_thread.join();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(60));
+  EXPECT_EQ(scheduler.num_paused(QueryClass::kBackground), 0);
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -18,11 +18,17 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <queue>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/carnot/carnot.h"
 #include "src/common/event/dispatcher.h"
 #include "src/common/event/nats.h"
 #include "src/shared/metadata/state_manager.h"
@@ -98,6 +104,8 @@ class FakeAgentMetadataStateManager : public md::AgentMetadataStateManager {
     return event;
   }
 
+  void AddProcessLifecycleEvent(md::ProcessLifecycleEvent) override {}
+
  private:
   md::AgentMetadataFilter* metadata_filter_ = nullptr;
   std::shared_ptr<const md::AgentMetadataState> metadata_state_;
@@ -108,6 +116,64 @@ class FakeAgentMetadataStateManager : public md::AgentMetadataStateManager {
   std::queue<std::unique_ptr<md::PIDStatusEvent>> pid_status_events_;
 };
 
+/**
+ * FakeCarnot calls execute_plan_fn in place of executing the plans, and returns compiled_plan for
+ * every query that it compiles, except the queries given a compile error. ExecutePlan() is called
+ * from the threads that run the queries.
+ */
+class FakeCarnot : public carnot::Carnot {
+ public:
+  using ExecutePlanFunc = std::function<void(const planpb::Plan& plan, const sole::uuid& query_id,
+                                             carnot::exec::YieldFunc yield_func)>;
+
+  explicit FakeCarnot(ExecutePlanFunc execute_plan_fn = nullptr)
+      : execute_plan_fn_(std::move(execute_plan_fn)) {}
+
+  void set_compiled_plan(planpb::Plan plan) { compiled_plan_ = std::move(plan); }
+  void set_compile_error(const std::string& query, Status status) {
+    compile_errors_[query] = std::move(status);
+  }
+
+  Status ExecuteQuery(const std::string&, const sole::uuid&, types::Time64NSValue, bool) override {
+    return error::Unimplemented("FakeCarnot does not execute queries");
+  }
+
+  StatusOr<planpb::Plan> CompileQuery(const std::string& query, types::Time64NSValue) override {
+    auto it = compile_errors_.find(query);
+    if (it != compile_errors_.end()) {
+      return it->second;
+    }
+    return compiled_plan_;
+  }
+
+  Status ExecutePlan(const planpb::Plan& plan, const sole::uuid& query_id, bool,
+                     carnot::exec::YieldFunc yield_func) override {
+    if (execute_plan_fn_) {
+      execute_plan_fn_(plan, query_id, std::move(yield_func));
+    }
+    absl::MutexLock lock(&mu_);
+    executed_plans_.push_back(plan);
+    return Status::OK();
+  }
+
+  void RegisterAgentMetadataCallback(AgentMetadataCallbackFunc) override {}
+
+  const carnot::udf::Registry* FuncRegistry() const override { return nullptr; }
+
+  std::vector<planpb::Plan> executed_plans() const {
+    absl::MutexLock lock(&mu_);
+    return executed_plans_;
+  }
+
+ private:
+  ExecutePlanFunc execute_plan_fn_;
+  planpb::Plan compiled_plan_;
+  absl::flat_hash_map<std::string, Status> compile_errors_;
+
+  mutable absl::Mutex mu_;
+  std::vector<planpb::Plan> executed_plans_ ABSL_GUARDED_BY(mu_);
+};
+
 }  // namespace agent
 }  // namespace vizier
 }  // namespace px
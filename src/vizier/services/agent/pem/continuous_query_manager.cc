@@ -0,0 +1,270 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/vizier/services/agent/pem/continuous_query_manager.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <sole.hpp>
+
+#include "src/common/base/file.h"
+#include "src/common/event/task.h"
+#include "src/shared/schema/utils.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+using ::px::event::AsyncTask;
+
+// How often to check whether a window is complete.
+constexpr auto kRunCheckPeriod = std::chrono::seconds(1);
+// How long to wait after the end of a window before processing it, so that the data of the window
+// has been pushed to the table store.
+constexpr auto kWindowDelay = std::chrono::seconds(5);
+
+class ContinuousQueryManager::ContinuousQueryTask : public AsyncTask {
+ public:
+  ContinuousQueryTask(ContinuousQueryManager* parent, carnot::Carnot* carnot,
+                      QueryScheduler* query_scheduler, std::string name, sole::uuid query_id,
+                      planpb::Plan plan, carnot::exec::YieldFunc yield_func)
+      : parent_(parent),
+        carnot_(carnot),
+        query_scheduler_(query_scheduler),
+        name_(std::move(name)),
+        query_id_(query_id),
+        plan_(std::move(plan)),
+        yield_func_(std::move(yield_func)) {}
+
+  void Work() override {
+    query_scheduler_->MarkStarted(query_id_);
+    VLOG(1) << absl::Substitute("Executing continuous query: name=$0 id=$1", name_,
+                                query_id_.str());
+    auto s = carnot_->ExecutePlan(plan_, query_id_, /* analyze */ false, yield_func_);
+    LOG_IF(ERROR, !s.ok()) << absl::Substitute("Continuous query $0 failed, reason: $1", name_,
+                                               s.ToString());
+  }
+
+  void Done() override { parent_->HandleRunComplete(name_); }
+
+ private:
+  ContinuousQueryManager* parent_;
+  carnot::Carnot* carnot_;
+  QueryScheduler* query_scheduler_;
+  const std::string name_;
+  const sole::uuid query_id_;
+  const planpb::Plan plan_;
+  carnot::exec::YieldFunc yield_func_;
+};
+
+ContinuousQueryManager::ContinuousQueryManager(px::event::Dispatcher* dispatcher,
+                                               carnot::Carnot* carnot,
+                                               QueryScheduler* query_scheduler,
+                                               table_store::TableStore* table_store,
+                                               RelationInfoManager* relation_info_manager,
+                                               std::chrono::milliseconds window,
+                                               int64_t table_size_limit)
+    : dispatcher_(dispatcher),
+      carnot_(carnot),
+      query_scheduler_(query_scheduler),
+      table_store_(table_store),
+      relation_info_manager_(relation_info_manager),
+      window_(window),
+      table_size_limit_(table_size_limit) {
+  DCHECK_GT(window_.count(), 0);
+  run_timer_ = dispatcher_->CreateTimer([this]() {
+    RunQueries();
+    if (run_timer_) {
+      run_timer_->EnableTimer(kRunCheckPeriod);
+    }
+  });
+  run_timer_->EnableTimer(kRunCheckPeriod);
+}
+
+Status ContinuousQueryManager::RegisterQuery(const std::string& name, const std::string& query) {
+  if (queries_.contains(name)) {
+    return error::AlreadyExists("Continuous query '$0' is already registered", name);
+  }
+  PL_ASSIGN_OR_RETURN(planpb::Plan plan, carnot_->CompileQuery(query, CurrentTimeNS()));
+  // Rewrite the plan once, so that the tables it displays can be created from it. Only the time
+  // window changes between runs.
+  PL_RETURN_IF_ERROR(PrepareWindowPlan(0, 0, &plan));
+  PL_RETURN_IF_ERROR(CreateOutputTables(plan));
+
+  ContinuousQuery continuous_query;
+  continuous_query.plan = std::move(plan);
+  continuous_query.last_window_end_ns = LastWindowEnd();
+  queries_.emplace(name, std::move(continuous_query));
+  LOG(INFO) << absl::Substitute("Registered continuous query: name=$0", name);
+  return Status::OK();
+}
+
+Status ContinuousQueryManager::RegisterQueriesFromDir(const std::filesystem::path& dir) {
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    if (!entry.is_regular_file() || entry.path().extension() != ".pxl") {
+      continue;
+    }
+    // A script that cannot be read or compiled must not keep the agent from starting, nor the
+    // other scripts from running.
+    StatusOr<std::string> query = ReadFileToString(entry.path().string());
+    Status s = query.ok() ? RegisterQuery(entry.path().stem().string(), query.ValueOrDie())
+                          : query.status();
+    if (!s.ok()) {
+      LOG(ERROR) << absl::Substitute("Skipping continuous query $0: $1", entry.path().string(),
+                                     s.msg());
+    }
+  }
+  if (ec) {
+    return error::InvalidArgument("Failed to list continuous queries in $0: $1", dir.string(),
+                                  ec.message());
+  }
+  return Status::OK();
+}
+
+Status ContinuousQueryManager::PrepareWindowPlan(int64_t start_time_ns, int64_t stop_time_ns,
+                                                 planpb::Plan* plan) {
+  for (auto& fragment : *plan->mutable_nodes()) {
+    for (auto& node : *fragment.mutable_nodes()) {
+      planpb::Operator* op = node.mutable_op();
+      switch (op->op_type()) {
+        case planpb::MEMORY_SOURCE_OPERATOR: {
+          auto* source = op->mutable_mem_source_op();
+          source->set_streaming(false);
+          source->mutable_start_time()->set_value(start_time_ns);
+          // The stop time is inclusive.
+          source->mutable_stop_time()->set_value(stop_time_ns - 1);
+          break;
+        }
+        case planpb::GRPC_SINK_OPERATOR: {
+          if (!op->grpc_sink_op().has_output_table()) {
+            return error::InvalidArgument(
+                "Continuous queries can only send results to output tables");
+          }
+          // Write the result table to the table store, instead of sending it to a client.
+          planpb::GRPCSinkOperator::ResultTable output_table =
+              op->grpc_sink_op().output_table();
+          op->set_op_type(planpb::MEMORY_SINK_OPERATOR);
+          auto* sink = op->mutable_mem_sink_op();
+          sink->set_name(output_table.table_name());
+          *sink->mutable_column_types() = output_table.column_types();
+          *sink->mutable_column_names() = output_table.column_names();
+          *sink->mutable_column_semantic_types() = output_table.column_semantic_types();
+          sink->set_append(true);
+          break;
+        }
+        case planpb::MEMORY_SINK_OPERATOR:
+          op->mutable_mem_sink_op()->set_append(true);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  return Status::OK();
+}
+
+Status ContinuousQueryManager::CreateOutputTables(const planpb::Plan& plan) {
+  std::vector<RelationInfo> relation_infos;
+  for (const auto& fragment : plan.nodes()) {
+    for (const auto& node : fragment.nodes()) {
+      if (node.op().op_type() != planpb::MEMORY_SINK_OPERATOR) {
+        continue;
+      }
+      const auto& sink = node.op().mem_sink_op();
+      table_store::schema::Relation relation;
+      for (int i = 0; i < sink.column_types_size(); ++i) {
+        auto semantic_type = i < sink.column_semantic_types_size()
+                                 ? sink.column_semantic_types(i)
+                                 : types::ST_NONE;
+        relation.AddColumn(sink.column_types(i), sink.column_names(i), semantic_type);
+      }
+      if (relation_info_manager_->HasRelation(sink.name())) {
+        return error::AlreadyExists("Output table '$0' of the continuous query already exists",
+                                    sink.name());
+      }
+      relation_infos.emplace_back(sink.name(), /* id */ 0,
+                                  absl::Substitute("Continuous query output table $0", sink.name()),
+                                  std::move(relation));
+    }
+  }
+
+  for (auto& relation_info : relation_infos) {
+    auto table = std::make_shared<table_store::Table>(relation_info.name, relation_info.relation,
+                                                      table_size_limit_);
+    table_store_->AddTable(std::move(table), relation_info.name);
+    PL_RETURN_IF_ERROR(relation_info_manager_->AddRelationInfo(std::move(relation_info)));
+  }
+  return Status::OK();
+}
+
+int64_t ContinuousQueryManager::LastWindowEnd() const {
+  int64_t window_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(window_).count();
+  int64_t delay_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(kWindowDelay).count();
+  return (CurrentTimeNS() - delay_ns) / window_ns * window_ns;
+}
+
+void ContinuousQueryManager::RunQueries() {
+  int64_t window_end_ns = LastWindowEnd();
+  for (auto& [name, continuous_query] : queries_) {
+    if (continuous_query.run_id.has_value() ||
+        continuous_query.last_window_end_ns >= window_end_ns) {
+      continue;
+    }
+    // If runs fell behind, the next run catches up by processing all the missed windows at once.
+    planpb::Plan plan = continuous_query.plan;
+    auto s = PrepareWindowPlan(continuous_query.last_window_end_ns, window_end_ns, &plan);
+    if (!s.ok()) {
+      LOG(ERROR) << absl::Substitute("Failed to prepare continuous query $0: $1", name,
+                                     s.ToString());
+      continue;
+    }
+    continuous_query.last_window_end_ns = window_end_ns;
+    continuous_query.run_id = sole::uuid4();
+    query_scheduler_->Submit(*continuous_query.run_id, QueryClass::kBackground,
+                             [this, name = name, plan = std::move(plan)]() mutable {
+                               StartRun(name, std::move(plan));
+                             });
+  }
+}
+
+void ContinuousQueryManager::StartRun(const std::string& name, planpb::Plan plan) {
+  auto& continuous_query = queries_.at(name);
+  continuous_query.running = dispatcher_->CreateAsyncTask(std::make_unique<ContinuousQueryTask>(
+      this, carnot_, query_scheduler_, name, *continuous_query.run_id, std::move(plan),
+      query_scheduler_->CreateYieldFunc(QueryClass::kBackground)));
+  continuous_query.running->Run();
+}
+
+void ContinuousQueryManager::HandleRunComplete(const std::string& name) {
+  auto it = queries_.find(name);
+  if (it == queries_.end() || it->second.running == nullptr) {
+    LOG(ERROR) << "Completed run of unknown continuous query: " << name;
+    return;
+  }
+  query_scheduler_->Finish(*it->second.run_id);
+  it->second.run_id.reset();
+  dispatcher_->DeferredDelete(std::move(it->second.running));
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
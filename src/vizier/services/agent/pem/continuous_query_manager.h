@@ -0,0 +1,123 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/common/event/event.h"
+#include "src/table_store/table_store.h"
+#include "src/vizier/services/agent/manager/query_scheduler.h"
+#include "src/vizier/services/agent/manager/relation_info_manager.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+/**
+ * ContinuousQueryManager runs registered queries in the background on every window, and appends
+ * their results to tables in the local table store.
+ *
+ * This is used to maintain rollups of the raw data tables, e.g. the per-service latency
+ * quantiles and request counts of every 10s, which can then be queried for long time ranges
+ * without rescanning the raw data. Each query is compiled once when registered. Then, every
+ * window, its memory sources are restricted to the last complete window, and the tables it
+ * displays are appended to instead of being sent to a client. The output tables have their own
+ * size limit, and are reported with the schema of the agent like any other table. The runs are
+ * scheduled as background queries, so they yield to the interactive queries.
+ */
+class ContinuousQueryManager : public NotCopyable {
+ public:
+  ContinuousQueryManager() = delete;
+  /**
+   * @param window The period of the queries, which must be positive. Each run processes the data
+   * of one window, which is aligned to a multiple of the period.
+   * @param table_size_limit The maximum size of each output table, in bytes.
+   */
+  ContinuousQueryManager(px::event::Dispatcher* dispatcher, carnot::Carnot* carnot,
+                         QueryScheduler* query_scheduler, table_store::TableStore* table_store,
+                         RelationInfoManager* relation_info_manager,
+                         std::chrono::milliseconds window, int64_t table_size_limit);
+
+  /**
+   * Compiles the query, and creates the tables that it displays. The query runs on the windows
+   * that start after it is registered.
+   */
+  Status RegisterQuery(const std::string& name, const std::string& query);
+
+  /**
+   * Registers the query of every .pxl file in the directory, named after the file. The scripts
+   * that cannot be read or registered are logged and skipped. Only fails if the directory cannot
+   * be listed.
+   */
+  Status RegisterQueriesFromDir(const std::filesystem::path& dir);
+
+  /**
+   * Rewrites a compiled plan to process the window [start_time_ns, stop_time_ns), and to append
+   * the tables that it displays to the local table store.
+   */
+  static Status PrepareWindowPlan(int64_t start_time_ns, int64_t stop_time_ns,
+                                  planpb::Plan* plan);
+
+  size_t num_queries() const { return queries_.size(); }
+
+ private:
+  class ContinuousQueryTask;
+
+  struct ContinuousQuery {
+    planpb::Plan plan;
+    // The end of the last window that was processed.
+    int64_t last_window_end_ns = 0;
+    // The id of the run that is queued or in progress, if any. Runs of the same query never
+    // overlap.
+    std::optional<sole::uuid> run_id;
+    // The task of the run, once it is started by the scheduler.
+    px::event::RunnableAsyncTaskUPtr running;
+  };
+
+  // Starts a run of every query that is not running and has a complete window to process.
+  void RunQueries();
+  void StartRun(const std::string& name, planpb::Plan plan);
+  void HandleRunComplete(const std::string& name);
+  Status CreateOutputTables(const planpb::Plan& plan);
+  int64_t LastWindowEnd() const;
+
+  px::event::Dispatcher* dispatcher_;
+  carnot::Carnot* carnot_;
+  QueryScheduler* query_scheduler_;
+  table_store::TableStore* table_store_;
+  RelationInfoManager* relation_info_manager_;
+  const std::chrono::milliseconds window_;
+  const int64_t table_size_limit_;
+
+  px::event::TimerUPtr run_timer_;
+  absl::flat_hash_map<std::string, ContinuousQuery> queries_;
+};
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/file.h"
+#include "src/common/event/api_impl.h"
+#include "src/common/testing/event/simulated_time_system.h"
+#include "src/common/testing/protobuf.h"
+#include "src/common/testing/testing.h"
+#include "src/vizier/services/agent/manager/test_utils.h"
+#include "src/vizier/services/agent/pem/continuous_query_manager.h"
+
+namespace px {
+namespace vizier {
+namespace agent {
+
+using ::google::protobuf::TextFormat;
+using ::px::testing::proto::EqualsProto;
+
+constexpr char kStreamingPlan[] = R"proto(
+  nodes {
+    id: 1
+    nodes {
+      id: 1
+      op {
+        op_type: MEMORY_SOURCE_OPERATOR
+        mem_source_op {
+          name: "http_events"
+          column_idxs: 0
+          column_names: "time_"
+          column_types: TIME64NS
+          streaming: true
+        }
+      }
+    }
+    nodes {
+      id: 2
+      op {
+        op_type: GRPC_SINK_OPERATOR
+        grpc_sink_op {
+          address: ""
+          output_table {
+            table_name: "http_latency_10s"
+            column_types: TIME64NS
+            column_names: "time_"
+            column_semantic_types: ST_NONE
+          }
+        }
+      }
+    }
+  }
+)proto";
+
+constexpr char kWindowPlan[] = R"proto(
+  nodes {
+    id: 1
+    nodes {
+      id: 1
+      op {
+        op_type: MEMORY_SOURCE_OPERATOR
+        mem_source_op {
+          name: "http_events"
+          column_idxs: 0
+          column_names: "time_"
+          column_types: TIME64NS
+          start_time { value: 10000 }
+          stop_time { value: 19999 }
+        }
+      }
+    }
+    nodes {
+      id: 2
+      op {
+        op_type: MEMORY_SINK_OPERATOR
+        mem_sink_op {
+          name: "http_latency_10s"
+          column_types: TIME64NS
+          column_names: "time_"
+          column_semantic_types: ST_NONE
+          append: true
+        }
+      }
+    }
+  }
+)proto";
+
+TEST(ContinuousQueryManagerTest, PrepareWindowPlan) {
+  planpb::Plan plan;
+  ASSERT_TRUE(TextFormat::ParseFromString(kStreamingPlan, &plan));
+  ASSERT_OK(ContinuousQueryManager::PrepareWindowPlan(10000, 20000, &plan));
+  EXPECT_THAT(plan, EqualsProto(kWindowPlan));
+
+  // Preparing the plan again only moves the window.
+  ASSERT_OK(ContinuousQueryManager::PrepareWindowPlan(20000, 30000, &plan));
+  EXPECT_EQ(20000, plan.nodes(0).nodes(0).op().mem_source_op().start_time().value());
+  EXPECT_EQ(29999, plan.nodes(0).nodes(0).op().mem_source_op().stop_time().value());
+  EXPECT_TRUE(plan.nodes(0).nodes(1).op().mem_sink_op().append());
+}
+
+constexpr char kInternalSinkPlan[] = R"proto(
+  nodes {
+    id: 1
+    nodes {
+      id: 1
+      op {
+        op_type: GRPC_SINK_OPERATOR
+        grpc_sink_op { address: "kelvin:59300" grpc_source_id: 3 }
+      }
+    }
+  }
+)proto";
+
+TEST(ContinuousQueryManagerTest, PrepareWindowPlanRejectsInternalSinks) {
+  planpb::Plan plan;
+  ASSERT_TRUE(TextFormat::ParseFromString(kInternalSinkPlan, &plan));
+  EXPECT_NOT_OK(ContinuousQueryManager::PrepareWindowPlan(10000, 20000, &plan));
+}
+
+class ContinuousQueryManagerRunTest : public ::testing::Test {
+ protected:
+  void TearDown() override { dispatcher_->Exit(); }
+
+  ContinuousQueryManagerRunTest()
+      : carnot_([this](const planpb::Plan& plan, const sole::uuid&,
+                       carnot::exec::YieldFunc yield_func) {
+          absl::MutexLock lock(&mu_);
+          executions_.push_back(Execution{plan, yield_func != nullptr,
+                                          query_scheduler_->num_running(QueryClass::kBackground)});
+        }) {
+    start_monotonic_time_ = std::chrono::steady_clock::now();
+    start_system_time_ = std::chrono::system_clock::now();
+    time_system_ =
+        std::make_unique<event::SimulatedTimeSystem>(start_monotonic_time_, start_system_time_);
+    api_ = std::make_unique<px::event::APIImpl>(time_system_.get());
+    dispatcher_ = api_->AllocateDispatcher("manager");
+
+    QueryScheduler::Config config;
+    config.max_running = {1, 1, 1};
+    config.time_slice = std::chrono::milliseconds(0);
+    config.max_pause = std::chrono::milliseconds(0);
+    query_scheduler_ = std::make_unique<QueryScheduler>(config);
+    relation_info_manager_ = std::make_unique<RelationInfoManager>();
+
+    manager_ = std::make_unique<ContinuousQueryManager>(
+        dispatcher_.get(), &carnot_, query_scheduler_.get(), &table_store_,
+        relation_info_manager_.get(), std::chrono::milliseconds(1), /* table_size_limit */ 1024);
+  }
+
+  struct Execution {
+    planpb::Plan plan;
+    bool has_yield_func;
+    // The number of running background queries, when the plan was executed.
+    int num_running;
+  };
+
+  std::vector<Execution> executions() {
+    absl::MutexLock lock(&mu_);
+    return executions_;
+  }
+
+  // Runs the event loop until the condition holds, or for at most 10s.
+  template <typename TCondition>
+  bool RunUntil(TCondition condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!condition() && std::chrono::steady_clock::now() < deadline) {
+      dispatcher_->Run(event::Dispatcher::RunType::NonBlock);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return condition();
+  }
+
+  event::MonotonicTimePoint start_monotonic_time_;
+  event::SystemTimePoint start_system_time_;
+  std::unique_ptr<event::SimulatedTimeSystem> time_system_;
+  std::unique_ptr<event::APIImpl> api_;
+  std::unique_ptr<event::Dispatcher> dispatcher_;
+  FakeCarnot carnot_;
+  std::unique_ptr<QueryScheduler> query_scheduler_;
+  table_store::TableStore table_store_;
+  std::unique_ptr<RelationInfoManager> relation_info_manager_;
+  std::unique_ptr<ContinuousQueryManager> manager_;
+
+  absl::Mutex mu_;
+  std::vector<Execution> executions_ ABSL_GUARDED_BY(mu_);
+};
+
+TEST_F(ContinuousQueryManagerRunTest, RunsWindowsAsBackgroundQueries) {
+  planpb::Plan plan;
+  ASSERT_TRUE(TextFormat::ParseFromString(kStreamingPlan, &plan));
+  carnot_.set_compiled_plan(plan);
+  ASSERT_OK(manager_->RegisterQuery("http_latency", "import px"));
+  EXPECT_TRUE(relation_info_manager_->HasRelation("http_latency_10s"));
+  EXPECT_NE(table_store_.GetTable("http_latency_10s"), nullptr);
+
+  // Let a window complete, then fire the run timer.
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  time_system_->SetMonotonicTime(start_monotonic_time_ + std::chrono::seconds(1));
+  ASSERT_TRUE(RunUntil([this]() {
+    return executions().size() == 1 &&
+           query_scheduler_->num_admitted(QueryClass::kBackground) == 0;
+  }));
+
+  const Execution& execution = executions()[0];
+  // The run counts as a running background query, and is time sliced.
+  EXPECT_EQ(execution.num_running, 1);
+  EXPECT_TRUE(execution.has_yield_func);
+  const auto& source = execution.plan.nodes(0).nodes(0).op().mem_source_op();
+  EXPECT_FALSE(source.streaming());
+  EXPECT_LT(source.start_time().value(), source.stop_time().value());
+  EXPECT_TRUE(execution.plan.nodes(0).nodes(1).op().mem_sink_op().append());
+  EXPECT_EQ(query_scheduler_->num_running(QueryClass::kBackground), 0);
+}
+
+TEST_F(ContinuousQueryManagerRunTest, RegisterQueriesFromDirSkipsBadScripts) {
+  planpb::Plan plan;
+  ASSERT_TRUE(TextFormat::ParseFromString(kStreamingPlan, &plan));
+  carnot_.set_compiled_plan(plan);
+  carnot_.set_compile_error("import bad", error::InvalidArgument("bad script"));
+
+  px::testing::TempDir dir;
+  ASSERT_OK(WriteFileFromString((dir.path() / "bad.pxl").string(), "import bad"));
+  ASSERT_OK(WriteFileFromString((dir.path() / "http_latency.pxl").string(), "import px"));
+  ASSERT_OK(WriteFileFromString((dir.path() / "README.md").string(), "import bad"));
+
+  ASSERT_OK(manager_->RegisterQueriesFromDir(dir.path()));
+  EXPECT_EQ(manager_->num_queries(), 1);
+  EXPECT_TRUE(relation_info_manager_->HasRelation("http_latency_10s"));
+
+  EXPECT_NOT_OK(manager_->RegisterQueriesFromDir(dir.path() / "missing"));
+}
+
+}  // namespace agent
+}  // namespace vizier
+}  // namespace px
@@ -43,6 +43,20 @@ DEFINE_int32(table_store_proc_exit_events_limit_bytes,
              gflags::Int32FromEnv("PL_TABLE_STORE_PROC_EXIT_EVENTS_LIMIT_BYTES", 10 * 1024 * 1024),
              "The maximum amount of data to store in the proc_exit_events table.");
 
+DEFINE_string(continuous_queries_dir, gflags::StringFromEnv("PL_CONTINUOUS_QUERIES_DIR", ""),
+              "A directory of PxL scripts (*.pxl) to run continuously in the background. Every "
+              "window, each script processes the data of the last window, and appends the tables "
+              "it displays to the table store. Disabled if empty.");
+
+DEFINE_int32(continuous_queries_window_s,
+             gflags::Int32FromEnv("PL_CONTINUOUS_QUERIES_WINDOW_S", 10),
+             "The window of the continuous queries, in seconds.");
+
+DEFINE_int32(table_store_continuous_query_table_limit_bytes,
+             gflags::Int32FromEnv("PL_TABLE_STORE_CONTINUOUS_QUERY_TABLE_LIMIT_BYTES",
+                                  16 * 1024 * 1024),
+             "The maximum amount of data to store in each output table of the continuous queries.");
+
 namespace px {
 namespace vizier {
 namespace agent {
@@ -64,12 +78,15 @@ Status PEMManager::PostRegisterHookImpl() {
   // Register the metadata callback for Stirling.
   stirling_->RegisterAgentMetadataCallback(
       std::bind(&px::md::AgentMetadataStateManager::CurrentAgentMetadataState, mds_manager()));
+  stirling_->RegisterProcessLifecycleCallback(
+      std::bind(&px::md::AgentMetadataStateManager::AddProcessLifecycleEvent, mds_manager(),
+                std::placeholders::_1));
 
   PL_RETURN_IF_ERROR(InitSchemas());
   PL_RETURN_IF_ERROR(stirling_->RunAsThread());
 
   auto execute_query_handler = std::make_shared<ExecuteQueryMessageHandler>(
-      dispatcher(), info(), agent_nats_connector(), carnot());
+      dispatcher(), info(), agent_nats_connector(), carnot(), query_scheduler());
   PL_RETURN_IF_ERROR(RegisterMessageHandler(messages::VizierMessage::MsgCase::kExecuteQueryRequest,
                                             execute_query_handler));
 
@@ -78,6 +95,8 @@ Status PEMManager::PostRegisterHookImpl() {
                                           stirling_.get(), table_store(), relation_info_manager());
   PL_RETURN_IF_ERROR(RegisterMessageHandler(messages::VizierMessage::MsgCase::kTracepointMessage,
                                             tracepoint_manager_));
+
+  PL_RETURN_IF_ERROR(InitContinuousQueries());
   return Status::OK();
 }
 
@@ -130,6 +149,26 @@ Status PEMManager::InitSchemas() {
   return Status::OK();
 }
 
+Status PEMManager::InitContinuousQueries() {
+  if (FLAGS_continuous_queries_dir.empty()) {
+    return Status::OK();
+  }
+  if (FLAGS_continuous_queries_window_s <= 0) {
+    return error::InvalidArgument("--continuous_queries_window_s must be positive, got $0",
+                                  FLAGS_continuous_queries_window_s);
+  }
+  // The queries read the tables created by InitSchemas(), so they must be registered after it.
+  continuous_query_manager_ = std::make_unique<ContinuousQueryManager>(
+      dispatcher(), carnot(), query_scheduler(), table_store(), relation_info_manager(),
+      std::chrono::seconds(FLAGS_continuous_queries_window_s),
+      FLAGS_table_store_continuous_query_table_limit_bytes);
+  PL_RETURN_IF_ERROR(
+      continuous_query_manager_->RegisterQueriesFromDir(FLAGS_continuous_queries_dir));
+  LOG(INFO) << absl::Substitute("Registered $0 continuous queries",
+                                continuous_query_manager_->num_queries());
+  return Status::OK();
+}
+
 Status PEMManager::InitClockConverters() {
   clock_converter_timer_ = dispatcher()->CreateTimer([this]() {
     auto clock_converter = px::system::Config::GetInstance().clock_converter();
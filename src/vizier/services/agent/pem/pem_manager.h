@@ -28,6 +28,7 @@
 
 #include "src/stirling/stirling.h"
 #include "src/vizier/services/agent/manager/manager.h"
+#include "src/vizier/services/agent/pem/continuous_query_manager.h"
 #include "src/vizier/services/agent/pem/tracepoint_manager.h"
 
 namespace px {
@@ -82,6 +83,7 @@ class PEMManager : public Manager {
  private:
   Status InitSchemas();
   Status InitClockConverters();
+  Status InitContinuousQueries();
   void StartNodeMemoryCollector();
   static services::shared::agent::AgentCapabilities Capabilities() {
     services::shared::agent::AgentCapabilities capabilities;
@@ -91,6 +93,7 @@ class PEMManager : public Manager {
 
   std::unique_ptr<stirling::Stirling> stirling_;
   std::shared_ptr<TracepointManager> tracepoint_manager_;
+  std::unique_ptr<ContinuousQueryManager> continuous_query_manager_;
 
   // Timer for triggering ClockConverter polls.
   px::event::TimerUPtr clock_converter_timer_;